@@ -0,0 +1,2268 @@
+//
+// flare16x core
+// Developed 2019 by Benedikt Muessig <github@bmuessig.eu>
+// Licensed under GPLv3
+//
+// bench.c: Benchmarks of the library on synthetic screenshots
+//
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+// For fopencookie, which counts the bytes the pipeline reads on glibc
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include "error.h"
+#include "bitmap.h"
+#include "canvas.h"
+#include "ocr.h"
+#include "locator.h"
+#include "palettes.h"
+#include "thermal.h"
+#include "stream.h"
+#include "convert.h"
+#include "container.h"
+#include "export.h"
+#include "codec.h"
+#include "series.h"
+#include "sequence.h"
+#include "synth.h"
+
+// The number of pixels of a screenshot
+#define FLARE16X_BENCH_SCREENSHOT_PIXELS (FLARE16X_LOCATOR_EXPECTED_WIDTH * FLARE16X_LOCATOR_EXPECTED_HEIGHT)
+// The number of pixels of the IR image
+#define FLARE16X_BENCH_IR_PIXELS (FLARE16X_LOCATOR_IR_WIDTH * FLARE16X_LOCATOR_IR_HEIGHT)
+// The number of pixels of the OSD text strip
+#define FLARE16X_BENCH_TEXT_PIXELS (FLARE16X_LOCATOR_TEXT_WIDTH * FLARE16X_LOCATOR_TEXT_HEIGHT)
+// The capacity of the buffers that outputs are written to
+#define FLARE16X_BENCH_BUFFER_SIZE (1024 * 1024)
+// Marks a benchmark that does not use the conversion kernels
+#define FLARE16X_BENCH_NO_ISA 0xff
+// The number of frames of the container that is searched
+#define FLARE16X_BENCH_CONTAINER_FRAMES 32
+
+// A named enum value used to parse the command line
+typedef struct {
+    const char* name;
+    uint8_t value;
+} flare16x_bench_name;
+
+// The names of the device models
+static const flare16x_bench_name flare16x_bench_models[] = {
+    {"tg165", FLARE16X_LOCATOR_MODEL_TG165},
+    {"tg167", FLARE16X_LOCATOR_MODEL_TG167},
+    {NULL, 0}
+};
+
+// The names of the palettes
+static const flare16x_bench_name flare16x_bench_palettes[] = {
+    {"iron", FLARE16X_PALETTES_IRON},
+    {"grayscale", FLARE16X_PALETTES_GRAYSCALE},
+    {"rainbow", FLARE16X_PALETTES_RAINBOW},
+    {NULL, 0}
+};
+
+// The names of the scenes
+static const flare16x_bench_name flare16x_bench_scenes[] = {
+    {"waves", FLARE16X_SYNTH_SCENE_WAVES},
+    {"gradient", FLARE16X_SYNTH_SCENE_GRADIENT},
+    {"spots", FLARE16X_SYNTH_SCENE_SPOTS},
+    {"flat", FLARE16X_SYNTH_SCENE_FLAT},
+    {NULL, 0}
+};
+
+// The options parsed from the command line
+typedef struct {
+    // The number of timed calls per benchmark
+    unsigned iterations;
+    // The device model, palette and scene or 0xff for all of them
+    uint8_t model;
+    uint8_t palette;
+    uint8_t scene;
+    // The noise of the synthetic screenshots
+    uint8_t noise;
+    // Only the benchmarks whose names contain this string are run, if it is not null
+    const char* filter;
+    // If non-zero, the hardware counters are printed instead of the allocations
+    uint8_t counters;
+    // The generated screenshots are written to this directory instead of running the benchmarks, if it is not null
+    const char* output_directory;
+    // The number of screenshots processed by the end-to-end benchmark or zero to run the microbenchmarks
+    size_t images;
+    // The maximum number of threads of the end-to-end benchmark or zero for all cores
+    unsigned threads;
+    // The end-to-end results are written to this JSON file, if it is not null
+    const char* report_path;
+    // The end-to-end results are compared with this JSON file, if it is not null
+    const char* baseline_path;
+    // The largest loss of throughput or gain of p99 latency in percent that is not a regression
+    double threshold;
+} flare16x_bench_options;
+
+// The inputs prepared once per screenshot and the state of the benchmark that is running
+typedef struct {
+    // The synthetic screenshot and its file image
+    flare16x_bitmap screenshot;
+    uint8_t* file;
+    size_t file_size;
+    // The screenshot compressed by the codec
+    uint8_t* archive;
+    size_t archive_size;
+    // A buffer that outputs are written to
+    uint8_t* buffer;
+    // A fully processed thermal context and a canvas of its size that other canvases are merged onto
+    flare16x_thermal thermal;
+    flare16x_canvas canvas;
+    // A second processed frame of the same scene with the crosshair moved and both frames in order
+    flare16x_thermal neighbour;
+    flare16x_thermal* frames[2];
+    // The values of the thermal context as a floating point plane
+    float* floats;
+    // A container of several copies of the thermal context, attached in memory and stored in a temporary file
+    char* container_data;
+    size_t container_size;
+    flare16x_container container;
+    char container_path[32];
+    // A sequence of a keyframe of the thermal context and a delta frame of its neighbour
+    char* sequence_data;
+    size_t sequence_size;
+    // A thermal image that the frames of the sequence are decoded into
+    flare16x_thermal_image image;
+    // The palette the screenshot was rendered with
+    uint8_t palette;
+    // The OSD temperature and emissivity the screenshot was rendered with
+    char temperature[FLARE16X_LOCATOR_TEMPERATURE_DIGITS + 1];
+    char emissivity[FLARE16X_LOCATOR_EMISSIVITY_DIGITS + 1];
+    // The state of the generator that picks the pixels flipped in the OSD text
+    uint32_t flip_state;
+    // The streaming recolor context
+    flare16x_stream stream;
+    // The OSD text cache
+    flare16x_thermal_ocr_cache cache;
+    // The conversion and accumulation kernels of the running benchmark
+    const flare16x_convert_kernels* kernels;
+    flare16x_series_kernel accumulate;
+    // The per-call state of the running benchmark
+    flare16x_bitmap work_bitmap;
+    flare16x_locator work_locator;
+    flare16x_thermal work_thermal;
+    flare16x_canvas work_canvas;
+    flare16x_thermal_image work_image;
+    flare16x_series_accumulator work_accumulator;
+    FILE* work_file;
+    flare16x_container_writer work_container;
+    flare16x_sequence_writer work_writer;
+    flare16x_sequence work_sequence;
+} flare16x_bench_context;
+
+// A benchmark of a single library function
+typedef struct {
+    // The name of the benchmark
+    const char* name;
+    // The number of pixels processed by every call
+    uint32_t pixels;
+    // The instruction set of the kernels as defined in FLARE16X_CONVERT_ISA_* or FLARE16X_BENCH_NO_ISA
+    uint8_t isa;
+    // Prepares the context before every call without being timed, may be null
+    flare16x_error (*prepare)(flare16x_bench_context* context);
+    // Calls the function that is timed
+    flare16x_error (*run)(flare16x_bench_context* context);
+    // Frees the resources left by a call without being timed, may be null
+    void (*cleanup)(flare16x_bench_context* context);
+} flare16x_bench_case;
+
+// The number of allocations and the bytes requested while counting
+static volatile int flare16x_bench_counting = 0;
+static uint64_t flare16x_bench_allocations = 0;
+static uint64_t flare16x_bench_allocated = 0;
+
+#ifdef FLARE16X_BENCH_WRAP
+// The allocator is wrapped by the linker, so that every allocation of the library is counted
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* pointer, size_t size);
+
+// Counts an allocation and forwards it to the real allocator
+void* __wrap_malloc(size_t size)
+{
+    if (flare16x_bench_counting)
+    {
+        flare16x_bench_allocations++;
+        flare16x_bench_allocated += size;
+    }
+    return __real_malloc(size);
+}
+
+// Counts an allocation and forwards it to the real allocator
+void* __wrap_calloc(size_t count, size_t size)
+{
+    if (flare16x_bench_counting)
+    {
+        flare16x_bench_allocations++;
+        flare16x_bench_allocated += count * size;
+    }
+    return __real_calloc(count, size);
+}
+
+// Counts an allocation and forwards it to the real allocator
+void* __wrap_realloc(void* pointer, size_t size)
+{
+    if (flare16x_bench_counting)
+    {
+        flare16x_bench_allocations++;
+        flare16x_bench_allocated += size;
+    }
+    return __real_realloc(pointer, size);
+}
+#endif
+
+// Hardware counter enum
+enum {
+    // The CPU cycles spent in user space
+    FLARE16X_BENCH_CYCLES,
+    // The instructions retired in user space
+    FLARE16X_BENCH_INSTRUCTIONS,
+    // The reads that missed the L1 data cache
+    FLARE16X_BENCH_L1D_MISSES,
+    // The reads that missed the last level cache
+    FLARE16X_BENCH_LLC_MISSES,
+    // The mispredicted branches
+    FLARE16X_BENCH_BRANCH_MISSES,
+    // The number of hardware counters
+    FLARE16X_BENCH_COUNTER_COUNT
+};
+
+// The hardware counters of the calling thread
+typedef struct {
+    // The file descriptor of every counter or -1, if it is not available
+    int descriptors[FLARE16X_BENCH_COUNTER_COUNT];
+    // The counter that leads the group of every counter, which is the counter itself for a leader
+    uint8_t leaders[FLARE16X_BENCH_COUNTER_COUNT];
+    // The sum of every counter over all calls so far
+    uint64_t values[FLARE16X_BENCH_COUNTER_COUNT];
+    // The time every group leader was enabled and running for as of the last read
+    uint64_t enabled[FLARE16X_BENCH_COUNTER_COUNT];
+    uint64_t running[FLARE16X_BENCH_COUNTER_COUNT];
+    // The error number of the last counter that could not be opened
+    int error;
+} flare16x_bench_counters;
+
+// Opens the hardware counters of the calling thread and returns the number of counters available
+// All counters form one group led by the cycles, so that they count the very same instructions
+// Counters that cannot join this group are opened as groups of their own
+// Counters are unavailable, if the kernel denies access, the CPU lacks them or this is not Linux
+static int flare16x_bench_counters_open(flare16x_bench_counters* counters)
+{
+    int counter, leader = -1, available = 0;
+    memset(counters, 0, sizeof(flare16x_bench_counters));
+    for (counter = 0; counter < FLARE16X_BENCH_COUNTER_COUNT; counter++)
+        counters->descriptors[counter] = -1;
+    counters->error = ENOSYS;
+
+#ifdef __linux__
+    // The type and configuration of every counter in the order of the enum
+    static const uint32_t types[FLARE16X_BENCH_COUNTER_COUNT] = {
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE
+    };
+    static const uint64_t configs[FLARE16X_BENCH_COUNTER_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+
+    // Open the counters in the order of the enum, so that the first available one leads the group
+    for (counter = 0; counter < FLARE16X_BENCH_COUNTER_COUNT; counter++)
+    {
+        struct perf_event_attr attributes;
+        memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = types[counter];
+        attributes.config = configs[counter];
+        attributes.disabled = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        // Join the group or fall back to a group of its own, so that missing counters do not affect the others
+        if (leader >= 0)
+        {
+            counters->descriptors[counter] = (int)syscall(SYS_perf_event_open, &attributes, 0, -1,
+                    counters->descriptors[leader], 0);
+            counters->leaders[counter] = (uint8_t)leader;
+        }
+        if (counters->descriptors[counter] < 0)
+        {
+            counters->descriptors[counter] = (int)syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+            counters->leaders[counter] = (uint8_t)counter;
+        }
+        if (counters->descriptors[counter] < 0)
+        {
+            counters->error = errno;
+            continue;
+        }
+
+        // The first counter that is available leads the group
+        if (leader < 0)
+            leader = counter;
+        available++;
+    }
+#endif
+
+    return available;
+}
+
+// Resets and starts all available counters through the leaders of their groups
+static void flare16x_bench_counters_start(flare16x_bench_counters* counters)
+{
+#ifdef __linux__
+    int counter;
+    for (counter = 0; counter < FLARE16X_BENCH_COUNTER_COUNT; counter++)
+        if (counters->descriptors[counter] >= 0 && counters->leaders[counter] == counter)
+        {
+            ioctl(counters->descriptors[counter], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(counters->descriptors[counter], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#else
+    (void)counters;
+#endif
+}
+
+// Stops all available counters and adds their values, scaled up if the kernel had to multiplex them
+// Resetting a counter does not reset the times it was enabled and running for, so they are scaled by the time
+// that passed since the last read
+static void flare16x_bench_counters_stop(flare16x_bench_counters* counters)
+{
+#ifdef __linux__
+    int leader, counter;
+    for (leader = 0; leader < FLARE16X_BENCH_COUNTER_COUNT; leader++)
+    {
+        // Only the leaders can stop and read their groups
+        uint64_t data[3 + FLARE16X_BENCH_COUNTER_COUNT], enabled, running, member = 0;
+        ssize_t size;
+        if (counters->descriptors[leader] < 0 || counters->leaders[leader] != leader)
+            continue;
+        ioctl(counters->descriptors[leader], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+        // Read the number of counters, the time enabled, the time running and the values in the order they joined
+        size = read(counters->descriptors[leader], data, sizeof(data));
+        if (size < (ssize_t)(3 * sizeof(uint64_t)) || size < (ssize_t)((3 + data[0]) * sizeof(uint64_t)))
+            continue;
+        enabled = data[1] - counters->enabled[leader];
+        running = data[2] - counters->running[leader];
+        counters->enabled[leader] = data[1];
+        counters->running[leader] = data[2];
+
+        // Add the value of every member of the group
+        for (counter = leader; counter < FLARE16X_BENCH_COUNTER_COUNT && member < data[0]; counter++)
+            if (counters->descriptors[counter] >= 0 && counters->leaders[counter] == leader)
+            {
+                uint64_t value = data[3 + member++];
+                counters->values[counter] += running > 0 && running < enabled ?
+                        (uint64_t)((double)value * enabled / running) : value;
+            }
+    }
+#else
+    (void)counters;
+#endif
+}
+
+// Closes all available counters
+static void flare16x_bench_counters_close(flare16x_bench_counters* counters)
+{
+    int counter;
+    for (counter = 0; counter < FLARE16X_BENCH_COUNTER_COUNT; counter++)
+        if (counters->descriptors[counter] >= 0)
+            close(counters->descriptors[counter]);
+}
+
+// Prints a counter per pixel or a dash, if it is not available
+static void flare16x_bench_counters_print(const flare16x_bench_counters* counters, uint8_t counter, double pixels)
+{
+    if (counters->descriptors[counter] >= 0)
+        printf(" %11.3f", counters->values[counter] / pixels);
+    else
+        printf(" %11s", "-");
+}
+
+// Returns the current monotonic time in nanoseconds
+static uint64_t flare16x_bench_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+// Looks up a name in a list of names and stores the matching value, where "all" stores 0xff
+static int flare16x_bench_lookup(const flare16x_bench_name* names, const char* name, uint8_t* value)
+{
+    if (strcmp(name, "all") == 0)
+    {
+        *value = 0xff;
+        return 1;
+    }
+    for (; names->name != NULL; names++)
+        if (strcmp(names->name, name) == 0)
+        {
+            *value = names->value;
+            return 1;
+        }
+
+    return 0;
+}
+
+// Returns the name of a value from a list of names
+static const char* flare16x_bench_name_of(const flare16x_bench_name* names, uint8_t value)
+{
+    for (; names->name != NULL; names++)
+        if (names->value == value)
+            return names->name;
+
+    return "unknown";
+}
+
+// Opens the file image of the screenshot as a file
+static FILE* flare16x_bench_open(flare16x_bench_context* context)
+{
+    return fmemopen(context->file, context->file_size, "rb");
+}
+
+// Opens the output buffer as a file
+static FILE* flare16x_bench_create(flare16x_bench_context* context)
+{
+    return fmemopen(context->buffer, FLARE16X_BENCH_BUFFER_SIZE, "wb");
+}
+
+// Loads and processes the locator of the screenshot
+static flare16x_error flare16x_bench_prepare_locator(flare16x_bench_context* context)
+{
+    flare16x_error error = flare16x_locator_create(&context->screenshot, &context->work_locator);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_locator_process(&context->work_locator);
+    return error;
+}
+
+// Creates a thermal context of the screenshot
+static flare16x_error flare16x_bench_prepare_thermal(flare16x_bench_context* context)
+{
+    flare16x_error error = flare16x_bench_prepare_locator(context);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_thermal_create(&context->work_locator, &context->work_thermal);
+    return error;
+}
+
+// Exports the processed thermal context into the work canvas
+static flare16x_error flare16x_bench_prepare_canvas(flare16x_bench_context* context)
+{
+    return flare16x_thermal_export(&context->thermal, context->palette, &context->work_canvas);
+}
+
+// Frees the per-call state
+static void flare16x_bench_cleanup(flare16x_bench_context* context)
+{
+    flare16x_bitmap_destroy(&context->work_bitmap);
+    flare16x_locator_destroy(&context->work_locator);
+    flare16x_thermal_destroy(&context->work_thermal);
+    flare16x_canvas_destroy(&context->work_canvas);
+    flare16x_thermal_image_destroy(&context->work_image);
+    memset(&context->work_bitmap, 0, sizeof(flare16x_bitmap));
+    memset(&context->work_locator, 0, sizeof(flare16x_locator));
+    memset(&context->work_thermal, 0, sizeof(flare16x_thermal));
+    memset(&context->work_canvas, 0, sizeof(flare16x_canvas));
+}
+
+// Opens the output buffer as the file of a writer
+static flare16x_error flare16x_bench_prepare_file(flare16x_bench_context* context)
+{
+    context->work_file = flare16x_bench_create(context);
+    if (context->work_file == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_GLOBAL);
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_GLOBAL);
+}
+
+// Starts a container in the output buffer
+static flare16x_error flare16x_bench_prepare_container(flare16x_bench_context* context)
+{
+    flare16x_error error = flare16x_bench_prepare_file(context);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_container_create(context->work_file, &context->work_container);
+    return error;
+}
+
+// Starts a container in the output buffer that already holds a frame
+static flare16x_error flare16x_bench_prepare_container_frame(flare16x_bench_context* context)
+{
+    flare16x_error error = flare16x_bench_prepare_container(context);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_container_append(&context->work_container, "frame", 1, &context->thermal);
+    return error;
+}
+
+// Finishes the container in the output buffer, unless the timed call did, and closes the buffer
+static void flare16x_bench_cleanup_container(flare16x_bench_context* context)
+{
+    if (context->work_container.file != NULL)
+        flare16x_container_finish(&context->work_container);
+    if (context->work_file != NULL)
+        fclose(context->work_file);
+    context->work_file = NULL;
+}
+
+// Starts a sequence in the output buffer
+static flare16x_error flare16x_bench_prepare_writer(flare16x_bench_context* context)
+{
+    flare16x_thermal_image* image = context->thermal.thermal_image;
+    flare16x_error error = flare16x_bench_prepare_file(context);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_sequence_create(context->work_file, image->width, image->height,
+                FLARE16X_SEQUENCE_INTERVAL, &context->work_writer);
+    return error;
+}
+
+// Starts a sequence in the output buffer that already holds a keyframe, so that the next frame is a delta frame
+static flare16x_error flare16x_bench_prepare_writer_frame(flare16x_bench_context* context)
+{
+    flare16x_error error = flare16x_bench_prepare_writer(context);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_sequence_append(&context->work_writer, context->thermal.thermal_image);
+    return error;
+}
+
+// Finishes the sequence in the output buffer, unless the timed call did, and closes the buffer
+static void flare16x_bench_cleanup_writer(flare16x_bench_context* context)
+{
+    if (context->work_writer.file != NULL)
+        flare16x_sequence_finish(&context->work_writer);
+    if (context->work_file != NULL)
+        fclose(context->work_file);
+    context->work_file = NULL;
+}
+
+// Attaches the sequence
+static flare16x_error flare16x_bench_prepare_sequence(flare16x_bench_context* context)
+{
+    return flare16x_sequence_attach(context->sequence_data, context->sequence_size, &context->work_sequence);
+}
+
+// Attaches the sequence and decodes its keyframe, so that the delta frame is decoded next
+static flare16x_error flare16x_bench_prepare_sequence_frame(flare16x_bench_context* context)
+{
+    flare16x_error error = flare16x_bench_prepare_sequence(context);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_sequence_next(&context->work_sequence, &context->image);
+    return error;
+}
+
+// Frees the attached sequence
+static void flare16x_bench_cleanup_sequence(flare16x_bench_context* context)
+{
+    flare16x_sequence_destroy(&context->work_sequence);
+}
+
+// Creates an accumulator that already holds the thermal context
+static flare16x_error flare16x_bench_prepare_accumulator(flare16x_bench_context* context)
+{
+    flare16x_error error = flare16x_series_accumulator_create(&context->work_accumulator);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_series_accumulator_add(&context->work_accumulator, &context->thermal);
+    return error;
+}
+
+// Frees the accumulator
+static void flare16x_bench_cleanup_accumulator(flare16x_bench_context* context)
+{
+    flare16x_series_accumulator_destroy(&context->work_accumulator);
+}
+
+// flare16x_bitmap_load
+static flare16x_error flare16x_bench_bitmap_load(flare16x_bench_context* context)
+{
+    FILE* file = flare16x_bench_open(context);
+    if (file == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_GLOBAL);
+    flare16x_error error = flare16x_bitmap_load(file, &context->work_bitmap);
+    fclose(file);
+    return error;
+}
+
+// flare16x_bitmap_parse
+static flare16x_error flare16x_bench_bitmap_parse(flare16x_bench_context* context)
+{
+    return flare16x_bitmap_parse(context->file, context->file_size, 0, &context->work_bitmap);
+}
+
+// flare16x_bitmap_serialize_into
+static flare16x_error flare16x_bench_bitmap_serialize(flare16x_bench_context* context)
+{
+    size_t size;
+    return flare16x_bitmap_serialize_into(&context->screenshot, context->buffer, FLARE16X_BENCH_BUFFER_SIZE, &size);
+}
+
+// flare16x_bitmap_store
+static flare16x_error flare16x_bench_bitmap_store(flare16x_bench_context* context)
+{
+    FILE* file = flare16x_bench_create(context);
+    if (file == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_GLOBAL);
+    flare16x_error error = flare16x_bitmap_store(&context->screenshot, file);
+    fclose(file);
+    return error;
+}
+
+// Creates the bitmap that the visible image is merged onto
+static flare16x_error flare16x_bench_prepare_bitmap(flare16x_bench_context* context)
+{
+    return flare16x_bitmap_create16(context->thermal.visible_image->width, context->thermal.visible_image->height,
+            &context->work_bitmap);
+}
+
+// flare16x_bitmap_merge of the visible image
+static flare16x_error flare16x_bench_bitmap_merge(flare16x_bench_context* context)
+{
+    return flare16x_bitmap_merge(context->thermal.visible_image, 0, 0, &context->work_bitmap);
+}
+
+// flare16x_locator_create
+static flare16x_error flare16x_bench_locator_create(flare16x_bench_context* context)
+{
+    return flare16x_locator_create(&context->screenshot, &context->work_locator);
+}
+
+// flare16x_locator_load
+static flare16x_error flare16x_bench_locator_load(flare16x_bench_context* context)
+{
+    FILE* file = flare16x_bench_open(context);
+    if (file == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_GLOBAL);
+    flare16x_error error = flare16x_locator_load(file, &context->work_locator);
+    fclose(file);
+    return error;
+}
+
+// Creates the locator that is processed
+static flare16x_error flare16x_bench_prepare_process(flare16x_bench_context* context)
+{
+    return flare16x_locator_create(&context->screenshot, &context->work_locator);
+}
+
+// flare16x_locator_process
+static flare16x_error flare16x_bench_locator_process(flare16x_bench_context* context)
+{
+    return flare16x_locator_process(&context->work_locator);
+}
+
+// flare16x_thermal_create
+static flare16x_error flare16x_bench_thermal_create(flare16x_bench_context* context)
+{
+    return flare16x_thermal_create(&context->work_locator, &context->work_thermal);
+}
+
+// flare16x_thermal_ocr without a cache
+static flare16x_error flare16x_bench_thermal_ocr(flare16x_bench_context* context)
+{
+    return flare16x_thermal_ocr(&context->thermal, NULL);
+}
+
+// flare16x_thermal_ocr with a cache that holds the text
+static flare16x_error flare16x_bench_thermal_ocr_cached(flare16x_bench_context* context)
+{
+    return flare16x_thermal_ocr(&context->thermal, &context->cache);
+}
+
+// flare16x_ocr_large_string of the OSD temperature
+static flare16x_error flare16x_bench_ocr_large_string(flare16x_bench_context* context)
+{
+    char result[FLARE16X_LOCATOR_TEMPERATURE_DIGITS + 1];
+    return flare16x_ocr_large_string(FLARE16X_LOCATOR_TEMPERATURE_OFFSET_X, FLARE16X_LOCATOR_TEMPERATURE_OFFSET_Y,
+            FLARE16X_LOCATOR_TEMPERATURE_PITCH, FLARE16X_LOCATOR_TEMPERATURE_DIGITS, 0, context->thermal.text_image,
+            result);
+}
+
+// flare16x_ocr_small_string of the OSD emissivity
+static flare16x_error flare16x_bench_ocr_small_string(flare16x_bench_context* context)
+{
+    char result[FLARE16X_LOCATOR_EMISSIVITY_DIGITS + 1];
+    return flare16x_ocr_small_string(FLARE16X_LOCATOR_EMISSIVITY_OFFSET_X, FLARE16X_LOCATOR_EMISSIVITY_OFFSET_Y,
+            FLARE16X_LOCATOR_EMISSIVITY_PITCH, FLARE16X_LOCATOR_EMISSIVITY_DIGITS, 0, context->thermal.text_image,
+            result);
+}
+
+// Flips a pixel of every glyph of a field, and a second one of every other glyph
+static void flare16x_bench_flip_field(uint16_t offset_x, uint16_t offset_y, uint16_t pitch, uint8_t length,
+        const flare16x_ocr_font* font, flare16x_bench_context* context)
+{
+    uint16_t previous_x = 0, previous_y = 0;
+    uint8_t glyph, flip;
+    for (glyph = 0; glyph < length; glyph++)
+    {
+        for (flip = 0; flip < 1 + glyph % 2; flip++)
+        {
+            // Pick a pixel of the glyph with an xorshift generator, never flipping the same pixel back
+            uint16_t x, y;
+            do
+            {
+                context->flip_state ^= context->flip_state << 13;
+                context->flip_state ^= context->flip_state >> 17;
+                context->flip_state ^= context->flip_state << 5;
+                x = (uint16_t)(context->flip_state % font->width);
+                y = (uint16_t)(context->flip_state / font->width % font->height);
+            }
+            while (flip > 0 && x == previous_x && y == previous_y);
+            previous_x = x;
+            previous_y = y;
+
+            // Turn a pixel of the text into background and any other pixel into text
+            uint16_t* pixel = &flare16x_canvas_raw(offset_x + glyph * (font->width + pitch) + x, offset_y + y,
+                    &context->work_canvas);
+            *pixel = *pixel == font->color ? 0 : font->color;
+        }
+    }
+}
+
+// Copies the text image into the work canvas and flips one or two pixels of every glyph of the OSD text
+static flare16x_error flare16x_bench_prepare_flipped(flare16x_bench_context* context)
+{
+    flare16x_canvas* source = context->thermal.text_image;
+    flare16x_error error = flare16x_canvas_copy(source, 0, 0, source->width, source->height, &context->work_canvas);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return error;
+    flare16x_bench_flip_field(FLARE16X_LOCATOR_TEMPERATURE_OFFSET_X, FLARE16X_LOCATOR_TEMPERATURE_OFFSET_Y,
+            FLARE16X_LOCATOR_TEMPERATURE_PITCH, FLARE16X_LOCATOR_TEMPERATURE_DIGITS, &flare16x_ocr_large_font, context);
+    flare16x_bench_flip_field(FLARE16X_LOCATOR_EMISSIVITY_OFFSET_X, FLARE16X_LOCATOR_EMISSIVITY_OFFSET_Y,
+            FLARE16X_LOCATOR_EMISSIVITY_PITCH, FLARE16X_LOCATOR_EMISSIVITY_DIGITS, &flare16x_ocr_small_font, context);
+    return error;
+}
+
+// flare16x_ocr_large_string of the OSD temperature with flipped pixels, which must still read the rendered text
+static flare16x_error flare16x_bench_ocr_large_flipped(flare16x_bench_context* context)
+{
+    char result[FLARE16X_LOCATOR_TEMPERATURE_DIGITS + 1];
+    flare16x_error error = flare16x_ocr_large_string(FLARE16X_LOCATOR_TEMPERATURE_OFFSET_X,
+            FLARE16X_LOCATOR_TEMPERATURE_OFFSET_Y, FLARE16X_LOCATOR_TEMPERATURE_PITCH,
+            FLARE16X_LOCATOR_TEMPERATURE_DIGITS, 0, &context->work_canvas, result);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE && strcmp(result, context->temperature) != 0)
+        return flare16x_error_make(FLARE16X_ERROR_ASSERT, FLARE16X_ERROR_SOURCE_GLOBAL);
+    return error;
+}
+
+// flare16x_ocr_small_string of the OSD emissivity with flipped pixels, which must still read the rendered text
+static flare16x_error flare16x_bench_ocr_small_flipped(flare16x_bench_context* context)
+{
+    char result[FLARE16X_LOCATOR_EMISSIVITY_DIGITS + 1];
+    flare16x_error error = flare16x_ocr_small_string(FLARE16X_LOCATOR_EMISSIVITY_OFFSET_X,
+            FLARE16X_LOCATOR_EMISSIVITY_OFFSET_Y, FLARE16X_LOCATOR_EMISSIVITY_PITCH,
+            FLARE16X_LOCATOR_EMISSIVITY_DIGITS, 0, &context->work_canvas, result);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE && strcmp(result, context->emissivity) != 0)
+        return flare16x_error_make(FLARE16X_ERROR_ASSERT, FLARE16X_ERROR_SOURCE_GLOBAL);
+    return error;
+}
+
+// flare16x_thermal_probe without a cache
+static flare16x_error flare16x_bench_thermal_probe(flare16x_bench_context* context)
+{
+    FILE* file = flare16x_bench_open(context);
+    if (file == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_GLOBAL);
+    flare16x_error error = flare16x_thermal_probe(file, &context->work_thermal, NULL);
+    fclose(file);
+    return error;
+}
+
+// flare16x_palettes_determine
+static flare16x_error flare16x_bench_palettes_determine(flare16x_bench_context* context)
+{
+    uint8_t palette;
+    return flare16x_palettes_determine(context->thermal.visible_image, FLARE16X_PALETTES_IGNORE_ERRORS, &palette);
+}
+
+// flare16x_palettes_tally_init, flare16x_palettes_tally_line on every IR line and flare16x_palettes_tally_result
+static flare16x_error flare16x_bench_palettes_tally(flare16x_bench_context* context)
+{
+    const flare16x_canvas* canvas = context->thermal.visible_image;
+    flare16x_palette_tally tally;
+    uint8_t palette;
+    uint16_t y;
+    flare16x_error error = flare16x_palettes_tally_init(FLARE16X_PALETTES_IGNORE_ERRORS, &tally);
+    for (y = 0; y < canvas->height && flare16x_error_reason(error) == FLARE16X_ERROR_NONE; y++)
+        error = flare16x_palettes_tally_line(&canvas->pixels[(size_t)y * canvas->width], canvas->width, &tally);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_palettes_tally_result(&tally, &palette);
+    return error;
+}
+
+// The linear palette search that flare16x_palettes_find_color falls back to on a cache miss, on every IR pixel
+static flare16x_error flare16x_bench_find_color(flare16x_bench_context* context)
+{
+    static volatile size_t found;
+    const flare16x_canvas* canvas = context->thermal.visible_image;
+    const flare16x_palette_entry* palette = flare16x_palettes_get(context->palette);
+    int length = flare16x_palettes_get_length(context->palette), item;
+    size_t pixel, matches = 0;
+    for (pixel = 0; pixel < (size_t)canvas->width * canvas->height; pixel++)
+    {
+        for (item = 0; item < length && palette[item].color != canvas->pixels[pixel]; item++);
+        matches += item < length;
+    }
+    found += matches;
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_GLOBAL);
+}
+
+// flare16x_palettes_find_color on every IR pixel with a single cache
+static flare16x_error flare16x_bench_find_color_cached(flare16x_bench_context* context)
+{
+    const flare16x_canvas* canvas = context->thermal.visible_image;
+    const flare16x_palette_entry* entry;
+    flare16x_palette_cache cache;
+    size_t pixel;
+    flare16x_palettes_cache_init(&cache);
+    for (pixel = 0; pixel < (size_t)canvas->width * canvas->height; pixel++)
+        flare16x_palettes_find_color(canvas->pixels[pixel], context->palette, &cache, &entry);
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_GLOBAL);
+}
+
+// flare16x_thermal_process
+static flare16x_error flare16x_bench_thermal_process(flare16x_bench_context* context)
+{
+    return flare16x_thermal_process(&context->work_thermal, FLARE16X_THERMAL_INTERPOLATION_SQUARE_LARGE,
+            FLARE16X_THERMAL_QUANTIFICATION_MEDIAN_LOW);
+}
+
+// flare16x_thermal_export
+static flare16x_error flare16x_bench_thermal_export(flare16x_bench_context* context)
+{
+    return flare16x_thermal_export(&context->thermal, context->palette, &context->work_canvas);
+}
+
+// flare16x_thermal_crosshair
+static flare16x_error flare16x_bench_thermal_crosshair(flare16x_bench_context* context)
+{
+    return flare16x_thermal_crosshair(FLARE16X_LOCATOR_CROSSHAIR_BORDER, FLARE16X_LOCATOR_CROSSHAIR_FILL,
+            &context->thermal, &context->work_canvas);
+}
+
+// flare16x_thermal_merge_masked of the image pixels of the visible image
+static flare16x_error flare16x_bench_thermal_merge_masked(flare16x_bench_context* context)
+{
+    return flare16x_thermal_merge_masked(&context->thermal.mask, FLARE16X_LOCATOR_DETECT_IMAGE,
+            context->thermal.visible_image, 0, 0, &context->canvas);
+}
+
+// flare16x_canvas_copy of the visible image
+static flare16x_error flare16x_bench_canvas_copy(flare16x_bench_context* context)
+{
+    flare16x_canvas* source = context->thermal.visible_image;
+    return flare16x_canvas_copy(source, 0, 0, source->width, source->height, &context->work_canvas);
+}
+
+// flare16x_canvas_merge of the visible image
+static flare16x_error flare16x_bench_canvas_merge(flare16x_bench_context* context)
+{
+    flare16x_canvas* source = context->thermal.visible_image;
+    return flare16x_canvas_merge(source, 0, 0, 0, 0, source->width, source->height, &context->canvas);
+}
+
+// flare16x_canvas_merge_keyed of the visible image without the crosshair fill
+static flare16x_error flare16x_bench_canvas_merge_keyed(flare16x_bench_context* context)
+{
+    flare16x_canvas* source = context->thermal.visible_image;
+    return flare16x_canvas_merge_keyed(source, 0, 0, 0, 0, source->width, source->height,
+            FLARE16X_LOCATOR_CROSSHAIR_FILL, &context->canvas);
+}
+
+// flare16x_canvas_merge_masked of the image pixels of the visible image
+static flare16x_error flare16x_bench_canvas_merge_masked(flare16x_bench_context* context)
+{
+    flare16x_canvas* source = context->thermal.visible_image;
+    return flare16x_canvas_merge_masked(source, context->thermal.mask.pixels, FLARE16X_LOCATOR_DETECT_IMAGE,
+            0, 0, 0, 0, source->width, source->height, &context->canvas);
+}
+
+// flare16x_stream_recolor
+static flare16x_error flare16x_bench_stream_recolor(flare16x_bench_context* context)
+{
+    FILE* source = flare16x_bench_open(context);
+    FILE* target = flare16x_bench_create(context);
+    flare16x_error error = source != NULL && target != NULL ?
+            flare16x_stream_recolor(&context->stream, source, target) :
+            flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_GLOBAL);
+    if (source != NULL)
+        fclose(source);
+    if (target != NULL)
+        fclose(target);
+    return error;
+}
+
+// flare16x_codec_encode
+static flare16x_error flare16x_bench_codec_encode(flare16x_bench_context* context)
+{
+    FILE* file = flare16x_bench_create(context);
+    if (file == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_GLOBAL);
+    flare16x_error error = flare16x_codec_encode(context->file, context->file_size, file);
+    fclose(file);
+    return error;
+}
+
+// flare16x_codec_decode
+static flare16x_error flare16x_bench_codec_decode(flare16x_bench_context* context)
+{
+    size_t size;
+    return flare16x_codec_decode(context->archive, context->archive_size, context->buffer,
+            FLARE16X_BENCH_BUFFER_SIZE, &size);
+}
+
+// flare16x_container_hash
+static flare16x_error flare16x_bench_container_hash(flare16x_bench_context* context)
+{
+    static volatile uint64_t hash;
+    hash = flare16x_container_hash(context->file, context->file_size, hash);
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_GLOBAL);
+}
+
+// flare16x_container_hash_file
+static flare16x_error flare16x_bench_container_hash_file(flare16x_bench_context* context)
+{
+    uint64_t hash;
+    FILE* file = flare16x_bench_open(context);
+    if (file == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_GLOBAL);
+    flare16x_error error = flare16x_container_hash_file(file, &hash);
+    fclose(file);
+    return error;
+}
+
+// flare16x_container_create
+static flare16x_error flare16x_bench_container_create(flare16x_bench_context* context)
+{
+    return flare16x_container_create(context->work_file, &context->work_container);
+}
+
+// flare16x_container_append
+static flare16x_error flare16x_bench_container_append(flare16x_bench_context* context)
+{
+    return flare16x_container_append(&context->work_container, "frame", 1, &context->thermal);
+}
+
+// flare16x_container_finish of a container with a single frame
+static flare16x_error flare16x_bench_container_finish(flare16x_bench_context* context)
+{
+    return flare16x_container_finish(&context->work_container);
+}
+
+// flare16x_container_open and flare16x_container_close of the container file
+static flare16x_error flare16x_bench_container_open(flare16x_bench_context* context)
+{
+    flare16x_container container;
+    flare16x_error error = flare16x_container_open(context->container_path, &container);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_container_close(&container);
+    return error;
+}
+
+// flare16x_container_attach
+static flare16x_error flare16x_bench_container_attach(flare16x_bench_context* context)
+{
+    flare16x_container container;
+    return flare16x_container_attach(context->container_data, context->container_size, &container);
+}
+
+// flare16x_container_find of the last frame
+static flare16x_error flare16x_bench_container_find(flare16x_bench_context* context)
+{
+    uint32_t index;
+    return flare16x_container_find(&context->container, "frame31", FLARE16X_BENCH_CONTAINER_FRAMES, &index);
+}
+
+// flare16x_container_frame_get of the last frame
+static flare16x_error flare16x_bench_container_frame_get(flare16x_bench_context* context)
+{
+    flare16x_container_frame frame;
+    return flare16x_container_frame_get(&context->container, FLARE16X_BENCH_CONTAINER_FRAMES - 1, &frame);
+}
+
+// flare16x_container_load of the last frame
+static flare16x_error flare16x_bench_container_load(flare16x_bench_context* context)
+{
+    return flare16x_container_load(&context->container, FLARE16X_BENCH_CONTAINER_FRAMES - 1, &context->work_image);
+}
+
+// flare16x_export_plane
+static flare16x_error flare16x_bench_export_plane(flare16x_bench_context* context)
+{
+    FILE* file = flare16x_bench_create(context);
+    if (file == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_GLOBAL);
+    flare16x_error error = flare16x_export_plane(file, FLARE16X_EXPORT_FORMAT_NPY, FLARE16X_EXPORT_PLANE_VALUE,
+            &context->thermal);
+    fclose(file);
+    return error;
+}
+
+// flare16x_export_floats
+static flare16x_error flare16x_bench_export_floats(flare16x_bench_context* context)
+{
+    flare16x_thermal_image* image = context->thermal.thermal_image;
+    FILE* file = flare16x_bench_create(context);
+    if (file == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_GLOBAL);
+    flare16x_error error = flare16x_export_floats(file, FLARE16X_EXPORT_FORMAT_NPY, image->width, image->height,
+            context->floats);
+    fclose(file);
+    return error;
+}
+
+// flare16x_series_accumulator_add to an accumulator that holds a frame
+static flare16x_error flare16x_bench_series_accumulator_add(flare16x_bench_context* context)
+{
+    return flare16x_series_accumulator_add(&context->work_accumulator, &context->thermal);
+}
+
+// flare16x_series_accumulator_result into the output buffer
+static flare16x_error flare16x_bench_series_accumulator_result(flare16x_bench_context* context)
+{
+    uint16_t* mean = (uint16_t*)context->buffer;
+    float* variance = (float*)(context->buffer + FLARE16X_BENCH_IR_PIXELS * sizeof(uint16_t));
+    return flare16x_series_accumulator_result(&context->work_accumulator, mean, variance);
+}
+
+// flare16x_series_register of a frame against itself
+static flare16x_error flare16x_bench_series_register(flare16x_bench_context* context)
+{
+    flare16x_series_shift shift;
+    return flare16x_series_register(&context->thermal, &context->thermal, FLARE16X_SERIES_RADIUS, &shift);
+}
+
+// flare16x_series_fill of the crosshair of the neighbour from the thermal context
+static flare16x_error flare16x_bench_series_fill(flare16x_bench_context* context)
+{
+    uint32_t filled;
+    return flare16x_series_fill(&context->neighbour, context->frames, 2, FLARE16X_SERIES_RADIUS, &filled);
+}
+
+// flare16x_series_normalize of the thermal context and its neighbour
+static flare16x_error flare16x_bench_series_normalize(flare16x_bench_context* context)
+{
+    flare16x_series_mapping mappings[2];
+    flare16x_series_scale scale;
+    return flare16x_series_normalize(context->frames, 2, FLARE16X_SERIES_RADIUS, mappings, &scale);
+}
+
+// flare16x_series_remap of the neighbour onto its own scale, which leaves its values unchanged
+static flare16x_error flare16x_bench_series_remap(flare16x_bench_context* context)
+{
+    static const flare16x_series_mapping mapping = {0, 1, 1};
+    static const flare16x_series_scale scale = {0, 0, 255};
+    return flare16x_series_remap(&context->frames[1], 1, &mapping, &scale);
+}
+
+// flare16x_sequence_create
+static flare16x_error flare16x_bench_sequence_create(flare16x_bench_context* context)
+{
+    flare16x_thermal_image* image = context->thermal.thermal_image;
+    return flare16x_sequence_create(context->work_file, image->width, image->height, FLARE16X_SEQUENCE_INTERVAL,
+            &context->work_writer);
+}
+
+// flare16x_sequence_append of the neighbour, which becomes a keyframe or a delta frame to the thermal context
+static flare16x_error flare16x_bench_sequence_append(flare16x_bench_context* context)
+{
+    return flare16x_sequence_append(&context->work_writer, context->neighbour.thermal_image);
+}
+
+// flare16x_sequence_finish of a sequence with a single frame
+static flare16x_error flare16x_bench_sequence_finish(flare16x_bench_context* context)
+{
+    return flare16x_sequence_finish(&context->work_writer);
+}
+
+// flare16x_sequence_attach and flare16x_sequence_destroy
+static flare16x_error flare16x_bench_sequence_attach(flare16x_bench_context* context)
+{
+    flare16x_sequence sequence;
+    flare16x_error error = flare16x_sequence_attach(context->sequence_data, context->sequence_size, &sequence);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_sequence_destroy(&sequence);
+    return error;
+}
+
+// flare16x_sequence_seek to the delta frame and flare16x_sequence_next, which decodes the keyframe first
+static flare16x_error flare16x_bench_sequence_seek(flare16x_bench_context* context)
+{
+    flare16x_error error = flare16x_sequence_seek(&context->work_sequence, 1);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_sequence_next(&context->work_sequence, &context->image);
+    return error;
+}
+
+// flare16x_sequence_next, which decodes the keyframe or the delta frame that follows it
+static flare16x_error flare16x_bench_sequence_next(flare16x_bench_context* context)
+{
+    return flare16x_sequence_next(&context->work_sequence, &context->image);
+}
+
+// The bgr888_to_rgb565 conversion kernel over the pixels of a screenshot
+static flare16x_error flare16x_bench_convert_narrow(flare16x_bench_context* context)
+{
+    context->kernels->bgr888_to_rgb565(context->buffer, (uint16_t*)(context->buffer +
+            FLARE16X_BENCH_SCREENSHOT_PIXELS * 3), FLARE16X_BENCH_SCREENSHOT_PIXELS);
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_GLOBAL);
+}
+
+// The rgb565_to_bgr888 conversion kernel over the pixels of a screenshot
+static flare16x_error flare16x_bench_convert_widen(flare16x_bench_context* context)
+{
+    context->kernels->rgb565_to_bgr888(context->screenshot.pixels565, context->buffer,
+            FLARE16X_BENCH_SCREENSHOT_PIXELS);
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_GLOBAL);
+}
+
+// The accumulation kernel over the points of the IR image
+static flare16x_error flare16x_bench_series_accumulate(flare16x_bench_context* context)
+{
+    uint32_t* sums = (uint32_t*)context->buffer;
+    context->accumulate(context->thermal.thermal_image->points, sums, sums + FLARE16X_BENCH_IR_PIXELS,
+            FLARE16X_BENCH_IR_PIXELS);
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_GLOBAL);
+}
+
+// All benchmarks in the order they are run
+static const flare16x_bench_case flare16x_bench_cases[] = {
+    {"bitmap_load", FLARE16X_BENCH_SCREENSHOT_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_bitmap_load, flare16x_bench_cleanup},
+    {"bitmap_parse", FLARE16X_BENCH_SCREENSHOT_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_bitmap_parse, flare16x_bench_cleanup},
+    {"bitmap_serialize", FLARE16X_BENCH_SCREENSHOT_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_bitmap_serialize, NULL},
+    {"bitmap_store", FLARE16X_BENCH_SCREENSHOT_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_bitmap_store, NULL},
+    {"bitmap_merge", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            flare16x_bench_prepare_bitmap, flare16x_bench_bitmap_merge, flare16x_bench_cleanup},
+    {"locator_create", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_locator_create, flare16x_bench_cleanup},
+    {"locator_load", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_locator_load, flare16x_bench_cleanup},
+    {"locator_process", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            flare16x_bench_prepare_process, flare16x_bench_locator_process, flare16x_bench_cleanup},
+    {"thermal_create", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            flare16x_bench_prepare_locator, flare16x_bench_thermal_create, flare16x_bench_cleanup},
+    {"thermal_ocr", FLARE16X_BENCH_TEXT_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_thermal_ocr, NULL},
+    {"thermal_ocr_cached", FLARE16X_BENCH_TEXT_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_thermal_ocr_cached, NULL},
+    {"ocr_large_string", FLARE16X_BENCH_TEXT_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_ocr_large_string, NULL},
+    {"ocr_small_string", FLARE16X_BENCH_TEXT_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_ocr_small_string, NULL},
+    {"ocr_large_string_flipped", FLARE16X_BENCH_TEXT_PIXELS, FLARE16X_BENCH_NO_ISA,
+            flare16x_bench_prepare_flipped, flare16x_bench_ocr_large_flipped, flare16x_bench_cleanup},
+    {"ocr_small_string_flipped", FLARE16X_BENCH_TEXT_PIXELS, FLARE16X_BENCH_NO_ISA,
+            flare16x_bench_prepare_flipped, flare16x_bench_ocr_small_flipped, flare16x_bench_cleanup},
+    {"thermal_probe", FLARE16X_BENCH_TEXT_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_thermal_probe, flare16x_bench_cleanup},
+    {"palettes_determine", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_palettes_determine, NULL},
+    {"palettes_tally", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_palettes_tally, NULL},
+    {"find_color_uncached", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_find_color, NULL},
+    {"find_color_cached", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_find_color_cached, NULL},
+    {"thermal_process", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            flare16x_bench_prepare_thermal, flare16x_bench_thermal_process, flare16x_bench_cleanup},
+    {"thermal_export", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_thermal_export, flare16x_bench_cleanup},
+    {"thermal_crosshair", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            flare16x_bench_prepare_canvas, flare16x_bench_thermal_crosshair, flare16x_bench_cleanup},
+    {"thermal_merge_masked", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_thermal_merge_masked, NULL},
+    {"canvas_copy", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_canvas_copy, flare16x_bench_cleanup},
+    {"canvas_merge", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_canvas_merge, NULL},
+    {"canvas_merge_keyed", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_canvas_merge_keyed, NULL},
+    {"canvas_merge_masked", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_canvas_merge_masked, NULL},
+    {"stream_recolor", FLARE16X_BENCH_SCREENSHOT_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_stream_recolor, NULL},
+    {"codec_encode", FLARE16X_BENCH_SCREENSHOT_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_codec_encode, NULL},
+    {"codec_decode", FLARE16X_BENCH_SCREENSHOT_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_codec_decode, NULL},
+    {"container_hash", FLARE16X_BENCH_SCREENSHOT_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_container_hash, NULL},
+    {"container_hash_file", FLARE16X_BENCH_SCREENSHOT_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_container_hash_file, NULL},
+    {"container_create", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            flare16x_bench_prepare_file, flare16x_bench_container_create, flare16x_bench_cleanup_container},
+    {"container_append", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            flare16x_bench_prepare_container, flare16x_bench_container_append, flare16x_bench_cleanup_container},
+    {"container_finish", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            flare16x_bench_prepare_container_frame, flare16x_bench_container_finish,
+            flare16x_bench_cleanup_container},
+    {"container_open", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_container_open, NULL},
+    {"container_attach", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_container_attach, NULL},
+    {"container_find", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_container_find, NULL},
+    {"container_frame_get", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_container_frame_get, NULL},
+    {"container_load", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_container_load, flare16x_bench_cleanup},
+    {"export_plane", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_export_plane, NULL},
+    {"export_floats", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_export_floats, NULL},
+    {"series_accumulator_add", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            flare16x_bench_prepare_accumulator, flare16x_bench_series_accumulator_add,
+            flare16x_bench_cleanup_accumulator},
+    {"series_accumulator_result", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            flare16x_bench_prepare_accumulator, flare16x_bench_series_accumulator_result,
+            flare16x_bench_cleanup_accumulator},
+    {"series_register", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_series_register, NULL},
+    {"series_fill", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_series_fill, NULL},
+    {"series_normalize", FLARE16X_BENCH_IR_PIXELS * 2, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_series_normalize, NULL},
+    {"series_remap", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_series_remap, NULL},
+    {"sequence_create", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            flare16x_bench_prepare_file, flare16x_bench_sequence_create, flare16x_bench_cleanup_writer},
+    {"sequence_append_key", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            flare16x_bench_prepare_writer, flare16x_bench_sequence_append, flare16x_bench_cleanup_writer},
+    {"sequence_append_delta", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            flare16x_bench_prepare_writer_frame, flare16x_bench_sequence_append, flare16x_bench_cleanup_writer},
+    {"sequence_finish", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            flare16x_bench_prepare_writer_frame, flare16x_bench_sequence_finish, flare16x_bench_cleanup_writer},
+    {"sequence_attach", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            NULL, flare16x_bench_sequence_attach, NULL},
+    {"sequence_seek", FLARE16X_BENCH_IR_PIXELS * 2, FLARE16X_BENCH_NO_ISA,
+            flare16x_bench_prepare_sequence, flare16x_bench_sequence_seek, flare16x_bench_cleanup_sequence},
+    {"sequence_next_key", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            flare16x_bench_prepare_sequence, flare16x_bench_sequence_next, flare16x_bench_cleanup_sequence},
+    {"sequence_next_delta", FLARE16X_BENCH_IR_PIXELS, FLARE16X_BENCH_NO_ISA,
+            flare16x_bench_prepare_sequence_frame, flare16x_bench_sequence_next, flare16x_bench_cleanup_sequence},
+    {"convert_narrow_scalar", FLARE16X_BENCH_SCREENSHOT_PIXELS, FLARE16X_CONVERT_ISA_SCALAR,
+            NULL, flare16x_bench_convert_narrow, NULL},
+    {"convert_narrow_sse2", FLARE16X_BENCH_SCREENSHOT_PIXELS, FLARE16X_CONVERT_ISA_SSE2,
+            NULL, flare16x_bench_convert_narrow, NULL},
+    {"convert_narrow_ssse3", FLARE16X_BENCH_SCREENSHOT_PIXELS, FLARE16X_CONVERT_ISA_SSSE3,
+            NULL, flare16x_bench_convert_narrow, NULL},
+    {"convert_narrow_avx2", FLARE16X_BENCH_SCREENSHOT_PIXELS, FLARE16X_CONVERT_ISA_AVX2,
+            NULL, flare16x_bench_convert_narrow, NULL},
+    {"convert_widen_scalar", FLARE16X_BENCH_SCREENSHOT_PIXELS, FLARE16X_CONVERT_ISA_SCALAR,
+            NULL, flare16x_bench_convert_widen, NULL},
+    {"convert_widen_sse2", FLARE16X_BENCH_SCREENSHOT_PIXELS, FLARE16X_CONVERT_ISA_SSE2,
+            NULL, flare16x_bench_convert_widen, NULL},
+    {"convert_widen_ssse3", FLARE16X_BENCH_SCREENSHOT_PIXELS, FLARE16X_CONVERT_ISA_SSSE3,
+            NULL, flare16x_bench_convert_widen, NULL},
+    {"convert_widen_avx2", FLARE16X_BENCH_SCREENSHOT_PIXELS, FLARE16X_CONVERT_ISA_AVX2,
+            NULL, flare16x_bench_convert_widen, NULL},
+    {"series_accumulate_scalar", FLARE16X_BENCH_IR_PIXELS, FLARE16X_CONVERT_ISA_SCALAR,
+            NULL, flare16x_bench_series_accumulate, NULL},
+    {"series_accumulate_sse2", FLARE16X_BENCH_IR_PIXELS, FLARE16X_CONVERT_ISA_SSE2,
+            NULL, flare16x_bench_series_accumulate, NULL},
+    {"series_accumulate_avx2", FLARE16X_BENCH_IR_PIXELS, FLARE16X_CONVERT_ISA_AVX2,
+            NULL, flare16x_bench_series_accumulate, NULL},
+    {NULL, 0, 0, NULL, NULL, NULL}
+};
+
+// Locates, reads and processes a screenshot into a new thermal context
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+static flare16x_error flare16x_bench_context_frame(flare16x_bitmap* screenshot, flare16x_thermal_ocr_cache* cache,
+        flare16x_thermal* thermal)
+{
+    flare16x_locator locator;
+    flare16x_error error = flare16x_locator_create(screenshot, &locator);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+    {
+        error = flare16x_locator_process(&locator);
+        if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+            error = flare16x_thermal_create(&locator, thermal);
+        flare16x_locator_destroy(&locator);
+    }
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_thermal_ocr(thermal, cache);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_thermal_process(thermal, FLARE16X_THERMAL_INTERPOLATION_SQUARE_LARGE,
+                FLARE16X_THERMAL_QUANTIFICATION_MEDIAN_LOW);
+    return error;
+}
+
+// Writes the container and the sequence of the context into memory and the container into a temporary file
+static flare16x_error flare16x_bench_context_files(flare16x_bench_context* context)
+{
+    // Append the same frame under several names to the container
+    char name[16];
+    unsigned frame;
+    flare16x_container_writer container;
+    FILE* file = open_memstream(&context->container_data, &context->container_size);
+    if (file == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_GLOBAL);
+    flare16x_error error = flare16x_container_create(file, &container);
+    for (frame = 0; frame < FLARE16X_BENCH_CONTAINER_FRAMES && flare16x_error_reason(error) == FLARE16X_ERROR_NONE;
+         frame++)
+    {
+        snprintf(name, sizeof(name), "frame%u", frame);
+        error = flare16x_container_append(&container, name, frame + 1, &context->thermal);
+    }
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_container_finish(&container);
+    fclose(file);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return error;
+    error = flare16x_container_attach(context->container_data, context->container_size, &context->container);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return error;
+
+    // Store the container in a temporary file, so that it can be opened by its path
+    strcpy(context->container_path, "/tmp/flare16x_bench_XXXXXX");
+    int descriptor = mkstemp(context->container_path);
+    if (descriptor < 0)
+    {
+        context->container_path[0] = '\0';
+        return flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_GLOBAL);
+    }
+    ssize_t written = write(descriptor, context->container_data, context->container_size);
+    close(descriptor);
+    if (written < 0 || (size_t)written != context->container_size)
+        return flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_GLOBAL);
+
+    // Then, store the thermal context as a keyframe, followed by the neighbour as a delta frame
+    flare16x_sequence_writer writer;
+    flare16x_thermal_image* image = context->thermal.thermal_image;
+    file = open_memstream(&context->sequence_data, &context->sequence_size);
+    if (file == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_GLOBAL);
+    error = flare16x_sequence_create(file, image->width, image->height, FLARE16X_SEQUENCE_INTERVAL, &writer);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+    {
+        error = flare16x_sequence_append(&writer, image);
+        if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+            error = flare16x_sequence_append(&writer, context->neighbour.thermal_image);
+        flare16x_error finish_error = flare16x_sequence_finish(&writer);
+        if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+            error = finish_error;
+    }
+    fclose(file);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return error;
+
+    // Finally, create the image that the frames of the sequence are decoded into
+    return flare16x_thermal_image_init(image->width, image->height, &context->image);
+}
+
+// Renders a screenshot and prepares all inputs of the benchmarks from it
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+static flare16x_error flare16x_bench_context_create(const flare16x_synth_options* options,
+        flare16x_bench_context* context)
+{
+    // Start from an empty context
+    memset(context, 0, sizeof(flare16x_bench_context));
+    context->palette = options->palette;
+    context->flip_state = options->seed != 0 ? options->seed : 1;
+
+    // Keep the OSD text, which is left blank without one
+    memset(context->temperature, ' ', FLARE16X_LOCATOR_TEMPERATURE_DIGITS);
+    memset(context->emissivity, ' ', FLARE16X_LOCATOR_EMISSIVITY_DIGITS);
+    if (options->temperature != NULL)
+        memcpy(context->temperature, options->temperature, FLARE16X_LOCATOR_TEMPERATURE_DIGITS);
+    if (options->emissivity != NULL)
+        memcpy(context->emissivity, options->emissivity, FLARE16X_LOCATOR_EMISSIVITY_DIGITS);
+
+    // Render the screenshot
+    flare16x_error error = flare16x_synth_render(options, &context->screenshot);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return error;
+
+    // Allocate the buffers
+    context->file = malloc(FLARE16X_BENCH_BUFFER_SIZE);
+    context->archive = malloc(FLARE16X_BENCH_BUFFER_SIZE);
+    context->buffer = malloc(FLARE16X_BENCH_BUFFER_SIZE);
+    if (context->file == NULL || context->archive == NULL || context->buffer == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_GLOBAL);
+
+    // Serialize the screenshot into its file image
+    error = flare16x_bitmap_serialize_into(&context->screenshot, context->file, FLARE16X_BENCH_BUFFER_SIZE,
+            &context->file_size);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return error;
+
+    // Compress the file image
+    FILE* file = fmemopen(context->archive, FLARE16X_BENCH_BUFFER_SIZE, "wb");
+    if (file == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_GLOBAL);
+    error = flare16x_codec_encode(context->file, context->file_size, file);
+    long archive_size = ftell(file);
+    fclose(file);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return error;
+    if (archive_size < 0)
+        return flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_GLOBAL);
+    context->archive_size = (size_t)archive_size;
+
+    // Locate and process the screenshot once
+    error = flare16x_bench_context_frame(&context->screenshot, &context->cache, &context->thermal);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return error;
+
+    // Render and process its neighbour with the crosshair and the noise moved
+    flare16x_synth_options neighbour_options = *options;
+    flare16x_bitmap neighbour_screenshot;
+    neighbour_options.crosshair_x += 3;
+    neighbour_options.crosshair_y += 2;
+    neighbour_options.seed++;
+    error = flare16x_synth_render(&neighbour_options, &neighbour_screenshot);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return error;
+    error = flare16x_bench_context_frame(&neighbour_screenshot, NULL, &context->neighbour);
+    flare16x_bitmap_destroy(&neighbour_screenshot);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return error;
+    context->frames[0] = &context->thermal;
+    context->frames[1] = &context->neighbour;
+
+    // Convert the values into floats and create the canvas that is merged onto
+    flare16x_thermal_image* image = context->thermal.thermal_image;
+    size_t point, points = (size_t)image->width * image->height;
+    context->floats = malloc(points * sizeof(float));
+    if (context->floats == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_GLOBAL);
+    for (point = 0; point < points; point++)
+        context->floats[point] = image->points[point].value;
+    error = flare16x_canvas_create(context->thermal.visible_image->width, context->thermal.visible_image->height,
+            &context->canvas);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return error;
+
+    // Write the container and the sequence
+    error = flare16x_bench_context_files(context);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return error;
+
+    // Create the streaming recolor context
+    return flare16x_stream_create(context->palette, FLARE16X_THERMAL_INTERPOLATION_SQUARE_LARGE,
+            FLARE16X_THERMAL_QUANTIFICATION_MEDIAN_LOW, 1, FLARE16X_LOCATOR_CROSSHAIR_BORDER,
+            FLARE16X_LOCATOR_CROSSHAIR_FILL, &context->stream);
+}
+
+// Frees the resources used by a context
+static void flare16x_bench_context_destroy(flare16x_bench_context* context)
+{
+    flare16x_bench_cleanup(context);
+    flare16x_stream_destroy(&context->stream);
+    flare16x_thermal_destroy(&context->thermal);
+    flare16x_thermal_destroy(&context->neighbour);
+    flare16x_thermal_image_destroy(&context->image);
+    flare16x_canvas_destroy(&context->canvas);
+    flare16x_container_close(&context->container);
+    if (context->container_path[0] != '\0')
+        unlink(context->container_path);
+    free(context->container_data);
+    free(context->sequence_data);
+    free(context->floats);
+    flare16x_bitmap_destroy(&context->screenshot);
+    free(context->file);
+    free(context->archive);
+    free(context->buffer);
+}
+
+// Runs a benchmark for the given number of calls and prints its results
+// If counters are given, their values per pixel are printed instead of the allocations
+static flare16x_error flare16x_bench_run(const flare16x_bench_case* bench, unsigned iterations,
+        flare16x_bench_counters* counters, flare16x_bench_context* context)
+{
+    // Look up the conversion and accumulation kernels, if they are used
+    context->kernels = NULL;
+    context->accumulate = NULL;
+    if (bench->isa != FLARE16X_BENCH_NO_ISA)
+    {
+        flare16x_error error = flare16x_convert_get(bench->isa, &context->kernels);
+        if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+            error = flare16x_series_kernel_get(bench->isa, &context->accumulate);
+        if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        {
+            printf("%-26s %10s\n", bench->name, "unsupported");
+            return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_GLOBAL);
+        }
+    }
+
+    // Call the function once without timing it, so that caches and lazy tables are warm
+    uint64_t total = 0, best = UINT64_MAX;
+    flare16x_bench_allocations = 0;
+    flare16x_bench_allocated = 0;
+    if (counters != NULL)
+        memset(counters->values, 0, sizeof(counters->values));
+    for (unsigned iteration = 0; iteration <= iterations; iteration++)
+    {
+        // Prepare the call
+        flare16x_error error = flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_GLOBAL);
+        if (bench->prepare != NULL)
+            error = bench->prepare(context);
+
+        // Time the call and count its allocations and hardware events
+        if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        {
+            if (counters != NULL && iteration > 0)
+                flare16x_bench_counters_start(counters);
+            flare16x_bench_counting = iteration > 0;
+            uint64_t start = flare16x_bench_now();
+            error = bench->run(context);
+            uint64_t duration = flare16x_bench_now() - start;
+            flare16x_bench_counting = 0;
+            if (counters != NULL && iteration > 0)
+                flare16x_bench_counters_stop(counters);
+            if (iteration > 0)
+            {
+                total += duration;
+                if (duration < best)
+                    best = duration;
+            }
+        }
+
+        // Clean up after the call
+        if (bench->cleanup != NULL)
+            bench->cleanup(context);
+        if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+            return error;
+    }
+
+    // Print the results
+    double average = (double)total / iterations;
+    printf("%-26s %10u %12.0f %12llu %10.3f %12.1f", bench->name, iterations, average, (unsigned long long)best,
+            average / bench->pixels, average > 0 ? 1e9 / average : 0.0);
+    if (counters != NULL)
+    {
+        double pixels = (double)bench->pixels * iterations;
+        flare16x_bench_counters_print(counters, FLARE16X_BENCH_CYCLES, pixels);
+        if (counters->descriptors[FLARE16X_BENCH_CYCLES] >= 0 &&
+            counters->descriptors[FLARE16X_BENCH_INSTRUCTIONS] >= 0 && counters->values[FLARE16X_BENCH_CYCLES] > 0)
+            printf(" %8.2f", (double)counters->values[FLARE16X_BENCH_INSTRUCTIONS] /
+                    counters->values[FLARE16X_BENCH_CYCLES]);
+        else
+            printf(" %8s", "-");
+        flare16x_bench_counters_print(counters, FLARE16X_BENCH_L1D_MISSES, pixels);
+        flare16x_bench_counters_print(counters, FLARE16X_BENCH_LLC_MISSES, pixels);
+        flare16x_bench_counters_print(counters, FLARE16X_BENCH_BRANCH_MISSES, pixels);
+        printf("\n");
+        return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_GLOBAL);
+    }
+#ifdef FLARE16X_BENCH_WRAP
+    printf(" %12.2f %10.1f\n", (double)flare16x_bench_allocations / iterations,
+            (double)flare16x_bench_allocated / iterations / 1024.0);
+#else
+    printf(" %12s %10s\n", "-", "-");
+#endif
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_GLOBAL);
+}
+
+// Writes a synthetic screenshot as a bitmap file into the given directory
+static flare16x_error flare16x_bench_write(const char* directory, const flare16x_synth_options* options)
+{
+    // Render the screenshot
+    flare16x_bitmap screenshot;
+    flare16x_error error = flare16x_synth_render(options, &screenshot);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return error;
+
+    // Store it under a name describing its options
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s_%s_%s.bmp", directory,
+            flare16x_bench_name_of(flare16x_bench_models, options->device_model),
+            flare16x_bench_name_of(flare16x_bench_palettes, options->palette),
+            flare16x_bench_name_of(flare16x_bench_scenes, options->scene));
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        flare16x_bitmap_destroy(&screenshot);
+        return flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_GLOBAL);
+    }
+    error = flare16x_bitmap_store(&screenshot, file);
+    if (fclose(file) != 0 && flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_GLOBAL);
+    flare16x_bitmap_destroy(&screenshot);
+    return error;
+}
+
+// The results of one run of the end-to-end benchmark
+typedef struct {
+    // The number of worker threads
+    unsigned threads;
+    // The number of images processed per second
+    double images_per_second;
+    // The median and 99th percentile of the latency of a single image in microseconds
+    double p50;
+    double p99;
+    // The peak resident set size of the whole process up to the end of the run in KiB
+    // This includes the corpus and all earlier runs, so it never drops from one run to the next
+    long process_peak_rss;
+    // The number of bytes read from the screenshots and written as recolored bitmaps
+    // Without glibc, the whole screenshot counts as read
+    uint64_t bytes_read;
+    uint64_t bytes_written;
+    // The number of images that failed
+    unsigned failures;
+} flare16x_bench_throughput;
+
+// The corpus and the shared state of the workers of the end-to-end benchmark
+typedef struct {
+    // The file images of the screenshots
+    uint8_t** files;
+    size_t* sizes;
+    size_t count;
+    // The index of the next image to process
+    pthread_mutex_t lock;
+    size_t next;
+    // The latency of every image in nanoseconds
+    uint64_t* latencies;
+    // The totals of all workers
+    uint64_t bytes_read;
+    uint64_t bytes_written;
+    unsigned failures;
+} flare16x_bench_corpus;
+
+// A screenshot in memory that counts the bytes read from it
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    size_t position;
+    uint64_t read;
+} flare16x_bench_source;
+
+#ifdef __GLIBC__
+// Reads from a screenshot in memory and counts the bytes
+static ssize_t flare16x_bench_source_read(void* cookie, char* data, size_t size)
+{
+    flare16x_bench_source* source = cookie;
+    if (size > source->size - source->position)
+        size = source->size - source->position;
+    memcpy(data, source->data + source->position, size);
+    source->position += size;
+    source->read += size;
+    return (ssize_t)size;
+}
+
+// Moves the position in a screenshot in memory
+static int flare16x_bench_source_seek(void* cookie, off64_t* offset, int whence)
+{
+    flare16x_bench_source* source = cookie;
+    off64_t position = whence == SEEK_SET ? *offset : whence == SEEK_CUR ? (off64_t)source->position + *offset :
+            whence == SEEK_END ? (off64_t)source->size + *offset : -1;
+    if (position < 0 || position > (off64_t)source->size)
+        return -1;
+    source->position = (size_t)position;
+    *offset = position;
+    return 0;
+}
+#endif
+
+// Opens a screenshot in memory for reading, so that the bytes read from it are counted
+// The file is not buffered, so that only the bytes that are actually requested count
+static FILE* flare16x_bench_source_open(flare16x_bench_source* source)
+{
+#ifdef __GLIBC__
+    cookie_io_functions_t functions = {flare16x_bench_source_read, NULL, flare16x_bench_source_seek, NULL};
+    FILE* file = fopencookie(source, "rb", functions);
+    if (file != NULL)
+        setvbuf(file, NULL, _IONBF, 0);
+    return file;
+#else
+    // Without glibc, the whole screenshot counts as read
+    source->read = source->size;
+    return fmemopen((void*)source->data, source->size, "rb");
+#endif
+}
+
+// Runs the whole pipeline on a single screenshot and stores the recolored IR image into the buffer
+// Stores the number of bytes read from the screenshot and written to the buffer
+static flare16x_error flare16x_bench_pipeline(const uint8_t* file, size_t size, uint8_t* buffer,
+        flare16x_thermal_ocr_cache* cache, uint64_t* read, size_t* written)
+{
+    // Load and locate the screenshot
+    flare16x_bench_source counted = {file, size, 0, 0};
+    FILE* source = flare16x_bench_source_open(&counted);
+    if (source == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_GLOBAL);
+    flare16x_locator locator;
+    flare16x_error error = flare16x_locator_load(source, &locator);
+    fclose(source);
+    *read = counted.read;
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return error;
+    error = flare16x_locator_process(&locator);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+    {
+        flare16x_locator_destroy(&locator);
+        return error;
+    }
+
+    // Read the OSD and process the IR image
+    flare16x_thermal thermal;
+    error = flare16x_thermal_create(&locator, &thermal);
+    flare16x_locator_destroy(&locator);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return error;
+    error = flare16x_thermal_ocr(&thermal, cache);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_thermal_process(&thermal, FLARE16X_THERMAL_INTERPOLATION_SQUARE_LARGE,
+                FLARE16X_THERMAL_QUANTIFICATION_MEDIAN_LOW);
+
+    // Export it in the default palette with the crosshair redrawn
+    flare16x_canvas canvas;
+    memset(&canvas, 0, sizeof(canvas));
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_thermal_export(&thermal, FLARE16X_PALETTES_IRON, &canvas);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_thermal_crosshair(FLARE16X_LOCATOR_CROSSHAIR_BORDER, FLARE16X_LOCATOR_CROSSHAIR_FILL,
+                &thermal, &canvas);
+    flare16x_thermal_destroy(&thermal);
+
+    // Store it as a bitmap
+    flare16x_bitmap bitmap;
+    memset(&bitmap, 0, sizeof(bitmap));
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_bitmap_create16(canvas.width, canvas.height, &bitmap);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_bitmap_merge(&canvas, 0, 0, &bitmap);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+    {
+        FILE* target = fmemopen(buffer, FLARE16X_BENCH_BUFFER_SIZE, "wb");
+        if (target == NULL)
+            error = flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_GLOBAL);
+        else
+        {
+            error = flare16x_bitmap_store(&bitmap, target);
+            long position = ftell(target);
+            fclose(target);
+            *written = position > 0 ? (size_t)position : 0;
+        }
+    }
+    flare16x_bitmap_destroy(&bitmap);
+    flare16x_canvas_destroy(&canvas);
+    return error;
+}
+
+// Processes images of the corpus until all are done
+static void* flare16x_bench_worker(void* argument)
+{
+    flare16x_bench_corpus* corpus = argument;
+    uint64_t bytes_read = 0, bytes_written = 0;
+    unsigned failures = 0;
+
+    // Every worker has its own output buffer and OSD text cache
+    flare16x_thermal_ocr_cache cache;
+    memset(&cache, 0, sizeof(cache));
+    uint8_t* buffer = malloc(FLARE16X_BENCH_BUFFER_SIZE);
+
+    for (;;)
+    {
+        // Fetch the next image
+        pthread_mutex_lock(&corpus->lock);
+        size_t index = corpus->next++;
+        pthread_mutex_unlock(&corpus->lock);
+        if (index >= corpus->count)
+            break;
+
+        // Time the pipeline
+        size_t written = 0;
+        uint64_t read = 0;
+        uint64_t start = flare16x_bench_now();
+        flare16x_error error = buffer != NULL ? flare16x_bench_pipeline(corpus->files[index], corpus->sizes[index],
+                buffer, &cache, &read, &written) :
+                flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_GLOBAL);
+        corpus->latencies[index] = flare16x_bench_now() - start;
+        bytes_read += read;
+        bytes_written += written;
+        if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+            failures++;
+    }
+    free(buffer);
+
+    // Add the totals of this worker
+    pthread_mutex_lock(&corpus->lock);
+    corpus->bytes_read += bytes_read;
+    corpus->bytes_written += bytes_written;
+    corpus->failures += failures;
+    pthread_mutex_unlock(&corpus->lock);
+    return NULL;
+}
+
+// Compares two latencies for sorting
+static int flare16x_bench_compare(const void* a, const void* b)
+{
+    uint64_t left = *(const uint64_t*)a, right = *(const uint64_t*)b;
+    return (left > right) - (left < right);
+}
+
+// Processes the whole corpus with the given number of threads
+static flare16x_error flare16x_bench_throughput_run(flare16x_bench_corpus* corpus, unsigned threads,
+        flare16x_bench_throughput* result)
+{
+    // Reset the shared state
+    corpus->next = 0;
+    corpus->bytes_read = 0;
+    corpus->bytes_written = 0;
+    corpus->failures = 0;
+    pthread_t* workers = calloc(threads, sizeof(pthread_t));
+    if (workers == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_GLOBAL);
+
+    // Run the workers
+    unsigned thread, started = 0;
+    uint64_t start = flare16x_bench_now();
+    for (thread = 0; thread < threads; thread++, started++)
+        if (pthread_create(&workers[thread], NULL, flare16x_bench_worker, corpus) != 0)
+            break;
+    for (thread = 0; thread < started; thread++)
+        pthread_join(workers[thread], NULL);
+    uint64_t duration = flare16x_bench_now() - start;
+    free(workers);
+    if (started < 1)
+        return flare16x_error_make(FLARE16X_ERROR_OTHER, FLARE16X_ERROR_SOURCE_GLOBAL);
+
+    // Summarize the run
+    qsort(corpus->latencies, corpus->count, sizeof(uint64_t), flare16x_bench_compare);
+    struct rusage usage;
+    memset(&usage, 0, sizeof(usage));
+    getrusage(RUSAGE_SELF, &usage);
+    result->threads = started;
+    result->images_per_second = duration > 0 ? corpus->count * 1e9 / duration : 0.0;
+    result->p50 = corpus->latencies[(corpus->count - 1) * 50 / 100] / 1e3;
+    result->p99 = corpus->latencies[(corpus->count - 1) * 99 / 100] / 1e3;
+    result->process_peak_rss = usage.ru_maxrss;
+    result->bytes_read = corpus->bytes_read;
+    result->bytes_written = corpus->bytes_written;
+    result->failures = corpus->failures;
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_GLOBAL);
+}
+
+// Writes the results of all runs as JSON
+static void flare16x_bench_throughput_json(FILE* file, size_t images, const flare16x_bench_throughput* results,
+        size_t count)
+{
+    fprintf(file, "{\n  \"images\": %zu,\n  \"runs\": [\n", images);
+    size_t run;
+    for (run = 0; run < count; run++)
+        fprintf(file, "    {\"threads\": %u, \"images_per_second\": %.1f, \"p50_us\": %.1f, \"p99_us\": %.1f, "
+                "\"process_peak_rss_kib\": %ld, \"bytes_read\": %llu, \"bytes_written\": %llu, \"failures\": %u}%s\n",
+                results[run].threads, results[run].images_per_second, results[run].p50, results[run].p99,
+                results[run].process_peak_rss, (unsigned long long)results[run].bytes_read,
+                (unsigned long long)results[run].bytes_written, results[run].failures, run + 1 < count ? "," : "");
+    fprintf(file, "  ]\n}\n");
+}
+
+// Reads a number following the given JSON key within the text up to the end, returning zero if it is missing
+static int flare16x_bench_json_number(const char* text, const char* end, const char* key, double* number)
+{
+    const char* found = strstr(text, key);
+    if (found == NULL || found >= end)
+        return 0;
+    found += strlen(key);
+    while (*found == ' ' || *found == ':')
+        found++;
+    char* last;
+    *number = strtod(found, &last);
+    return last != found;
+}
+
+// Compares the results with the runs of the same thread counts in a baseline report of the same number of images
+// Stores the number of runs whose throughput dropped or whose p99 latency rose by more than the threshold in percent
+// Fails with a format error, if the baseline holds another number of images or a run without throughput or latency
+static flare16x_error flare16x_bench_throughput_compare(FILE* table, const char* path, double threshold, size_t images,
+        const flare16x_bench_throughput* results, size_t count, int* regressions)
+{
+    // Read the whole baseline
+    FILE* file = fopen(path, "rb");
+    if (file == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_GLOBAL);
+    long length = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+    char* text = length < 0 || fseek(file, 0, SEEK_SET) != 0 ? NULL : malloc((size_t)length + 1);
+    if (text == NULL || (length > 0 && fread(text, (size_t)length, 1, file) != 1))
+    {
+        fclose(file);
+        free(text);
+        return flare16x_error_make(length < 0 ? FLARE16X_ERROR_IO : FLARE16X_ERROR_MALLOC,
+                FLARE16X_ERROR_SOURCE_GLOBAL);
+    }
+    fclose(file);
+    text[length] = 0;
+
+    // The baseline has to be measured on a corpus of the same size
+    const char* runs = strstr(text, "\"runs\"");
+    double baseline_images;
+    if (runs == NULL || !flare16x_bench_json_number(text, runs, "\"images\"", &baseline_images) ||
+        baseline_images != (double)images)
+    {
+        free(text);
+        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_GLOBAL);
+    }
+
+    // Find the runs of the baseline, which are single objects without nesting
+    const char* run = runs;
+    *regressions = 0;
+    while ((run = strstr(run, "{\"threads\"")) != NULL)
+    {
+        const char* end = strchr(run, '}');
+        if (end == NULL)
+            break;
+        double threads, images_per_second, p99;
+        if (!flare16x_bench_json_number(run, end, "\"threads\"", &threads) ||
+            !flare16x_bench_json_number(run, end, "\"images_per_second\"", &images_per_second) ||
+            !flare16x_bench_json_number(run, end, "\"p99_us\"", &p99) || images_per_second <= 0 || p99 <= 0)
+        {
+            free(text);
+            return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_GLOBAL);
+        }
+
+        // Compare the run of the same thread count
+        size_t index;
+        for (index = 0; index < count; index++)
+        {
+            if (results[index].threads != (unsigned)threads)
+                continue;
+            double speed = (results[index].images_per_second / images_per_second - 1) * 100.0;
+            double latency = (results[index].p99 / p99 - 1) * 100.0;
+            fprintf(table, "%3u threads: %+7.1f%% images/s, %+7.1f%% p99 latency against the baseline\n",
+                    results[index].threads, speed, latency);
+            if (-speed > threshold || latency > threshold)
+            {
+                fprintf(stderr, "regression with %u threads beyond %.1f%%\n", results[index].threads, threshold);
+                (*regressions)++;
+            }
+        }
+        run = end;
+    }
+
+    free(text);
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_GLOBAL);
+}
+
+// Runs the end-to-end benchmark on a corpus of synthetic screenshots at 1, 2, 4 and so on up to all threads
+static int flare16x_bench_throughput_main(const char* name, const flare16x_bench_options* options)
+{
+    // Render the corpus, cycling through the selected device models, palettes and scenes
+    flare16x_bench_corpus corpus;
+    memset(&corpus, 0, sizeof(corpus));
+    corpus.count = options->images;
+    corpus.files = calloc(corpus.count, sizeof(uint8_t*));
+    corpus.sizes = calloc(corpus.count, sizeof(size_t));
+    corpus.latencies = calloc(corpus.count, sizeof(uint64_t));
+    uint8_t* buffer = malloc(FLARE16X_BENCH_BUFFER_SIZE);
+    int failures = corpus.files == NULL || corpus.sizes == NULL || corpus.latencies == NULL || buffer == NULL;
+    size_t index, combination = 0;
+    for (index = 0; index < corpus.count && !failures; combination++)
+    {
+        const flare16x_bench_name* model = &flare16x_bench_models[combination % 2];
+        const flare16x_bench_name* palette = &flare16x_bench_palettes[combination / 2 % 3];
+        const flare16x_bench_name* scene = &flare16x_bench_scenes[combination / 6 % FLARE16X_SYNTH_SCENE_COUNT];
+        if ((options->model != 0xff && options->model != model->value) ||
+            (options->palette != 0xff && options->palette != palette->value) ||
+            (options->scene != 0xff && options->scene != scene->value))
+            continue;
+
+        // Render and serialize the screenshot with a seed and OSD temperature of its own
+        // Consecutive screenshots never show the same temperature, so that the OCR never hits its text cache
+        char temperature[FLARE16X_LOCATOR_TEMPERATURE_DIGITS + 1];
+        unsigned tenths = 100 + (unsigned)(index * 7 % 900);
+        snprintf(temperature, sizeof(temperature), " %2u.%uC", tenths / 10, tenths % 10);
+        flare16x_synth_options synth;
+        flare16x_synth_defaults(model->value, palette->value, &synth);
+        synth.scene = scene->value;
+        synth.noise = options->noise;
+        synth.seed = (uint32_t)index + 1;
+        synth.temperature = temperature;
+        flare16x_bitmap screenshot;
+        flare16x_error error = flare16x_synth_render(&synth, &screenshot);
+        if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        {
+            error = flare16x_bitmap_serialize_into(&screenshot, buffer, FLARE16X_BENCH_BUFFER_SIZE,
+                    &corpus.sizes[index]);
+            flare16x_bitmap_destroy(&screenshot);
+        }
+        if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE &&
+            (corpus.files[index] = malloc(corpus.sizes[index])) == NULL)
+            error = flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_GLOBAL);
+        if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        {
+            fprintf(stderr, "%s: cannot prepare the corpus: %s\n", name, flare16x_error_string(error));
+            failures++;
+            break;
+        }
+        memcpy(corpus.files[index], buffer, corpus.sizes[index]);
+        index++;
+    }
+    free(buffer);
+
+    // Run the corpus with a doubling number of threads and once with all of them
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned maximum = options->threads > 0 ? options->threads : (cores > 0 ? (unsigned)cores : 1);
+    flare16x_bench_throughput results[64];
+    size_t count = 0;
+    pthread_mutex_init(&corpus.lock, NULL);
+    FILE* table = options->report_path != NULL && strcmp(options->report_path, "-") == 0 ? stderr : stdout;
+    if (!failures)
+        fprintf(table, "%8s %12s %12s %12s %14s %14s %14s %8s\n", "threads", "images/s", "p50 us", "p99 us",
+                "proc peak KiB", "bytes read", "bytes written", "failed");
+    unsigned threads;
+    for (threads = 1; !failures && count < sizeof(results) / sizeof(results[0]);
+         threads = threads < maximum && threads * 2 > maximum ? maximum : threads * 2)
+    {
+        flare16x_error error = flare16x_bench_throughput_run(&corpus, threads, &results[count]);
+        if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        {
+            fprintf(stderr, "%s: %u threads: %s\n", name, threads, flare16x_error_string(error));
+            failures++;
+            break;
+        }
+        const flare16x_bench_throughput* result = &results[count++];
+        fprintf(table, "%8u %12.1f %12.1f %12.1f %14ld %14llu %14llu %8u\n", result->threads, result->images_per_second,
+                result->p50, result->p99, result->process_peak_rss, (unsigned long long)result->bytes_read,
+                (unsigned long long)result->bytes_written, result->failures);
+        failures += result->failures > 0;
+        if (threads >= maximum)
+            break;
+    }
+    pthread_mutex_destroy(&corpus.lock);
+
+    // Write the report
+    if (!failures && options->report_path != NULL)
+    {
+        FILE* file = strcmp(options->report_path, "-") == 0 ? stdout : fopen(options->report_path, "wb");
+        if (file == NULL)
+        {
+            fprintf(stderr, "%s: %s: %s\n", name, options->report_path, flare16x_error_string(FLARE16X_ERROR_OPEN));
+            failures++;
+        }
+        else
+        {
+            flare16x_bench_throughput_json(file, corpus.count, results, count);
+            if (file != stdout)
+                fclose(file);
+        }
+    }
+
+    // Compare against the baseline
+    if (!failures && options->baseline_path != NULL)
+    {
+        int regressions = 0;
+        flare16x_error error = flare16x_bench_throughput_compare(table, options->baseline_path, options->threshold,
+                corpus.count, results, count, &regressions);
+        if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        {
+            fprintf(stderr, "%s: %s: %s\n", name, options->baseline_path, flare16x_error_string(error));
+            failures++;
+        }
+        failures += regressions;
+    }
+
+    // Free the corpus
+    for (index = 0; corpus.files != NULL && index < corpus.count; index++)
+        free(corpus.files[index]);
+    free(corpus.files);
+    free(corpus.sizes);
+    free(corpus.latencies);
+    return failures > 0;
+}
+
+// Prints the usage
+static void flare16x_bench_usage(const char* name)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "Benchmarks the library on synthetic TG165 and TG167 screenshots\n"
+            "\n"
+            "Options:\n"
+            "  -n <calls>     number of timed calls per benchmark (default: 100)\n"
+            "  -m <model>     device model: tg165, tg167 or all (default: all)\n"
+            "  -p <palette>   palette: iron, grayscale, rainbow or all (default: all)\n"
+            "  -s <scene>     scene: waves, gradient, spots, flat or all (default: waves)\n"
+            "  -z <noise>     maximum noise added to every relative value (default: 3)\n"
+            "  -f <text>      only run the benchmarks whose names contain the text\n"
+            "  -c             print cycles, IPC and cache and branch misses per pixel instead of the allocations\n"
+            "  -w <dir>       write the screenshots as bitmaps into the directory instead of benchmarking\n"
+            "  -e <images>    run the whole pipeline on this many screenshots at 1, 2, 4 ... threads instead\n"
+            "  -j <threads>   maximum number of threads of -e, 0 for all cores (default: 0)\n"
+            "  -o <file>      write the results of -e as JSON, '-' for stdout\n"
+            "  -b <file>      compare the results of -e with a JSON report written by -o\n"
+            "  -r <percent>   loss of throughput or gain of p99 latency that counts as a regression (default: 10)\n"
+            "  -h             show this help\n", name);
+}
+
+int main(int argc, char** argv)
+{
+    flare16x_bench_options options;
+    memset(&options, 0, sizeof(options));
+    options.iterations = 100;
+    options.model = 0xff;
+    options.palette = 0xff;
+    options.scene = FLARE16X_SYNTH_SCENE_WAVES;
+    options.noise = 3;
+    options.threshold = 10.0;
+
+    // Parse the options
+    int option;
+    while ((option = getopt(argc, argv, "n:m:p:s:z:f:cw:e:j:o:b:r:h")) != -1)
+    {
+        int valid = 1;
+        switch (option)
+        {
+            case 'n':
+                options.iterations = (unsigned)strtoul(optarg, NULL, 10);
+                valid = options.iterations > 0;
+                break;
+            case 'm':
+                valid = flare16x_bench_lookup(flare16x_bench_models, optarg, &options.model);
+                break;
+            case 'p':
+                valid = flare16x_bench_lookup(flare16x_bench_palettes, optarg, &options.palette);
+                break;
+            case 's':
+                valid = flare16x_bench_lookup(flare16x_bench_scenes, optarg, &options.scene);
+                break;
+            case 'z':
+                options.noise = (uint8_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'f':
+                options.filter = optarg;
+                break;
+            case 'c':
+                options.counters = 1;
+                break;
+            case 'w':
+                options.output_directory = optarg;
+                break;
+            case 'e':
+                options.images = (size_t)strtoul(optarg, NULL, 10);
+                valid = options.images > 0;
+                break;
+            case 'j':
+                options.threads = (unsigned)strtoul(optarg, NULL, 10);
+                break;
+            case 'o':
+                options.report_path = optarg;
+                break;
+            case 'b':
+                options.baseline_path = optarg;
+                break;
+            case 'r':
+                options.threshold = strtod(optarg, NULL);
+                valid = options.threshold >= 0;
+                break;
+            case 'h':
+                flare16x_bench_usage(argv[0]);
+                return 0;
+            default:
+                flare16x_bench_usage(argv[0]);
+                return 1;
+        }
+        if (!valid)
+        {
+            fprintf(stderr, "%s: invalid argument for -%c: %s\n", argv[0], option, optarg);
+            flare16x_bench_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    // Run the end-to-end benchmark instead, if requested
+    if (options.images > 0 && options.output_directory == NULL)
+        return flare16x_bench_throughput_main(argv[0], &options);
+
+    // Open the hardware counters, if requested
+    flare16x_bench_counters counters;
+    if (options.counters && options.output_directory == NULL && flare16x_bench_counters_open(&counters) <
+        FLARE16X_BENCH_COUNTER_COUNT)
+        fprintf(stderr, "%s: some hardware counters are not available: %s\n", argv[0], strerror(counters.error));
+
+    // Run every combination of device model, palette and scene
+    int failures = 0;
+    for (const flare16x_bench_name* model = flare16x_bench_models; model->name != NULL; model++)
+    {
+        if (options.model != 0xff && options.model != model->value)
+            continue;
+        for (const flare16x_bench_name* palette = flare16x_bench_palettes; palette->name != NULL; palette++)
+        {
+            if (options.palette != 0xff && options.palette != palette->value)
+                continue;
+            for (const flare16x_bench_name* scene = flare16x_bench_scenes; scene->name != NULL; scene++)
+            {
+                if (options.scene != 0xff && options.scene != scene->value)
+                    continue;
+
+                // Describe the screenshot
+                flare16x_synth_options synth;
+                flare16x_synth_defaults(model->value, palette->value, &synth);
+                synth.scene = scene->value;
+                synth.noise = options.noise;
+
+                // Only write the screenshot, if requested
+                if (options.output_directory != NULL)
+                {
+                    flare16x_error error = flare16x_bench_write(options.output_directory, &synth);
+                    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+                    {
+                        fprintf(stderr, "%s: %s: %s\n", argv[0], options.output_directory,
+                                flare16x_error_string(error));
+                        failures++;
+                    }
+                    continue;
+                }
+
+                // Prepare the inputs
+                printf("%s %s %s\n", model->name, palette->name, scene->name);
+                flare16x_bench_context context;
+                flare16x_error error = flare16x_bench_context_create(&synth, &context);
+                if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+                {
+                    fprintf(stderr, "%s: cannot prepare the screenshot: %s\n", argv[0], flare16x_error_string(error));
+                    flare16x_bench_context_destroy(&context);
+                    failures++;
+                    continue;
+                }
+
+                // Run the benchmarks
+                printf("%-26s %10s %12s %12s %10s %12s", "benchmark", "calls", "ns/call", "best ns", "ns/pixel",
+                        "images/s");
+                if (options.counters)
+                    printf(" %11s %8s %11s %11s %11s\n", "cycles/px", "IPC", "L1D miss/px", "LLC miss/px",
+                            "br miss/px");
+                else
+                    printf(" %12s %10s\n", "allocs/call", "KiB/call");
+                for (const flare16x_bench_case* bench = flare16x_bench_cases; bench->name != NULL; bench++)
+                {
+                    if (options.filter != NULL && strstr(bench->name, options.filter) == NULL)
+                        continue;
+                    error = flare16x_bench_run(bench, options.iterations, options.counters ? &counters : NULL,
+                            &context);
+                    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+                    {
+                        fprintf(stderr, "%s: %s failed: %s\n", argv[0], bench->name, flare16x_error_string(error));
+                        failures++;
+                    }
+                }
+                printf("\n");
+                flare16x_bench_context_destroy(&context);
+            }
+        }
+    }
+    if (options.counters && options.output_directory == NULL)
+        flare16x_bench_counters_close(&counters);
+
+    return failures > 0;
+}
@@ -12,13 +12,17 @@
 #include <stdint.h>
 
 #include "error.h"
+#include "profile.h"
 #include "canvas.h"
+#include "convert.h"
 
 #include "bitmap.h"
 
-// Creates a new 16-bit RGB565 bitmap, allocates the required memory and fills in the values
+// Fills in the headers of a new top-down bitmap with the given pixel format and optionally its pixel data
+// The headers and the pixel data are allocated as one block in the same layout as the bitmap file
 // Will overwrite any existing state and WILL leak memory if a previous state is re-used
-flare16x_error flare16x_bitmap_create16(uint16_t width, uint16_t height, flare16x_bitmap* bitmap)
+static flare16x_error flare16x_bitmap_describe(uint16_t width, uint16_t height, uint16_t bit_count,
+        uint8_t with_pixels, flare16x_bitmap* bitmap)
 {
     // Make sure the bitmap is not null
     if (bitmap == NULL)
@@ -32,47 +36,41 @@ flare16x_error flare16x_bitmap_create16(uint16_t width, uint16_t height, flare16
     memset(bitmap, 0, sizeof(flare16x_bitmap));
 
     // Calculate the stride
-    bitmap->stride = ((((width * 16) + 31) & ~31) >> 3);
+    bitmap->stride = ((((width * bit_count) + 31) & ~31) >> 3);
 
-    // Calculate the required memory
+    // Calculate the required memory, only RGB565 requires the mask struct
     bitmap->dib_size = sizeof(flare16x_bitmap_dib);
-    bitmap->mask_size = sizeof(flare16x_bitmap_mask);
+    bitmap->mask_size = bit_count == 16 ? sizeof(flare16x_bitmap_mask) : 0;
     bitmap->pixels_size = height * bitmap->stride;
-    size_t total_size = bitmap->dib_size + bitmap->mask_size + bitmap->pixels_size + sizeof(flare16x_bitmap_header);
+    size_t payload_offset = sizeof(flare16x_bitmap_header) + bitmap->dib_size + bitmap->mask_size;
 
-    // Allocate the required memory and clear it
-    bitmap->header = malloc(sizeof(flare16x_bitmap_header));
-    if (bitmap->header == NULL)
-        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_BITMAP);
-    memset(bitmap->header, 0, sizeof(flare16x_bitmap_header));
-    bitmap->dib = malloc(bitmap->dib_size + bitmap->mask_size);
-    bitmap->mask = (void*)bitmap->dib + bitmap->dib_size;
-    if (bitmap->dib == NULL)
-    {
-        free(bitmap->header);
-        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_BITMAP);
-    }
-    memset(bitmap->dib, 0, bitmap->dib_size + bitmap->mask_size);
-    bitmap->pixels = malloc(bitmap->pixels_size);
-    if (bitmap->pixels == NULL)
-    {
-        free(bitmap->dib);
-        free(bitmap->header);
+    // Allocate the block and clear it
+    // The headers are moved back by a few bytes, so that the pixel data starts at a 32-bit boundary
+    size_t lead = (sizeof(uint32_t) - payload_offset % sizeof(uint32_t)) % sizeof(uint32_t);
+    bitmap->block = calloc(1, lead + payload_offset + (with_pixels ? bitmap->pixels_size : 0));
+    if (bitmap->block == NULL)
         return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_BITMAP);
-    }
-    memset(bitmap->pixels, 0, bitmap->pixels_size);
+
+    // Point the structs into the block
+    bitmap->header = (flare16x_bitmap_header*)((uint8_t*)bitmap->block + lead);
+    bitmap->dib = (flare16x_bitmap_dib*)((uint8_t*)bitmap->header + sizeof(flare16x_bitmap_header));
+    if (bitmap->mask_size > 0)
+        bitmap->mask = (flare16x_bitmap_mask*)((uint8_t*)bitmap->dib + bitmap->dib_size);
+    if (with_pixels)
+        bitmap->pixels = (uint8_t*)bitmap->header + payload_offset;
 
     // Next, fill in the header struct
     bitmap->header->magic = FLARE16X_BITMAP_HEADER_MAGIC;
     bitmap->header->reserved = FLARE16X_BITMAP_HEADER_RESERVED;
-    bitmap->header->file_size = total_size;
-    bitmap->header->payload_offset = bitmap->dib_size + bitmap->mask_size + sizeof(flare16x_bitmap_header);
+    bitmap->header->file_size = payload_offset + bitmap->pixels_size;
+    bitmap->header->payload_offset = payload_offset;
 
     // Followed by the DIB struct
     bitmap->dib->height = -height;
     bitmap->dib->width = width;
-    bitmap->dib->compression = FLARE16X_BITMAP_COMPRESSION_BITFIELDS;
-    bitmap->dib->bit_count = 16;
+    bitmap->dib->compression = bit_count == 16 ? FLARE16X_BITMAP_COMPRESSION_BITFIELDS :
+            FLARE16X_BITMAP_COMPRESSION_RGB;
+    bitmap->dib->bit_count = bit_count;
     bitmap->dib->planes = 1;
     bitmap->dib->size = bitmap->dib_size;
     bitmap->dib->size_image = bitmap->pixels_size;
@@ -82,152 +80,98 @@ flare16x_error flare16x_bitmap_create16(uint16_t width, uint16_t height, flare16
     bitmap->dib->ver_px_per_meter = 0;
 
     // And followed by the mask struct
-    bitmap->mask->mask_red = 0xf800;
-    bitmap->mask->mask_green = 0x7e0;
-    bitmap->mask->mask_blue = 0x1f;
+    if (bitmap->mask != NULL)
+    {
+        bitmap->mask->mask_red = FLARE16X_BITMAP_MASK_RGB565_RED;
+        bitmap->mask->mask_green = FLARE16X_BITMAP_MASK_RGB565_GREEN;
+        bitmap->mask->mask_blue = FLARE16X_BITMAP_MASK_RGB565_BLUE;
+    }
 
     return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_BITMAP);
 }
 
-// Creates a new 24-bit RGB888 bitmap, allocates the required memory and fills in the values
+// Fills in the headers of a new 16-bit RGB565 bitmap without allocating the pixel data
+// This allows writing the pixel data to the file line by line after storing the headers
 // Will overwrite any existing state and WILL leak memory if a previous state is re-used
-flare16x_error flare16x_bitmap_create24(uint16_t width, uint16_t height, flare16x_bitmap* bitmap)
+flare16x_error flare16x_bitmap_describe16(uint16_t width, uint16_t height, flare16x_bitmap* bitmap)
 {
-    // Make sure the bitmap is not null
-    if (bitmap == NULL)
-        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_BITMAP);
-
-    // Verify width and height
-    if (width == 0 || height == 0 || height * width > FLARE16X_BITMAP_MAX_PIXELS)
-        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_BITMAP);
-
-    // Clear the target struct
-    memset(bitmap, 0, sizeof(flare16x_bitmap));
-
-    // Calculate the stride
-    bitmap->stride = ((((width * 24) + 31) & ~31) >> 3);
-
-    // Calculate the required memory
-    bitmap->dib_size = sizeof(flare16x_bitmap_dib);
-    bitmap->mask_size = 0;
-    bitmap->pixels_size = height * bitmap->stride;
-    size_t total_size = bitmap->dib_size + bitmap->pixels_size + sizeof(flare16x_bitmap_header);
-
-    // Allocate the required memory and clear it
-    bitmap->header = malloc(sizeof(flare16x_bitmap_header));
-    if (bitmap->header == NULL)
-        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_BITMAP);
-    memset(bitmap->header, 0, sizeof(flare16x_bitmap_header));
-    bitmap->dib = malloc(bitmap->dib_size);
-    bitmap->mask = NULL;
-    if (bitmap->dib == NULL)
-    {
-        free(bitmap->header);
-        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_BITMAP);
-    }
-    memset(bitmap->dib, 0, bitmap->dib_size + bitmap->mask_size);
-    bitmap->pixels = malloc(bitmap->pixels_size);
-    if (bitmap->pixels == NULL)
-    {
-        free(bitmap->dib);
-        free(bitmap->header);
-        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_BITMAP);
-    }
-    memset(bitmap->pixels, 0, bitmap->pixels_size);
-
-    // Next, fill in the header struct
-    bitmap->header->magic = FLARE16X_BITMAP_HEADER_MAGIC;
-    bitmap->header->reserved = FLARE16X_BITMAP_HEADER_RESERVED;
-    bitmap->header->file_size = total_size;
-    bitmap->header->payload_offset = bitmap->dib_size + sizeof(flare16x_bitmap_header);
+    return flare16x_bitmap_describe(width, height, 16, 0, bitmap);
+}
 
-    // Followed by the DIB struct
-    bitmap->dib->height = -height;
-    bitmap->dib->width = width;
-    bitmap->dib->compression = FLARE16X_BITMAP_COMPRESSION_RGB;
-    bitmap->dib->bit_count = 24;
-    bitmap->dib->planes = 1;
-    bitmap->dib->size = bitmap->dib_size;
-    bitmap->dib->size_image = bitmap->pixels_size;
-    bitmap->dib->colors_important = 0;
-    bitmap->dib->colors_used = 0;
-    bitmap->dib->hor_px_per_meter = 0;
-    bitmap->dib->ver_px_per_meter = 0;
+// Creates a new 16-bit RGB565 bitmap, allocates the required memory and fills in the values
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_bitmap_create16(uint16_t width, uint16_t height, flare16x_bitmap* bitmap)
+{
+    return flare16x_bitmap_describe(width, height, 16, 1, bitmap);
+}
 
-    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_BITMAP);
+// Creates a new 24-bit RGB888 bitmap, allocates the required memory and fills in the values
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_bitmap_create24(uint16_t width, uint16_t height, flare16x_bitmap* bitmap)
+{
+    return flare16x_bitmap_describe(width, height, 24, 1, bitmap);
 }
 
 // Creates a new 32-bit RGBA8888 bitmap, allocates the required memory and fills in the values
 // Will overwrite any existing state and WILL leak memory if a previous state is re-used
 flare16x_error flare16x_bitmap_create32(uint16_t width, uint16_t height, flare16x_bitmap* bitmap)
 {
-    // Make sure the bitmap is not null
-    if (bitmap == NULL)
-        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_BITMAP);
+    return flare16x_bitmap_describe(width, height, 32, 1, bitmap);
+}
 
-    // Verify width and height
-    if (width == 0 || height == 0 || height * width > FLARE16X_BITMAP_MAX_PIXELS)
-        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_BITMAP);
+// Validates the magic number, reserved field, size and payload offset of a bitmap file header
+static int flare16x_bitmap_header_valid(const flare16x_bitmap_header* header)
+{
+    return header->magic == FLARE16X_BITMAP_HEADER_MAGIC && header->reserved == FLARE16X_BITMAP_HEADER_RESERVED &&
+           header->file_size != 0 && (header->payload_offset == 0x36 || header->payload_offset == 0x42);
+}
 
-    // Clear the target struct
-    memset(bitmap, 0, sizeof(flare16x_bitmap));
+// Validates the DIB and mask structs of a bitmap with a valid file header and derives the stride and pixel size
+// The DIB struct has to hold the entire DIB plus optional mask of dib_mask_size bytes
+static flare16x_error flare16x_bitmap_dib_prepare(flare16x_bitmap* bitmap_struct, size_t dib_mask_size)
+{
+    // Verify, that the reported DIB size, planes, bit-count, compression and maximum size matches
+    if ((bitmap_struct->dib->size + sizeof(flare16x_bitmap_mask) != dib_mask_size &&
+        bitmap_struct->dib->size != dib_mask_size) || bitmap_struct->dib->planes != 1 ||
+        bitmap_struct->dib->width <= 0 || bitmap_struct->dib->height == 0 ||
+        bitmap_struct->dib->width * abs(bitmap_struct->dib->height) > FLARE16X_BITMAP_MAX_PIXELS)
+        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_BITMAP);
 
-    // Calculate the stride
-    bitmap->stride = ((((width * 32) + 31) & ~31) >> 3);
+    // Copy the dib size
+    bitmap_struct->dib_size = bitmap_struct->dib->size;
 
-    // Calculate the required memory
-    bitmap->dib_size = sizeof(flare16x_bitmap_dib);
-    bitmap->mask_size = 0;
-    bitmap->pixels_size = height * bitmap->stride;
-    size_t total_size = bitmap->dib_size + bitmap->pixels_size + sizeof(flare16x_bitmap_header);
+    // Calculate the stride
+    bitmap_struct->stride = ((((bitmap_struct->dib->width * bitmap_struct->dib->bit_count) + 31) & ~31) >> 3);
 
-    // Allocate the required memory and clear it
-    bitmap->header = malloc(sizeof(flare16x_bitmap_header));
-    if (bitmap->header == NULL)
-        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_BITMAP);
-    memset(bitmap->header, 0, sizeof(flare16x_bitmap_header));
-    bitmap->dib = malloc(bitmap->dib_size);
-    bitmap->mask = NULL;
-    if (bitmap->dib == NULL)
-    {
-        free(bitmap->header);
-        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_BITMAP);
-    }
-    memset(bitmap->dib, 0, bitmap->dib_size + bitmap->mask_size);
-    bitmap->pixels = malloc(bitmap->pixels_size);
-    if (bitmap->pixels == NULL)
+    // Next, determine the number of bits and calculate the image data size
+    if (bitmap_struct->dib->bit_count == 16 && bitmap_struct->header->payload_offset == 0x42 &&
+        bitmap_struct->dib->compression == FLARE16X_BITMAP_COMPRESSION_BITFIELDS)
     {
-        free(bitmap->dib);
-        free(bitmap->header);
-        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_BITMAP);
-    }
-    memset(bitmap->pixels, 0, bitmap->pixels_size);
+        // For 16 bit RGB565 calculate the mask struct pointer
+        bitmap_struct->mask = (flare16x_bitmap_mask*)((void*)bitmap_struct->dib + bitmap_struct->dib->size);
+        bitmap_struct->mask_size = dib_mask_size - bitmap_struct->dib->size;
 
-    // Next, fill in the header struct
-    bitmap->header->magic = FLARE16X_BITMAP_HEADER_MAGIC;
-    bitmap->header->reserved = FLARE16X_BITMAP_HEADER_RESERVED;
-    bitmap->header->file_size = total_size;
-    bitmap->header->payload_offset = bitmap->dib_size + sizeof(flare16x_bitmap_header);
+        // And verify the masks
+        if (bitmap_struct->mask->mask_red != FLARE16X_BITMAP_MASK_RGB565_RED ||
+            bitmap_struct->mask->mask_green != FLARE16X_BITMAP_MASK_RGB565_GREEN ||
+            bitmap_struct->mask->mask_blue != FLARE16X_BITMAP_MASK_RGB565_BLUE)
+            return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_BITMAP);
+    } else if (!(bitmap_struct->dib->bit_count == 24 || bitmap_struct->dib->bit_count == 32) ||
+               bitmap_struct->header->payload_offset != 0x36 ||
+               bitmap_struct->dib->compression != FLARE16X_BITMAP_COMPRESSION_RGB)
+        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_BITMAP);
 
-    // Followed by the DIB struct
-    bitmap->dib->height = -height;
-    bitmap->dib->width = width;
-    bitmap->dib->compression = FLARE16X_BITMAP_COMPRESSION_RGB;
-    bitmap->dib->bit_count = 32;
-    bitmap->dib->planes = 1;
-    bitmap->dib->size = bitmap->dib_size;
-    bitmap->dib->size_image = bitmap->pixels_size;
-    bitmap->dib->colors_important = 0;
-    bitmap->dib->colors_used = 0;
-    bitmap->dib->hor_px_per_meter = 0;
-    bitmap->dib->ver_px_per_meter = 0;
+    // All formats share the same pixel size calculation
+    bitmap_struct->pixels_size = bitmap_struct->stride * abs(bitmap_struct->dib->height);
 
+    // The headers are valid
     return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_BITMAP);
 }
 
-// Attempts to load a bitmap from file
+// Attempts to load and validate the headers of a bitmap from file without reading the pixel data
+// Afterwards, the file is positioned at the start of the pixel data, which is stored in file line order
 // Will overwrite any existing state and WILL leak memory if a previous state is re-used
-flare16x_error flare16x_bitmap_load(FILE* bitmap_file, flare16x_bitmap* bitmap_struct)
+flare16x_error flare16x_bitmap_load_header(FILE* bitmap_file, flare16x_bitmap* bitmap_struct)
 {
     // Make sure that there are no null pointers
     if (bitmap_file == NULL || bitmap_struct == NULL)
@@ -250,11 +194,8 @@ flare16x_error flare16x_bitmap_load(FILE* bitmap_file, flare16x_bitmap* bitmap_s
         return flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_BITMAP);
     }
 
-    // Now, validate the resulting struct starting with the magic number, reserved field, size and offset
-    if (bitmap_struct->header->magic != FLARE16X_BITMAP_HEADER_MAGIC ||
-        bitmap_struct->header->reserved != FLARE16X_BITMAP_HEADER_RESERVED ||
-        bitmap_struct->header->file_size == 0 ||
-        (bitmap_struct->header->payload_offset != 0x36 && bitmap_struct->header->payload_offset != 0x42))
+    // Now, validate the resulting struct
+    if (!flare16x_bitmap_header_valid(bitmap_struct->header))
     {
         // On failure, free the buffer struct again and return failure
         free(bitmap_struct->header);
@@ -275,79 +216,32 @@ flare16x_error flare16x_bitmap_load(FILE* bitmap_file, flare16x_bitmap* bitmap_s
     }
 
     // Read the DIB struct from the input file
+    flare16x_error error;
     if (fread(bitmap_struct->dib, dib_mask_size, 1, bitmap_file) != 1)
-    {
-        // On failure, free the buffer structs again and return failure
-        free(bitmap_struct->dib);
-        free(bitmap_struct->header);
-        bitmap_struct->dib = NULL;
-        bitmap_struct->header = NULL;
-        return flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_BITMAP);
-    }
+        error = flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_BITMAP);
+    else
+        error = flare16x_bitmap_dib_prepare(bitmap_struct, dib_mask_size);
 
-    // Verify, that the reported DIB size, planes, bit-count, compression and maximum size matches
-    if ((bitmap_struct->dib->size + sizeof(flare16x_bitmap_mask) != dib_mask_size &&
-        bitmap_struct->dib->size != dib_mask_size) || bitmap_struct->dib->planes != 1 ||
-        bitmap_struct->dib->width <= 0 || bitmap_struct->dib->height == 0 ||
-        bitmap_struct->dib->width * abs(bitmap_struct->dib->height) > FLARE16X_BITMAP_MAX_PIXELS)
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
     {
         // On failure, free the buffer structs again and return failure
         free(bitmap_struct->dib);
         free(bitmap_struct->header);
-        bitmap_struct->dib = NULL;
-        bitmap_struct->header = NULL;
-        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_BITMAP);
+        memset(bitmap_struct, 0, sizeof(flare16x_bitmap));
+        return error;
     }
 
-    // Copy the dib size
-    bitmap_struct->dib_size = bitmap_struct->dib->size;
-
-    // Calculate the stride
-    bitmap_struct->stride = ((((bitmap_struct->dib->width * bitmap_struct->dib->bit_count) + 31) & ~31) >> 3);
-
-    // TODO: Simplify this if-clause and merge the two equal outcomes
-    // Next, determine the number of bits and calculate the image data size
-    if (bitmap_struct->dib->bit_count == 16 && bitmap_struct->header->payload_offset == 0x42 &&
-        bitmap_struct->dib->compression == FLARE16X_BITMAP_COMPRESSION_BITFIELDS)
-    {
-        // For 16 bit RGB565 calculate the mask struct pointer
-        bitmap_struct->mask = (flare16x_bitmap_mask*)((void*)bitmap_struct->dib + bitmap_struct->dib->size);
-        bitmap_struct->mask_size = dib_mask_size - bitmap_struct->dib->size;
-
-        // As well as the pixel size
-        bitmap_struct->pixels_size = bitmap_struct->stride * abs(bitmap_struct->dib->height);
+    // The headers are valid
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_BITMAP);
+}
 
-        // And verify the masks
-        if (bitmap_struct->mask->mask_red != FLARE16X_BITMAP_MASK_RGB565_RED ||
-            bitmap_struct->mask->mask_green != FLARE16X_BITMAP_MASK_RGB565_GREEN ||
-            bitmap_struct->mask->mask_blue != FLARE16X_BITMAP_MASK_RGB565_BLUE)
-        {
-            // On failure, free the buffer structs again and return failure
-            free(bitmap_struct->dib);
-            free(bitmap_struct->header);
-            bitmap_struct->dib = NULL;
-            bitmap_struct->header = NULL;
-            return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_BITMAP);
-        }
-    } else if (bitmap_struct->dib->bit_count == 24 && bitmap_struct->header->payload_offset == 0x36 &&
-                bitmap_struct->dib->compression == FLARE16X_BITMAP_COMPRESSION_RGB)
-    {
-        // For 24-bit RGB888 calculate the pixel size
-        bitmap_struct->pixels_size = bitmap_struct->stride * abs(bitmap_struct->dib->height);
-    } else if (bitmap_struct->dib->bit_count == 32 && bitmap_struct->header->payload_offset == 0x36 &&
-               bitmap_struct->dib->compression == FLARE16X_BITMAP_COMPRESSION_RGB)
-    {
-        // For 32-bit RGBA8888 calculate the pixel size
-        bitmap_struct->pixels_size = bitmap_struct->stride * abs(bitmap_struct->dib->height);
-    } else
-    {
-        // On failure, free the buffer structs again and return failure
-        free(bitmap_struct->dib);
-        free(bitmap_struct->header);
-        bitmap_struct->dib = NULL;
-        bitmap_struct->header = NULL;
-        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_BITMAP);
-    }
+// Implements flare16x_bitmap_load without profiling
+static flare16x_error flare16x_bitmap_load_untimed(FILE* bitmap_file, flare16x_bitmap* bitmap_struct)
+{
+    // Load and validate the headers first, which also checks the pointers
+    flare16x_error error = flare16x_bitmap_load_header(bitmap_file, bitmap_struct);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return error;
 
     // Since the header worked out well, allocate space for the image data next
     bitmap_struct->pixels = malloc(bitmap_struct->pixels_size);
@@ -411,28 +305,271 @@ flare16x_error flare16x_bitmap_load(FILE* bitmap_file, flare16x_bitmap* bitmap_s
     return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_BITMAP);
 }
 
-// Attempts to store a bitmap to file
-flare16x_error flare16x_bitmap_store(flare16x_bitmap* bitmap_struct, FILE* bitmap_file)
+// Attempts to load a bitmap from file
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_bitmap_load(FILE* bitmap_file, flare16x_bitmap* bitmap_struct)
+{
+    // Time the whole load, if profiling is enabled
+    uint64_t start = flare16x_profile_begin();
+    flare16x_error error = flare16x_bitmap_load_untimed(bitmap_file, bitmap_struct);
+    flare16x_profile_end(FLARE16X_PROFILE_BITMAP_LOAD, start);
+    return error;
+}
+
+// Reads a region of a bitmap from file straight into a new canvas without reading the rest of the pixel data
+// The bitmap has to hold the headers loaded by flare16x_bitmap_load_header and the file has to be seekable
+// Will overwrite any existing canvas state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_bitmap_read_region(flare16x_bitmap* bitmap, FILE* bitmap_file, uint16_t offset_x,
+        uint16_t offset_y, uint16_t width, uint16_t height, flare16x_canvas* canvas)
+{
+    // Make sure that there are no null pointers
+    if (bitmap == NULL || bitmap_file == NULL || canvas == NULL || bitmap->header == NULL || bitmap->dib == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_BITMAP);
+
+    // Validate the format
+    if (bitmap->dib->width <= 0 || bitmap->dib->height == 0 || bitmap->stride == 0 || bitmap->dib->bit_count < 16)
+        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_BITMAP);
+
+    // Validate the width and height
+    if (width == 0 || height == 0 || width + offset_x > bitmap->dib->width ||
+        height + offset_y > abs(bitmap->dib->height))
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_BITMAP);
+
+    // The requested lines are contiguous in the file, but bottom up bitmaps store them in reverse order
+    int bottom_up = bitmap->dib->height > 0;
+    long first_line = bottom_up ? bitmap->dib->height - offset_y - height : offset_y;
+
+    // Only the bytes up to the right edge of the region are needed from the last line of each chunk
+    size_t used_size = (offset_x + width) * (bitmap->dib->bit_count / 8);
+    uint16_t chunk_lines = height < FLARE16X_BITMAP_REGION_LINES ? height : FLARE16X_BITMAP_REGION_LINES;
+    uint8_t* lines = malloc((chunk_lines - 1) * bitmap->stride + used_size);
+    if (lines == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_BITMAP);
+
+    // Create the target canvas
+    flare16x_error error = flare16x_canvas_create(width, height, canvas);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+    {
+        free(lines);
+        return flare16x_error_wrap(flare16x_error_make(FLARE16X_ERROR_CALLEE, FLARE16X_ERROR_SOURCE_BITMAP), error);
+    }
+
+    // Seek to the first line once, as all following chunks are read sequentially
+    if (fseek(bitmap_file, (long)bitmap->header->payload_offset + first_line * bitmap->stride, SEEK_SET) != 0)
+        error = flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_BITMAP);
+
+    // Read the lines in chunks in file order and convert them into the canvas
+    uint16_t line = 0;
+    while (line < height && flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+    {
+        uint16_t count = height - line < chunk_lines ? height - line : chunk_lines;
+
+        // Read the whole chunk at once, skipping the padding bytes between chunks afterwards
+        if (fread(lines, (count - 1) * bitmap->stride + used_size, 1, bitmap_file) != 1 ||
+            (line + count < height && fseek(bitmap_file, (long)(bitmap->stride - used_size), SEEK_CUR) != 0))
+        {
+            error = flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_BITMAP);
+            break;
+        }
+
+        // Then, convert each line of the chunk
+        uint16_t index;
+        for (index = 0; index < count && flare16x_error_reason(error) == FLARE16X_ERROR_NONE; index++)
+        {
+            uint16_t y = bottom_up ? height - 1 - (line + index) : line + index;
+            error = flare16x_bitmap_scanline(bitmap, lines + index * bitmap->stride, offset_x, width,
+                    &flare16x_canvas_raw(0, y, canvas));
+        }
+        line += count;
+    }
+
+    // The raw lines are not needed anymore
+    free(lines);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+    {
+        flare16x_canvas_destroy(canvas);
+        return error;
+    }
+
+    // And, it's done!
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_BITMAP);
+}
+
+// Attempts to load only a region of a bitmap from file into a new canvas
+// Only the headers and the lines covering the region are read, so the file has to be seekable
+// Will overwrite any existing canvas state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_bitmap_load_region(FILE* bitmap_file, uint16_t offset_x, uint16_t offset_y,
+        uint16_t width, uint16_t height, flare16x_canvas* canvas)
+{
+    // Load and validate the headers first, which also checks the file pointer
+    flare16x_bitmap bitmap;
+    flare16x_error error = flare16x_bitmap_load_header(bitmap_file, &bitmap);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return error;
+
+    // Then, read the region and release the headers again
+    error = flare16x_bitmap_read_region(&bitmap, bitmap_file, offset_x, offset_y, width, height, canvas);
+    flare16x_bitmap_destroy(&bitmap);
+    return error;
+}
+
+// Attempts to parse a bitmap from a memory buffer
+// If alias is non-zero, the pixel data of top-down bitmaps references the buffer instead of being copied
+// In this case, the buffer has to outlive the bitmap and its pixels must not be modified
+// Bottom-up bitmaps are always copied, as their lines have to be reordered
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_bitmap_parse(const void* buffer, size_t size, uint8_t alias, flare16x_bitmap* bitmap_struct)
+{
+    // Make sure that there are no null pointers
+    if (buffer == NULL || bitmap_struct == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_BITMAP);
+
+    // Next, clean up the target struct
+    memset(bitmap_struct, 0, sizeof(flare16x_bitmap));
+
+    // Make sure the buffer can hold the header
+    const uint8_t* data = buffer;
+    if (size < sizeof(flare16x_bitmap_header))
+        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_BITMAP);
+
+    // Allocate the memory for the header struct and copy it from the buffer
+    bitmap_struct->header = malloc(sizeof(flare16x_bitmap_header));
+    if (bitmap_struct->header == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_BITMAP);
+    memcpy(bitmap_struct->header, data, sizeof(flare16x_bitmap_header));
+
+    // Now, validate the resulting struct and make sure the buffer holds the remaining headers
+    if (!flare16x_bitmap_header_valid(bitmap_struct->header) || size < bitmap_struct->header->payload_offset)
+    {
+        // On failure, free the buffer struct again and return failure
+        free(bitmap_struct->header);
+        bitmap_struct->header = NULL;
+        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_BITMAP);
+    }
+
+    // Allocate more memory for the DIB and mask structs and copy them from the buffer
+    // The data offset minus the size of the file header yields the entire DIB plus optional mask size
+    size_t dib_mask_size = bitmap_struct->header->payload_offset - sizeof(flare16x_bitmap_header);
+    bitmap_struct->dib = malloc(dib_mask_size);
+    if (bitmap_struct->dib == NULL)
+    {
+        // On failure, free the buffer struct again and return failure
+        free(bitmap_struct->header);
+        bitmap_struct->header = NULL;
+        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_BITMAP);
+    }
+    memcpy(bitmap_struct->dib, data + sizeof(flare16x_bitmap_header), dib_mask_size);
+
+    // Validate the DIB and mask and make sure the buffer holds the entire pixel data
+    flare16x_error error = flare16x_bitmap_dib_prepare(bitmap_struct, dib_mask_size);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE &&
+        size - bitmap_struct->header->payload_offset < bitmap_struct->pixels_size)
+        error = flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_BITMAP);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+    {
+        // On failure, free the buffer structs again and return failure
+        free(bitmap_struct->dib);
+        free(bitmap_struct->header);
+        memset(bitmap_struct, 0, sizeof(flare16x_bitmap));
+        return error;
+    }
+
+    // Top-down pixel data that is aligned to its pixel size can be referenced in place
+    const uint8_t* pixels = data + bitmap_struct->header->payload_offset;
+    if (alias && bitmap_struct->dib->height < 0 &&
+        (uintptr_t)pixels % (bitmap_struct->dib->bit_count == 32 ? sizeof(uint32_t) : sizeof(uint16_t)) == 0)
+    {
+        bitmap_struct->pixels = (uint8_t*)pixels;
+        bitmap_struct->pixels_external = 1;
+        return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_BITMAP);
+    }
+
+    // Otherwise, allocate space for the image data
+    bitmap_struct->pixels = malloc(bitmap_struct->pixels_size);
+    if (bitmap_struct->pixels == NULL)
+    {
+        // On failure, free the buffer structs again and return failure
+        free(bitmap_struct->dib);
+        free(bitmap_struct->header);
+        memset(bitmap_struct, 0, sizeof(flare16x_bitmap));
+        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_BITMAP);
+    }
+
+    // Copy top-down images at once, while bottom up ones are reordered line by line while copying them
+    if (bitmap_struct->dib->height < 0)
+        memcpy(bitmap_struct->pixels, pixels, bitmap_struct->pixels_size);
+    else
+    {
+        int y;
+        for (y = 0; y < bitmap_struct->dib->height; y++)
+            memcpy(bitmap_struct->pixels + (y * bitmap_struct->stride),
+                   pixels + ((bitmap_struct->dib->height - y - 1) * bitmap_struct->stride), bitmap_struct->stride);
+
+        // Finally flip the sign of the height
+        bitmap_struct->dib->height = -bitmap_struct->dib->height;
+    }
+
+    // As everything worked out, return success
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_BITMAP);
+}
+
+// Validates the headers of a top-down bitmap before it is stored
+// Note that this requires short-circuiting to work properly!
+static int flare16x_bitmap_format_valid(flare16x_bitmap* bitmap_struct)
+{
+    return bitmap_struct->dib_size != 0 && bitmap_struct->pixels_size != 0 && bitmap_struct->stride != 0 &&
+           bitmap_struct->dib->width > 0 && bitmap_struct->dib->height < 0 && bitmap_struct->dib->planes == 1 &&
+           (-bitmap_struct->dib->height) * bitmap_struct->dib->width <= FLARE16X_BITMAP_MAX_PIXELS &&
+           ((bitmap_struct->dib->compression == FLARE16X_BITMAP_COMPRESSION_BITFIELDS &&
+           bitmap_struct->dib->bit_count == 16) || (bitmap_struct->dib->compression == FLARE16X_BITMAP_COMPRESSION_RGB &&
+           (bitmap_struct->dib->bit_count == 24 || bitmap_struct->dib->bit_count == 32)));
+}
+
+// Provides the file image of a contiguous bitmap without copying it
+// The data stays owned by the bitmap and is only valid until the bitmap is destroyed
+flare16x_error flare16x_bitmap_data(flare16x_bitmap* bitmap_struct, const void** data, size_t* size)
+{
+    // Make sure that there are no null pointers
+    if (bitmap_struct == NULL || data == NULL || size == NULL || bitmap_struct->header == NULL ||
+        bitmap_struct->dib == NULL || bitmap_struct->pixels == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_BITMAP);
+
+    // Validate the format
+    if (!flare16x_bitmap_format_valid(bitmap_struct))
+        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_BITMAP);
+
+    // Only bitmaps with headers and pixel data in one block are laid out like the file
+    if (bitmap_struct->block == NULL ||
+        bitmap_struct->pixels != (uint8_t*)bitmap_struct->header + bitmap_struct->header->payload_offset)
+        return flare16x_error_make(FLARE16X_ERROR_UNKNOWN, FLARE16X_ERROR_SOURCE_BITMAP);
+
+    *data = bitmap_struct->header;
+    *size = bitmap_struct->header->payload_offset + bitmap_struct->pixels_size;
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_BITMAP);
+}
+
+// Attempts to store the headers of a bitmap to file without writing the pixel data
+// Afterwards, exactly pixels_size bytes of top-down pixel data have to be written to complete the file
+flare16x_error flare16x_bitmap_store_header(flare16x_bitmap* bitmap_struct, FILE* bitmap_file)
 {
     // Make sure that there are no null pointers
     if (bitmap_struct == NULL || bitmap_file == NULL || bitmap_struct->header == NULL || bitmap_struct->dib == NULL ||
-        bitmap_struct->pixels == NULL || (bitmap_struct->mask_size > 0 && bitmap_struct->mask == NULL))
+        (bitmap_struct->mask_size > 0 && bitmap_struct->mask == NULL))
         return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_BITMAP);
 
     // Validate the format
-    // Note that this requires short-circuiting to work properly!
-    if (bitmap_struct->dib_size == 0 ||
-    bitmap_struct->pixels_size == 0 || bitmap_struct->dib->width <= 0 || bitmap_struct->dib->height >= 0 ||
-    bitmap_struct->dib->height * bitmap_struct->dib->width > FLARE16X_BITMAP_MAX_PIXELS || bitmap_struct->stride == 0 ||
-    bitmap_struct->dib->planes != 1 || (bitmap_struct->dib->bit_count != 16 && bitmap_struct->dib->bit_count != 24 &&
-    bitmap_struct->dib->bit_count != 32) || (bitmap_struct->dib->compression != FLARE16X_BITMAP_COMPRESSION_RGB &&
-    bitmap_struct->dib->compression != FLARE16X_BITMAP_COMPRESSION_BITFIELDS) ||
-    (bitmap_struct->dib->compression == FLARE16X_BITMAP_COMPRESSION_BITFIELDS &&
-    bitmap_struct->dib->bit_count != 16) || (bitmap_struct->dib->compression == FLARE16X_BITMAP_COMPRESSION_RGB &&
-    !(bitmap_struct->dib->bit_count == 24 || bitmap_struct->dib->bit_count == 32)))
+    if (!flare16x_bitmap_format_valid(bitmap_struct))
         return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_BITMAP);
 
-    // First, write the header struct
+    // Contiguous headers are already laid out like the file, so they are written at once
+    if (bitmap_struct->block != NULL)
+    {
+        if (fwrite(bitmap_struct->header, bitmap_struct->header->payload_offset, 1, bitmap_file) != 1)
+            return flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_BITMAP);
+        return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_BITMAP);
+    }
+
+    // Otherwise, write the header struct first
     if (fwrite(bitmap_struct->header, sizeof(flare16x_bitmap_header), 1, bitmap_file) != 1)
         return flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_BITMAP);
 
@@ -445,6 +582,33 @@ flare16x_error flare16x_bitmap_store(flare16x_bitmap* bitmap_struct, FILE* bitma
         if (fwrite(bitmap_struct->mask, bitmap_struct->mask_size, 1, bitmap_file) != 1)
             return flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_BITMAP);
 
+    // The headers are written
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_BITMAP);
+}
+
+// Implements flare16x_bitmap_store without profiling
+static flare16x_error flare16x_bitmap_store_untimed(flare16x_bitmap* bitmap_struct, FILE* bitmap_file)
+{
+    // Make sure that the pixel data is not null
+    if (bitmap_struct == NULL || bitmap_struct->pixels == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_BITMAP);
+
+    // A contiguous bitmap is written with a single call
+    const void* data;
+    size_t size;
+    flare16x_error error = flare16x_bitmap_data(bitmap_struct, &data, &size);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+    {
+        if (fwrite(data, size, 1, bitmap_file) != 1)
+            return flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_BITMAP);
+        return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_BITMAP);
+    }
+
+    // Otherwise, validate and write the headers first
+    error = flare16x_bitmap_store_header(bitmap_struct, bitmap_file);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return error;
+
     // Finally, write the pixel data
     if (fwrite(bitmap_struct->pixels, bitmap_struct->pixels_size, 1, bitmap_file) != 1)
         return flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_BITMAP);
@@ -453,6 +617,63 @@ flare16x_error flare16x_bitmap_store(flare16x_bitmap* bitmap_struct, FILE* bitma
     return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_BITMAP);
 }
 
+// Attempts to store a bitmap to file
+flare16x_error flare16x_bitmap_store(flare16x_bitmap* bitmap_struct, FILE* bitmap_file)
+{
+    // Time the whole store, if profiling is enabled
+    uint64_t start = flare16x_profile_begin();
+    flare16x_error error = flare16x_bitmap_store_untimed(bitmap_struct, bitmap_file);
+    flare16x_profile_end(FLARE16X_PROFILE_BITMAP_STORE, start);
+    return error;
+}
+
+// Attempts to serialize a bitmap into a memory buffer
+// The exact size of the serialized bitmap is always stored in size, even if the buffer is null or too small
+// This allows querying the size with a null buffer first and then serializing into a preallocated buffer
+flare16x_error flare16x_bitmap_serialize_into(flare16x_bitmap* bitmap_struct, void* buffer, size_t capacity,
+        size_t* size)
+{
+    // Make sure that there are no null pointers
+    if (bitmap_struct == NULL || size == NULL || bitmap_struct->header == NULL || bitmap_struct->dib == NULL ||
+        bitmap_struct->pixels == NULL || (bitmap_struct->mask_size > 0 && bitmap_struct->mask == NULL))
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_BITMAP);
+
+    // Validate the format
+    if (!flare16x_bitmap_format_valid(bitmap_struct))
+        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_BITMAP);
+
+    // Calculate the exact size of the output
+    size_t mask_size = bitmap_struct->dib->compression == FLARE16X_BITMAP_COMPRESSION_BITFIELDS ?
+            bitmap_struct->mask_size : 0;
+    *size = sizeof(flare16x_bitmap_header) + bitmap_struct->dib_size + mask_size + bitmap_struct->pixels_size;
+
+    // Make sure the output fits into the buffer
+    if (buffer == NULL || capacity < *size)
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_BITMAP);
+
+    // Contiguous bitmaps are copied at once
+    const void* block;
+    if (flare16x_error_reason(flare16x_bitmap_data(bitmap_struct, &block, size)) == FLARE16X_ERROR_NONE)
+    {
+        memcpy(buffer, block, *size);
+        return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_BITMAP);
+    }
+
+    // Otherwise, copy the header, DIB and mask structs as well as the pixel data in file order
+    uint8_t* data = buffer;
+    memcpy(data, bitmap_struct->header, sizeof(flare16x_bitmap_header));
+    data += sizeof(flare16x_bitmap_header);
+    memcpy(data, bitmap_struct->dib, bitmap_struct->dib_size);
+    data += bitmap_struct->dib_size;
+    if (mask_size > 0)
+        memcpy(data, bitmap_struct->mask, mask_size);
+    data += mask_size;
+    memcpy(data, bitmap_struct->pixels, bitmap_struct->pixels_size);
+
+    // And, it's done!
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_BITMAP);
+}
+
 // Destroys an existing bitmap context and frees the resources
 flare16x_error flare16x_bitmap_destroy(flare16x_bitmap* bitmap)
 {
@@ -460,10 +681,16 @@ flare16x_error flare16x_bitmap_destroy(flare16x_bitmap* bitmap)
     if (bitmap == NULL)
         return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_BITMAP);
 
-    // Free all allocated memory
-    free(bitmap->header);
-    free(bitmap->dib);
-    free(bitmap->pixels);
+    // Free all allocated memory, which is a single block for contiguous bitmaps
+    if (bitmap->block != NULL)
+        free(bitmap->block);
+    else
+    {
+        free(bitmap->header);
+        free(bitmap->dib);
+        if (!bitmap->pixels_external)
+            free(bitmap->pixels);
+    }
 
     // And zero the struct to get rid of all pointers and state
     memset(bitmap, 0, sizeof(flare16x_bitmap));
@@ -502,70 +729,61 @@ flare16x_error flare16x_bitmap_edit(flare16x_bitmap* bitmap, uint16_t offset_x,
     if (canvas->pixels == NULL)
         return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_BITMAP);
 
+    // Now, copy and convert the pixel data to RGB565 line by line
+    int y;
+    for (y = 0; y < height; y++)
+    {
+        flare16x_error error = flare16x_bitmap_scanline(bitmap, bitmap->pixels + (y + offset_y) * bitmap->stride,
+                offset_x, width, canvas->pixels + y * width);
+        if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        {
+            free(canvas->pixels);
+            canvas->pixels = NULL;
+            return error;
+        }
+    }
+
+    // And, it's done!
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_BITMAP);
+}
+
+// Converts a region of a single raw scanline of the bitmap's format to RGB565 pixels
+// The scanline does not need to belong to the bitmap's pixel buffer, so streamed lines can be converted as well
+flare16x_error flare16x_bitmap_scanline(flare16x_bitmap* bitmap, const uint8_t* line, uint16_t offset_x,
+        uint16_t width, uint16_t* pixels)
+{
+    // Make sure that there are no null pointers
+    if (bitmap == NULL || bitmap->dib == NULL || line == NULL || pixels == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_BITMAP);
+
+    // Validate the region
+    if (width == 0 || offset_x + width > bitmap->dib->width)
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_BITMAP);
+
     // Now, check the format and copy and convert the pixel data to RGB565
     if (bitmap->dib->bit_count == 16 && bitmap->dib->compression == FLARE16X_BITMAP_COMPRESSION_BITFIELDS)
     {
         // RGB565 just requires a copy operation
         // For good measure, verify the masks
-        if (bitmap->mask->mask_red != FLARE16X_BITMAP_MASK_RGB565_RED ||
+        if (bitmap->mask == NULL || bitmap->mask->mask_red != FLARE16X_BITMAP_MASK_RGB565_RED ||
             bitmap->mask->mask_green != FLARE16X_BITMAP_MASK_RGB565_GREEN ||
             bitmap->mask->mask_blue != FLARE16X_BITMAP_MASK_RGB565_BLUE)
-        {
-            free(canvas->pixels);
-            canvas->pixels = NULL;
             return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_BITMAP);
-        }
 
-        // Now, copy the pixels line by line, pixel by pixel without changing them
-        int x, y;
-        for (y = 0; y < height; y++)
-            for (x = 0; x < width; x++)
-                canvas->pixels[y * width + x] = bitmap->pixels565[(y + offset_y) *
-                                                                  (bitmap->stride / sizeof(uint16_t)) + x + offset_x];
+        // Copy the pixels without changing them
+        flare16x_convert_copy16((const uint16_t*)(line + offset_x * sizeof(uint16_t)), pixels, width);
     } else if (bitmap->dib->bit_count == 24 && bitmap->dib->compression == FLARE16X_BITMAP_COMPRESSION_RGB)
     {
         // RGB888 requires reducing the resolution and remapping the image data
-        // Now, process the pixels line by line, pixel by pixel
-        int x, y;
-        uint8_t r, g, b;
-        for (y = 0; y < height; y++)
-            for (x = 0; x < width; x++)
-            {
-                // Fetch the r, g and b components and truncate them to RGB565
-                r = bitmap->pixels[(y + offset_y) * bitmap->stride + (x + offset_x) * 4] >> 3; // R5
-                g = bitmap->pixels[(y + offset_y) * bitmap->stride + (x + offset_x) * 4 + 1] >> 2; // G6
-                b = bitmap->pixels[(y + offset_y) * bitmap->stride + (x + offset_x) * 4 + 2] >> 3; // B5
-
-                // Assemble the new RGB565 pixel
-                canvas->pixels[y * width + x] = r << 11 | g << 5 | b;
-            }
+        // The components are stored in blue, green, red order with three bytes per pixel
+        flare16x_convert_best()->bgr888_to_rgb565(line + offset_x * 3, pixels, width);
     } else if (bitmap->dib->bit_count == 32 && bitmap->dib->compression == FLARE16X_BITMAP_COMPRESSION_RGB)
     {
         // RGBA8888 requires reducing the resolution, discarding the alpha channel and remapping the image data
-        // Now, process the pixels line by line, pixel by pixel
-        int x, y;
-        uint8_t r, g, b;
-        uint32_t p;
-        for (y = 0; y < height; y++)
-            for (x = 0; x < width; x++)
-            {
-                // Fetch the whole pixel
-                p = bitmap->pixels8888[(y + offset_y) * (bitmap->stride / sizeof(uint32_t)) + x + offset_x];
-
-                // Mask the pixel, split it into it's components components and truncate them to RGB565
-                r = (p & 0x00ff0000ul) >> (3 + (8*2)); // R5
-                g = (p & 0x0000ff00ul) >> (2 + 8); // G6
-                b = (p & 0x000000fful) >> 3; // B5
-
-                // Assemble the new RGB565 pixel
-                canvas->pixels[y * width + x] = (r & 0x1fu) << 11 | (g & 0x3fu) << 5 | (b & 0x1fu);
-            }
+        // The components are stored in blue, green, red, alpha order with four bytes per pixel
+        flare16x_convert_best()->bgra8888_to_rgb565(line + offset_x * 4, pixels, width);
     } else
-    {
-        free(canvas->pixels);
-        canvas->pixels = NULL;
         return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_BITMAP);
-    }
 
     // And, it's done!
     return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_BITMAP);
@@ -590,7 +808,8 @@ flare16x_error flare16x_bitmap_merge(flare16x_canvas* canvas, uint16_t offset_x,
     if (canvas->width + offset_x > bitmap->dib->width || canvas->height + offset_y > (-bitmap->dib->height))
         return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_BITMAP);
 
-    // Now, check the format and copy and convert the pixel data from RGB565 to the bitmap format
+    // Now, check the format and copy and convert the pixel data from RGB565 to the bitmap format line by line
+    int y;
     if (bitmap->dib->bit_count == 16 && bitmap->dib->compression == FLARE16X_BITMAP_COMPRESSION_BITFIELDS)
     {
         // RGB565 just requires a copy operation
@@ -604,57 +823,24 @@ flare16x_error flare16x_bitmap_merge(flare16x_canvas* canvas, uint16_t offset_x,
             return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_BITMAP);
         }
 
-        // Now, copy the pixels line by line, pixel by pixel without changing them
-        int x, y;
+        // Now, copy the pixels line by line without changing them
         for (y = 0; y < canvas->height; y++)
-            for (x = 0; x < canvas->width; x++)
-                bitmap->pixels565[(y + offset_y) * (bitmap->stride / sizeof(uint16_t)) + x + offset_x] =
-                        canvas->pixels[y * canvas->width + x];
+            flare16x_convert_copy16(&flare16x_canvas_raw(0, y, canvas),
+                    (uint16_t*)(bitmap->pixels + (y + offset_y) * bitmap->stride) + offset_x, canvas->width);
     } else if (bitmap->dib->bit_count == 24 && bitmap->dib->compression == FLARE16X_BITMAP_COMPRESSION_RGB)
     {
-        // RGB888 requires reducing the resolution and remapping the image data
-        // Now, process the pixels line by line, pixel by pixel
-        int x, y;
-        uint16_t p;
-        uint8_t r, g, b;
+        // RGB888 requires expanding the resolution and remapping the image data
+        const flare16x_convert_kernels* kernels = flare16x_convert_best();
         for (y = 0; y < canvas->height; y++)
-            for (x = 0; x < canvas->width; x++)
-            {
-                // Fetch the RGB565 pixel
-                p = canvas->pixels[y * canvas->width + x];
-
-                // Unpack it and separate the r, g and b components while expanding them to RGB888
-                r = p & 0xf800u; // R5
-                g = (p << 5) & 0xfc00u; // G6
-                b = (p << 11) & 0xf800u; // B5
-
-                // Store the components
-                bitmap->pixels[(y + offset_x) * bitmap->stride + (x + offset_x) * 3] = r;
-                bitmap->pixels[(y + offset_y) * bitmap->stride + (x + offset_x) * 3 + 1] = g;
-                bitmap->pixels[(y + offset_y) * bitmap->stride + (x + offset_x) * 3 + 2] = b;
-            }
+            kernels->rgb565_to_bgr888(&flare16x_canvas_raw(0, y, canvas),
+                    bitmap->pixels + (y + offset_y) * bitmap->stride + offset_x * 3, canvas->width);
     } else if (bitmap->dib->bit_count == 32 && bitmap->dib->compression == FLARE16X_BITMAP_COMPRESSION_RGB)
     {
-        // RGBA8888 requires reducing the resolution, discarding the alpha channel and remapping the image data
-        // Now, process the pixels line by line, pixel by pixel
-        int x, y;
-        uint16_t p;
-        uint8_t r, g, b;
-        for (y = offset_y; y < offset_y + canvas->height; y++)
-            for (x = offset_x; x < offset_x + canvas->width; x++)
-            {
-                // Fetch the RGB565 pixel
-                p = canvas->pixels[y * canvas->width + x];
-
-                // Unpack it and separate the r, g and b components while expanding them to RGB888
-                r = p & 0xf800u; // R5
-                g = (p << 5) & 0xfc00u; // G6
-                b = (p << 11) & 0xf800u; // B5
-
-                // Store the components with a 0xff alpha
-                bitmap->pixels8888[(y + offset_x) * (bitmap->stride / sizeof(uint16_t)) + (x + offset_x) * 4] =
-                        0xff000000ul | (r << 16) | (g << 8) | b;
-            }
+        // RGBA8888 requires expanding the resolution, adding an opaque alpha channel and remapping the image data
+        const flare16x_convert_kernels* kernels = flare16x_convert_best();
+        for (y = 0; y < canvas->height; y++)
+            kernels->rgb565_to_bgra8888(&flare16x_canvas_raw(0, y, canvas),
+                    bitmap->pixels + (y + offset_y) * bitmap->stride + offset_x * 4, canvas->width);
     } else
     {
         free(canvas->pixels);
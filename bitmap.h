@@ -24,9 +24,15 @@
 
 // Import works with fixed-size RGB565 images, while export works with fixed size RGB888 images
 
+// Newly created bitmaps keep their headers and pixel data in one block that is laid out exactly like the file
+// Such bitmaps are stored with a single write and their file image can be handed out without copying it
+
 // The maximum pixel count used to prevent external DOS attacks through malformed DIB headers
 #define FLARE16X_BITMAP_MAX_PIXELS (1 << 24)
 
+// The maximum number of lines read at once when loading a region of a bitmap
+#define FLARE16X_BITMAP_REGION_LINES 64
+
 // Constants for the header magic and reserved fields
 #define FLARE16X_BITMAP_HEADER_MAGIC 0x4d42u
 #define FLARE16X_BITMAP_HEADER_RESERVED 0x0u
@@ -100,10 +106,19 @@ typedef struct {
     };
     // The size of the pixel data
     size_t pixels_size;
+    // If non-zero, the pixel data references an external buffer that is not freed along with the bitmap
+    uint8_t pixels_external;
+    // The single allocation holding the headers and pixel data in file layout or null if they are separate
+    void* block;
     // The aligned data width of one scanline
     uint16_t stride;
 } flare16x_bitmap;
 
+// Fills in the headers of a new 16-bit RGB565 bitmap without allocating the pixel data
+// This allows writing the pixel data to the file line by line after storing the headers
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_bitmap_describe16(uint16_t width, uint16_t height, flare16x_bitmap* bitmap);
+
 // Creates a new 16-bit RGB565 bitmap, allocates the required memory and fills in the values
 // Will overwrite any existing state and WILL leak memory if a previous state is re-used
 flare16x_error flare16x_bitmap_create16(uint16_t width, uint16_t height, flare16x_bitmap* bitmap);
@@ -116,13 +131,51 @@ flare16x_error flare16x_bitmap_create24(uint16_t width, uint16_t height, flare16
 // Will overwrite any existing state and WILL leak memory if a previous state is re-used
 flare16x_error flare16x_bitmap_create32(uint16_t width, uint16_t height, flare16x_bitmap* bitmap);
 
+// Attempts to load and validate the headers of a bitmap from file without reading the pixel data
+// Afterwards, the file is positioned at the start of the pixel data, which is stored in file line order
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_bitmap_load_header(FILE* bitmap_file, flare16x_bitmap* bitmap_struct);
+
 // Attempts to load a bitmap from file
 // Will overwrite any existing state and WILL leak memory if a previous state is re-used
 flare16x_error flare16x_bitmap_load(FILE* bitmap_file, flare16x_bitmap* bitmap_struct);
 
+// Reads a region of a bitmap from file straight into a new canvas without reading the rest of the pixel data
+// The bitmap has to hold the headers loaded by flare16x_bitmap_load_header and the file has to be seekable
+// Will overwrite any existing canvas state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_bitmap_read_region(flare16x_bitmap* bitmap, FILE* bitmap_file, uint16_t offset_x,
+        uint16_t offset_y, uint16_t width, uint16_t height, flare16x_canvas* canvas);
+
+// Attempts to load only a region of a bitmap from file into a new canvas
+// Only the headers and the lines covering the region are read, so the file has to be seekable
+// Will overwrite any existing canvas state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_bitmap_load_region(FILE* bitmap_file, uint16_t offset_x, uint16_t offset_y,
+        uint16_t width, uint16_t height, flare16x_canvas* canvas);
+
+// Attempts to parse a bitmap from a memory buffer
+// If alias is non-zero, the pixel data of top-down bitmaps references the buffer instead of being copied
+// In this case, the buffer has to outlive the bitmap and its pixels must not be modified
+// Bottom-up bitmaps are always copied, as their lines have to be reordered
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_bitmap_parse(const void* buffer, size_t size, uint8_t alias, flare16x_bitmap* bitmap_struct);
+
+// Provides the file image of a contiguous bitmap without copying it
+// The data stays owned by the bitmap and is only valid until the bitmap is destroyed
+flare16x_error flare16x_bitmap_data(flare16x_bitmap* bitmap_struct, const void** data, size_t* size);
+
+// Attempts to store the headers of a bitmap to file without writing the pixel data
+// Afterwards, exactly pixels_size bytes of top-down pixel data have to be written to complete the file
+flare16x_error flare16x_bitmap_store_header(flare16x_bitmap* bitmap_struct, FILE* bitmap_file);
+
 // Attempts to store a bitmap to file
 flare16x_error flare16x_bitmap_store(flare16x_bitmap* bitmap_struct, FILE* bitmap_file);
 
+// Attempts to serialize a bitmap into a memory buffer
+// The exact size of the serialized bitmap is always stored in size, even if the buffer is null or too small
+// This allows querying the size with a null buffer first and then serializing into a preallocated buffer
+flare16x_error flare16x_bitmap_serialize_into(flare16x_bitmap* bitmap_struct, void* buffer, size_t capacity,
+        size_t* size);
+
 // Destroys an existing bitmap context and frees the resources
 flare16x_error flare16x_bitmap_destroy(flare16x_bitmap* bitmap);
 
@@ -131,6 +184,11 @@ flare16x_error flare16x_bitmap_destroy(flare16x_bitmap* bitmap);
 flare16x_error flare16x_bitmap_edit(flare16x_bitmap* bitmap, uint16_t offset_x, uint16_t offset_y,
         uint16_t width, uint16_t height, flare16x_canvas* canvas);
 
+// Converts a region of a single raw scanline of the bitmap's format to RGB565 pixels
+// The scanline does not need to belong to the bitmap's pixel buffer, so streamed lines can be converted as well
+flare16x_error flare16x_bitmap_scanline(flare16x_bitmap* bitmap, const uint8_t* line, uint16_t offset_x,
+        uint16_t width, uint16_t* pixels);
+
 // Copies a region from a canvas buffer to a bitmap buffer
 flare16x_error flare16x_bitmap_merge(flare16x_canvas* canvas, uint16_t offset_x, uint16_t offset_y,
         flare16x_bitmap* bitmap);
@@ -61,16 +61,52 @@ flare16x_error flare16x_canvas_copy(flare16x_canvas* source_canvas, uint16_t off
     if (target_canvas->pixels == NULL)
         return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_CANVAS);
 
-    // Finally, copy the pixels
-    int x, y;
+    // Finally, copy the pixels line by line
+    int y;
     for (y = 0; y < height; y++)
-        for (x = 0; x < width; x++)
-            target_canvas->pixels[y * width + x] =
-                    source_canvas->pixels[(y + offset_y) * source_canvas->width + x + offset_x];
+        memcpy(&flare16x_canvas_raw(0, y, target_canvas), &flare16x_canvas_raw(offset_x, y + offset_y, source_canvas),
+               width * sizeof(uint16_t));
 
     return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_CANVAS);
 }
 
+// Clips a region that is copied between two canvases against the bounds of both canvases
+// Afterwards, the region only covers pixels that lie within both canvases and its offsets are non-negative
+// Returns zero, if no pixel of the region is left
+static int flare16x_canvas_clip(flare16x_canvas* source_canvas, flare16x_canvas* target_canvas,
+                                flare16x_canvas_rect* rect)
+{
+    // Determine the first and last column and line of the region that fall within both canvases
+    int min_x = 0, min_y = 0, max_x = rect->width, max_y = rect->height;
+    if (-rect->source_x > min_x)
+        min_x = -rect->source_x;
+    if (-rect->target_x > min_x)
+        min_x = -rect->target_x;
+    if (-rect->source_y > min_y)
+        min_y = -rect->source_y;
+    if (-rect->target_y > min_y)
+        min_y = -rect->target_y;
+    if (source_canvas->width - rect->source_x < max_x)
+        max_x = source_canvas->width - rect->source_x;
+    if (target_canvas->width - rect->target_x < max_x)
+        max_x = target_canvas->width - rect->target_x;
+    if (source_canvas->height - rect->source_y < max_y)
+        max_y = source_canvas->height - rect->source_y;
+    if (target_canvas->height - rect->target_y < max_y)
+        max_y = target_canvas->height - rect->target_y;
+    if (min_x >= max_x || min_y >= max_y)
+        return 0;
+
+    // Then, move the region accordingly
+    rect->source_x += min_x;
+    rect->source_y += min_y;
+    rect->target_x += min_x;
+    rect->target_y += min_y;
+    rect->width = max_x - min_x;
+    rect->height = max_y - min_y;
+    return 1;
+}
+
 // Copies a canvas region to an offset on another canvas
 flare16x_error flare16x_canvas_merge(flare16x_canvas* source_canvas,
                                      int16_t source_offset_x, int16_t source_offset_y,
@@ -86,16 +122,88 @@ flare16x_error flare16x_canvas_merge(flare16x_canvas* source_canvas,
     if (width == 0 || height == 0)
         return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_CANVAS);
 
-    // Now, copy the pixels, while making sure that the point is within source and target bounds
+    // Clip the region once, so that only the points within source and target bounds are copied
+    flare16x_canvas_rect rect = {source_offset_x, source_offset_y, target_offset_x, target_offset_y, width, height};
+    if (!flare16x_canvas_clip(source_canvas, target_canvas, &rect))
+        return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_CANVAS);
+
+    // Now, copy the pixels line by line
+    int y;
+    for (y = 0; y < rect.height; y++)
+        memmove(&flare16x_canvas_raw(rect.target_x, rect.target_y + y, target_canvas),
+                &flare16x_canvas_raw(rect.source_x, rect.source_y + y, source_canvas), rect.width * sizeof(uint16_t));
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_CANVAS);
+}
+
+// Copies a canvas region to an offset on another canvas, skipping all source pixels of the key color
+flare16x_error flare16x_canvas_merge_keyed(flare16x_canvas* source_canvas,
+                                           int16_t source_offset_x, int16_t source_offset_y,
+                                           int16_t target_offset_x, int16_t target_offset_y,
+                                           uint16_t width, uint16_t height, uint16_t key,
+                                           flare16x_canvas* target_canvas)
+{
+    // Make sure that neither canvas nor their pixels are null (this requires short circuiting to work)
+    if (source_canvas == NULL || source_canvas->pixels == NULL || target_canvas == NULL ||
+        target_canvas->pixels == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_CANVAS);
+
+    // Check, if the width and height are valid
+    if (width == 0 || height == 0)
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_CANVAS);
+
+    // Clip the region once, so that only the points within source and target bounds are copied
+    flare16x_canvas_rect rect = {source_offset_x, source_offset_y, target_offset_x, target_offset_y, width, height};
+    if (!flare16x_canvas_clip(source_canvas, target_canvas, &rect))
+        return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_CANVAS);
+
+    // Now, blend the pixels line by line
+    // The selection is written without branches, so that the compiler can vectorize the inner loop
     int x, y;
-    for (y = 0; y < height; y++)
-        for (x = 0; x < width; x++)
-            if (x + source_offset_x >= 0 && y + source_offset_y >= 0 &&
-                x + target_offset_x >= 0 && y + target_offset_y >= 0 &&
-                x + source_offset_x < source_canvas->width && y + source_offset_y < source_canvas->height &&
-                x + target_offset_x < target_canvas->width && y + target_offset_y < target_canvas->height)
-                target_canvas->pixels[(y + target_offset_y) * target_canvas->width + x + target_offset_x] =
-                        source_canvas->pixels[(y + source_offset_y) * source_canvas->width + x + source_offset_x];
+    for (y = 0; y < rect.height; y++)
+    {
+        const uint16_t* source = &flare16x_canvas_raw(rect.source_x, rect.source_y + y, source_canvas);
+        uint16_t* target = &flare16x_canvas_raw(rect.target_x, rect.target_y + y, target_canvas);
+        for (x = 0; x < rect.width; x++)
+            target[x] = source[x] == key ? target[x] : source[x];
+    }
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_CANVAS);
+}
+
+// Copies a canvas region to an offset on another canvas, but only where the mask holds the selected value
+// The mask has one byte per source pixel and the same dimensions as the source canvas
+flare16x_error flare16x_canvas_merge_masked(flare16x_canvas* source_canvas, const uint8_t* mask, uint8_t selected,
+                                            int16_t source_offset_x, int16_t source_offset_y,
+                                            int16_t target_offset_x, int16_t target_offset_y,
+                                            uint16_t width, uint16_t height, flare16x_canvas* target_canvas)
+{
+    // Make sure that neither canvas nor their pixels nor the mask are null (this requires short circuiting to work)
+    if (source_canvas == NULL || source_canvas->pixels == NULL || mask == NULL || target_canvas == NULL ||
+        target_canvas->pixels == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_CANVAS);
+
+    // Check, if the width and height are valid
+    if (width == 0 || height == 0)
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_CANVAS);
+
+    // Clip the region once, so that only the points within source and target bounds are copied
+    flare16x_canvas_rect rect = {source_offset_x, source_offset_y, target_offset_x, target_offset_y, width, height};
+    if (!flare16x_canvas_clip(source_canvas, target_canvas, &rect))
+        return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_CANVAS);
+
+    // Now, blend the pixels line by line
+    // The selection is written without branches, so that the compiler can vectorize the inner loop
+    int x, y;
+    for (y = 0; y < rect.height; y++)
+    {
+        size_t offset = (size_t)(rect.source_y + y) * source_canvas->width + rect.source_x;
+        const uint16_t* source = source_canvas->pixels + offset;
+        const uint8_t* selection = mask + offset;
+        uint16_t* target = &flare16x_canvas_raw(rect.target_x, rect.target_y + y, target_canvas);
+        for (x = 0; x < rect.width; x++)
+            target[x] = selection[x] == selected ? source[x] : target[x];
+    }
 
     return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_CANVAS);
 }
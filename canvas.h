@@ -23,6 +23,22 @@ typedef struct {
     uint16_t* pixels;
 } flare16x_canvas;
 
+// A region that is copied from one canvas to another, which may exceed the bounds of either canvas
+typedef struct {
+    // The horizontal offset of the region on the source canvas
+    int source_x;
+    // The vertical offset of the region on the source canvas
+    int source_y;
+    // The horizontal offset of the region on the target canvas
+    int target_x;
+    // The vertical offset of the region on the target canvas
+    int target_y;
+    // The width of the region
+    int width;
+    // The height of the region
+    int height;
+} flare16x_canvas_rect;
+
 // Define a canvas color by its RGB565 component value
 #define flare16x_canvas_rgb(r,g,b) ((uint16_t)((((r) & 0x1f) << 11) | (((g) & 0x3f) << 5) | ((b) & 0x1f)))
 // Define a canvas color by its RGB888 component value
@@ -45,6 +61,20 @@ flare16x_error flare16x_canvas_merge(flare16x_canvas* source_canvas,
                                         int16_t target_offset_x, int16_t target_offset_y,
                                         uint16_t width, uint16_t height, flare16x_canvas* target_canvas);
 
+// Copies a canvas region to an offset on another canvas, skipping all source pixels of the key color
+flare16x_error flare16x_canvas_merge_keyed(flare16x_canvas* source_canvas,
+                                           int16_t source_offset_x, int16_t source_offset_y,
+                                           int16_t target_offset_x, int16_t target_offset_y,
+                                           uint16_t width, uint16_t height, uint16_t key,
+                                           flare16x_canvas* target_canvas);
+
+// Copies a canvas region to an offset on another canvas, but only where the mask holds the selected value
+// The mask has one byte per source pixel and the same dimensions as the source canvas
+flare16x_error flare16x_canvas_merge_masked(flare16x_canvas* source_canvas, const uint8_t* mask, uint8_t selected,
+                                            int16_t source_offset_x, int16_t source_offset_y,
+                                            int16_t target_offset_x, int16_t target_offset_y,
+                                            uint16_t width, uint16_t height, flare16x_canvas* target_canvas);
+
 // Destroys the canvas and frees its resources
 flare16x_error flare16x_canvas_destroy(flare16x_canvas* canvas);
 
@@ -0,0 +1,510 @@
+//
+// flare16x core
+// Developed 2019 by Benedikt Muessig <github@bmuessig.eu>
+// Licensed under GPLv3
+//
+// codec.c: Functions for the lossless palette-indexed screenshot codec
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "error.h"
+#include "bitmap.h"
+#include "palettes.h"
+
+#include "codec.h"
+
+// The number of run length bits in a control byte
+#define FLARE16X_CODEC_LENGTH_BITS 6
+// The run length value that indicates an appended variable length integer
+#define FLARE16X_CODEC_LENGTH_EXTENDED ((1u << FLARE16X_CODEC_LENGTH_BITS) - 1)
+// The minimum length of a left or above run that ends a literal token
+#define FLARE16X_CODEC_MIN_RUN 2
+// The minimum length of a left or above run that ends a delta token
+#define FLARE16X_CODEC_MIN_DELTA_RUN 4
+// The minimum length of a delta token that ends a literal token
+#define FLARE16X_CODEC_MIN_DELTA 4
+
+// The CRC-32 (IEEE 802.3, reflected) of every nibble value
+static const uint32_t flare16x_codec_crc_table[16] = {
+    0x00000000u, 0x1db71064u, 0x3b6e20c8u, 0x26d930acu, 0x76dc4190u, 0x6b6b51f4u, 0x4db26158u, 0x5005713cu,
+    0xedb88320u, 0xf00f9344u, 0xd6d6a3e8u, 0xcb61b38cu, 0x9b64c2b0u, 0x86d3d2d4u, 0xa00ae278u, 0xbdbdf21cu
+};
+
+// Calculates the CRC-32 of a buffer
+static uint32_t flare16x_codec_crc(const uint8_t* data, size_t size)
+{
+    uint32_t crc = 0xffffffffu;
+    size_t index;
+    for (index = 0; index < size; index++)
+    {
+        crc ^= data[index];
+        crc = (crc >> 4) ^ flare16x_codec_crc_table[crc & 0xf];
+        crc = (crc >> 4) ^ flare16x_codec_crc_table[crc & 0xf];
+    }
+    return ~crc;
+}
+
+// Checks, whether a bitmap file can be indexed and fills in the layout of its pixels
+static int flare16x_codec_layout(const uint8_t* bytes, size_t size, flare16x_codec_header* header)
+{
+    flare16x_bitmap_header file_header;
+    flare16x_bitmap_dib dib;
+
+    // The headers have to be present
+    if (size < sizeof(flare16x_bitmap_header) + sizeof(flare16x_bitmap_dib) || size > UINT32_MAX)
+        return 0;
+    memcpy(&file_header, bytes, sizeof(flare16x_bitmap_header));
+    memcpy(&dib, bytes + sizeof(flare16x_bitmap_header), sizeof(flare16x_bitmap_dib));
+
+    // Only uncompressed 16-bit bitmaps without line padding are indexed
+    uint32_t height = dib.height < 0 ? -(uint32_t)dib.height : (uint32_t)dib.height;
+    if (file_header.magic != FLARE16X_BITMAP_HEADER_MAGIC || dib.bit_count != 16 ||
+        (dib.compression != FLARE16X_BITMAP_COMPRESSION_RGB &&
+         dib.compression != FLARE16X_BITMAP_COMPRESSION_BITFIELDS) ||
+        dib.width < 1 || dib.width > UINT16_MAX || dib.width % 2 != 0 || height < 1 || height > UINT16_MAX ||
+        (uint64_t)dib.width * height > FLARE16X_BITMAP_MAX_PIXELS)
+        return 0;
+
+    // And the pixels have to lie within the file
+    uint64_t pixels_size = (uint64_t)dib.width * height * sizeof(uint16_t);
+    if (file_header.payload_offset > size || pixels_size > size - file_header.payload_offset)
+        return 0;
+
+    header->width = (uint16_t)dib.width;
+    header->height = (uint16_t)height;
+    header->prefix_size = file_header.payload_offset;
+    header->suffix_size = (uint32_t)(size - file_header.payload_offset - pixels_size);
+    return 1;
+}
+
+// Returns the length of the run of indices starting at the position that repeat the previous index
+static size_t flare16x_codec_run_left(const uint8_t* indices, size_t position, size_t count, size_t limit)
+{
+    uint8_t previous = position > 0 ? indices[position - 1] : 0;
+    size_t end = position;
+    while (end < count && end - position < limit && indices[end] == previous)
+        end++;
+    return end - position;
+}
+
+// Returns the length of the run of indices starting at the position that repeat the indices of the previous line
+static size_t flare16x_codec_run_above(const uint8_t* indices, size_t position, size_t count, size_t width,
+        size_t limit)
+{
+    size_t end = position;
+    if (position < width)
+        return 0;
+    while (end < count && end - position < limit && indices[end] == indices[end - width])
+        end++;
+    return end - position;
+}
+
+// Returns the length of the run of indices starting at the position that differ from the previous line by a nibble
+static size_t flare16x_codec_run_delta(const uint8_t* indices, size_t position, size_t count, size_t width,
+        size_t limit)
+{
+    size_t end = position;
+    if (position < width)
+        return 0;
+    while (end < count && end - position < limit && (uint8_t)(indices[end] - indices[end - width] + 8) < 16)
+        end++;
+    return end - position;
+}
+
+// Returns non-zero, if a left or above run of at least the given length starts at the position
+static int flare16x_codec_run_starts(const uint8_t* indices, size_t position, size_t count, size_t width,
+        size_t length)
+{
+    return flare16x_codec_run_left(indices, position, count, length) >= length ||
+           flare16x_codec_run_above(indices, position, count, width, length) >= length;
+}
+
+// Writes the control byte and the extended length of a token
+static uint8_t* flare16x_codec_token(uint8_t* output, uint8_t type, size_t length)
+{
+    size_t extra = length - 1;
+    if (extra < FLARE16X_CODEC_LENGTH_EXTENDED)
+    {
+        *output++ = (uint8_t)((type << FLARE16X_CODEC_LENGTH_BITS) | extra);
+        return output;
+    }
+
+    *output++ = (uint8_t)((type << FLARE16X_CODEC_LENGTH_BITS) | FLARE16X_CODEC_LENGTH_EXTENDED);
+    extra -= FLARE16X_CODEC_LENGTH_EXTENDED;
+    while (extra >= 0x80)
+    {
+        *output++ = (uint8_t)(extra | 0x80);
+        extra >>= 7;
+    }
+    *output++ = (uint8_t)extra;
+    return output;
+}
+
+// Returns the maximum size of the tokens of a plane with the given number of pixels
+size_t flare16x_codec_tokens_bound(size_t count)
+{
+    return count * 2 + 16;
+}
+
+// Codes a plane of indices with the given line width as tokens and returns the size of the tokens
+// The output has to hold at least flare16x_codec_tokens_bound bytes
+size_t flare16x_codec_tokens_encode(const uint8_t* indices, size_t count, size_t width, uint8_t* output)
+{
+    uint8_t* start = output;
+    size_t position = 0;
+    while (position < count)
+    {
+        // Prefer the longer one of the left and above runs, unless it is short and a long delta run starts here
+        size_t left = flare16x_codec_run_left(indices, position, count, SIZE_MAX);
+        size_t above = flare16x_codec_run_above(indices, position, count, width, SIZE_MAX);
+        size_t run = above > left ? above : left;
+        size_t end = position;
+        if (run < FLARE16X_CODEC_MIN_DELTA_RUN)
+        {
+            // Find the end of the run of small differences to the previous line, which ends once a long run starts
+            while (end < count && flare16x_codec_run_delta(indices, end, count, width, 1) > 0 &&
+                   (end == position ||
+                    !flare16x_codec_run_starts(indices, end, count, width, FLARE16X_CODEC_MIN_DELTA_RUN)))
+                end++;
+        }
+        if (run >= FLARE16X_CODEC_MIN_RUN && (run >= FLARE16X_CODEC_MIN_DELTA_RUN ||
+            end - position < FLARE16X_CODEC_MIN_DELTA))
+        {
+            output = flare16x_codec_token(output, above > left ? FLARE16X_CODEC_TOKEN_ABOVE :
+                    FLARE16X_CODEC_TOKEN_LEFT, run);
+            position += run;
+            continue;
+        }
+
+        // Then, code the run of small differences
+        if (end - position >= FLARE16X_CODEC_MIN_DELTA)
+        {
+            output = flare16x_codec_token(output, FLARE16X_CODEC_TOKEN_DELTA, end - position);
+            size_t index;
+            for (index = position; index < end; index += 2)
+            {
+                uint8_t low = (uint8_t)(indices[index] - indices[index - width]) & 0xf;
+                uint8_t high = index + 1 < end ? (uint8_t)(indices[index + 1] - indices[index + 1 - width]) & 0xf : 0;
+                *output++ = (uint8_t)(low | (high << 4));
+            }
+            position = end;
+            continue;
+        }
+
+        // Otherwise, store the indices as they are until a run starts
+        end = position + 1;
+        while (end < count && !flare16x_codec_run_starts(indices, end, count, width, FLARE16X_CODEC_MIN_RUN) &&
+               flare16x_codec_run_delta(indices, end, count, width, FLARE16X_CODEC_MIN_DELTA) < FLARE16X_CODEC_MIN_DELTA)
+            end++;
+        output = flare16x_codec_token(output, FLARE16X_CODEC_TOKEN_LITERAL, end - position);
+        memcpy(output, indices + position, end - position);
+        output += end - position;
+        position = end;
+    }
+
+    return (size_t)(output - start);
+}
+
+// Compresses the image of a bitmap file held in memory and writes the archive to a file
+flare16x_error flare16x_codec_encode(const void* buffer, size_t size, FILE* file)
+{
+    // Make sure that there are no null pointers
+    if (buffer == NULL || file == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_CODEC);
+
+    // The size is stored in 32 bits
+    if (size > UINT32_MAX)
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_CODEC);
+
+    // Fill in the common header fields
+    const uint8_t* bytes = buffer;
+    flare16x_codec_header header;
+    memset(&header, 0, sizeof(header));
+    header.magic = FLARE16X_CODEC_MAGIC;
+    header.version = FLARE16X_CODEC_VERSION;
+    header.size = (uint32_t)size;
+    header.checksum = flare16x_codec_crc(bytes, size);
+
+    // Store files that cannot be indexed as they are
+    if (!flare16x_codec_layout(bytes, size, &header))
+    {
+        header.method = FLARE16X_CODEC_METHOD_STORED;
+        if (fwrite(&header, sizeof(header), 1, file) != 1 || (size > 0 && fwrite(buffer, size, 1, file) != 1))
+            return flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_CODEC);
+        return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_CODEC);
+    }
+    header.method = FLARE16X_CODEC_METHOD_INDEXED;
+
+    // Allocate the color lookup, the index plane and the archive, which is large enough for the worst case
+    size_t count = (size_t)header.width * header.height, pixel;
+    size_t capacity = sizeof(header) + header.prefix_size + header.suffix_size + FLARE16X_CODEC_TABLE_SIZE * 2 +
+            count * 2 + flare16x_codec_tokens_bound(count);
+    uint8_t* lookup = malloc(0x10000);
+    uint8_t* indices = malloc(count);
+    uint8_t* archive = malloc(capacity);
+    if (lookup == NULL || indices == NULL || archive == NULL)
+    {
+        free(lookup);
+        free(indices);
+        free(archive);
+        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_CODEC);
+    }
+    const uint8_t* pixels = bytes + header.prefix_size;
+
+    // Mark all colors used by the image
+    memset(lookup, 0, 0x10000);
+    for (pixel = 0; pixel < count; pixel++)
+        lookup[pixels[pixel * 2] | (pixels[pixel * 2 + 1] << 8)] = 1;
+
+    // Select the palette that shares the most colors with the image
+    uint8_t palette;
+    int palette_matches = 0;
+    header.palette = FLARE16X_PALETTES_UNKNOWN;
+    for (palette = FLARE16X_PALETTES_MIN; palette <= FLARE16X_PALETTES_MAX; palette++)
+    {
+        const flare16x_palette_entry* entries = flare16x_palettes_get(palette);
+        int length = flare16x_palettes_get_length(palette), entry, matches = 0;
+        for (entry = 0; entry < length; entry++)
+            matches += lookup[entries[entry].color];
+        if (matches > palette_matches)
+        {
+            palette_matches = matches;
+            header.palette = palette;
+        }
+    }
+
+    // Start the color table with the palette, where duplicate colors map to their first index
+    memset(lookup, FLARE16X_CODEC_ESCAPE, 0x10000);
+    int table_size = flare16x_palettes_get_length(header.palette), entry;
+    const flare16x_palette_entry* entries = flare16x_palettes_get(header.palette);
+    for (entry = table_size - 1; entry >= 0; entry--)
+        lookup[entries[entry].color] = (uint8_t)entry;
+
+    // Then, index the pixels while adding new colors to the table and escaping the colors that do not fit
+    uint8_t* extras = archive + sizeof(header) + header.prefix_size + header.suffix_size;
+    uint8_t* escapes = extras + FLARE16X_CODEC_TABLE_SIZE * 2;
+    for (pixel = 0; pixel < count; pixel++)
+    {
+        uint16_t color = (uint16_t)(pixels[pixel * 2] | (pixels[pixel * 2 + 1] << 8));
+        uint8_t index = lookup[color];
+        if (index == FLARE16X_CODEC_ESCAPE && table_size < (int)FLARE16X_CODEC_TABLE_SIZE)
+        {
+            index = (uint8_t)table_size++;
+            lookup[color] = index;
+            extras[header.extra_count * 2] = (uint8_t)(color & 0xff);
+            extras[header.extra_count * 2 + 1] = (uint8_t)(color >> 8);
+            header.extra_count++;
+        }
+        else if (index == FLARE16X_CODEC_ESCAPE)
+        {
+            escapes[header.escape_count * 2] = (uint8_t)(color & 0xff);
+            escapes[header.escape_count * 2 + 1] = (uint8_t)(color >> 8);
+            header.escape_count++;
+        }
+        indices[pixel] = index;
+    }
+    free(lookup);
+
+    // Close the gap between the extra and escaped colors
+    memmove(extras + header.extra_count * 2, escapes, header.escape_count * 2);
+    uint8_t* tokens = extras + header.extra_count * 2 + header.escape_count * 2;
+
+    // Code the index plane
+    header.tokens_size = (uint32_t)flare16x_codec_tokens_encode(indices, count, header.width, tokens);
+    uint8_t* end = tokens + header.tokens_size;
+    free(indices);
+
+    // Finally, assemble the archive and write it at once
+    memcpy(archive, &header, sizeof(header));
+    memcpy(archive + sizeof(header), bytes, header.prefix_size);
+    memcpy(archive + sizeof(header) + header.prefix_size, pixels + count * 2, header.suffix_size);
+    size_t archive_size = (size_t)(end - archive);
+    size_t written = fwrite(archive, archive_size, 1, file);
+    free(archive);
+    if (written != 1)
+        return flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_CODEC);
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_CODEC);
+}
+
+// Decodes tokens into a plane of indices with the given line width
+// All tokens have to be used to exactly fill the plane
+flare16x_error flare16x_codec_tokens_decode(const uint8_t* tokens, size_t tokens_size, uint8_t* indices,
+        size_t count, size_t width)
+{
+    const uint8_t* tokens_end = tokens + tokens_size;
+    size_t position = 0;
+    while (position < count)
+    {
+        // Read the control byte and the extended length
+        if (tokens >= tokens_end)
+            return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_CODEC);
+        uint8_t type = *tokens >> FLARE16X_CODEC_LENGTH_BITS;
+        size_t length = (*tokens++ & FLARE16X_CODEC_LENGTH_EXTENDED) + 1;
+        if (length == FLARE16X_CODEC_LENGTH_EXTENDED + 1)
+        {
+            unsigned shift;
+            for (shift = 0; ; shift += 7)
+            {
+                if (tokens >= tokens_end || shift > 28)
+                    return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_CODEC);
+                length += (size_t)(*tokens & 0x7f) << shift;
+                if (!(*tokens++ & 0x80))
+                    break;
+            }
+        }
+
+        // The run has to fit into the plane
+        if (length > count - position)
+            return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_CODEC);
+
+        // Most runs are short, so they are copied without calling memcpy or memset
+        uint8_t* target = indices + position;
+        uint8_t previous;
+        size_t index;
+        switch (type)
+        {
+            case FLARE16X_CODEC_TOKEN_LITERAL:
+                if (length > (size_t)(tokens_end - tokens))
+                    return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_CODEC);
+                for (index = 0; index < length; index++)
+                    target[index] = tokens[index];
+                tokens += length;
+                break;
+
+            case FLARE16X_CODEC_TOKEN_LEFT:
+                previous = position > 0 ? target[-1] : 0;
+                for (index = 0; index < length; index++)
+                    target[index] = previous;
+                break;
+
+            case FLARE16X_CODEC_TOKEN_ABOVE:
+                if (position < width)
+                    return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_CODEC);
+                for (index = 0; index < length; index++)
+                    target[index] = target[index - width];
+                break;
+
+            case FLARE16X_CODEC_TOKEN_DELTA:
+                if (position < width || (length + 1) / 2 > (size_t)(tokens_end - tokens))
+                    return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_CODEC);
+                for (index = 0; index + 1 < length; index += 2, tokens++)
+                {
+                    target[index] = (uint8_t)(target[index - width] + ((*tokens & 0xf) ^ 8) - 8);
+                    target[index + 1] = (uint8_t)(target[index + 1 - width] + ((*tokens >> 4) ^ 8) - 8);
+                }
+                if (index < length)
+                    target[index] = (uint8_t)(target[index - width] + ((*tokens++ & 0xf) ^ 8) - 8);
+                break;
+        }
+        position += length;
+    }
+
+    // All tokens have to be used
+    if (tokens != tokens_end)
+        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_CODEC);
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_CODEC);
+}
+
+// Decompresses an archive held in memory into a buffer
+// The exact size of the decoded file is always stored in size, even if the buffer is null or too small
+// This allows querying the size with a null buffer first and then decoding into a preallocated buffer
+flare16x_error flare16x_codec_decode(const void* archive, size_t archive_size, void* buffer, size_t capacity,
+        size_t* size)
+{
+    // Make sure that there are no null pointers
+    if (archive == NULL || size == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_CODEC);
+
+    // Validate the header
+    flare16x_codec_header header;
+    if (archive_size < sizeof(header))
+        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_CODEC);
+    memcpy(&header, archive, sizeof(header));
+    if (header.magic != FLARE16X_CODEC_MAGIC || header.version != FLARE16X_CODEC_VERSION ||
+        header.method > FLARE16X_CODEC_METHOD_INDEXED || header.palette > FLARE16X_PALETTES_MAX)
+        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_CODEC);
+
+    // Validate the layout
+    const uint8_t* data = (const uint8_t*)archive + sizeof(header);
+    size_t count = (size_t)header.width * header.height;
+    int palette_size = flare16x_palettes_get_length(header.palette);
+    if (header.method == FLARE16X_CODEC_METHOD_STORED ?
+        (uint64_t)header.size != archive_size - sizeof(header) :
+        (uint64_t)header.prefix_size + count * 2 + header.suffix_size != header.size ||
+        palette_size + header.extra_count > (int)FLARE16X_CODEC_TABLE_SIZE || header.escape_count > count ||
+        (uint64_t)header.prefix_size + header.suffix_size + header.extra_count * 2 + (uint64_t)header.escape_count * 2 +
+        header.tokens_size != archive_size - sizeof(header))
+        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_CODEC);
+
+    // Make sure the output fits into the buffer
+    *size = header.size;
+    if (buffer == NULL || capacity < *size)
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_CODEC);
+
+    // Stored files are simply copied
+    uint8_t* output = buffer;
+    if (header.method == FLARE16X_CODEC_METHOD_STORED)
+    {
+        memcpy(output, data, header.size);
+        if (flare16x_codec_crc(output, header.size) != header.checksum)
+            return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_CODEC);
+        return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_CODEC);
+    }
+
+    // Copy the verbatim parts
+    const uint8_t* extras = data + header.prefix_size + header.suffix_size;
+    const uint8_t* escapes = extras + header.extra_count * 2;
+    const uint8_t* tokens = escapes + (size_t)header.escape_count * 2;
+    uint8_t* pixels = output + header.prefix_size;
+    memcpy(output, data, header.prefix_size);
+    memcpy(pixels + count * 2, data + header.prefix_size, header.suffix_size);
+
+    // Assemble the color table
+    uint16_t table[FLARE16X_CODEC_TABLE_SIZE + 1] = {0};
+    const flare16x_palette_entry* entries = flare16x_palettes_get(header.palette);
+    int entry;
+    for (entry = 0; entry < palette_size; entry++)
+        table[entry] = entries[entry].color;
+    for (entry = 0; entry < header.extra_count; entry++)
+        table[palette_size + entry] = (uint16_t)(extras[entry * 2] | (extras[entry * 2 + 1] << 8));
+    int table_size = palette_size + header.extra_count;
+
+    // Decode the index plane into the upper half of the pixels, which is overwritten from the start only afterwards
+    uint8_t* indices = pixels + count;
+    flare16x_error error = flare16x_codec_tokens_decode(tokens, header.tokens_size, indices, count, header.width);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return error;
+
+    // Then, expand the indices into colors, which never overtakes the indices that are still to be read
+    size_t pixel, escape = 0;
+    for (pixel = 0; pixel < count; pixel++)
+    {
+        uint8_t index = indices[pixel];
+        uint16_t color = table[index];
+        if (index >= (unsigned)table_size)
+        {
+            if (index != FLARE16X_CODEC_ESCAPE || escape >= header.escape_count)
+                return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_CODEC);
+            color = (uint16_t)(escapes[escape * 2] | (escapes[escape * 2 + 1] << 8));
+            escape++;
+        }
+        pixels[pixel * 2] = (uint8_t)(color & 0xff);
+        pixels[pixel * 2 + 1] = (uint8_t)(color >> 8);
+    }
+
+    // All escaped colors have to be used
+    if (escape != header.escape_count)
+        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_CODEC);
+
+    // Finally, the decoded file has to match its checksum
+    if (flare16x_codec_crc(output, header.size) != header.checksum)
+        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_CODEC);
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_CODEC);
+}
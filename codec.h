@@ -0,0 +1,109 @@
+//
+// flare16x core
+// Developed 2019 by Benedikt Muessig <github@bmuessig.eu>
+// Licensed under GPLv3
+//
+// codec.h: Header file for the lossless palette-indexed screenshot codec
+//
+
+#ifndef FLARE16X_CODEC_H
+#define FLARE16X_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "error.h"
+
+/*
+ * The codec compresses 16-bit screenshots losslessly by exploiting that almost all of their pixels use the colors of
+ * one of the known palettes. Every pixel is mapped to an 8-bit index into a color table, which starts with the colors
+ * of the best matching palette followed by the other colors in the order they appear. Colors that do not fit into the
+ * table are escaped and stored separately.
+ * The index plane is then coded as a sequence of tokens, each starting with a control byte:
+ * The upper two bits select the token type and the lower six bits hold the run length minus one. If all six bits are
+ * set, the remaining length is appended as a variable length integer (seven bits per byte, low bits first).
+ * Runs may extend across line boundaries, as the lines are coded back to back in file order.
+ * All other parts of the file, such as the headers, are kept verbatim, so the decoded file is bit-exact.
+ * A CRC-32 of the decoded file is stored in the header, so that corrupted archives are detected while decoding.
+ * Files that are not uncompressed 16-bit bitmaps without line padding are stored as they are.
+ */
+
+// The magic number of the archive header ("F16Z")
+#define FLARE16X_CODEC_MAGIC 0x5a363146u
+// The current version of the archive format
+#define FLARE16X_CODEC_VERSION 2
+// The index used to mark escaped colors
+#define FLARE16X_CODEC_ESCAPE 0xffu
+// The maximum number of colors in the color table
+#define FLARE16X_CODEC_TABLE_SIZE FLARE16X_CODEC_ESCAPE
+
+// Archive method enum
+enum {
+    // The file is stored as it is
+    FLARE16X_CODEC_METHOD_STORED,
+    // The pixels are palette-indexed and coded as tokens
+    FLARE16X_CODEC_METHOD_INDEXED
+};
+
+// Token type enum
+enum {
+    // Followed by the given number of indices
+    FLARE16X_CODEC_TOKEN_LITERAL,
+    // Repeats the previous index (or index zero at the very start)
+    FLARE16X_CODEC_TOKEN_LEFT,
+    // Copies the indices of the previous line
+    FLARE16X_CODEC_TOKEN_ABOVE,
+    // Followed by the differences to the indices of the previous line, as signed nibbles with the low nibble first
+    FLARE16X_CODEC_TOKEN_DELTA
+};
+
+// Make sure the archive header is laid out exactly like the file
+#pragma pack(push, 1)
+
+// The archive header struct
+typedef struct {
+    uint32_t magic; // must be FLARE16X_CODEC_MAGIC
+    uint8_t version; // must be FLARE16X_CODEC_VERSION
+    uint8_t method; // the method as defined in FLARE16X_CODEC_METHOD_*
+    uint8_t palette; // the palette that starts the color table as defined in FLARE16X_PALETTES_*
+    uint8_t extra_count; // the number of colors in the color table following the palette colors
+    uint32_t size; // the size of the decoded file
+    uint32_t prefix_size; // the size of the verbatim data before the pixels
+    uint32_t suffix_size; // the size of the verbatim data after the pixels
+    uint16_t width; // the width of the index plane
+    uint16_t height; // the height of the index plane
+    uint32_t escape_count; // the number of escaped colors
+    uint32_t tokens_size; // the size of the tokens in bytes
+    uint32_t checksum; // the CRC-32 of the decoded file
+} flare16x_codec_header;
+
+// Restore regular 32 or 64 bit struct boundaries
+#pragma pack(pop)
+
+// The archive header is followed by the prefix, the suffix, the extra colors, the escaped colors and the tokens
+// With the stored method, the header is only followed by the file
+
+// Compresses the image of a bitmap file held in memory and writes the archive to a file
+flare16x_error flare16x_codec_encode(const void* buffer, size_t size, FILE* file);
+
+// Decompresses an archive held in memory into a buffer
+// The exact size of the decoded file is always stored in size, even if the buffer is null or too small
+// This allows querying the size with a null buffer first and then decoding into a preallocated buffer
+// Fails with a format error, if the archive is malformed or the decoded file does not match its checksum
+flare16x_error flare16x_codec_decode(const void* archive, size_t archive_size, void* buffer, size_t capacity,
+        size_t* size);
+
+// Returns the maximum size of the tokens of a plane with the given number of pixels
+size_t flare16x_codec_tokens_bound(size_t count);
+
+// Codes a plane of indices with the given line width as tokens and returns the size of the tokens
+// The output has to hold at least flare16x_codec_tokens_bound bytes
+size_t flare16x_codec_tokens_encode(const uint8_t* indices, size_t count, size_t width, uint8_t* output);
+
+// Decodes tokens into a plane of indices with the given line width
+// All tokens have to be used to exactly fill the plane
+flare16x_error flare16x_codec_tokens_decode(const uint8_t* tokens, size_t tokens_size, uint8_t* indices,
+        size_t count, size_t width);
+
+#endif //FLARE16X_CODEC_H
@@ -0,0 +1,471 @@
+//
+// flare16x core
+// Developed 2019 by Benedikt Muessig <github@bmuessig.eu>
+// Licensed under GPLv3
+//
+// container.c: Functions for writing and reading the multi-frame thermal container
+//
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define FLARE16X_CONTAINER_MMAP 1
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "error.h"
+#include "thermal.h"
+
+#include "container.h"
+
+// The padding bytes written after blocks that are not aligned
+static const uint8_t flare16x_container_padding[FLARE16X_CONTAINER_ALIGNMENT] = {0};
+
+// Continues a 64-bit FNV-1a hash over a block of data
+uint64_t flare16x_container_hash(const void* data, size_t size, uint64_t hash)
+{
+    const uint8_t* bytes = data;
+    size_t index;
+    for (index = 0; index < size; index++)
+    {
+        hash ^= bytes[index];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// Hashes the entire content of a file starting at its beginning
+// Afterwards, the file is positioned at its beginning again
+flare16x_error flare16x_container_hash_file(FILE* file, uint64_t* hash)
+{
+    // Make sure that there are no null pointers
+    if (file == NULL || hash == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_CONTAINER);
+
+    // Read the file in blocks and hash them
+    uint8_t block[4096];
+    size_t size;
+    *hash = FLARE16X_CONTAINER_HASH_SEED;
+    if (fseek(file, 0, SEEK_SET) != 0)
+        return flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_CONTAINER);
+    while ((size = fread(block, 1, sizeof(block), file)) > 0)
+        *hash = flare16x_container_hash(block, size, *hash);
+
+    // Rewind the file again
+    if (ferror(file) || fseek(file, 0, SEEK_SET) != 0)
+        return flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_CONTAINER);
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_CONTAINER);
+}
+
+// Writes a block to the container and pads it to the alignment
+static flare16x_error flare16x_container_write(flare16x_container_writer* writer, const void* data, size_t size)
+{
+    size_t padding = flare16x_container_align(size) - size;
+    if ((size > 0 && fwrite(data, size, 1, writer->file) != 1) ||
+        (padding > 0 && fwrite(flare16x_container_padding, padding, 1, writer->file) != 1))
+        return flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_CONTAINER);
+
+    writer->offset += size + padding;
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_CONTAINER);
+}
+
+// Starts a new container by writing the file header to the file
+// The file has to stay open until the container is finished
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_container_create(FILE* file, flare16x_container_writer* writer)
+{
+    // Make sure that there are no null pointers
+    if (file == NULL || writer == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_CONTAINER);
+
+    // Clear the writer
+    memset(writer, 0, sizeof(flare16x_container_writer));
+    writer->file = file;
+
+    // Fill in and write the file header
+    flare16x_container_header header;
+    memset(&header, 0, sizeof(header));
+    header.magic = FLARE16X_CONTAINER_MAGIC;
+    header.version = FLARE16X_CONTAINER_VERSION;
+    header.header_size = sizeof(flare16x_container_header);
+    return flare16x_container_write(writer, &header, sizeof(header));
+}
+
+// Appends the processed thermal image of a thermal context as a new frame
+// The name and hash identify the source file, which allows finding the frame later on
+flare16x_error flare16x_container_append(flare16x_container_writer* writer, const char* name, uint64_t hash,
+        flare16x_thermal* thermal)
+{
+    // Make sure that there are no null pointers
+    if (writer == NULL || writer->file == NULL || name == NULL || thermal == NULL || thermal->thermal_image == NULL ||
+        thermal->thermal_image->points == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_CONTAINER);
+
+    // Validate the name and the mask dimensions
+    flare16x_thermal_image* image = thermal->thermal_image;
+    size_t name_length = strlen(name);
+    if (name_length > UINT16_MAX || (thermal->mask.pixels != NULL &&
+        (thermal->mask.width != image->width || thermal->mask.height != image->height)))
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_CONTAINER);
+
+    // Grow the index and the names, if required
+    if (writer->count >= writer->capacity)
+    {
+        uint32_t capacity = writer->capacity ? writer->capacity * 2 : 64;
+        flare16x_container_entry* entries = realloc(writer->entries, capacity * sizeof(flare16x_container_entry));
+        if (entries == NULL)
+            return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_CONTAINER);
+        writer->entries = entries;
+        writer->capacity = capacity;
+    }
+    if (writer->names_size + name_length + 1 > writer->names_capacity)
+    {
+        uint32_t capacity = writer->names_capacity ? writer->names_capacity : 1024;
+        while (writer->names_size + name_length + 1 > capacity)
+            capacity *= 2;
+        char* names = realloc(writer->names, capacity);
+        if (names == NULL)
+            return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_CONTAINER);
+        writer->names = names;
+        writer->names_capacity = capacity;
+    }
+
+    // Fill in the frame header
+    flare16x_container_frame_header header;
+    memset(&header, 0, sizeof(header));
+    header.width = image->width;
+    header.height = image->height;
+    header.mode = image->mode;
+    header.device_model = thermal->device_model;
+    header.palette = thermal->palette;
+    header.emissivity = thermal->emissivity;
+    header.temperature_spot = thermal->temperature_spot;
+    header.spot_x = thermal->spot_x;
+    header.spot_y = thermal->spot_y;
+    header.spot_width = thermal->spot_width;
+    header.spot_height = thermal->spot_height;
+    header.plane_size = (uint32_t)image->width * image->height;
+    header.plane_stride = flare16x_container_align(header.plane_size);
+
+    // Split the thermal points into the value and uncertainty planes
+    uint8_t* planes = calloc(2, header.plane_size);
+    if (planes == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_CONTAINER);
+    uint32_t point;
+    for (point = 0; point < header.plane_size; point++)
+    {
+        planes[point] = image->points[point].value;
+        planes[header.plane_size + point] = image->points[point].uncertainty;
+    }
+
+    // Write the frame header and the planes, where a missing mask is stored as zeros
+    uint64_t offset = writer->offset;
+    flare16x_error error = flare16x_container_write(writer, &header, sizeof(header));
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_container_write(writer, planes, header.plane_size);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_container_write(writer, planes + header.plane_size, header.plane_size);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE && thermal->mask.pixels == NULL)
+        memset(planes, 0, header.plane_size);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_container_write(writer, thermal->mask.pixels != NULL ? thermal->mask.pixels : planes,
+                header.plane_size);
+    free(planes);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return error;
+
+    // Finally, add the index entry and the name
+    flare16x_container_entry* entry = &writer->entries[writer->count++];
+    memset(entry, 0, sizeof(flare16x_container_entry));
+    entry->offset = offset;
+    entry->hash = hash;
+    entry->size = (uint32_t)(writer->offset - offset);
+    entry->name_offset = writer->names_size;
+    entry->name_length = (uint16_t)name_length;
+    memcpy(writer->names + writer->names_size, name, name_length + 1);
+    writer->names_size += name_length + 1;
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_CONTAINER);
+}
+
+// Completes the container by writing the index and trailer and frees all resources used by the writer
+// The file is not closed
+flare16x_error flare16x_container_finish(flare16x_container_writer* writer)
+{
+    // Make sure that there are no null pointers
+    if (writer == NULL || writer->file == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_CONTAINER);
+
+    // Fill in the trailer
+    flare16x_container_trailer trailer;
+    memset(&trailer, 0, sizeof(trailer));
+    trailer.count = writer->count;
+    trailer.names_size = writer->names_size;
+    trailer.magic = FLARE16X_CONTAINER_INDEX_MAGIC;
+
+    // Write the index entries, followed by the names and the trailer
+    trailer.index_offset = writer->offset;
+    flare16x_error error = flare16x_container_write(writer, writer->entries,
+            writer->count * sizeof(flare16x_container_entry));
+    trailer.names_offset = writer->offset;
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_container_write(writer, writer->names, writer->names_size);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_container_write(writer, &trailer, sizeof(trailer));
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE && fflush(writer->file) != 0)
+        error = flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_CONTAINER);
+
+    // Free the resources in any case
+    free(writer->entries);
+    free(writer->names);
+    memset(writer, 0, sizeof(flare16x_container_writer));
+
+    return error;
+}
+
+// Opens a container file by memory-mapping it (or reading it where memory-mapping is unavailable)
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_container_open(const char* path, flare16x_container* container)
+{
+    // Make sure that there are no null pointers
+    if (path == NULL || container == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_CONTAINER);
+
+    void* data;
+    size_t size;
+    uint8_t owned;
+#ifdef FLARE16X_CONTAINER_MMAP
+    // Map the entire file read-only
+    int descriptor = open(path, O_RDONLY);
+    if (descriptor < 0)
+        return flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_CONTAINER);
+    struct stat info;
+    if (fstat(descriptor, &info) != 0 || info.st_size <= 0)
+    {
+        close(descriptor);
+        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_CONTAINER);
+    }
+    size = (size_t)info.st_size;
+    data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if (data == MAP_FAILED)
+        return flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_CONTAINER);
+    owned = 1;
+#else
+    // Read the entire file into memory
+    FILE* file = fopen(path, "rb");
+    if (file == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_CONTAINER);
+    long length = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+    if (length <= 0 || fseek(file, 0, SEEK_SET) != 0)
+    {
+        fclose(file);
+        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_CONTAINER);
+    }
+    size = (size_t)length;
+    data = malloc(size);
+    if (data == NULL)
+    {
+        fclose(file);
+        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_CONTAINER);
+    }
+    if (fread(data, size, 1, file) != 1)
+    {
+        free(data);
+        fclose(file);
+        return flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_CONTAINER);
+    }
+    fclose(file);
+    owned = 2;
+#endif
+
+    // Validate the container
+    flare16x_error error = flare16x_container_attach(data, size, container);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+    {
+#ifdef FLARE16X_CONTAINER_MMAP
+        munmap(data, size);
+#else
+        free(data);
+#endif
+        return error;
+    }
+    container->owned = owned;
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_CONTAINER);
+}
+
+// Opens a container that is already held in memory without copying it
+// The data has to outlive the container
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_container_attach(const void* data, size_t size, flare16x_container* container)
+{
+    // Make sure that there are no null pointers
+    if (data == NULL || container == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_CONTAINER);
+
+    // Clear the container
+    memset(container, 0, sizeof(flare16x_container));
+
+    // Validate the file header
+    const flare16x_container_header* header = data;
+    if (size < sizeof(flare16x_container_header) + sizeof(flare16x_container_trailer) ||
+        header->magic != FLARE16X_CONTAINER_MAGIC || header->version != FLARE16X_CONTAINER_VERSION ||
+        header->header_size != sizeof(flare16x_container_header))
+        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_CONTAINER);
+
+    // Validate the trailer and make sure that the index and the names lie within the data
+    const uint8_t* bytes = data;
+    const flare16x_container_trailer* trailer =
+            (const flare16x_container_trailer*)(bytes + size - sizeof(flare16x_container_trailer));
+    uint64_t limit = size - sizeof(flare16x_container_trailer);
+    if (trailer->magic != FLARE16X_CONTAINER_INDEX_MAGIC || trailer->index_offset > limit ||
+        trailer->count > (limit - trailer->index_offset) / sizeof(flare16x_container_entry) ||
+        trailer->names_offset > limit || trailer->names_size > limit - trailer->names_offset ||
+        (trailer->names_size > 0 && bytes[trailer->names_offset + trailer->names_size - 1] != '\0'))
+        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_CONTAINER);
+
+    container->data = bytes;
+    container->size = size;
+    container->trailer = trailer;
+    container->entries = (const flare16x_container_entry*)(bytes + trailer->index_offset);
+    container->names = (const char*)(bytes + trailer->names_offset);
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_CONTAINER);
+}
+
+// Returns the number of frames held in the container
+uint32_t flare16x_container_count(flare16x_container* container)
+{
+    if (container == NULL || container->trailer == NULL)
+        return 0;
+    return container->trailer->count;
+}
+
+// Provides a view of a frame that points straight into the container data
+flare16x_error flare16x_container_frame_get(flare16x_container* container, uint32_t index,
+        flare16x_container_frame* frame)
+{
+    // Make sure that there are no null pointers
+    if (container == NULL || container->trailer == NULL || frame == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_CONTAINER);
+
+    // Check the index
+    if (index >= container->trailer->count)
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_CONTAINER);
+
+    // Make sure that the frame and its name lie within the data
+    const flare16x_container_entry* entry = &container->entries[index];
+    if (entry->offset > container->trailer->index_offset ||
+        entry->size > container->trailer->index_offset - entry->offset ||
+        entry->size < sizeof(flare16x_container_frame_header) ||
+        (uint64_t)entry->name_offset + entry->name_length >= container->trailer->names_size)
+        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_CONTAINER);
+
+    // As well as its planes
+    const flare16x_container_frame_header* header =
+            (const flare16x_container_frame_header*)(container->data + entry->offset);
+    if (header->plane_size != (uint32_t)header->width * header->height || header->plane_stride < header->plane_size ||
+        (uint64_t)header->plane_stride * 3 > entry->size - sizeof(flare16x_container_frame_header))
+        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_CONTAINER);
+
+    // Then, point the view into the data
+    const uint8_t* planes = (const uint8_t*)header + sizeof(flare16x_container_frame_header);
+    frame->header = header;
+    frame->name = container->names + entry->name_offset;
+    frame->hash = entry->hash;
+    frame->values = planes;
+    frame->uncertainties = planes + header->plane_stride;
+    frame->mask = planes + header->plane_stride * 2;
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_CONTAINER);
+}
+
+// Searches the index for the frame of a source file by its name and hash
+// A null name matches any name and a zero hash matches any hash
+flare16x_error flare16x_container_find(flare16x_container* container, const char* name, uint64_t hash,
+        uint32_t* index)
+{
+    // Make sure that there are no null pointers
+    if (container == NULL || container->trailer == NULL || index == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_CONTAINER);
+
+    // Compare the hash and the name length first, as they are stored in the index itself
+    size_t name_length = name != NULL ? strlen(name) : 0;
+    uint32_t entry;
+    for (entry = 0; entry < container->trailer->count; entry++)
+    {
+        const flare16x_container_entry* candidate = &container->entries[entry];
+        if ((hash != 0 && candidate->hash != hash) || (name != NULL && (candidate->name_length != name_length ||
+            (uint64_t)candidate->name_offset + name_length >= container->trailer->names_size ||
+            memcmp(container->names + candidate->name_offset, name, name_length) != 0)))
+            continue;
+
+        *index = entry;
+        return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_CONTAINER);
+    }
+
+    return flare16x_error_make(FLARE16X_ERROR_UNKNOWN, FLARE16X_ERROR_SOURCE_CONTAINER);
+}
+
+// Copies the values and uncertainties of a frame into a new thermal image
+// Will overwrite any existing image state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_container_load(flare16x_container* container, uint32_t index, flare16x_thermal_image* image)
+{
+    // Make sure the image is not null
+    if (image == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_CONTAINER);
+
+    // Look up the frame, which also validates the container
+    flare16x_container_frame frame;
+    flare16x_error error = flare16x_container_frame_get(container, index, &frame);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return error;
+
+    // Allocate the image
+    error = flare16x_thermal_image_init(frame.header->width, frame.header->height, image);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return flare16x_error_wrap(flare16x_error_make(FLARE16X_ERROR_CALLEE, FLARE16X_ERROR_SOURCE_CONTAINER),
+                error);
+    image->mode = frame.header->mode;
+
+    // Then, interleave the planes into the thermal points
+    uint32_t point;
+    for (point = 0; point < frame.header->plane_size; point++)
+    {
+        image->points[point].value = frame.values[point];
+        image->points[point].uncertainty = frame.uncertainties[point];
+    }
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_CONTAINER);
+}
+
+// Closes a container and frees its resources
+flare16x_error flare16x_container_close(flare16x_container* container)
+{
+    // Make sure the container is not null
+    if (container == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_CONTAINER);
+
+    // Release the data, if it is owned by the container
+#ifdef FLARE16X_CONTAINER_MMAP
+    if (container->owned == 1)
+        munmap((void*)container->data, container->size);
+#endif
+    if (container->owned == 2)
+        free((void*)container->data);
+
+    // And zero the struct
+    memset(container, 0, sizeof(flare16x_container));
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_CONTAINER);
+}
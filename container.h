@@ -0,0 +1,201 @@
+//
+// flare16x core
+// Developed 2019 by Benedikt Muessig <github@bmuessig.eu>
+// Licensed under GPLv3
+//
+// container.h: Header file for the multi-frame thermal container
+//
+
+#ifndef FLARE16X_CONTAINER_H
+#define FLARE16X_CONTAINER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "error.h"
+#include "thermal.h"
+
+/*
+ * The container stores any number of processed frames in a single file that can be memory-mapped and used in place.
+ * All fields are stored in the byte order of the host that wrote the file, so that the structs can be used in place.
+ * This is little endian on all supported platforms; a file written with the other byte order fails the magic check.
+ * Every block starts at an eight byte boundary:
+ * 1) The file header identifies the file
+ * 2) Each frame consists of a frame header followed by the value, uncertainty and mask planes
+ *    Each plane holds one byte per pixel in line order
+ * 3) The index holds one entry per frame in the order they were appended, followed by their source names
+ * 4) The trailer at the very end of the file locates the index
+ * As the index is written last, frames can be appended strictly sequentially without knowing their count in advance.
+ */
+
+// The magic number of the file header ("F16X")
+#define FLARE16X_CONTAINER_MAGIC 0x58363146u
+// The magic number of the trailer ("F16I")
+#define FLARE16X_CONTAINER_INDEX_MAGIC 0x49363146u
+// The current version of the container format
+#define FLARE16X_CONTAINER_VERSION 1
+// The alignment of all blocks in bytes
+#define FLARE16X_CONTAINER_ALIGNMENT 8
+// Rounds a size up to the alignment of the container blocks
+#define flare16x_container_align(size) (((size) + FLARE16X_CONTAINER_ALIGNMENT - 1) & \
+        ~(uint64_t)(FLARE16X_CONTAINER_ALIGNMENT - 1))
+// The initial value of the source hash (64-bit FNV-1a offset basis)
+#define FLARE16X_CONTAINER_HASH_SEED 0xcbf29ce484222325ull
+
+// Make sure the container structs are laid out exactly like the file
+#pragma pack(push, 1)
+
+// The file header struct
+typedef struct {
+    uint32_t magic; // must be FLARE16X_CONTAINER_MAGIC
+    uint16_t version; // must be FLARE16X_CONTAINER_VERSION
+    uint16_t header_size; // must be the size of this struct
+    uint64_t reserved; // must be 0
+} flare16x_container_header;
+
+// The frame header struct that precedes the planes of each frame
+typedef struct {
+    uint16_t width; // the width of the thermal image in pixels
+    uint16_t height; // the height of the thermal image in pixels
+    uint8_t mode; // the quantification mode as defined in FLARE16X_THERMAL_QUANTIFICATION_*
+    uint8_t device_model; // the device model as defined in FLARE16X_LOCATOR_MODEL_*
+    uint8_t palette; // the source palette as defined in FLARE16X_PALETTES_*
+    uint8_t emissivity; // the emissivity times 100
+    int16_t temperature_spot; // the spot temperature in degrees celsius times 10
+    uint16_t spot_x; // the x-coordinate of the aperture spot
+    uint16_t spot_y; // the y-coordinate of the aperture spot
+    uint16_t spot_width; // the width of the aperture spot
+    uint16_t spot_height; // the height of the aperture spot
+    uint16_t reserved; // must be 0
+    uint32_t reserved2; // must be 0
+    uint32_t plane_size; // the size of each plane in bytes without padding
+    uint32_t plane_stride; // the distance between the planes in bytes including padding
+} flare16x_container_frame_header;
+
+// The index entry struct
+typedef struct {
+    uint64_t offset; // the offset of the frame header from the start of the file
+    uint64_t hash; // the hash of the source file's content
+    uint32_t size; // the size of the frame including the header and all planes
+    uint32_t name_offset; // the offset of the source name relative to the start of the names
+    uint16_t name_length; // the length of the source name without the terminating null byte
+    uint16_t reserved; // must be 0
+    uint32_t reserved2; // must be 0
+} flare16x_container_entry;
+
+// The trailer struct
+typedef struct {
+    uint64_t index_offset; // the offset of the first index entry from the start of the file
+    uint64_t names_offset; // the offset of the null-terminated source names from the start of the file
+    uint32_t count; // the number of frames
+    uint32_t names_size; // the size of all source names in bytes
+    uint32_t magic; // must be FLARE16X_CONTAINER_INDEX_MAGIC
+    uint32_t reserved; // must be 0
+} flare16x_container_trailer;
+
+// Restore regular 32 or 64 bit struct boundaries
+#pragma pack(pop)
+
+// Represents a container that is being written
+typedef struct {
+    // The target file
+    FILE* file;
+    // The current offset in the file
+    uint64_t offset;
+    // The index entries of all frames written so far
+    flare16x_container_entry* entries;
+    // The number of frames written so far
+    uint32_t count;
+    // The number of entries that fit into the allocated index
+    uint32_t capacity;
+    // The null-terminated source names of all frames written so far
+    char* names;
+    // The size of all source names in bytes
+    uint32_t names_size;
+    // The number of bytes that fit into the allocated names
+    uint32_t names_capacity;
+} flare16x_container_writer;
+
+// Represents an opened container
+typedef struct {
+    // The contents of the container file
+    const uint8_t* data;
+    // The size of the container file
+    size_t size;
+    // The trailer that locates the index
+    const flare16x_container_trailer* trailer;
+    // The index entries
+    const flare16x_container_entry* entries;
+    // The source names
+    const char* names;
+    // Zero, if the data is borrowed, one, if it is memory-mapped or two, if it was read into an allocated buffer
+    uint8_t owned;
+} flare16x_container;
+
+// Represents a single frame of an opened container, which points straight into the container data
+typedef struct {
+    // The frame header
+    const flare16x_container_frame_header* header;
+    // The null-terminated source name
+    const char* name;
+    // The hash of the source file's content
+    uint64_t hash;
+    // The relative thermal values
+    const uint8_t* values;
+    // The relative uncertainties of the thermal values
+    const uint8_t* uncertainties;
+    // The mask values as defined in FLARE16X_LOCATOR_DETECT_*
+    const uint8_t* mask;
+} flare16x_container_frame;
+
+// Continues a 64-bit FNV-1a hash over a block of data
+uint64_t flare16x_container_hash(const void* data, size_t size, uint64_t hash);
+
+// Hashes the entire content of a file starting at its beginning
+// Afterwards, the file is positioned at its beginning again
+flare16x_error flare16x_container_hash_file(FILE* file, uint64_t* hash);
+
+// Starts a new container by writing the file header to the file
+// The file has to stay open until the container is finished
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_container_create(FILE* file, flare16x_container_writer* writer);
+
+// Appends the processed thermal image of a thermal context as a new frame
+// The name and hash identify the source file, which allows finding the frame later on
+flare16x_error flare16x_container_append(flare16x_container_writer* writer, const char* name, uint64_t hash,
+        flare16x_thermal* thermal);
+
+// Completes the container by writing the index and trailer and frees all resources used by the writer
+// The file is not closed
+flare16x_error flare16x_container_finish(flare16x_container_writer* writer);
+
+// Opens a container file by memory-mapping it (or reading it where memory-mapping is unavailable)
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_container_open(const char* path, flare16x_container* container);
+
+// Opens a container that is already held in memory without copying it
+// The data has to outlive the container
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_container_attach(const void* data, size_t size, flare16x_container* container);
+
+// Returns the number of frames held in the container
+uint32_t flare16x_container_count(flare16x_container* container);
+
+// Provides a view of a frame that points straight into the container data
+flare16x_error flare16x_container_frame_get(flare16x_container* container, uint32_t index,
+        flare16x_container_frame* frame);
+
+// Searches the index for the frame of a source file by its name and hash
+// A null name matches any name and a zero hash matches any hash
+flare16x_error flare16x_container_find(flare16x_container* container, const char* name, uint64_t hash,
+        uint32_t* index);
+
+// Copies the values and uncertainties of a frame into a new thermal image
+// Will overwrite any existing image state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_container_load(flare16x_container* container, uint32_t index, flare16x_thermal_image* image);
+
+// Closes a container and frees its resources
+flare16x_error flare16x_container_close(flare16x_container* container);
+
+#endif //FLARE16X_CONTAINER_H
@@ -0,0 +1,340 @@
+//
+// flare16x core
+// Developed 2019 by Benedikt Muessig <github@bmuessig.eu>
+// Licensed under GPLv3
+//
+// convert.c: Vectorized pixel format conversion kernels with runtime dispatch
+//
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "error.h"
+#include "canvas.h"
+
+#include "convert.h"
+
+// The vector kernels are only built where convert.h enables them
+#ifdef FLARE16X_CONVERT_X86
+#include <immintrin.h>
+#endif
+
+// Widens a 5-bit component to 8 bits by replicating its upper bits
+#define flare16x_convert_expand5(c) ((uint8_t)(((c) << 3) | ((c) >> 2)))
+// Widens a 6-bit component to 8 bits by replicating its upper bits
+#define flare16x_convert_expand6(c) ((uint8_t)(((c) << 2) | ((c) >> 4)))
+
+// Converts 24-bit BGR888 pixels to RGB565 pixels
+static void flare16x_convert_bgr888_to_rgb565_scalar(const uint8_t* source, uint16_t* target, size_t count)
+{
+    size_t x;
+    for (x = 0; x < count; x++, source += 3)
+        target[x] = flare16x_canvas_rgb888(source[2], source[1], source[0]);
+}
+
+// Converts 32-bit BGRA8888 pixels to RGB565 pixels
+static void flare16x_convert_bgra8888_to_rgb565_scalar(const uint8_t* source, uint16_t* target, size_t count)
+{
+    size_t x;
+    for (x = 0; x < count; x++, source += 4)
+        target[x] = flare16x_canvas_rgb888(source[2], source[1], source[0]);
+}
+
+// Converts RGB565 pixels to 24-bit BGR888 pixels
+static void flare16x_convert_rgb565_to_bgr888_scalar(const uint16_t* source, uint8_t* target, size_t count)
+{
+    size_t x;
+    for (x = 0; x < count; x++, target += 3)
+    {
+        uint16_t p = source[x];
+        target[0] = flare16x_convert_expand5(p & 0x1fu);
+        target[1] = flare16x_convert_expand6((p >> 5) & 0x3fu);
+        target[2] = flare16x_convert_expand5(p >> 11);
+    }
+}
+
+// Converts RGB565 pixels to 32-bit BGRA8888 pixels
+static void flare16x_convert_rgb565_to_bgra8888_scalar(const uint16_t* source, uint8_t* target, size_t count)
+{
+    size_t x;
+    for (x = 0; x < count; x++, target += 4)
+    {
+        uint16_t p = source[x];
+        target[0] = flare16x_convert_expand5(p & 0x1fu);
+        target[1] = flare16x_convert_expand6((p >> 5) & 0x3fu);
+        target[2] = flare16x_convert_expand5(p >> 11);
+        target[3] = 0xff;
+    }
+}
+
+#ifdef FLARE16X_CONVERT_X86
+
+// Narrows four BGRX pixels held in 32-bit lanes to RGB565 values in the same lanes
+// The result is sign-extended from 16 bits, so that a signed saturating pack keeps the values intact
+__attribute__((target("sse2")))
+static inline __m128i flare16x_convert_narrow_sse2(__m128i pixels)
+{
+    __m128i r = _mm_and_si128(_mm_srli_epi32(pixels, 8), _mm_set1_epi32(0xf800));
+    __m128i g = _mm_and_si128(_mm_srli_epi32(pixels, 5), _mm_set1_epi32(0x07e0));
+    __m128i b = _mm_and_si128(_mm_srli_epi32(pixels, 3), _mm_set1_epi32(0x001f));
+    __m128i rgb = _mm_or_si128(_mm_or_si128(r, g), b);
+    return _mm_srai_epi32(_mm_slli_epi32(rgb, 16), 16);
+}
+
+// Widens eight RGB565 pixels to the blue/green and red/alpha byte pairs of BGRA8888
+__attribute__((target("sse2")))
+static inline void flare16x_convert_widen_sse2(__m128i pixels, __m128i* bg, __m128i* ra)
+{
+    __m128i low5 = _mm_set1_epi16(0x1f);
+    __m128i b5 = _mm_and_si128(pixels, low5);
+    __m128i g6 = _mm_and_si128(_mm_srli_epi16(pixels, 5), _mm_set1_epi16(0x3f));
+    __m128i r5 = _mm_srli_epi16(pixels, 11);
+    __m128i b8 = _mm_or_si128(_mm_slli_epi16(b5, 3), _mm_srli_epi16(b5, 2));
+    __m128i g8 = _mm_or_si128(_mm_slli_epi16(g6, 2), _mm_srli_epi16(g6, 4));
+    __m128i r8 = _mm_or_si128(_mm_slli_epi16(r5, 3), _mm_srli_epi16(r5, 2));
+    *bg = _mm_or_si128(b8, _mm_slli_epi16(g8, 8));
+    *ra = _mm_or_si128(r8, _mm_set1_epi16((short)0xff00));
+}
+
+// Converts 32-bit BGRA8888 pixels to RGB565 pixels using SSE2
+__attribute__((target("sse2")))
+static void flare16x_convert_bgra8888_to_rgb565_sse2(const uint8_t* source, uint16_t* target, size_t count)
+{
+    size_t x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        __m128i low = flare16x_convert_narrow_sse2(_mm_loadu_si128((const __m128i*)(source + x * 4)));
+        __m128i high = flare16x_convert_narrow_sse2(_mm_loadu_si128((const __m128i*)(source + x * 4 + 16)));
+        _mm_storeu_si128((__m128i*)(target + x), _mm_packs_epi32(low, high));
+    }
+    flare16x_convert_bgra8888_to_rgb565_scalar(source + x * 4, target + x, count - x);
+}
+
+// Converts RGB565 pixels to 32-bit BGRA8888 pixels using SSE2
+__attribute__((target("sse2")))
+static void flare16x_convert_rgb565_to_bgra8888_sse2(const uint16_t* source, uint8_t* target, size_t count)
+{
+    size_t x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        __m128i bg, ra;
+        flare16x_convert_widen_sse2(_mm_loadu_si128((const __m128i*)(source + x)), &bg, &ra);
+        _mm_storeu_si128((__m128i*)(target + x * 4), _mm_unpacklo_epi16(bg, ra));
+        _mm_storeu_si128((__m128i*)(target + x * 4 + 16), _mm_unpackhi_epi16(bg, ra));
+    }
+    flare16x_convert_rgb565_to_bgra8888_scalar(source + x, target + x * 4, count - x);
+}
+
+// Converts 24-bit BGR888 pixels to RGB565 pixels using SSSE3
+// Each 16 byte load holds four complete pixels, which are spread into 32-bit lanes by a shuffle
+__attribute__((target("ssse3")))
+static void flare16x_convert_bgr888_to_rgb565_ssse3(const uint8_t* source, uint16_t* target, size_t count)
+{
+    const __m128i spread = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    size_t x = 0;
+
+    // The second load of each iteration reads four bytes past the eight pixels
+    for (; x + 10 <= count; x += 8)
+    {
+        __m128i low = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(source + x * 3)), spread);
+        __m128i high = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(source + x * 3 + 12)), spread);
+        _mm_storeu_si128((__m128i*)(target + x),
+                _mm_packs_epi32(flare16x_convert_narrow_sse2(low), flare16x_convert_narrow_sse2(high)));
+    }
+    flare16x_convert_bgr888_to_rgb565_scalar(source + x * 3, target + x, count - x);
+}
+
+// Converts RGB565 pixels to 24-bit BGR888 pixels using SSSE3
+// Sixteen pixels are widened to BGRA8888, have their alpha bytes removed and are stitched into three stores
+__attribute__((target("ssse3")))
+static void flare16x_convert_rgb565_to_bgr888_ssse3(const uint16_t* source, uint8_t* target, size_t count)
+{
+    const __m128i pack = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    size_t x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        __m128i bg, ra;
+        flare16x_convert_widen_sse2(_mm_loadu_si128((const __m128i*)(source + x)), &bg, &ra);
+        __m128i a = _mm_shuffle_epi8(_mm_unpacklo_epi16(bg, ra), pack);
+        __m128i b = _mm_shuffle_epi8(_mm_unpackhi_epi16(bg, ra), pack);
+        flare16x_convert_widen_sse2(_mm_loadu_si128((const __m128i*)(source + x + 8)), &bg, &ra);
+        __m128i c = _mm_shuffle_epi8(_mm_unpacklo_epi16(bg, ra), pack);
+        __m128i d = _mm_shuffle_epi8(_mm_unpackhi_epi16(bg, ra), pack);
+
+        uint8_t* line = target + x * 3;
+        _mm_storeu_si128((__m128i*)line, _mm_or_si128(a, _mm_slli_si128(b, 12)));
+        _mm_storeu_si128((__m128i*)(line + 16), _mm_or_si128(_mm_srli_si128(b, 4), _mm_slli_si128(c, 8)));
+        _mm_storeu_si128((__m128i*)(line + 32), _mm_or_si128(_mm_srli_si128(c, 8), _mm_slli_si128(d, 4)));
+    }
+    flare16x_convert_rgb565_to_bgr888_scalar(source + x, target + x * 3, count - x);
+}
+
+// Narrows eight BGRX pixels held in 32-bit lanes to sign-extended RGB565 values in the same lanes
+__attribute__((target("avx2")))
+static inline __m256i flare16x_convert_narrow_avx2(__m256i pixels)
+{
+    __m256i r = _mm256_and_si256(_mm256_srli_epi32(pixels, 8), _mm256_set1_epi32(0xf800));
+    __m256i g = _mm256_and_si256(_mm256_srli_epi32(pixels, 5), _mm256_set1_epi32(0x07e0));
+    __m256i b = _mm256_and_si256(_mm256_srli_epi32(pixels, 3), _mm256_set1_epi32(0x001f));
+    __m256i rgb = _mm256_or_si256(_mm256_or_si256(r, g), b);
+    return _mm256_srai_epi32(_mm256_slli_epi32(rgb, 16), 16);
+}
+
+// Packs two vectors of eight narrowed pixels each into sixteen RGB565 pixels in order
+// The pack instruction works within 128-bit lanes, so the 64-bit quarters have to be reordered afterwards
+__attribute__((target("avx2")))
+static inline __m256i flare16x_convert_pack_avx2(__m256i low, __m256i high)
+{
+    return _mm256_permute4x64_epi64(_mm256_packs_epi32(low, high), 0xd8);
+}
+
+// Converts 24-bit BGR888 pixels to RGB565 pixels using AVX2
+__attribute__((target("avx2")))
+static void flare16x_convert_bgr888_to_rgb565_avx2(const uint8_t* source, uint16_t* target, size_t count)
+{
+    const __m256i spread = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                            0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    size_t x = 0;
+
+    // The last load of each iteration reads four bytes past the sixteen pixels
+    for (; x + 18 <= count; x += 16)
+    {
+        const uint8_t* line = source + x * 3;
+        __m256i low = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)line)),
+                _mm_loadu_si128((const __m128i*)(line + 12)), 1);
+        __m256i high = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(line + 24))),
+                _mm_loadu_si128((const __m128i*)(line + 36)), 1);
+        low = flare16x_convert_narrow_avx2(_mm256_shuffle_epi8(low, spread));
+        high = flare16x_convert_narrow_avx2(_mm256_shuffle_epi8(high, spread));
+        _mm256_storeu_si256((__m256i*)(target + x), flare16x_convert_pack_avx2(low, high));
+    }
+    flare16x_convert_bgr888_to_rgb565_ssse3(source + x * 3, target + x, count - x);
+}
+
+// Converts 32-bit BGRA8888 pixels to RGB565 pixels using AVX2
+__attribute__((target("avx2")))
+static void flare16x_convert_bgra8888_to_rgb565_avx2(const uint8_t* source, uint16_t* target, size_t count)
+{
+    size_t x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        __m256i low = flare16x_convert_narrow_avx2(_mm256_loadu_si256((const __m256i*)(source + x * 4)));
+        __m256i high = flare16x_convert_narrow_avx2(_mm256_loadu_si256((const __m256i*)(source + x * 4 + 32)));
+        _mm256_storeu_si256((__m256i*)(target + x), flare16x_convert_pack_avx2(low, high));
+    }
+    flare16x_convert_bgra8888_to_rgb565_sse2(source + x * 4, target + x, count - x);
+}
+
+// Converts RGB565 pixels to 32-bit BGRA8888 pixels using AVX2
+__attribute__((target("avx2")))
+static void flare16x_convert_rgb565_to_bgra8888_avx2(const uint16_t* source, uint8_t* target, size_t count)
+{
+    size_t x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        __m256i pixels = _mm256_loadu_si256((const __m256i*)(source + x));
+        __m256i b5 = _mm256_and_si256(pixels, _mm256_set1_epi16(0x1f));
+        __m256i g6 = _mm256_and_si256(_mm256_srli_epi16(pixels, 5), _mm256_set1_epi16(0x3f));
+        __m256i r5 = _mm256_srli_epi16(pixels, 11);
+        __m256i b8 = _mm256_or_si256(_mm256_slli_epi16(b5, 3), _mm256_srli_epi16(b5, 2));
+        __m256i g8 = _mm256_or_si256(_mm256_slli_epi16(g6, 2), _mm256_srli_epi16(g6, 4));
+        __m256i r8 = _mm256_or_si256(_mm256_slli_epi16(r5, 3), _mm256_srli_epi16(r5, 2));
+        __m256i bg = _mm256_or_si256(b8, _mm256_slli_epi16(g8, 8));
+        __m256i ra = _mm256_or_si256(r8, _mm256_set1_epi16((short)0xff00));
+
+        // The unpack instructions work within 128-bit lanes, so the halves have to be swapped into order
+        __m256i low = _mm256_unpacklo_epi16(bg, ra);
+        __m256i high = _mm256_unpackhi_epi16(bg, ra);
+        _mm256_storeu_si256((__m256i*)(target + x * 4), _mm256_permute2x128_si256(low, high, 0x20));
+        _mm256_storeu_si256((__m256i*)(target + x * 4 + 32), _mm256_permute2x128_si256(low, high, 0x31));
+    }
+    flare16x_convert_rgb565_to_bgra8888_sse2(source + x, target + x * 4, count - x);
+}
+
+#endif
+
+// The kernels of all instruction sets in the order of FLARE16X_CONVERT_ISA_*
+// Instruction sets without a dedicated kernel for a conversion use the best kernel of a lower one
+static const flare16x_convert_kernels flare16x_convert_table[FLARE16X_CONVERT_ISA_COUNT] = {
+    {
+        FLARE16X_CONVERT_ISA_SCALAR, "scalar",
+        flare16x_convert_bgr888_to_rgb565_scalar, flare16x_convert_bgra8888_to_rgb565_scalar,
+        flare16x_convert_rgb565_to_bgr888_scalar, flare16x_convert_rgb565_to_bgra8888_scalar
+    },
+#ifdef FLARE16X_CONVERT_X86
+    {
+        FLARE16X_CONVERT_ISA_SSE2, "sse2",
+        flare16x_convert_bgr888_to_rgb565_scalar, flare16x_convert_bgra8888_to_rgb565_sse2,
+        flare16x_convert_rgb565_to_bgr888_scalar, flare16x_convert_rgb565_to_bgra8888_sse2
+    },
+    {
+        FLARE16X_CONVERT_ISA_SSSE3, "ssse3",
+        flare16x_convert_bgr888_to_rgb565_ssse3, flare16x_convert_bgra8888_to_rgb565_sse2,
+        flare16x_convert_rgb565_to_bgr888_ssse3, flare16x_convert_rgb565_to_bgra8888_sse2
+    },
+    {
+        FLARE16X_CONVERT_ISA_AVX2, "avx2",
+        flare16x_convert_bgr888_to_rgb565_avx2, flare16x_convert_bgra8888_to_rgb565_avx2,
+        flare16x_convert_rgb565_to_bgr888_ssse3, flare16x_convert_rgb565_to_bgra8888_avx2
+    }
+#endif
+};
+
+// Checks, whether the compiler and the running CPU support an instruction set as defined in FLARE16X_CONVERT_ISA_*
+int flare16x_convert_supported(uint8_t isa)
+{
+    switch (isa)
+    {
+        case FLARE16X_CONVERT_ISA_SCALAR:
+            return 1;
+#ifdef FLARE16X_CONVERT_X86
+        case FLARE16X_CONVERT_ISA_SSE2:
+            return __builtin_cpu_supports("sse2");
+        case FLARE16X_CONVERT_ISA_SSSE3:
+            return __builtin_cpu_supports("ssse3");
+        case FLARE16X_CONVERT_ISA_AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return 0;
+    }
+}
+
+// Looks up the conversion kernels of a specific instruction set
+// Fails with an unknown error if the instruction set is not supported by the compiler or the running CPU
+flare16x_error flare16x_convert_get(uint8_t isa, const flare16x_convert_kernels** kernels)
+{
+    // Make sure that the kernels pointer is not null
+    if (kernels == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_CONVERT);
+
+    // Validate the instruction set
+    if (isa >= FLARE16X_CONVERT_ISA_COUNT)
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_CONVERT);
+
+    // Check, if it can be used
+    if (!flare16x_convert_supported(isa))
+        return flare16x_error_make(FLARE16X_ERROR_UNKNOWN, FLARE16X_ERROR_SOURCE_CONVERT);
+
+    *kernels = &flare16x_convert_table[isa];
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_CONVERT);
+}
+
+// Returns the conversion kernels of the best instruction set supported by the running CPU
+const flare16x_convert_kernels* flare16x_convert_best(void)
+{
+    // The CPU features are cached by the compiler runtime, so checking them is cheap
+    int isa;
+    for (isa = FLARE16X_CONVERT_ISA_COUNT - 1; isa > FLARE16X_CONVERT_ISA_SCALAR; isa--)
+        if (flare16x_convert_supported(isa))
+            break;
+    return &flare16x_convert_table[isa];
+}
+
+// Copies a run of RGB565 pixels, which does not require any conversion
+void flare16x_convert_copy16(const uint16_t* source, uint16_t* target, size_t count)
+{
+    // The C library already provides vectorized copies for all targets
+    memcpy(target, source, count * sizeof(uint16_t));
+}
@@ -0,0 +1,71 @@
+//
+// flare16x core
+// Developed 2019 by Benedikt Muessig <github@bmuessig.eu>
+// Licensed under GPLv3
+//
+// convert.h: Header file for the vectorized pixel format conversion kernels
+//
+
+#ifndef FLARE16X_CONVERT_H
+#define FLARE16X_CONVERT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "error.h"
+
+// The vector kernels require the GCC or Clang target attributes and are only built for x86
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define FLARE16X_CONVERT_X86 1
+#endif
+
+// All kernels convert a run of pixels between RGB565 and the byte orders used by bitmap files
+// 24-bit pixels are stored in blue, green, red order and 32-bit pixels in blue, green, red, alpha order
+// Narrowing to RGB565 truncates the components just like flare16x_canvas_rgb888 does
+// Widening from RGB565 replicates the upper bits into the lower ones, so that white stays white
+// The alpha channel is ignored when reading and set to 0xff when writing
+
+// Instruction set enum
+enum {
+    // Portable C reference implementation
+    FLARE16X_CONVERT_ISA_SCALAR,
+    // x86 SSE2
+    FLARE16X_CONVERT_ISA_SSE2,
+    // x86 SSSE3
+    FLARE16X_CONVERT_ISA_SSSE3,
+    // x86 AVX2
+    FLARE16X_CONVERT_ISA_AVX2,
+    // The number of instruction sets known
+    FLARE16X_CONVERT_ISA_COUNT
+};
+
+// Represents the set of conversion kernels of one instruction set
+typedef struct {
+    // The instruction set as defined in FLARE16X_CONVERT_ISA_*
+    uint8_t isa;
+    // The name of the instruction set
+    const char* name;
+    // Converts 24-bit BGR888 pixels to RGB565 pixels
+    void (*bgr888_to_rgb565)(const uint8_t* source, uint16_t* target, size_t count);
+    // Converts 32-bit BGRA8888 pixels to RGB565 pixels
+    void (*bgra8888_to_rgb565)(const uint8_t* source, uint16_t* target, size_t count);
+    // Converts RGB565 pixels to 24-bit BGR888 pixels
+    void (*rgb565_to_bgr888)(const uint16_t* source, uint8_t* target, size_t count);
+    // Converts RGB565 pixels to 32-bit BGRA8888 pixels
+    void (*rgb565_to_bgra8888)(const uint16_t* source, uint8_t* target, size_t count);
+} flare16x_convert_kernels;
+
+// Checks, whether the compiler and the running CPU support an instruction set as defined in FLARE16X_CONVERT_ISA_*
+int flare16x_convert_supported(uint8_t isa);
+
+// Looks up the conversion kernels of a specific instruction set
+// Fails with an unknown error if the instruction set is not supported by the compiler or the running CPU
+flare16x_error flare16x_convert_get(uint8_t isa, const flare16x_convert_kernels** kernels);
+
+// Returns the conversion kernels of the best instruction set supported by the running CPU
+const flare16x_convert_kernels* flare16x_convert_best(void);
+
+// Copies a run of RGB565 pixels, which does not require any conversion
+void flare16x_convert_copy16(const uint16_t* source, uint16_t* target, size_t count);
+
+#endif //FLARE16X_CONVERT_H
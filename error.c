@@ -57,7 +57,25 @@ const char* const flare16x_error_source_names[FLARE16X_ERROR_SOURCE_COUNT] = {
     // FLARE16X_ERROR_SOURCE_PALETTES
     "palettes",
     // FLARE16X_ERROR_SOURCE_THERMAL
-    "thermal"
+    "thermal",
+    // FLARE16X_ERROR_SOURCE_STREAM
+    "stream",
+    // FLARE16X_ERROR_SOURCE_CONVERT
+    "convert",
+    // FLARE16X_ERROR_SOURCE_CONTAINER
+    "container",
+    // FLARE16X_ERROR_SOURCE_EXPORT
+    "export",
+    // FLARE16X_ERROR_SOURCE_CODEC
+    "codec",
+    // FLARE16X_ERROR_SOURCE_SEQUENCE
+    "sequence",
+    // FLARE16X_ERROR_SOURCE_SERIES
+    "series",
+    // FLARE16X_ERROR_SOURCE_PROFILE
+    "profile",
+    // FLARE16X_ERROR_SOURCE_SYNTH
+    "synth"
 };
 
 // Returns a matching error name for the latest error on the stack
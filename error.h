@@ -70,6 +70,24 @@ enum {
     FLARE16X_ERROR_SOURCE_PALETTES,
     // Thermal
     FLARE16X_ERROR_SOURCE_THERMAL,
+    // Stream
+    FLARE16X_ERROR_SOURCE_STREAM,
+    // Convert
+    FLARE16X_ERROR_SOURCE_CONVERT,
+    // Container
+    FLARE16X_ERROR_SOURCE_CONTAINER,
+    // Export
+    FLARE16X_ERROR_SOURCE_EXPORT,
+    // Codec
+    FLARE16X_ERROR_SOURCE_CODEC,
+    // Sequence
+    FLARE16X_ERROR_SOURCE_SEQUENCE,
+    // Series
+    FLARE16X_ERROR_SOURCE_SERIES,
+    // Profile
+    FLARE16X_ERROR_SOURCE_PROFILE,
+    // Synth (the last source that fits into the 4 bits of the source, so the source space is full now)
+    FLARE16X_ERROR_SOURCE_SYNTH,
     // The number of error sources known
     FLARE16X_ERROR_SOURCE_COUNT,
     // The error source mask used to differentiate the stacked error sources
@@ -80,7 +98,7 @@ enum {
 
 // Assembles a new error from an error and a source
 #define flare16x_error_make(error,source) \
-(((source) & (FLARE16X_ERROR_SOURCE_MASK) << (FLARE16X_ERROR_WIDTH)) | ((error) & (FLARE16X_ERROR_MASK)))
+((((source) << (FLARE16X_ERROR_WIDTH)) & (FLARE16X_ERROR_SOURCE_MASK)) | ((error) & (FLARE16X_ERROR_MASK)))
 
 // Gets the reason from the error
 #define flare16x_error_reason(error) ((error) & (FLARE16X_ERROR_MASK))
@@ -0,0 +1,207 @@
+//
+// flare16x core
+// Developed 2019 by Benedikt Muessig <github@bmuessig.eu>
+// Licensed under GPLv3
+//
+// export.c: Functions for exporting thermal planes for numerical processing
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "error.h"
+#include "thermal.h"
+
+#include "export.h"
+
+// The alignment of the NumPy header including the magic and length fields
+#define FLARE16X_EXPORT_NPY_ALIGNMENT 64
+
+// Returns non-zero, if the machine stores multi-byte values in little endian order
+static int flare16x_export_little_endian(void)
+{
+    uint16_t probe = 1;
+    return *(uint8_t*)&probe == 1;
+}
+
+// Writes the header of the format, if it has one
+// The type is the NumPy type descriptor of a single channel
+static flare16x_error flare16x_export_header(FILE* file, uint8_t format, uint16_t width, uint16_t height,
+        uint8_t channels, const char* type)
+{
+    char header[FLARE16X_EXPORT_NPY_ALIGNMENT * 2];
+    int length = 0;
+
+    // Format the header
+    switch (format)
+    {
+        case FLARE16X_EXPORT_FORMAT_RAW:
+            return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_EXPORT);
+
+        case FLARE16X_EXPORT_FORMAT_NPY:
+        {
+            // Write the dictionary after the magic, version and length fields
+            if (channels > 1)
+                length = snprintf(header + 10, sizeof(header) - 10,
+                        "{'descr': '%s', 'fortran_order': False, 'shape': (%u, %u, %u), }", type, height, width,
+                        channels);
+            else
+                length = snprintf(header + 10, sizeof(header) - 10,
+                        "{'descr': '%s', 'fortran_order': False, 'shape': (%u, %u), }", type, height, width);
+            if (length < 0 || length + 11 > (int)sizeof(header))
+                return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_EXPORT);
+
+            // Pad the dictionary with spaces and a line break, so that the data starts aligned
+            length += 11;
+            int padded = (length + FLARE16X_EXPORT_NPY_ALIGNMENT - 1) & ~(FLARE16X_EXPORT_NPY_ALIGNMENT - 1);
+            memset(header + length - 1, ' ', padded - length);
+            header[padded - 1] = '\n';
+
+            // Fill in the magic, version and the little endian header length
+            memcpy(header, "\x93NUMPY\x01\x00", 8);
+            header[8] = (char)((padded - 10) & 0xff);
+            header[9] = (char)((padded - 10) >> 8);
+            length = padded;
+            break;
+        }
+
+        case FLARE16X_EXPORT_FORMAT_PGM:
+            length = snprintf(header, sizeof(header), "P5\n%u %u\n255\n", width, height);
+            break;
+
+        case FLARE16X_EXPORT_FORMAT_PFM:
+            // A negative scale indicates little endian values
+            length = snprintf(header, sizeof(header), "Pf\n%u %u\n%s\n", width, height,
+                    flare16x_export_little_endian() ? "-1.0" : "1.0");
+            break;
+
+        default:
+            return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_EXPORT);
+    }
+
+    // Then, write it
+    if (fwrite(header, length, 1, file) != 1)
+        return flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_EXPORT);
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_EXPORT);
+}
+
+// Writes a plane of a processed thermal context to a file
+// Every plane is written with a single write straight from the thermal context, except for the value and
+// uncertainty planes, which are first separated from the thermal points
+flare16x_error flare16x_export_plane(FILE* file, uint8_t format, uint8_t plane, flare16x_thermal* thermal)
+{
+    // Make sure that there are no null pointers
+    if (file == NULL || thermal == NULL || thermal->thermal_image == NULL || thermal->thermal_image->points == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_EXPORT);
+
+    flare16x_thermal_image* image = thermal->thermal_image;
+    flare16x_error error;
+    switch (plane)
+    {
+        case FLARE16X_EXPORT_PLANE_VALUE:
+        case FLARE16X_EXPORT_PLANE_UNCERTAINTY:
+        {
+            // Separate the requested half of the thermal points
+            size_t count = (size_t)image->width * image->height, point;
+            uint8_t* data = malloc(count);
+            if (data == NULL)
+                return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_EXPORT);
+            for (point = 0; point < count; point++)
+                data[point] = plane == FLARE16X_EXPORT_PLANE_VALUE ? image->points[point].value :
+                        image->points[point].uncertainty;
+
+            error = flare16x_export_bytes(file, format, image->width, image->height, 1, data);
+            free(data);
+            break;
+        }
+
+        case FLARE16X_EXPORT_PLANE_MASK:
+            // The mask has to exist
+            if (thermal->mask.pixels == NULL)
+                return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_EXPORT);
+
+            error = flare16x_export_bytes(file, format, thermal->mask.width, thermal->mask.height, 1,
+                    thermal->mask.pixels);
+            break;
+
+        case FLARE16X_EXPORT_PLANE_POINTS:
+            error = flare16x_export_bytes(file, format, image->width, image->height,
+                    sizeof(flare16x_thermal_point), (const uint8_t*)image->points);
+            break;
+
+        default:
+            return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_EXPORT);
+    }
+
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return flare16x_error_wrap(flare16x_error_make(FLARE16X_ERROR_CALLEE, FLARE16X_ERROR_SOURCE_EXPORT), error);
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_EXPORT);
+}
+
+// Writes a byte plane of the given dimensions with one or more interleaved channels per pixel to a file
+// The PGM format requires a single channel and the PFM format is not supported for byte planes
+flare16x_error flare16x_export_bytes(FILE* file, uint8_t format, uint16_t width, uint16_t height, uint8_t channels,
+        const uint8_t* data)
+{
+    // Make sure that there are no null pointers
+    if (file == NULL || data == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_EXPORT);
+
+    // Verify the parameters
+    if (width < 1 || height < 1 || channels < 1 || format == FLARE16X_EXPORT_FORMAT_PFM ||
+        (format == FLARE16X_EXPORT_FORMAT_PGM && channels != 1))
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_EXPORT);
+
+    // Write the header
+    flare16x_error error = flare16x_export_header(file, format, width, height, channels, "|u1");
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return error;
+
+    // And the entire plane at once
+    if (fwrite(data, (size_t)width * height * channels, 1, file) != 1)
+        return flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_EXPORT);
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_EXPORT);
+}
+
+// Writes a floating point plane of the given dimensions, such as calibrated temperatures, to a file
+// The PGM format is not supported for floating point planes
+// As PFM stores its lines bottom to top, it is written line by line rather than with a single write
+flare16x_error flare16x_export_floats(FILE* file, uint8_t format, uint16_t width, uint16_t height,
+        const float* data)
+{
+    // Make sure that there are no null pointers
+    if (file == NULL || data == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_EXPORT);
+
+    // Verify the parameters
+    if (width < 1 || height < 1 || format == FLARE16X_EXPORT_FORMAT_PGM)
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_EXPORT);
+
+    // Write the header
+    flare16x_error error = flare16x_export_header(file, format, width, height, 1,
+            flare16x_export_little_endian() ? "<f4" : ">f4");
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return error;
+
+    // Write the lines bottom to top for PFM
+    if (format == FLARE16X_EXPORT_FORMAT_PFM)
+    {
+        uint16_t line;
+        for (line = height; line > 0; line--)
+            if (fwrite(data + (size_t)(line - 1) * width, sizeof(float) * width, 1, file) != 1)
+                return flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_EXPORT);
+
+        return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_EXPORT);
+    }
+
+    // And the entire plane at once otherwise
+    if (fwrite(data, sizeof(float) * width * height, 1, file) != 1)
+        return flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_EXPORT);
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_EXPORT);
+}
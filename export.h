@@ -0,0 +1,62 @@
+//
+// flare16x core
+// Developed 2019 by Benedikt Muessig <github@bmuessig.eu>
+// Licensed under GPLv3
+//
+// export.h: Header file for the plane export functions
+//
+
+#ifndef FLARE16X_EXPORT_H
+#define FLARE16X_EXPORT_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "error.h"
+#include "thermal.h"
+
+// Export file format enum
+enum {
+    // Headerless raw data in line order
+    FLARE16X_EXPORT_FORMAT_RAW,
+    // NumPy array file (version 1.0)
+    FLARE16X_EXPORT_FORMAT_NPY,
+    // Binary portable graymap (P5), only for single byte planes
+    FLARE16X_EXPORT_FORMAT_PGM,
+    // Portable floatmap (Pf), only for floating point planes
+    FLARE16X_EXPORT_FORMAT_PFM,
+    // The number of export formats
+    FLARE16X_EXPORT_FORMAT_COUNT
+};
+
+// Export plane enum
+enum {
+    // The relative thermal values
+    FLARE16X_EXPORT_PLANE_VALUE,
+    // The relative uncertainties of the thermal values
+    FLARE16X_EXPORT_PLANE_UNCERTAINTY,
+    // The crosshair mask values as defined in FLARE16X_LOCATOR_DETECT_*
+    FLARE16X_EXPORT_PLANE_MASK,
+    // The value and uncertainty pairs as stored in memory, exported as a two channel plane
+    FLARE16X_EXPORT_PLANE_POINTS,
+    // The number of export planes
+    FLARE16X_EXPORT_PLANE_COUNT
+};
+
+// Writes a plane of a processed thermal context to a file
+// Every plane is written with a single write straight from the thermal context, except for the value and
+// uncertainty planes, which are first separated from the thermal points
+flare16x_error flare16x_export_plane(FILE* file, uint8_t format, uint8_t plane, flare16x_thermal* thermal);
+
+// Writes a byte plane of the given dimensions with one or more interleaved channels per pixel to a file
+// The PGM format requires a single channel and the PFM format is not supported for byte planes
+flare16x_error flare16x_export_bytes(FILE* file, uint8_t format, uint16_t width, uint16_t height, uint8_t channels,
+        const uint8_t* data);
+
+// Writes a floating point plane of the given dimensions, such as calibrated temperatures, to a file
+// The PGM format is not supported for floating point planes
+// As PFM stores its lines bottom to top, it is written line by line rather than with a single write
+flare16x_error flare16x_export_floats(FILE* file, uint8_t format, uint16_t width, uint16_t height,
+        const float* data);
+
+#endif //FLARE16X_EXPORT_H
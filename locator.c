@@ -12,12 +12,12 @@
 
 #include "canvas.h"
 #include "bitmap.h"
+#include "profile.h"
 
 #include "locator.h"
 
-// Cuts the input image into the IR image and text and initializes the locator
-// Will overwrite any existing state and WILL leak memory if a previous state is re-used
-flare16x_error flare16x_locator_create(flare16x_bitmap* screenshot, flare16x_locator* locator)
+// Implements flare16x_locator_create without profiling
+static flare16x_error flare16x_locator_create_untimed(flare16x_bitmap* screenshot, flare16x_locator* locator)
 {
     // Make sure the screenshot and locator are not null
     if (screenshot == NULL || locator == NULL || screenshot->dib == NULL)
@@ -70,8 +70,91 @@ flare16x_error flare16x_locator_create(flare16x_bitmap* screenshot, flare16x_loc
     return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_LOCATOR);
 }
 
-// Attempts to identify the model of the device and locate the crosshair
-flare16x_error flare16x_locator_process(flare16x_locator* locator)
+// Cuts the input image into the IR image and text and initializes the locator
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_locator_create(flare16x_bitmap* screenshot, flare16x_locator* locator)
+{
+    // Time the whole creation, if profiling is enabled
+    uint64_t start = flare16x_profile_begin();
+    flare16x_error error = flare16x_locator_create_untimed(screenshot, locator);
+    flare16x_profile_end(FLARE16X_PROFILE_LOCATOR_CREATE, start);
+    return error;
+}
+
+// Implements flare16x_locator_load without profiling
+static flare16x_error flare16x_locator_load_untimed(FILE* screenshot_file, flare16x_locator* locator)
+{
+    // Make sure the file and locator are not null
+    if (screenshot_file == NULL || locator == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_LOCATOR);
+
+    // Zero the locator struct
+    memset(locator, 0, sizeof(flare16x_locator));
+
+    // Load and validate the bitmap headers only
+    flare16x_bitmap screenshot;
+    flare16x_error error = flare16x_bitmap_load_header(screenshot_file, &screenshot);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return flare16x_error_wrap(flare16x_error_make(FLARE16X_ERROR_CALLEE, FLARE16X_ERROR_SOURCE_LOCATOR),
+                error);
+
+    // Check, if the size of the bitmap matches
+    if (screenshot.dib->width != FLARE16X_LOCATOR_EXPECTED_WIDTH ||
+        abs(screenshot.dib->height) != FLARE16X_LOCATOR_EXPECTED_HEIGHT)
+    {
+        flare16x_bitmap_destroy(&screenshot);
+        return flare16x_error_make(FLARE16X_ERROR_IMAGE, FLARE16X_ERROR_SOURCE_LOCATOR);
+    }
+
+    // Allocate storage for the two canvas structs
+    locator->text_canvas = malloc(sizeof(flare16x_canvas));
+    locator->ir_canvas = malloc(sizeof(flare16x_canvas));
+    if (locator->text_canvas == NULL || locator->ir_canvas == NULL)
+    {
+        free(locator->text_canvas);
+        free(locator->ir_canvas);
+        locator->text_canvas = NULL;
+        locator->ir_canvas = NULL;
+        flare16x_bitmap_destroy(&screenshot);
+        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_LOCATOR);
+    }
+    memset(locator->text_canvas, 0, sizeof(flare16x_canvas));
+    memset(locator->ir_canvas, 0, sizeof(flare16x_canvas));
+
+    // Read the text region and the IR region, skipping the rest of the screenshot
+    error = flare16x_bitmap_read_region(&screenshot, screenshot_file, FLARE16X_LOCATOR_TEXT_OFFSET_X,
+            FLARE16X_LOCATOR_TEXT_OFFSET_Y, FLARE16X_LOCATOR_TEXT_WIDTH, FLARE16X_LOCATOR_TEXT_HEIGHT,
+            locator->text_canvas);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_bitmap_read_region(&screenshot, screenshot_file, FLARE16X_LOCATOR_IR_OFFSET_X,
+                FLARE16X_LOCATOR_IR_OFFSET_Y, FLARE16X_LOCATOR_IR_WIDTH, FLARE16X_LOCATOR_IR_HEIGHT,
+                locator->ir_canvas);
+
+    // The headers are not needed anymore
+    flare16x_bitmap_destroy(&screenshot);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+    {
+        flare16x_locator_destroy(locator);
+        return flare16x_error_wrap(flare16x_error_make(FLARE16X_ERROR_CALLEE, FLARE16X_ERROR_SOURCE_LOCATOR),
+                error);
+    }
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_LOCATOR);
+}
+
+// Reads only the IR image and text regions of a screenshot file and initializes the locator
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_locator_load(FILE* screenshot_file, flare16x_locator* locator)
+{
+    // Time the whole load, if profiling is enabled
+    uint64_t start = flare16x_profile_begin();
+    flare16x_error error = flare16x_locator_load_untimed(screenshot_file, locator);
+    flare16x_profile_end(FLARE16X_PROFILE_LOCATOR_LOAD, start);
+    return error;
+}
+
+// Implements flare16x_locator_process without profiling
+static flare16x_error flare16x_locator_process_untimed(flare16x_locator* locator)
 {
     // Make sure the locator and its pointers are not null
     if (locator == NULL || locator->text_canvas == NULL || locator->ir_canvas == NULL ||
@@ -85,6 +168,36 @@ flare16x_error flare16x_locator_process(flare16x_locator* locator)
         locator->ir_canvas->height != FLARE16X_LOCATOR_IR_HEIGHT)
         return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_LOCATOR);
 
+    // Scan through the image line by line until the crosshair pattern is found
+    int y;
+    for (y = 0; y < locator->ir_canvas->height; y++)
+        if (flare16x_error_reason(flare16x_locator_scan(&flare16x_canvas_raw(0, y, locator->ir_canvas),
+                locator->ir_canvas->width, y, locator)) == FLARE16X_ERROR_NONE)
+            return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_LOCATOR);
+
+    // No pattern was found, but the image is still valid
+    locator->device_model = FLARE16X_LOCATOR_MODEL_UNKNOWN;
+    return flare16x_error_make(FLARE16X_ERROR_IMAGE, FLARE16X_ERROR_SOURCE_LOCATOR);
+}
+
+// Attempts to identify the model of the device and locate the crosshair
+flare16x_error flare16x_locator_process(flare16x_locator* locator)
+{
+    // Time the whole search, if profiling is enabled
+    uint64_t start = flare16x_profile_begin();
+    flare16x_error error = flare16x_locator_process_untimed(locator);
+    flare16x_profile_end(FLARE16X_PROFILE_LOCATOR_PROCESS, start);
+    return error;
+}
+
+// Searches a single line of the IR image for the crosshair pattern and fills in the locator on a match
+// This does not touch the canvas pointers of the locator, so it can also be used on streamed lines
+flare16x_error flare16x_locator_scan(const uint16_t* row, uint16_t width, uint16_t y, flare16x_locator* locator)
+{
+    // Make sure the row and locator are not null
+    if (row == NULL || locator == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_LOCATOR);
+
     // Fetch the minimum expected border and fill
     int expected_border = FLARE16X_LOCATOR_CROSSHAIR_BORDER_WIDTH,
         expected_fill = FLARE16X_LOCATOR_TG165_FILL_WIDTH;
@@ -93,164 +206,160 @@ flare16x_error flare16x_locator_process(flare16x_locator* locator)
     // Duplicate the expected fill, since there are two fill regions in the search line
     expected_fill *= 2;
 
-    // Scan through the image line by line and count the border and fill pixels
-    int x, y, actual_border = 0, actual_fill = 0, actual_eye = 0;
-    for (y = 0; y < locator->ir_canvas->height; y++, actual_border = 0, actual_fill = 0)
-        for (x = 0; x < locator->ir_canvas->width; x++)
+    // Count the border and fill pixels first, as only lines that reach the criteria can contain the crosshair
+    int x, actual_border = 0, actual_fill = 0, actual_eye = 0;
+    for (x = 0; x < width && (actual_border < expected_border || actual_fill < expected_fill); x++)
+    {
+        // Check the pixel and increment the correct counters
+        if (row[x] == FLARE16X_LOCATOR_CROSSHAIR_BORDER)
+            actual_border++;
+        else if (row[x] == FLARE16X_LOCATOR_CROSSHAIR_FILL)
+            actual_fill++;
+    }
+
+    // Check, if the line reaches or exceeds the criteria
+    if (actual_border < expected_border || actual_fill < expected_fill)
+        return flare16x_error_make(FLARE16X_ERROR_IMAGE, FLARE16X_ERROR_SOURCE_LOCATOR);
+
+    // Count the line as rescanned for the profile
+    flare16x_profile_count(FLARE16X_PROFILE_LOCATOR_RESCANS, 1);
+
+    // Reset the counters
+    actual_border = 0, actual_fill = 0;
+    uint16_t pixel;
+
+    // Keep track of the state
+    int state = FLARE16X_LOCATOR_STATE_START;
+
+    // Start scanning the line again and search for the pattern
+    for (x = 0; x < width; x++)
+    {
+        // First, the pixel has to be fetched
+        pixel = row[x];
+
+        switch (pixel)
         {
-            // Fetch the pixel
-            uint16_t pixel = flare16x_canvas_raw(x, y, locator->ir_canvas);
-
-            // Check the pixel and increment the correct counters
-            if (pixel == FLARE16X_LOCATOR_CROSSHAIR_BORDER)
-                actual_border++;
-            else if (pixel == FLARE16X_LOCATOR_CROSSHAIR_FILL)
-                actual_fill++;
-
-            // Check, if the line reaches or exceeds the criteria
-            if (actual_border >= expected_border && actual_fill >= expected_fill)
-            {
-                // Stop scanning this line and reset the counters
-                actual_border = 0, actual_fill = 0, actual_eye = 0;
-
-                // Keep track of the state
-                int state = FLARE16X_LOCATOR_STATE_START;
-
-                // Start scanning the line again and search for the pattern
-                for (x = 0; x < locator->ir_canvas->width; x++)
+            case FLARE16X_LOCATOR_CROSSHAIR_BORDER:
+                // For border pixels, check the state
+                if (state == FLARE16X_LOCATOR_STATE_FILL_1 && actual_border == 1 &&
+                  (actual_fill == FLARE16X_LOCATOR_TG165_FILL_WIDTH ||
+                   actual_fill == FLARE16X_LOCATOR_TG167_FILL_WIDTH))
+                {
+                    // FILL_1 -> BORDER_2
+                    state = FLARE16X_LOCATOR_STATE_BORDER_2;
+                    actual_border++;
+                } else if (state == FLARE16X_LOCATOR_STATE_EYE && actual_border == 2 &&
+                            (actual_eye == FLARE16X_LOCATOR_TG165_CENTER_WIDTH ||
+                            actual_eye == FLARE16X_LOCATOR_TG167_CENTER_WIDTH))
                 {
-                    // First, the pixel has to be fetched
-                    pixel = flare16x_canvas_raw(x, y, locator->ir_canvas);
-
-                    switch (pixel)
-                    {
-                        case FLARE16X_LOCATOR_CROSSHAIR_BORDER:
-                            // For border pixels, check the state
-                            if (state == FLARE16X_LOCATOR_STATE_FILL_1 && actual_border == 1 &&
-                              (actual_fill == FLARE16X_LOCATOR_TG165_FILL_WIDTH ||
-                               actual_fill == FLARE16X_LOCATOR_TG167_FILL_WIDTH))
-                            {
-                                // FILL_1 -> BORDER_2
-                                state = FLARE16X_LOCATOR_STATE_BORDER_2;
-                                actual_border++;
-                            } else if (state == FLARE16X_LOCATOR_STATE_EYE && actual_border == 2 &&
-                                        (actual_eye == FLARE16X_LOCATOR_TG165_CENTER_WIDTH ||
-                                        actual_eye == FLARE16X_LOCATOR_TG167_CENTER_WIDTH))
-                            {
-                                // EYE -> BORDER_3
-                                state = FLARE16X_LOCATOR_STATE_BORDER_3;
-                                actual_border++;
-                            } else if (state == FLARE16X_LOCATOR_STATE_FILL_2 && actual_border == 3 &&
-                                     (actual_fill == FLARE16X_LOCATOR_TG165_FILL_WIDTH * 2 ||
-                                      actual_fill == FLARE16X_LOCATOR_TG167_FILL_WIDTH * 2))
-                            {
-                                // FILL_2 -> BORDER_4
-                                state = FLARE16X_LOCATOR_STATE_BORDER_4;
-                                actual_border++;
-                            } else
-                            {
-                                // START or any other reset condition -> BORDER_1
-                                state = FLARE16X_LOCATOR_STATE_BORDER_1;
-                                actual_border = 1, actual_fill = 0, actual_eye = 0;
-                            }
-                            break;
-                        case FLARE16X_LOCATOR_CROSSHAIR_FILL:
-                            // For fill pixels, check the state
-                            if (state == FLARE16X_LOCATOR_STATE_BORDER_1 && actual_border == 1)
-                            {
-                                // BORDER_1 -> FILL_1
-                                state = FLARE16X_LOCATOR_STATE_FILL_1;
-                                actual_fill++;
-                            } else if (state == FLARE16X_LOCATOR_STATE_BORDER_3 && actual_border == 3)
-                            {
-                                // BORDER_3 -> FILL_2
-                                state = FLARE16X_LOCATOR_STATE_FILL_2;
-                                actual_fill++;
-                            } else if (state == FLARE16X_LOCATOR_STATE_FILL_1 ||
-                                        state == FLARE16X_LOCATOR_STATE_FILL_2)
-                                actual_fill++;
-                            else
-                            {
-                                // Any reset condition -> START
-                                state = FLARE16X_LOCATOR_STATE_START;
-                                actual_border = 0, actual_fill = 0, actual_eye = 0;
-                            }
-                            break;
-                        default:
-                            // For other pixels, check the state
-                            if (state == FLARE16X_LOCATOR_STATE_BORDER_2 && actual_border == 2)
-                            {
-                                // BORDER_2 -> EYE
-                                state = FLARE16X_LOCATOR_STATE_EYE;
-                                actual_eye++;
-                            } else if (state == FLARE16X_LOCATOR_STATE_EYE)
-                                actual_eye++;
-                            else
-                            {
-                                // Any reset condition -> START
-                                state = FLARE16X_LOCATOR_STATE_START;
-                                actual_border = 0, actual_fill = 0, actual_eye = 0;
-                            }
-                            break;
-                    }
-
-                    // Check, if the border is finished
-                    if (actual_border != FLARE16X_LOCATOR_CROSSHAIR_BORDER_WIDTH)
-                        continue;
-
-                    // Now, try to determine a device model
-                    if (actual_fill == FLARE16X_LOCATOR_TG165_FILL_WIDTH * 2 &&
-                        actual_eye == FLARE16X_LOCATOR_TG165_CENTER_WIDTH)
-                    {
-                        // The device is a TG165
-                        locator->device_model = FLARE16X_LOCATOR_MODEL_TG165;
-
-                        // Set up the dimensions of the aperture and crosshair
-                        locator->aperture_height = FLARE16X_LOCATOR_TG165_CENTER_HEIGHT;
-                        locator->aperture_width = FLARE16X_LOCATOR_TG165_CENTER_WIDTH;
-                        locator->crosshair_height = FLARE16X_LOCATOR_TG165_CROSSHAIR_HEIGHT;
-                        locator->crosshair_width = FLARE16X_LOCATOR_CROSSHAIR_BORDER_WIDTH +
-                                FLARE16X_LOCATOR_TG165_CENTER_WIDTH + FLARE16X_LOCATOR_TG165_FILL_WIDTH * 2;
-
-                        // Calculate the positions of the crosshair and aperture
-                        locator->crosshair_x = x + 1 - locator->crosshair_width;
-                        locator->crosshair_y = y - FLARE16X_LOCATOR_TG165_TARGET_ROW;
-                        locator->aperture_x = locator->crosshair_x + FLARE16X_LOCATOR_TG165_CENTER_OFFSET_X;
-                        locator->aperture_y = locator->crosshair_y + FLARE16X_LOCATOR_TG165_CENTER_OFFSET_Y;
-
-                    } else if (actual_fill == FLARE16X_LOCATOR_TG167_FILL_WIDTH * 2 &&
-                            actual_eye == FLARE16X_LOCATOR_TG167_CENTER_WIDTH)
-                    {
-                        // The device is a TG167
-                        locator->device_model = FLARE16X_LOCATOR_MODEL_TG167;
-
-                        // Set up the dimensions of the aperture and crosshair
-                        locator->aperture_height = FLARE16X_LOCATOR_TG167_CENTER_HEIGHT;
-                        locator->aperture_width = FLARE16X_LOCATOR_TG167_CENTER_WIDTH;
-                        locator->crosshair_height = FLARE16X_LOCATOR_TG167_CROSSHAIR_HEIGHT;
-                        locator->crosshair_width = FLARE16X_LOCATOR_CROSSHAIR_BORDER_WIDTH +
-                                FLARE16X_LOCATOR_TG167_CENTER_WIDTH + FLARE16X_LOCATOR_TG167_FILL_WIDTH * 2;
-
-                        // Calculate the positions of the crosshair and aperture
-                        locator->crosshair_x = x + 1 - locator->crosshair_width;
-                        locator->crosshair_y = y - FLARE16X_LOCATOR_TG167_TARGET_ROW;
-                        locator->aperture_x = locator->crosshair_x + FLARE16X_LOCATOR_TG167_CENTER_OFFSET_X;
-                        locator->aperture_y = locator->crosshair_y + FLARE16X_LOCATOR_TG167_CENTER_OFFSET_Y;
-
-                    } else
-                        continue;
-
-                    // And return success
-                    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_LOCATOR);
+                    // EYE -> BORDER_3
+                    state = FLARE16X_LOCATOR_STATE_BORDER_3;
+                    actual_border++;
+                } else if (state == FLARE16X_LOCATOR_STATE_FILL_2 && actual_border == 3 &&
+                         (actual_fill == FLARE16X_LOCATOR_TG165_FILL_WIDTH * 2 ||
+                          actual_fill == FLARE16X_LOCATOR_TG167_FILL_WIDTH * 2))
+                {
+                    // FILL_2 -> BORDER_4
+                    state = FLARE16X_LOCATOR_STATE_BORDER_4;
+                    actual_border++;
+                } else
+                {
+                    // START or any other reset condition -> BORDER_1
+                    state = FLARE16X_LOCATOR_STATE_BORDER_1;
+                    actual_border = 1, actual_fill = 0, actual_eye = 0;
+                }
+                break;
+            case FLARE16X_LOCATOR_CROSSHAIR_FILL:
+                // For fill pixels, check the state
+                if (state == FLARE16X_LOCATOR_STATE_BORDER_1 && actual_border == 1)
+                {
+                    // BORDER_1 -> FILL_1
+                    state = FLARE16X_LOCATOR_STATE_FILL_1;
+                    actual_fill++;
+                } else if (state == FLARE16X_LOCATOR_STATE_BORDER_3 && actual_border == 3)
+                {
+                    // BORDER_3 -> FILL_2
+                    state = FLARE16X_LOCATOR_STATE_FILL_2;
+                    actual_fill++;
+                } else if (state == FLARE16X_LOCATOR_STATE_FILL_1 ||
+                            state == FLARE16X_LOCATOR_STATE_FILL_2)
+                    actual_fill++;
+                else
+                {
+                    // Any reset condition -> START
+                    state = FLARE16X_LOCATOR_STATE_START;
+                    actual_border = 0, actual_fill = 0, actual_eye = 0;
+                }
+                break;
+            default:
+                // For other pixels, check the state
+                if (state == FLARE16X_LOCATOR_STATE_BORDER_2 && actual_border == 2)
+                {
+                    // BORDER_2 -> EYE
+                    state = FLARE16X_LOCATOR_STATE_EYE;
+                    actual_eye++;
+                } else if (state == FLARE16X_LOCATOR_STATE_EYE)
+                    actual_eye++;
+                else
+                {
+                    // Any reset condition -> START
+                    state = FLARE16X_LOCATOR_STATE_START;
+                    actual_border = 0, actual_fill = 0, actual_eye = 0;
                 }
-
-                // If the line does not contain the desired pattern, jump to the next one
                 break;
-            }
         }
 
-    // No pattern was found, but the image is still valid
-    locator->device_model = FLARE16X_LOCATOR_MODEL_UNKNOWN;
+        // Check, if the border is finished
+        if (actual_border != FLARE16X_LOCATOR_CROSSHAIR_BORDER_WIDTH)
+            continue;
+
+        // Now, try to determine a device model
+        if (actual_fill == FLARE16X_LOCATOR_TG165_FILL_WIDTH * 2 &&
+            actual_eye == FLARE16X_LOCATOR_TG165_CENTER_WIDTH)
+        {
+            // The device is a TG165
+            locator->device_model = FLARE16X_LOCATOR_MODEL_TG165;
+
+            // Set up the dimensions of the aperture and crosshair
+            locator->aperture_height = FLARE16X_LOCATOR_TG165_CENTER_HEIGHT;
+            locator->aperture_width = FLARE16X_LOCATOR_TG165_CENTER_WIDTH;
+            locator->crosshair_height = FLARE16X_LOCATOR_TG165_CROSSHAIR_HEIGHT;
+            locator->crosshair_width = FLARE16X_LOCATOR_CROSSHAIR_BORDER_WIDTH +
+                    FLARE16X_LOCATOR_TG165_CENTER_WIDTH + FLARE16X_LOCATOR_TG165_FILL_WIDTH * 2;
+
+            // Calculate the positions of the crosshair and aperture
+            locator->crosshair_x = x + 1 - locator->crosshair_width;
+            locator->crosshair_y = y - FLARE16X_LOCATOR_TG165_TARGET_ROW;
+            locator->aperture_x = locator->crosshair_x + FLARE16X_LOCATOR_TG165_CENTER_OFFSET_X;
+            locator->aperture_y = locator->crosshair_y + FLARE16X_LOCATOR_TG165_CENTER_OFFSET_Y;
+
+        } else if (actual_fill == FLARE16X_LOCATOR_TG167_FILL_WIDTH * 2 &&
+                actual_eye == FLARE16X_LOCATOR_TG167_CENTER_WIDTH)
+        {
+            // The device is a TG167
+            locator->device_model = FLARE16X_LOCATOR_MODEL_TG167;
+
+            // Set up the dimensions of the aperture and crosshair
+            locator->aperture_height = FLARE16X_LOCATOR_TG167_CENTER_HEIGHT;
+            locator->aperture_width = FLARE16X_LOCATOR_TG167_CENTER_WIDTH;
+            locator->crosshair_height = FLARE16X_LOCATOR_TG167_CROSSHAIR_HEIGHT;
+            locator->crosshair_width = FLARE16X_LOCATOR_CROSSHAIR_BORDER_WIDTH +
+                    FLARE16X_LOCATOR_TG167_CENTER_WIDTH + FLARE16X_LOCATOR_TG167_FILL_WIDTH * 2;
+
+            // Calculate the positions of the crosshair and aperture
+            locator->crosshair_x = x + 1 - locator->crosshair_width;
+            locator->crosshair_y = y - FLARE16X_LOCATOR_TG167_TARGET_ROW;
+            locator->aperture_x = locator->crosshair_x + FLARE16X_LOCATOR_TG167_CENTER_OFFSET_X;
+            locator->aperture_y = locator->crosshair_y + FLARE16X_LOCATOR_TG167_CENTER_OFFSET_Y;
+
+        } else
+            continue;
+
+        // And return success
+        return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_LOCATOR);
+    }
+
+    // The line does not contain the desired pattern
     return flare16x_error_make(FLARE16X_ERROR_IMAGE, FLARE16X_ERROR_SOURCE_LOCATOR);
 }
 
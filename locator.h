@@ -10,6 +10,7 @@
 #define FLARE16X_LOCATOR_H
 
 #include <stdint.h>
+#include <stdio.h>
 
 #include "error.h"
 #include "canvas.h"
@@ -183,9 +184,17 @@ typedef struct {
 // Will overwrite any existing state and WILL leak memory if a previous state is re-used
 flare16x_error flare16x_locator_create(flare16x_bitmap* screenshot, flare16x_locator* locator);
 
+// Reads only the IR image and text regions of a screenshot file and initializes the locator
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_locator_load(FILE* screenshot_file, flare16x_locator* locator);
+
 // Attempts to identify the model of the device and locate the crosshair
 flare16x_error flare16x_locator_process(flare16x_locator* locator);
 
+// Searches a single line of the IR image for the crosshair pattern and fills in the locator on a match
+// This does not touch the canvas pointers of the locator, so it can also be used on streamed lines
+flare16x_error flare16x_locator_scan(const uint16_t* row, uint16_t width, uint16_t y, flare16x_locator* locator);
+
 // Detects the crosshair state of a particular pixel
 uint8_t flare16x_locator_detect(flare16x_locator* locator, uint16_t x, uint16_t y);
 
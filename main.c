@@ -3,98 +3,1553 @@
 // Developed 2019 by Benedikt Muessig <github@bmuessig.eu>
 // Licensed under GPLv3
 //
-// main.c: Application entry point
+// main.c: Command line batch processing tool
 //
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
 #include "error.h"
 #include "bitmap.h"
 #include "canvas.h"
-#include "ocr.h"
 #include "locator.h"
 #include "palettes.h"
 #include "thermal.h"
+#include "stream.h"
+#include "container.h"
+#include "sequence.h"
+#include "series.h"
+#include "export.h"
+#include "codec.h"
+#include "profile.h"
 
-int main() {
-    flare16x_error test = FLARE16X_ERROR_NONE;
-    printf("Error: %s\n", flare16x_error_string(test));
-    flare16x_error_push(FLARE16X_ERROR_IO, &test);
-    flare16x_error_push(FLARE16X_ERROR_ASSERT, &test);
-    printf("Error: %s\n", flare16x_error_string(test));
-    printf("Error: %s\n", flare16x_error_string(flare16x_error_first(test)));
-
-    flare16x_bitmap bmp;
-    //FILE* sample_img = fopen("/home/benedikt/Desktop/7/Image/FLIR00087.bmp", "r");
-    //FILE* sample_img = fopen("/home/benedikt/Desktop/7/Image/FLIR00086.bmp", "r");
-    //FILE* sample_img = fopen("/home/benedikt/Desktop/7/Image/FLIR00080.bmp", "r");
-    //FILE* sample_img = fopen("/home/benedikt/img.bmp", "r");
-    FILE* sample_img = fopen("/home/benedikt/tg165_cs.bmp", "r");
-    FILE* out_file = fopen("/home/benedikt/Desktop/test.bmp", "w");
-    FILE* out_file2 = fopen("/home/benedikt/Desktop/test2.bmp", "w");
-    if (sample_img == NULL || out_file == NULL || out_file2 == NULL)
-        return 1;
+// The operation modes of the tool
+enum {
+    // Converts the thermal image to another palette and stores it as bitmap
+    FLARE16X_CLI_MODE_RECOLOR,
+    // Processes the image and prints the statistics only
+    FLARE16X_CLI_MODE_STATS,
+    // Processes the image and stores the raw thermal points
+    FLARE16X_CLI_MODE_DUMP,
+    // Only reads the OSD text of the image
+    FLARE16X_CLI_MODE_PROBE,
+    // Compresses the screenshot losslessly
+    FLARE16X_CLI_MODE_PACK,
+    // Restores a compressed screenshot
+    FLARE16X_CLI_MODE_UNPACK,
+    // Processes the images of a static scene and stores the mean and variance of their values
+    FLARE16X_CLI_MODE_AVERAGE,
+    // Processes the images of a burst and stores their thermal data with the crosshairs filled from each other
+    FLARE16X_CLI_MODE_BURST,
+    // Processes the images of a sequence and stores their thermal data on a common scale
+    FLARE16X_CLI_MODE_NORMALIZE
+};
 
-    printf("Loading: %s\n", flare16x_error_string(flare16x_bitmap_load(sample_img, &bmp)));
+// The report formats of the tool
+enum {
+    FLARE16X_CLI_FORMAT_CSV,
+    FLARE16X_CLI_FORMAT_JSON
+};
 
-    flare16x_locator locator;
-    printf("Locator init: %s\n", flare16x_error_string(flare16x_locator_create(&bmp, &locator)));
-    printf("Locator run: %s\n", flare16x_error_string(flare16x_locator_process(&locator)));
+// The dump formats of the tool
+enum {
+    // The thermal points as stored in memory
+    FLARE16X_CLI_DUMP_POINTS,
+    // Separate value, uncertainty and mask planes as NumPy arrays
+    FLARE16X_CLI_DUMP_NPY,
+    // Separate headerless value, uncertainty and mask planes
+    FLARE16X_CLI_DUMP_RAW,
+    // Separate value, uncertainty and mask planes as graymaps
+    FLARE16X_CLI_DUMP_PGM
+};
+
+// The pipeline stages that are timed
+enum {
+    FLARE16X_CLI_STAGE_LOAD,
+    FLARE16X_CLI_STAGE_LOCATE,
+    FLARE16X_CLI_STAGE_CREATE,
+    FLARE16X_CLI_STAGE_OCR,
+    FLARE16X_CLI_STAGE_PROCESS,
+    FLARE16X_CLI_STAGE_STORE,
+    FLARE16X_CLI_STAGE_RECOLOR,
+    FLARE16X_CLI_STAGE_CODEC,
+    FLARE16X_CLI_STAGE_FILL,
+    FLARE16X_CLI_STAGE_NORMALIZE,
+    FLARE16X_CLI_STAGE_COUNT
+};
+
+// The names of the pipeline stages
+static const char* const flare16x_cli_stage_names[FLARE16X_CLI_STAGE_COUNT] = {
+    "load",
+    "locate",
+    "create",
+    "ocr",
+    "process",
+    "store",
+    "recolor",
+    "codec",
+    "fill",
+    "normalize"
+};
+
+// A named enum value used to parse the command line
+typedef struct {
+    const char* name;
+    uint8_t value;
+} flare16x_cli_name;
+
+// The names of the modes
+static const flare16x_cli_name flare16x_cli_modes[] = {
+    {"recolor", FLARE16X_CLI_MODE_RECOLOR},
+    {"stats", FLARE16X_CLI_MODE_STATS},
+    {"dump", FLARE16X_CLI_MODE_DUMP},
+    {"probe", FLARE16X_CLI_MODE_PROBE},
+    {"pack", FLARE16X_CLI_MODE_PACK},
+    {"unpack", FLARE16X_CLI_MODE_UNPACK},
+    {"average", FLARE16X_CLI_MODE_AVERAGE},
+    {"burst", FLARE16X_CLI_MODE_BURST},
+    {"normalize", FLARE16X_CLI_MODE_NORMALIZE},
+    {NULL, 0}
+};
+
+// The names of the report formats
+static const flare16x_cli_name flare16x_cli_formats[] = {
+    {"csv", FLARE16X_CLI_FORMAT_CSV},
+    {"json", FLARE16X_CLI_FORMAT_JSON},
+    {NULL, 0}
+};
+
+// The names of the dump formats
+static const flare16x_cli_name flare16x_cli_dumps[] = {
+    {"points", FLARE16X_CLI_DUMP_POINTS},
+    {"npy", FLARE16X_CLI_DUMP_NPY},
+    {"raw", FLARE16X_CLI_DUMP_RAW},
+    {"pgm", FLARE16X_CLI_DUMP_PGM},
+    {NULL, 0}
+};
 
+// The names of the palettes
+static const flare16x_cli_name flare16x_cli_palettes[] = {
+    {"iron", FLARE16X_PALETTES_IRON},
+    {"grayscale", FLARE16X_PALETTES_GRAYSCALE},
+    {"rainbow", FLARE16X_PALETTES_RAINBOW},
+    {NULL, 0}
+};
+
+// The names of the interpolation modes
+static const flare16x_cli_name flare16x_cli_interpolations[] = {
+    {"zero", FLARE16X_THERMAL_INTERPOLATION_ZERO},
+    {"min", FLARE16X_THERMAL_INTERPOLATION_MIN},
+    {"med", FLARE16X_THERMAL_INTERPOLATION_MED},
+    {"max", FLARE16X_THERMAL_INTERPOLATION_MAX},
+    {"small", FLARE16X_THERMAL_INTERPOLATION_SQUARE_SMALL},
+    {"large", FLARE16X_THERMAL_INTERPOLATION_SQUARE_LARGE},
+    {"weight", FLARE16X_THERMAL_INTERPOLATION_SQUARE_WEIGHT},
+    {NULL, 0}
+};
+
+// The names of the quantification modes
+static const flare16x_cli_name flare16x_cli_quantifications[] = {
+    {"exact", FLARE16X_THERMAL_QUANTIFICATION_EXACT},
+    {"floor", FLARE16X_THERMAL_QUANTIFICATION_FLOOR},
+    {"ceiling", FLARE16X_THERMAL_QUANTIFICATION_CEILING},
+    {"high", FLARE16X_THERMAL_QUANTIFICATION_MEDIAN_HIGH},
+    {"low", FLARE16X_THERMAL_QUANTIFICATION_MEDIAN_LOW},
+    {NULL, 0}
+};
+
+// The names of the device models
+static const char* const flare16x_cli_models[] = {"tbd", "unknown", "TG165", "TG167"};
+
+// The options parsed from the command line
+typedef struct {
+    uint8_t mode;
+    uint8_t format;
+    uint8_t dump;
     uint8_t palette;
-    printf("Palette det: %s\n", flare16x_error_string(flare16x_palettes_determine(locator.ir_canvas,
-            FLARE16X_PALETTES_IGNORE_ERRORS, &palette)));
-    printf("Current palette: %d\n", palette);
+    uint8_t interpolation;
+    uint8_t quantification;
+    uint8_t crosshair;
+    uint8_t timing;
+    uint8_t verbose;
+    unsigned threads;
+    const char* output_directory;
+    const char* container_path;
+    const char* sequence_path;
+    const char* trace_path;
+    uint16_t interval;
+} flare16x_cli_options;
+
+// The result of processing a single file
+typedef struct {
+    // The input path
+    char* path;
+    // The path of an earlier input whose outputs have the same names or null, which fails storing the outputs
+    const char* collision;
+    // The resulting error and the stage it occurred in
+    flare16x_error error;
+    int stage;
+    // The values read from the image
+    uint8_t device_model;
+    uint8_t palette;
+    int16_t temperature_spot;
+    uint8_t emissivity;
+    uint16_t spot_x;
+    uint16_t spot_y;
+    uint16_t spot_width;
+    uint16_t spot_height;
+    uint8_t value_min;
+    uint8_t value_max;
+    uint16_t value_mean;
+    // The algorithm counters of the library while processing the file
+    uint64_t counters[FLARE16X_PROFILE_COUNTER_COUNT];
+    // Flags that indicate which values are valid
+    uint8_t has_spot;
+    uint8_t has_ocr;
+    uint8_t has_values;
+} flare16x_cli_result;
+
+// The accumulated stage timings
+typedef struct {
+    uint64_t nanoseconds[FLARE16X_CLI_STAGE_COUNT];
+    uint64_t calls[FLARE16X_CLI_STAGE_COUNT];
+    // The lookups and hits of the OSD text caches
+    uint64_t ocr_lookups;
+    uint64_t ocr_hits;
+    // The stages timed inside the library
+    flare16x_profile profile;
+} flare16x_cli_timing;
+
+// The shared state of all workers
+typedef struct {
+    const flare16x_cli_options* options;
+    flare16x_cli_result* results;
+    size_t count;
+    size_t next;
+    flare16x_cli_timing timing;
+    pthread_mutex_t lock;
+    // The container that collects the processed frames in input order, if enabled
+    flare16x_container_writer* container;
+    // The sequence that collects the processed frames in input order, if enabled
+    flare16x_sequence_writer* sequence;
+    // The index of the next input to store into the container and sequence
+    size_t store_next;
+    pthread_mutex_t store_lock;
+    pthread_cond_t store_turn;
+    // The accumulator that averages the processed frames, if enabled
+    flare16x_series_accumulator* accumulator;
+    pthread_mutex_t accumulator_lock;
+    // The processed frames of a burst or sequence, which are kept until all of them are available
+    flare16x_thermal* frames;
+} flare16x_cli_batch;
+
+// A growable list of input paths
+typedef struct {
+    char** paths;
+    size_t count;
+    size_t capacity;
+    // The extension of the files collected from directories
+    const char* extension;
+} flare16x_cli_list;
+
+// Returns the current monotonic time in nanoseconds
+static uint64_t flare16x_cli_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+// Adds the time passed since start to the stage and returns the current time
+// The stage is also added to the trace, if tracing is enabled
+static uint64_t flare16x_cli_lap(flare16x_cli_timing* timing, int stage, uint64_t start)
+{
+    uint64_t now = flare16x_cli_now();
+    timing->nanoseconds[stage] += now - start;
+    timing->calls[stage]++;
+    if (flare16x_profile_active & FLARE16X_PROFILE_TRACING)
+        flare16x_profile_trace(flare16x_cli_stage_names[stage], start, now, NULL, -1, -1);
+    return now;
+}
+
+// Looks up a name in a list of names and stores the matching value
+static int flare16x_cli_lookup(const flare16x_cli_name* names, const char* name, uint8_t* value)
+{
+    for (; names->name != NULL; names++)
+        if (strcmp(names->name, name) == 0)
+        {
+            *value = names->value;
+            return 1;
+        }
+
+    return 0;
+}
+
+// Parses a whole decimal number up to a maximum and returns 1 if it is valid
+static int flare16x_cli_number(const char* text, unsigned long maximum, unsigned long* value)
+{
+    char* end;
+    if (text[0] < '0' || text[0] > '9')
+        return 0;
+    errno = 0;
+    *value = strtoul(text, &end, 10);
+    return errno == 0 && *end == '\0' && *value <= maximum;
+}
+
+// Returns the name of a value from a list of names
+static const char* flare16x_cli_name_of(const flare16x_cli_name* names, uint8_t value)
+{
+    for (; names->name != NULL; names++)
+        if (names->value == value)
+            return names->name;
+
+    return "unknown";
+}
+
+// Appends a copy of the path to the list
+static int flare16x_cli_list_add(flare16x_cli_list* list, const char* path)
+{
+    // Grow the list, if required
+    if (list->count >= list->capacity)
+    {
+        size_t capacity = list->capacity ? list->capacity * 2 : 64;
+        char** paths = realloc(list->paths, capacity * sizeof(char*));
+        if (paths == NULL)
+            return 0;
+        list->paths = paths;
+        list->capacity = capacity;
+    }
+
+    // Copy the path
+    list->paths[list->count] = strdup(path);
+    if (list->paths[list->count] == NULL)
+        return 0;
+    list->count++;
+
+    return 1;
+}
+
+// Compares two paths for sorting
+static int flare16x_cli_list_compare(const void* a, const void* b)
+{
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+// Adds a file or all bitmaps contained in a directory to the list
+static int flare16x_cli_list_input(flare16x_cli_list* list, const char* path)
+{
+    struct stat info;
+    if (stat(path, &info) != 0)
+    {
+        fprintf(stderr, "%s: no such file or directory\n", path);
+        return 0;
+    }
+
+    // Regular files are added as they are
+    if (!S_ISDIR(info.st_mode))
+        return flare16x_cli_list_add(list, path);
+
+    DIR* directory = opendir(path);
+    if (directory == NULL)
+    {
+        fprintf(stderr, "%s: cannot open directory\n", path);
+        return 0;
+    }
+
+    // Add all files ending in the extension in a stable order
+    size_t first = list->count;
+    struct dirent* entry;
+    while ((entry = readdir(directory)) != NULL)
+    {
+        size_t length = strlen(entry->d_name);
+        size_t extension_length = strlen(list->extension);
+        if (length <= extension_length ||
+            strcasecmp(entry->d_name + length - extension_length, list->extension) != 0)
+            continue;
+
+        char* entry_path = malloc(strlen(path) + length + 2);
+        if (entry_path == NULL)
+        {
+            closedir(directory);
+            return 0;
+        }
+        sprintf(entry_path, "%s/%s", path, entry->d_name);
+        int added = flare16x_cli_list_add(list, entry_path);
+        free(entry_path);
+        if (!added)
+        {
+            closedir(directory);
+            return 0;
+        }
+    }
+    closedir(directory);
+    qsort(list->paths + first, list->count - first, sizeof(char*), flare16x_cli_list_compare);
+
+    return 1;
+}
 
-    flare16x_canvas canvas;
-    printf("Editing: %s\n", flare16x_error_string(
-            flare16x_bitmap_edit(&bmp, 0, 0, 174, 40, &canvas)));
+// Reads a list of input paths from stdin, one per line
+static int flare16x_cli_list_stdin(flare16x_cli_list* list)
+{
+    char line[4096];
+    while (fgets(line, sizeof(line), stdin) != NULL)
+    {
+        // Strip the line ending
+        size_t length = strcspn(line, "\r\n");
+        line[length] = 0;
+        if (length == 0)
+            continue;
 
-    char ocr1[10];
-    char ocr2[10];
-    printf("OCR: %s: %s\n", flare16x_error_string(
-            flare16x_ocr_large_string(2, 1, 0, 6, 1, &canvas, ocr1)), ocr1);
-    printf("OCR: %s: %s\n", flare16x_error_string(
-            flare16x_ocr_small_string(112, 4, 0, 6, 1, &canvas, ocr2)), ocr2);
+        if (!flare16x_cli_list_input(list, line))
+            return 0;
+    }
 
-    flare16x_bitmap bmp2;
-    flare16x_bitmap_create16(locator.ir_canvas->width, locator.ir_canvas->height, &bmp2);
-    flare16x_bitmap_merge(locator.ir_canvas, 0, 0, &bmp2);
+    return 1;
+}
 
-    printf("Writing: %s\n", flare16x_error_string(
-            flare16x_bitmap_store(&bmp2, out_file)));
+// Returns the file name of an input without its directory and extension and stores the length of the name
+static const char* flare16x_cli_output_name(const char* input, size_t* length)
+{
+    // Strip the input directory
+    const char* name = strrchr(input, '/');
+    name = name == NULL ? input : name + 1;
 
+    // Strip the input extension
+    const char* dot = strrchr(name, '.');
+    *length = dot == NULL ? strlen(name) : (size_t)(dot - name);
+
+    return name;
+}
+
+// Compares the output names of two inputs
+static int flare16x_cli_output_order(const flare16x_cli_result* first, const flare16x_cli_result* second)
+{
+    size_t first_length, second_length;
+    const char* first_name = flare16x_cli_output_name(first->path, &first_length);
+    const char* second_name = flare16x_cli_output_name(second->path, &second_length);
+    int order = memcmp(first_name, second_name, first_length < second_length ? first_length : second_length);
+    if (order == 0)
+        order = first_length < second_length ? -1 : first_length > second_length;
+
+    return order;
+}
+
+// Compares the output names of two inputs for sorting, keeping inputs with the same name in input order
+static int flare16x_cli_output_compare(const void* a, const void* b)
+{
+    const flare16x_cli_result* first = *(const flare16x_cli_result* const*)a;
+    const flare16x_cli_result* second = *(const flare16x_cli_result* const*)b;
+    int order = flare16x_cli_output_order(first, second);
+    if (order == 0)
+        order = first < second ? -1 : first > second;
+
+    return order;
+}
+
+// Marks every input whose outputs would overwrite those of an earlier input with the same file name
+// Inputs from different directories can share a name, but all of their outputs are stored in one directory
+static int flare16x_cli_output_collisions(flare16x_cli_result* results, size_t count)
+{
+    flare16x_cli_result** sorted = malloc((count ? count : 1) * sizeof(flare16x_cli_result*));
+    if (sorted == NULL)
+        return 0;
+    size_t index, first = 0;
+    for (index = 0; index < count; index++)
+        sorted[index] = &results[index];
+    qsort(sorted, count, sizeof(flare16x_cli_result*), flare16x_cli_output_compare);
+
+    // Inputs with the same name are next to each other now and the first of them keeps its outputs
+    for (index = 1; index < count; index++)
+    {
+        if (flare16x_cli_output_order(sorted[first], sorted[index]) != 0)
+        {
+            first = index;
+            continue;
+        }
+        sorted[index]->collision = sorted[first]->path;
+        fprintf(stderr, "%s: same output name as %s\n", sorted[index]->path, sorted[first]->path);
+    }
+    free(sorted);
+
+    return 1;
+}
+
+// Builds an output path from the output directory, the input file name and a new extension
+static char* flare16x_cli_output_path(const char* directory, const char* input, const char* extension)
+{
+    size_t name_length;
+    const char* name = flare16x_cli_output_name(input, &name_length);
+
+    char* path = malloc(strlen(directory) + name_length + strlen(extension) + 2);
+    if (path == NULL)
+        return NULL;
+    sprintf(path, "%s/%.*s%s", directory, (int)name_length, name, extension);
+
+    return path;
+}
+
+// Stores one plane of a processed image next to the other outputs
+static flare16x_error flare16x_cli_dump_plane(const char* directory, const char* input, const char* extension,
+                                              uint8_t format, uint8_t plane, flare16x_thermal* thermal)
+{
+    char* path = flare16x_cli_output_path(directory, input, extension);
+    if (path == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_GLOBAL);
+    FILE* file = fopen(path, "wb");
+    free(path);
+    if (file == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_GLOBAL);
+
+    flare16x_error error = flare16x_export_plane(file, format, plane, thermal);
+    if (fclose(file) != 0 && flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_GLOBAL);
+
+    return error;
+}
+
+// Stores the raw thermal points (value and uncertainty pairs) or the separate value, uncertainty and mask planes
+static flare16x_error flare16x_cli_dump(const flare16x_cli_options* options, flare16x_thermal* thermal,
+                                        const flare16x_cli_result* result)
+{
+    static const char* const extensions[][FLARE16X_EXPORT_PLANE_MASK + 1] = {
+        {".value.npy", ".uncertainty.npy", ".mask.npy"},
+        {".value.raw", ".uncertainty.raw", ".mask.raw"},
+        {".value.pgm", ".uncertainty.pgm", ".mask.pgm"}
+    };
+    static const uint8_t formats[] = {FLARE16X_EXPORT_FORMAT_NPY, FLARE16X_EXPORT_FORMAT_RAW,
+                                      FLARE16X_EXPORT_FORMAT_PGM};
+
+    // Never overwrite the outputs of an earlier input with the same name
+    if (result->collision != NULL)
+        return flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_GLOBAL);
+
+    if (options->dump == FLARE16X_CLI_DUMP_POINTS)
+        return flare16x_cli_dump_plane(options->output_directory, result->path, ".raw", FLARE16X_EXPORT_FORMAT_RAW,
+                                       FLARE16X_EXPORT_PLANE_POINTS, thermal);
+
+    uint8_t plane;
+    for (plane = FLARE16X_EXPORT_PLANE_VALUE; plane <= FLARE16X_EXPORT_PLANE_MASK; plane++)
+    {
+        flare16x_error error = flare16x_cli_dump_plane(options->output_directory, result->path,
+                                                       extensions[options->dump - 1][plane],
+                                                       formats[options->dump - 1], plane, thermal);
+        if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+            return error;
+    }
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_GLOBAL);
+}
+
+// Stores a floating point plane in the output directory
+static flare16x_error flare16x_cli_store_floats(const char* directory, const char* name, const char* extension,
+                                                uint8_t format, uint16_t width, uint16_t height, const float* data)
+{
+    char* path = flare16x_cli_output_path(directory, name, extension);
+    if (path == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_GLOBAL);
+    FILE* file = fopen(path, "wb");
+    free(path);
+    if (file == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_GLOBAL);
+
+    flare16x_error error = flare16x_export_floats(file, format, width, height, data);
+    if (fclose(file) != 0 && flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_GLOBAL);
+
+    return error;
+}
+
+// Stores the mean values and their variances of the averaged frames as floating point planes
+// Graymaps are not available for floating point planes, so floatmaps are stored instead
+static flare16x_error flare16x_cli_average(const flare16x_cli_options* options,
+                                           flare16x_series_accumulator* accumulator)
+{
+    static const char* const extensions[][2] = {
+        {".value.npy", ".variance.npy"},
+        {".value.npy", ".variance.npy"},
+        {".value.raw", ".variance.raw"},
+        {".value.pfm", ".variance.pfm"}
+    };
+    static const uint8_t formats[] = {FLARE16X_EXPORT_FORMAT_NPY, FLARE16X_EXPORT_FORMAT_NPY,
+                                      FLARE16X_EXPORT_FORMAT_RAW, FLARE16X_EXPORT_FORMAT_PFM};
+
+    // Calculate the planes
+    size_t count = (size_t)accumulator->width * accumulator->height, point;
+    uint16_t* mean = malloc(count * sizeof(uint16_t));
+    float* planes = malloc(count * 2 * sizeof(float));
+    flare16x_error error = mean != NULL && planes != NULL ?
+            flare16x_series_accumulator_result(accumulator, mean, planes + count) :
+            flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_GLOBAL);
+
+    // Convert the fixed point mean values to floating point values
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        for (point = 0; point < count; point++)
+            planes[point] = (float)mean[point] / (float)(1 << FLARE16X_SERIES_MEAN_SHIFT);
+
+    // Then, store both of them
+    int plane;
+    for (plane = 0; plane < 2 && flare16x_error_reason(error) == FLARE16X_ERROR_NONE; plane++)
+        error = flare16x_cli_store_floats(options->output_directory, "average", extensions[options->dump][plane],
+                                          formats[options->dump], accumulator->width, accumulator->height,
+                                          planes + count * plane);
+
+    free(mean);
+    free(planes);
+    return error;
+}
+
+// Calculates the value statistics of a processed thermal image
+static void flare16x_cli_statistics(flare16x_thermal_image* image, flare16x_cli_result* result)
+{
+    uint32_t sum = 0, count = (uint32_t)image->width * image->height, point;
+    uint8_t value_min = 0xff, value_max = 0;
+    for (point = 0; point < count; point++)
+    {
+        uint8_t value = image->points[point].value;
+        sum += value;
+        if (value < value_min)
+            value_min = value;
+        if (value > value_max)
+            value_max = value;
+    }
+
+    result->value_min = value_min;
+    result->value_max = value_max;
+    result->value_mean = count > 0 ? (uint16_t)(sum / count) : 0;
+    result->has_values = 1;
+}
+
+// Runs the pipeline for a single file
+static void flare16x_cli_process(flare16x_cli_batch* batch, flare16x_thermal_ocr_cache* cache,
+                                 flare16x_cli_timing* timing, flare16x_cli_result* result)
+{
+    const flare16x_cli_options* options = batch->options;
+    flare16x_locator locator;
     flare16x_thermal thermal;
-    flare16x_canvas canvas2;
-    printf("Thermal init: %s\n", flare16x_error_string(flare16x_thermal_create(&locator, &thermal)));
-    printf("Thermal ocr: %s\n", flare16x_error_string(flare16x_thermal_ocr(&thermal)));
-    printf("Temperature: %d °C*10, Emissivity: 0.%d\n", thermal.temperature_spot, thermal.emissivity);
-    printf("Thermal process: %s\n", flare16x_error_string(flare16x_thermal_process(&thermal,
-            FLARE16X_THERMAL_INTERPOLATION_SQUARE_LARGE,
-            FLARE16X_THERMAL_QUANTIFICATION_MEDIAN_LOW)));
-    printf("Thermal export: %s\n", flare16x_error_string(flare16x_thermal_export(&thermal,
-            FLARE16X_PALETTES_IRON, &canvas2)));
-    printf("Thermal crosshair: %s\n", flare16x_error_string(flare16x_thermal_crosshair(
-            FLARE16X_LOCATOR_CROSSHAIR_BORDER, FLARE16X_LOCATOR_CROSSHAIR_FILL,
-            &thermal, &canvas2)));
-    printf("Thermal destroy: %s\n", flare16x_error_string(flare16x_thermal_destroy(&thermal)));
-
-    flare16x_bitmap bmp3;
-    flare16x_bitmap_create16(canvas2.width, canvas2.height, &bmp3);
-    flare16x_bitmap_merge(&canvas2, 0, 0, &bmp3);
-    printf("Writing: %s\n", flare16x_error_string(
-            flare16x_bitmap_store(&bmp3, out_file2)));
-    flare16x_canvas_destroy(&canvas2);
-    fclose(out_file2);
-    flare16x_bitmap_destroy(&bmp3);
-
-    fclose(sample_img);
-    fclose(out_file);
+    flare16x_error error;
+    uint64_t hash = 0;
+
+    memset(&locator, 0, sizeof(locator));
+    memset(&thermal, 0, sizeof(thermal));
+
+    // Load the text and IR regions of the screenshot
+    uint64_t start = flare16x_cli_now();
+    result->stage = FLARE16X_CLI_STAGE_LOAD;
+    FILE* file = fopen(result->path, "rb");
+    if (file == NULL)
+    {
+        error = flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_GLOBAL);
+        goto done;
+    }
+    error = batch->container != NULL ? flare16x_container_hash_file(file, &hash) :
+            flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_GLOBAL);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_locator_load(file, &locator);
+    fclose(file);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        goto done;
+    start = flare16x_cli_lap(timing, FLARE16X_CLI_STAGE_LOAD, start);
+
+    // Find the crosshair
+    result->stage = FLARE16X_CLI_STAGE_LOCATE;
+    error = flare16x_locator_process(&locator);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE &&
+        !(flare16x_error_reason(error) == FLARE16X_ERROR_IMAGE &&
+          locator.device_model == FLARE16X_LOCATOR_MODEL_UNKNOWN))
+        goto done;
+    start = flare16x_cli_lap(timing, FLARE16X_CLI_STAGE_LOCATE, start);
+
+    // Create the thermal context
+    result->stage = FLARE16X_CLI_STAGE_CREATE;
+    error = flare16x_thermal_create(&locator, &thermal);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        goto done;
+    result->device_model = thermal.device_model;
+    result->spot_x = thermal.spot_x;
+    result->spot_y = thermal.spot_y;
+    result->spot_width = thermal.spot_width;
+    result->spot_height = thermal.spot_height;
+    result->has_spot = 1;
+    start = flare16x_cli_lap(timing, FLARE16X_CLI_STAGE_CREATE, start);
+
+    // Read the OSD text
+    result->stage = FLARE16X_CLI_STAGE_OCR;
+    error = flare16x_thermal_ocr(&thermal, cache);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        goto done;
+    result->temperature_spot = thermal.temperature_spot;
+    result->emissivity = thermal.emissivity;
+    result->has_ocr = 1;
+    start = flare16x_cli_lap(timing, FLARE16X_CLI_STAGE_OCR, start);
+
+    // Convert the visible image into thermal data
+    result->stage = FLARE16X_CLI_STAGE_PROCESS;
+    error = flare16x_thermal_process(&thermal, options->interpolation, options->quantification);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        goto done;
+    result->palette = thermal.palette;
+    flare16x_cli_statistics(thermal.thermal_image, result);
+    start = flare16x_cli_lap(timing, FLARE16X_CLI_STAGE_PROCESS, start);
 
+    // Store the raw thermal points or planes
+    if (options->mode == FLARE16X_CLI_MODE_DUMP)
+    {
+        result->stage = FLARE16X_CLI_STAGE_STORE;
+        error = flare16x_cli_dump(options, &thermal, result);
+        if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+            goto done;
+        start = flare16x_cli_lap(timing, FLARE16X_CLI_STAGE_STORE, start);
+    }
+
+    // Add the frame to the average
+    if (batch->accumulator != NULL)
+    {
+        result->stage = FLARE16X_CLI_STAGE_STORE;
+        pthread_mutex_lock(&batch->accumulator_lock);
+        error = flare16x_series_accumulator_add(batch->accumulator, &thermal);
+        pthread_mutex_unlock(&batch->accumulator_lock);
+        if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+            goto done;
+        start = flare16x_cli_lap(timing, FLARE16X_CLI_STAGE_STORE, start);
+    }
+
+    // Keep the frame of a burst or sequence by moving it out of this context
+    if (batch->frames != NULL)
+    {
+        batch->frames[result - batch->results] = thermal;
+        memset(&thermal, 0, sizeof(thermal));
+    }
+
+done:
+    // Append the frame to the container and sequence once all previous inputs are done, skipping the failed ones
+    // This keeps both files in input order and thereby deterministic, no matter how many workers there are
+    if (batch->container != NULL || batch->sequence != NULL)
+    {
+        size_t index = (size_t)(result - batch->results);
+        pthread_mutex_lock(&batch->store_lock);
+        while (batch->store_next != index)
+            pthread_cond_wait(&batch->store_turn, &batch->store_lock);
+        if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE && batch->container != NULL)
+        {
+            result->stage = FLARE16X_CLI_STAGE_STORE;
+            error = flare16x_container_append(batch->container, result->path, hash, &thermal);
+        }
+        if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE && batch->sequence != NULL)
+        {
+            result->stage = FLARE16X_CLI_STAGE_STORE;
+            error = flare16x_sequence_append(batch->sequence, thermal.thermal_image);
+        }
+        batch->store_next++;
+        pthread_cond_broadcast(&batch->store_turn);
+        pthread_mutex_unlock(&batch->store_lock);
+        if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+            flare16x_cli_lap(timing, FLARE16X_CLI_STAGE_STORE, start);
+    }
+
+    result->error = error;
+    flare16x_thermal_destroy(&thermal);
     flare16x_locator_destroy(&locator);
-    flare16x_canvas_destroy(&canvas);
-    flare16x_bitmap_destroy(&bmp);
-    flare16x_bitmap_destroy(&bmp2);
+}
 
-    printf("Hello, World!\n");
-    return 0;
-}
\ No newline at end of file
+// Fills the crosshair of every frame of a burst from the other frames or normalizes the frames of a sequence
+// Then, the frames are stored like a dump
+static void flare16x_cli_series(flare16x_cli_batch* batch)
+{
+    const flare16x_cli_options* options = batch->options;
+
+    // Collect the successfully processed frames, keeping the failed ones as null pointers
+    flare16x_thermal** frames = calloc(batch->count ? batch->count : 1, sizeof(flare16x_thermal*));
+    flare16x_series_mapping* mappings = calloc(batch->count ? batch->count : 1, sizeof(flare16x_series_mapping));
+    flare16x_error error = frames != NULL && mappings != NULL ?
+            flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_GLOBAL) :
+            flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_GLOBAL);
+    size_t index;
+    for (index = 0; index < batch->count && frames != NULL; index++)
+        if (flare16x_error_reason(batch->results[index].error) == FLARE16X_ERROR_NONE)
+            frames[index] = &batch->frames[index];
+
+    // Relate all frames to a common scale and requantize them from it
+    if (options->mode == FLARE16X_CLI_MODE_NORMALIZE && flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+    {
+        flare16x_series_scale scale;
+        uint64_t start = flare16x_cli_now();
+        error = flare16x_series_normalize(frames, batch->count, FLARE16X_SERIES_RADIUS, mappings, &scale);
+        if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+            error = flare16x_series_remap(frames, batch->count, mappings, &scale);
+        if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+            flare16x_cli_lap(&batch->timing, FLARE16X_CLI_STAGE_NORMALIZE, start);
+        if (options->verbose && flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+            fprintf(stderr, "common scale: %.1f to %.1f%s\n", scale.minimum, scale.maximum,
+                    scale.absolute ? " degrees celsius" : " (relative)");
+    }
+
+    for (index = 0; index < batch->count; index++)
+    {
+        flare16x_cli_result* result = &batch->results[index];
+        if (flare16x_error_reason(result->error) != FLARE16X_ERROR_NONE)
+            continue;
+
+        // Frames that could not be related keep their own scale and are reported as failed
+        uint64_t start = flare16x_cli_now();
+        if (options->mode == FLARE16X_CLI_MODE_NORMALIZE)
+        {
+            result->stage = FLARE16X_CLI_STAGE_NORMALIZE;
+            result->error = flare16x_error_reason(error) != FLARE16X_ERROR_NONE || mappings[index].linked ? error :
+                    flare16x_error_make(FLARE16X_ERROR_IMAGE, FLARE16X_ERROR_SOURCE_SERIES);
+        }
+
+        // Fill the crosshair
+        else
+        {
+            result->stage = FLARE16X_CLI_STAGE_FILL;
+            result->error = flare16x_error_reason(error) != FLARE16X_ERROR_NONE ? error :
+                    flare16x_series_fill(&batch->frames[index], frames, batch->count, FLARE16X_SERIES_RADIUS, NULL);
+            if (flare16x_error_reason(result->error) == FLARE16X_ERROR_NONE)
+                start = flare16x_cli_lap(&batch->timing, FLARE16X_CLI_STAGE_FILL, start);
+        }
+        if (flare16x_error_reason(result->error) != FLARE16X_ERROR_NONE)
+            continue;
+        flare16x_cli_statistics(batch->frames[index].thermal_image, result);
+
+        // And store it like a dump
+        result->stage = FLARE16X_CLI_STAGE_STORE;
+        result->error = flare16x_cli_dump(options, &batch->frames[index], result);
+        if (flare16x_error_reason(result->error) == FLARE16X_ERROR_NONE)
+            flare16x_cli_lap(&batch->timing, FLARE16X_CLI_STAGE_STORE, start);
+    }
+
+    // The frames are only freed once all of them are done, as they serve as references for each other
+    for (index = 0; index < batch->count; index++)
+        flare16x_thermal_destroy(&batch->frames[index]);
+    free(frames);
+    free(mappings);
+}
+
+// Reads only the OSD text of a single file, which skips the IR image entirely
+static void flare16x_cli_probe(flare16x_thermal_ocr_cache* cache, flare16x_cli_timing* timing,
+                               flare16x_cli_result* result)
+{
+    flare16x_thermal thermal;
+    flare16x_error error;
+    memset(&thermal, 0, sizeof(thermal));
+
+    uint64_t start = flare16x_cli_now();
+    result->stage = FLARE16X_CLI_STAGE_OCR;
+    FILE* file = fopen(result->path, "rb");
+    if (file == NULL)
+    {
+        result->error = flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_GLOBAL);
+        return;
+    }
+    error = flare16x_thermal_probe(file, &thermal, cache);
+    fclose(file);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+    {
+        result->temperature_spot = thermal.temperature_spot;
+        result->emissivity = thermal.emissivity;
+        result->has_ocr = 1;
+        flare16x_cli_lap(timing, FLARE16X_CLI_STAGE_OCR, start);
+    }
+
+    result->error = error;
+    flare16x_thermal_destroy(&thermal);
+}
+
+// Recolors a single file with the streaming operator, which never holds more than a few lines in memory
+static void flare16x_cli_recolor(const flare16x_cli_options* options, flare16x_stream* stream,
+                                 flare16x_cli_timing* timing, flare16x_cli_result* result)
+{
+    flare16x_error error;
+    uint64_t start = flare16x_cli_now();
+    result->stage = FLARE16X_CLI_STAGE_RECOLOR;
+
+    char* output_path = flare16x_cli_output_path(options->output_directory, result->path, ".bmp");
+    if (output_path == NULL)
+    {
+        result->error = flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_GLOBAL);
+        return;
+    }
+
+    // Never overwrite the output of an earlier input with the same name
+    FILE* source = fopen(result->path, "rb");
+    FILE* target = source == NULL || result->collision != NULL ? NULL : fopen(output_path, "wb");
+    if (source == NULL || target == NULL)
+    {
+        if (source != NULL)
+            fclose(source);
+        free(output_path);
+        result->error = flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_GLOBAL);
+        return;
+    }
+
+    error = flare16x_stream_recolor(stream, source, target);
+    fclose(source);
+    if (fclose(target) != 0 && flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_GLOBAL);
+
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+    {
+        result->device_model = stream->device_model;
+        result->palette = stream->palette;
+        result->spot_x = stream->spot_x;
+        result->spot_y = stream->spot_y;
+        result->spot_width = stream->spot_width;
+        result->spot_height = stream->spot_height;
+        result->has_spot = 1;
+        result->value_min = stream->value_min;
+        result->value_max = stream->value_max;
+        result->value_mean = stream->value_mean;
+        result->has_values = 1;
+        flare16x_cli_lap(timing, FLARE16X_CLI_STAGE_RECOLOR, start);
+    } else
+        // Do not leave incomplete bitmaps behind
+        remove(output_path);
+
+    result->error = error;
+    free(output_path);
+}
+
+// Reads an entire file into a newly allocated buffer
+static flare16x_error flare16x_cli_read(const char* path, uint8_t** buffer, size_t* size)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_GLOBAL);
+
+    long length = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+    *buffer = length < 0 || fseek(file, 0, SEEK_SET) != 0 ? NULL : malloc(length > 0 ? (size_t)length : 1);
+    if (*buffer == NULL || (length > 0 && fread(*buffer, (size_t)length, 1, file) != 1))
+    {
+        fclose(file);
+        free(*buffer);
+        *buffer = NULL;
+        return flare16x_error_make(length < 0 ? FLARE16X_ERROR_IO : FLARE16X_ERROR_MALLOC,
+                                   FLARE16X_ERROR_SOURCE_GLOBAL);
+    }
+    fclose(file);
+    *size = (size_t)length;
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_GLOBAL);
+}
+
+// Compresses a screenshot or restores a compressed one
+static void flare16x_cli_pack(const flare16x_cli_options* options, flare16x_cli_timing* timing,
+                              flare16x_cli_result* result)
+{
+    uint8_t* input = NULL;
+    uint8_t* output = NULL;
+    size_t input_size, output_size = 0;
+    FILE* target = NULL;
+    int unpack = options->mode == FLARE16X_CLI_MODE_UNPACK;
+
+    // Read the input
+    uint64_t start = flare16x_cli_now();
+    result->stage = FLARE16X_CLI_STAGE_LOAD;
+    char* output_path = flare16x_cli_output_path(options->output_directory, result->path, unpack ? ".bmp" : ".f16z");
+    flare16x_error error = output_path == NULL ?
+            flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_GLOBAL) :
+            flare16x_cli_read(result->path, &input, &input_size);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        goto done;
+    start = flare16x_cli_lap(timing, FLARE16X_CLI_STAGE_LOAD, start);
+
+    // Open the output, but never overwrite the output of an earlier input with the same name
+    result->stage = FLARE16X_CLI_STAGE_CODEC;
+    target = result->collision == NULL ? fopen(output_path, "wb") : NULL;
+    if (target == NULL)
+    {
+        error = flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_GLOBAL);
+        goto done;
+    }
+
+    // Then, either compress the input straight into the output or restore it into a buffer first
+    if (!unpack)
+        error = flare16x_codec_encode(input, input_size, target);
+    else
+    {
+        // Query the size first, which only succeeds with the expected range error for a missing buffer
+        error = flare16x_codec_decode(input, input_size, NULL, 0, &output_size);
+        if (flare16x_error_reason(error) == FLARE16X_ERROR_RANGE)
+        {
+            output = malloc(output_size > 0 ? output_size : 1);
+            error = output == NULL ? flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_GLOBAL) :
+                    flare16x_codec_decode(input, input_size, output, output_size, &output_size);
+        }
+        else if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+            error = flare16x_error_make(FLARE16X_ERROR_ASSERT, FLARE16X_ERROR_SOURCE_GLOBAL);
+        if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE && output_size > 0 &&
+            fwrite(output, output_size, 1, target) != 1)
+            error = flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_GLOBAL);
+    }
+    if (fclose(target) != 0 && flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+        error = flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_GLOBAL);
+
+    // Do not leave incomplete files behind
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        remove(output_path);
+    else
+        flare16x_cli_lap(timing, FLARE16X_CLI_STAGE_CODEC, start);
+
+done:
+    result->error = error;
+    free(output_path);
+    free(input);
+    free(output);
+}
+
+// Processes files from the batch until none are left
+static void* flare16x_cli_worker(void* argument)
+{
+    flare16x_cli_batch* batch = argument;
+    flare16x_cli_timing timing;
+    memset(&timing, 0, sizeof(timing));
+
+    // Consecutive files of a worker often show the same OSD text, which is then only recognized once
+    flare16x_thermal_ocr_cache cache;
+    memset(&cache, 0, sizeof(cache));
+
+    // Recoloring uses a streaming context per worker, so that its lookup tables are shared between the files
+    flare16x_stream stream;
+    flare16x_error stream_error = flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_GLOBAL);
+    memset(&stream, 0, sizeof(stream));
+    if (batch->options->mode == FLARE16X_CLI_MODE_RECOLOR)
+        stream_error = flare16x_stream_create(batch->options->palette, batch->options->interpolation,
+                batch->options->quantification, batch->options->crosshair, FLARE16X_LOCATOR_CROSSHAIR_BORDER,
+                FLARE16X_LOCATOR_CROSSHAIR_FILL, &stream);
+
+    for (;;)
+    {
+        // Fetch the next file
+        pthread_mutex_lock(&batch->lock);
+        size_t index = batch->next++;
+        pthread_mutex_unlock(&batch->lock);
+        if (index >= batch->count)
+            break;
+
+        flare16x_cli_result* result = &batch->results[index];
+        uint64_t start = flare16x_cli_now();
+        flare16x_profile_snapshot(&timing.profile);
+        int counter;
+        for (counter = 0; counter < FLARE16X_PROFILE_COUNTER_COUNT; counter++)
+            result->counters[counter] = timing.profile.counters[counter];
+        if (batch->options->mode == FLARE16X_CLI_MODE_PROBE)
+            flare16x_cli_probe(&cache, &timing, &batch->results[index]);
+        else if (batch->options->mode == FLARE16X_CLI_MODE_PACK || batch->options->mode == FLARE16X_CLI_MODE_UNPACK)
+            flare16x_cli_pack(batch->options, &timing, &batch->results[index]);
+        else if (batch->options->mode != FLARE16X_CLI_MODE_RECOLOR)
+            flare16x_cli_process(batch, &cache, &timing, &batch->results[index]);
+        else if (flare16x_error_reason(stream_error) == FLARE16X_ERROR_NONE)
+            flare16x_cli_recolor(batch->options, &stream, &timing, &batch->results[index]);
+        else
+        {
+            batch->results[index].stage = FLARE16X_CLI_STAGE_RECOLOR;
+            batch->results[index].error = stream_error;
+        }
+
+        // Keep the counters of this file only
+        flare16x_profile_snapshot(&timing.profile);
+        for (counter = 0; counter < FLARE16X_PROFILE_COUNTER_COUNT; counter++)
+            result->counters[counter] = timing.profile.counters[counter] - result->counters[counter];
+
+        // Add the whole file to the trace, tagged with what was found out about it
+        if (flare16x_profile_active & FLARE16X_PROFILE_TRACING)
+            flare16x_profile_trace("file", start, flare16x_cli_now(), result->path,
+                    result->has_spot ? result->device_model : -1, result->has_values ? result->palette : -1);
+    }
+    flare16x_stream_destroy(&stream);
+
+    // Merge the timings of this worker
+    pthread_mutex_lock(&batch->lock);
+    int stage;
+    for (stage = 0; stage < FLARE16X_CLI_STAGE_COUNT; stage++)
+    {
+        batch->timing.nanoseconds[stage] += timing.nanoseconds[stage];
+        batch->timing.calls[stage] += timing.calls[stage];
+    }
+    batch->timing.ocr_lookups += cache.lookups;
+    batch->timing.ocr_hits += cache.hits;
+    flare16x_profile_snapshot(&timing.profile);
+    flare16x_profile_merge(&batch->timing.profile, &timing.profile);
+    pthread_mutex_unlock(&batch->lock);
+
+    return NULL;
+}
+
+// Prints a string as JSON string literal
+static void flare16x_cli_json_string(const char* string)
+{
+    putchar('"');
+    for (; *string; string++)
+    {
+        if (*string == '"' || *string == '\\')
+            printf("\\%c", *string);
+        else if ((unsigned char)*string < 0x20)
+            printf("\\u%04x", (unsigned char)*string);
+        else
+            putchar(*string);
+    }
+    putchar('"');
+}
+
+// Prints all results in the selected format
+static void flare16x_cli_report(const flare16x_cli_options* options, flare16x_cli_result* results, size_t count)
+{
+    size_t index;
+
+    // The algorithm counters of every file are only reported along with the timings
+    int counter;
+    if (options->format == FLARE16X_CLI_FORMAT_CSV)
+    {
+        printf("file,status,model,palette,temperature,emissivity,spot_x,spot_y,spot_width,spot_height,"
+               "value_min,value_max,value_mean");
+        for (counter = 0; options->timing && counter < FLARE16X_PROFILE_COUNTER_COUNT; counter++)
+            printf(",%s", flare16x_profile_counter_name((uint8_t)counter));
+        printf("\n");
+    }
+    else
+        printf("[\n");
+
+    for (index = 0; index < count; index++)
+    {
+        flare16x_cli_result* result = &results[index];
+        int failed = flare16x_error_reason(result->error) != FLARE16X_ERROR_NONE;
+        const char* status = failed ? flare16x_cli_stage_names[result->stage] : "ok";
+        const char* model = result->has_spot ? flare16x_cli_models[result->device_model & 3] : "";
+        const char* palette = result->has_values ?
+                flare16x_cli_name_of(flare16x_cli_palettes, result->palette) : "";
+
+        if (options->format == FLARE16X_CLI_FORMAT_CSV)
+        {
+            printf("%s,%s,%s,%s,", result->path, status, model, palette);
+            if (result->has_ocr)
+                printf("%s%d.%d,0.%02u,", result->temperature_spot < 0 ? "-" : "",
+                       abs(result->temperature_spot) / 10, abs(result->temperature_spot) % 10, result->emissivity);
+            else
+                printf(",,");
+            if (result->has_spot)
+                printf("%u,%u,%u,%u,", result->spot_x, result->spot_y, result->spot_width, result->spot_height);
+            else
+                printf(",,,,");
+            if (result->has_values)
+                printf("%u,%u,%u", result->value_min, result->value_max, result->value_mean);
+            else
+                printf(",,");
+            for (counter = 0; options->timing && counter < FLARE16X_PROFILE_COUNTER_COUNT; counter++)
+                printf(",%llu", (unsigned long long)result->counters[counter]);
+            printf("\n");
+            continue;
+        }
+
+        printf("  {\"file\": ");
+        flare16x_cli_json_string(result->path);
+        printf(", \"status\": \"%s\"", status);
+        if (result->has_spot)
+            printf(", \"model\": \"%s\", \"spot\": [%u, %u, %u, %u]", model, result->spot_x, result->spot_y,
+                   result->spot_width, result->spot_height);
+        if (result->has_ocr)
+            printf(", \"temperature\": %d, \"emissivity\": %u", result->temperature_spot, result->emissivity);
+        if (result->has_values)
+            printf(", \"palette\": \"%s\", \"value_min\": %u, \"value_max\": %u, \"value_mean\": %u", palette,
+                   result->value_min, result->value_max, result->value_mean);
+        for (counter = 0; options->timing && counter < FLARE16X_PROFILE_COUNTER_COUNT; counter++)
+            printf("%s\"%s\": %llu", counter == 0 ? ", \"counters\": {" : ", ",
+                   flare16x_profile_counter_name((uint8_t)counter), (unsigned long long)result->counters[counter]);
+        printf("%s}%s\n", options->timing ? "}" : "", index + 1 < count ? "," : "");
+    }
+
+    if (options->format == FLARE16X_CLI_FORMAT_JSON)
+        printf("]\n");
+}
+
+// Prints the stage timings to stderr
+static void flare16x_cli_report_timing(flare16x_cli_timing* timing, uint64_t total, size_t count)
+{
+    int stage;
+    fprintf(stderr, "%-10s %10s %12s %12s\n", "stage", "calls", "total ms", "avg us");
+    for (stage = 0; stage < FLARE16X_CLI_STAGE_COUNT; stage++)
+        if (timing->calls[stage] > 0)
+            fprintf(stderr, "%-10s %10llu %12.3f %12.3f\n", flare16x_cli_stage_names[stage],
+                    (unsigned long long)timing->calls[stage], timing->nanoseconds[stage] / 1e6,
+                    timing->nanoseconds[stage] / 1e3 / timing->calls[stage]);
+    if (timing->ocr_lookups > 0)
+        fprintf(stderr, "ocr cache  %10llu %12llu hits (%.1f%%)\n", (unsigned long long)timing->ocr_lookups,
+                (unsigned long long)timing->ocr_hits, timing->ocr_hits * 100.0 / timing->ocr_lookups);
+    // Followed by the stages timed inside the library, which overlap with the pipeline stages
+    int profiled = 0;
+    for (stage = 0; stage < FLARE16X_PROFILE_STAGE_COUNT; stage++)
+        profiled |= timing->profile.calls[stage] > 0;
+    if (profiled)
+        fprintf(stderr, "%-20s %10s %12s %12s\n", "library stage", "calls", "total ms", "avg us");
+    for (stage = 0; stage < FLARE16X_PROFILE_STAGE_COUNT; stage++)
+        if (timing->profile.calls[stage] > 0)
+            fprintf(stderr, "%-20s %10llu %12.3f %12.3f\n", flare16x_profile_name((uint8_t)stage),
+                    (unsigned long long)timing->profile.calls[stage], timing->profile.nanoseconds[stage] / 1e6,
+                    timing->profile.nanoseconds[stage] / 1e3 / timing->profile.calls[stage]);
+    // And the algorithm counters of the library
+    int counter, counted = 0;
+    for (counter = 0; counter < FLARE16X_PROFILE_COUNTER_COUNT; counter++)
+        counted |= timing->profile.counters[counter] > 0;
+    if (counted)
+        fprintf(stderr, "%-20s %16s %16s\n", "library counter", "total", "per file");
+    for (counter = 0; counted && counter < FLARE16X_PROFILE_COUNTER_COUNT; counter++)
+        fprintf(stderr, "%-20s %16llu %16.1f\n", flare16x_profile_counter_name((uint8_t)counter),
+                (unsigned long long)timing->profile.counters[counter],
+                count > 0 ? (double)timing->profile.counters[counter] / count : 0.0);
+    uint64_t lookups = timing->profile.counters[FLARE16X_PROFILE_PALETTE_HITS] +
+            timing->profile.counters[FLARE16X_PROFILE_PALETTE_MISSES];
+    if (lookups > 0)
+        fprintf(stderr, "palette cache hit rate %.1f%%\n",
+                timing->profile.counters[FLARE16X_PROFILE_PALETTE_HITS] * 100.0 / lookups);
+    fprintf(stderr, "%zu files in %.3f ms (%.1f files/s)\n", count, total / 1e6,
+            total > 0 ? count * 1e9 / total : 0.0);
+}
+
+// Prints the usage
+static void flare16x_cli_usage(const char* name)
+{
+    fprintf(stderr,
+            "Usage: %s [options] <file|directory|->...\n"
+            "Processes FLIR TG165 and TG167 screenshots; '-' reads the list of inputs from stdin\n"
+            "\n"
+            "Options:\n"
+            "  -m <mode>      recolor, stats, dump, probe, pack, unpack, average, burst or normalize (default: stats)\n"
+            "  -o <dir>       output directory for all modes except stats and probe\n"
+            "  -c <file>      also store the processed frames of stats, dump and average in a container file\n"
+            "  -s <file>      also store the processed frames of stats, dump and average as a delta-coded sequence\n"
+            "  -k <frames>    number of frames from one sequence keyframe to the next (default: 30)\n"
+            "  -f <format>    report format: csv or json (default: csv)\n"
+            "  -e <format>    dump format: points, npy, raw or pgm (default: points)\n"
+            "  -p <palette>   output palette: iron, grayscale or rainbow (default: iron)\n"
+            "  -i <mode>      crosshair interpolation: zero, min, med, max, small, large or weight (default: large)\n"
+            "  -q <mode>      quantification: exact, floor, ceiling, high or low (default: low)\n"
+            "  -x             do not redraw the crosshair when recoloring\n"
+            "  -j <threads>   number of worker threads, 0 for all cores (default: 1)\n"
+            "  -t             print per-stage timings to stderr\n"
+            "  -T <file>      write a trace of all files and stages for Perfetto or chrome://tracing\n"
+            "  -v             print errors to stderr\n"
+            "  -h             show this help\n", name);
+}
+
+int main(int argc, char** argv)
+{
+    flare16x_cli_options options;
+    memset(&options, 0, sizeof(options));
+    options.mode = FLARE16X_CLI_MODE_STATS;
+    options.format = FLARE16X_CLI_FORMAT_CSV;
+    options.palette = FLARE16X_PALETTES_IRON;
+    options.interpolation = FLARE16X_THERMAL_INTERPOLATION_SQUARE_LARGE;
+    options.quantification = FLARE16X_THERMAL_QUANTIFICATION_MEDIAN_LOW;
+    options.crosshair = 1;
+    options.threads = 1;
+    options.interval = FLARE16X_SEQUENCE_INTERVAL;
+
+    // Parse the options
+    int option;
+    while ((option = getopt(argc, argv, "m:o:c:s:k:f:e:p:i:q:xj:tT:vh")) != -1)
+    {
+        int valid = 1;
+        switch (option)
+        {
+            case 'm':
+                valid = flare16x_cli_lookup(flare16x_cli_modes, optarg, &options.mode);
+                break;
+            case 'o':
+                options.output_directory = optarg;
+                break;
+            case 'c':
+                options.container_path = optarg;
+                break;
+            case 's':
+                options.sequence_path = optarg;
+                break;
+            case 'k':
+            {
+                unsigned long interval;
+                valid = flare16x_cli_number(optarg, UINT16_MAX, &interval) && interval >= 1;
+                options.interval = (uint16_t)interval;
+                break;
+            }
+            case 'f':
+                valid = flare16x_cli_lookup(flare16x_cli_formats, optarg, &options.format);
+                break;
+            case 'e':
+                valid = flare16x_cli_lookup(flare16x_cli_dumps, optarg, &options.dump);
+                break;
+            case 'p':
+                valid = flare16x_cli_lookup(flare16x_cli_palettes, optarg, &options.palette);
+                break;
+            case 'i':
+                valid = flare16x_cli_lookup(flare16x_cli_interpolations, optarg, &options.interpolation);
+                break;
+            case 'q':
+                valid = flare16x_cli_lookup(flare16x_cli_quantifications, optarg, &options.quantification);
+                break;
+            case 'x':
+                options.crosshair = 0;
+                break;
+            case 'j':
+            {
+                unsigned long threads;
+                valid = flare16x_cli_number(optarg, UINT_MAX, &threads);
+                options.threads = (unsigned)threads;
+                break;
+            }
+            case 't':
+                options.timing = 1;
+                break;
+            case 'T':
+                options.trace_path = optarg;
+                break;
+            case 'v':
+                options.verbose = 1;
+                break;
+            case 'h':
+                flare16x_cli_usage(argv[0]);
+                return 0;
+            default:
+                valid = 0;
+                break;
+        }
+
+        if (!valid)
+        {
+            if (option != '?')
+                fprintf(stderr, "%s: invalid argument for -%c: %s\n", argv[0], option, optarg);
+            flare16x_cli_usage(argv[0]);
+            return 2;
+        }
+    }
+
+    // Verify the combination of options
+    if (optind >= argc || ((options.mode == FLARE16X_CLI_MODE_RECOLOR || options.mode == FLARE16X_CLI_MODE_DUMP ||
+                            options.mode == FLARE16X_CLI_MODE_PACK || options.mode == FLARE16X_CLI_MODE_UNPACK ||
+                            options.mode == FLARE16X_CLI_MODE_AVERAGE || options.mode == FLARE16X_CLI_MODE_BURST ||
+                            options.mode == FLARE16X_CLI_MODE_NORMALIZE) && options.output_directory == NULL) ||
+        ((options.container_path != NULL || options.sequence_path != NULL) &&
+         options.mode != FLARE16X_CLI_MODE_STATS && options.mode != FLARE16X_CLI_MODE_DUMP &&
+         options.mode != FLARE16X_CLI_MODE_AVERAGE))
+    {
+        flare16x_cli_usage(argv[0]);
+        return 2;
+    }
+
+    // Determine the number of threads
+    if (options.threads == 0)
+    {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        options.threads = cores > 0 ? (unsigned)cores : 1;
+    }
+
+    // Collect the input files
+    flare16x_cli_list list;
+    memset(&list, 0, sizeof(list));
+    list.extension = options.mode == FLARE16X_CLI_MODE_UNPACK ? ".f16z" : ".bmp";
+    int argument;
+    for (argument = optind; argument < argc; argument++)
+    {
+        int valid = strcmp(argv[argument], "-") == 0 ? flare16x_cli_list_stdin(&list) :
+                flare16x_cli_list_input(&list, argv[argument]);
+        if (!valid)
+            return 1;
+    }
+
+    // Prepare the batch
+    flare16x_cli_batch batch;
+    memset(&batch, 0, sizeof(batch));
+    batch.options = &options;
+    batch.count = list.count;
+    batch.results = calloc(list.count ? list.count : 1, sizeof(flare16x_cli_result));
+    if (batch.results == NULL)
+    {
+        fprintf(stderr, "%s: %s\n", argv[0], flare16x_error_string(FLARE16X_ERROR_MALLOC));
+        return 1;
+    }
+    size_t index;
+    for (index = 0; index < list.count; index++)
+        batch.results[index].path = list.paths[index];
+
+    // Find the inputs that would overwrite the outputs of others
+    if (options.mode != FLARE16X_CLI_MODE_STATS && options.mode != FLARE16X_CLI_MODE_PROBE &&
+        options.mode != FLARE16X_CLI_MODE_AVERAGE && !flare16x_cli_output_collisions(batch.results, batch.count))
+    {
+        fprintf(stderr, "%s: %s\n", argv[0], flare16x_error_string(FLARE16X_ERROR_MALLOC));
+        return 1;
+    }
+    pthread_mutex_init(&batch.lock, NULL);
+    pthread_mutex_init(&batch.store_lock, NULL);
+    pthread_cond_init(&batch.store_turn, NULL);
+    pthread_mutex_init(&batch.accumulator_lock, NULL);
+
+    // Prepare the average
+    flare16x_series_accumulator accumulator;
+    flare16x_series_accumulator_create(&accumulator);
+    if (options.mode == FLARE16X_CLI_MODE_AVERAGE)
+        batch.accumulator = &accumulator;
+
+    // Prepare the frames of the burst or sequence
+    if (options.mode == FLARE16X_CLI_MODE_BURST || options.mode == FLARE16X_CLI_MODE_NORMALIZE)
+    {
+        batch.frames = calloc(list.count ? list.count : 1, sizeof(flare16x_thermal));
+        if (batch.frames == NULL)
+        {
+            fprintf(stderr, "%s: %s\n", argv[0], flare16x_error_string(FLARE16X_ERROR_MALLOC));
+            return 1;
+        }
+    }
+
+    // Start the container
+    flare16x_container_writer container;
+    FILE* container_file = NULL;
+    if (options.container_path != NULL)
+    {
+        container_file = fopen(options.container_path, "wb");
+        flare16x_error error = container_file != NULL ? flare16x_container_create(container_file, &container) :
+                flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_CONTAINER);
+        if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        {
+            fprintf(stderr, "%s: %s: %s\n", argv[0], options.container_path, flare16x_error_string(error));
+            if (container_file != NULL)
+                fclose(container_file);
+            return 1;
+        }
+        batch.container = &container;
+    }
+
+    // Start the sequence with the dimensions of the IR image
+    flare16x_sequence_writer sequence;
+    FILE* sequence_file = NULL;
+    if (options.sequence_path != NULL)
+    {
+        sequence_file = fopen(options.sequence_path, "wb");
+        flare16x_error error = sequence_file != NULL ? flare16x_sequence_create(sequence_file,
+                FLARE16X_LOCATOR_IR_WIDTH, FLARE16X_LOCATOR_IR_HEIGHT, options.interval, &sequence) :
+                flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_SEQUENCE);
+        if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        {
+            fprintf(stderr, "%s: %s: %s\n", argv[0], options.sequence_path, flare16x_error_string(error));
+            if (sequence_file != NULL)
+                fclose(sequence_file);
+            return 1;
+        }
+        batch.sequence = &sequence;
+    }
+
+    // Run the workers, using the main thread as one of them
+    if (options.threads > list.count)
+        options.threads = list.count ? (unsigned)list.count : 1;
+    pthread_t* threads = calloc(options.threads, sizeof(pthread_t));
+    unsigned thread, started = 0;
+    flare16x_profile_enable((uint8_t)((options.timing ? FLARE16X_PROFILE_TIMING | FLARE16X_PROFILE_COUNTING : 0) |
+            (options.trace_path != NULL ? FLARE16X_PROFILE_TRACING : 0)));
+    uint64_t start = flare16x_cli_now();
+    for (thread = 1; threads != NULL && thread < options.threads; thread++, started++)
+        if (pthread_create(&threads[thread], NULL, flare16x_cli_worker, &batch) != 0)
+            break;
+    flare16x_cli_worker(&batch);
+    for (thread = 1; thread <= started; thread++)
+        pthread_join(threads[thread], NULL);
+    free(threads);
+
+    // Fill the crosshairs of the burst or normalize the sequence
+    if (batch.frames != NULL)
+        flare16x_cli_series(&batch);
+    uint64_t total = flare16x_cli_now() - start;
+    int failures = 0;
+
+    // Write the trace
+    if (options.trace_path != NULL)
+    {
+        flare16x_profile_enable(0);
+        FILE* trace_file = fopen(options.trace_path, "w");
+        flare16x_error error = trace_file != NULL ? flare16x_profile_trace_write(trace_file) :
+                flare16x_error_make(FLARE16X_ERROR_OPEN, FLARE16X_ERROR_SOURCE_PROFILE);
+        if (trace_file != NULL && fclose(trace_file) != 0 && flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+            error = flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_PROFILE);
+        if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        {
+            fprintf(stderr, "%s: %s: %s\n", argv[0], options.trace_path, flare16x_error_string(error));
+            failures++;
+        }
+    }
+
+    // Complete the container
+    if (container_file != NULL)
+    {
+        flare16x_error error = flare16x_container_finish(&container);
+        if (fclose(container_file) != 0 && flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+            error = flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_CONTAINER);
+        if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        {
+            fprintf(stderr, "%s: %s: %s\n", argv[0], options.container_path, flare16x_error_string(error));
+            failures++;
+        }
+    }
+
+    // Complete the sequence
+    if (sequence_file != NULL)
+    {
+        flare16x_error error = flare16x_sequence_finish(&sequence);
+        if (fclose(sequence_file) != 0 && flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+            error = flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_SEQUENCE);
+        if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        {
+            fprintf(stderr, "%s: %s: %s\n", argv[0], options.sequence_path, flare16x_error_string(error));
+            failures++;
+        }
+    }
+
+    // Store the average
+    if (batch.accumulator != NULL)
+    {
+        flare16x_error error = flare16x_cli_average(&options, &accumulator);
+        if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        {
+            fprintf(stderr, "%s: %s: %s\n", argv[0], options.output_directory,
+                    flare16x_error_string(flare16x_error_first(error)));
+            failures++;
+        }
+    }
+
+    // Report the results
+    for (index = 0; index < list.count; index++)
+    {
+        flare16x_cli_result* result = &batch.results[index];
+        if (flare16x_error_reason(result->error) == FLARE16X_ERROR_NONE)
+            continue;
+
+        failures++;
+        if (options.verbose)
+            fprintf(stderr, "%s: %s failed: %s: %s\n", result->path, flare16x_cli_stage_names[result->stage],
+                    flare16x_error_source_string(flare16x_error_first(result->error)),
+                    flare16x_error_string(flare16x_error_first(result->error)));
+    }
+    flare16x_cli_report(&options, batch.results, batch.count);
+    if (options.timing)
+        flare16x_cli_report_timing(&batch.timing, total, list.count);
+
+    // Clean up
+    pthread_mutex_destroy(&batch.lock);
+    pthread_mutex_destroy(&batch.store_lock);
+    pthread_cond_destroy(&batch.store_turn);
+    pthread_mutex_destroy(&batch.accumulator_lock);
+    flare16x_series_accumulator_destroy(&accumulator);
+    free(batch.frames);
+    for (index = 0; index < list.count; index++)
+        free(list.paths[index]);
+    free(list.paths);
+    free(batch.results);
+
+    return failures > 0 ? 1 : 0;
+}
@@ -14,111 +14,651 @@
 
 #include "ocr.h"
 
-// Attempts to detect a single large font character
-flare16x_error flare16x_ocr_large_char(uint16_t offset_x, uint16_t offset_y, flare16x_canvas* canvas,
-                                        char* result_char)
+// The pixels of the large font that tell its characters apart
+static const uint32_t flare16x_ocr_large_sampled_mask[FLARE16X_OCR_MAX_HEIGHT] =
+    {
+        0x00000, 0x10400, 0x00000, 0x00000, 0x08008, 0x00000, 0x00000, 0x01000, 0x00000, 0x00000, 0x00000, 0x00100,
+        0x00000, 0x00000, 0x10000, 0x00000, 0x00000, 0x00000, 0x00100, 0x00000, 0x00000, 0x00000, 0x00000
+    };
+
+// The sampled templates of the large font
+static const flare16x_ocr_glyph flare16x_ocr_large_sampled_glyphs[] =
+    {
+        // '0'
+        {'0',
+            {
+                0x00000, 0x00400, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000,
+                0x00000, 0x00000, 0x00000, 0x10000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000,
+                0x00000
+            }
+        },
+        // '1'
+        {'1',
+            {
+                0x00000, 0x00400, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x01000, 0x00000, 0x00000, 0x00000,
+                0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000,
+                0x00000
+            }
+        },
+        // '2'
+        {'2',
+            {
+                0x00000, 0x00400, 0x00000, 0x00000, 0x08008, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000,
+                0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00100, 0x00000, 0x00000, 0x00000,
+                0x00000
+            }
+        },
+        // '3'
+        {'3',
+            {
+                0x00000, 0x00400, 0x00000, 0x00000, 0x00008, 0x00000, 0x00000, 0x01000, 0x00000, 0x00000, 0x00000,
+                0x00100, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000,
+                0x00000
+            }
+        },
+        // '4'
+        {'4',
+            {
+                0x00000, 0x00400, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x01000, 0x00000, 0x00000, 0x00000,
+                0x00000, 0x00000, 0x00000, 0x10000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000,
+                0x00000
+            }
+        },
+        // '5'
+        {'5',
+            {
+                0x00000, 0x00400, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000,
+                0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000,
+                0x00000
+            }
+        },
+        // '6'
+        {'6',
+            {
+                0x00000, 0x00400, 0x00000, 0x00000, 0x08000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000,
+                0x00100, 0x00000, 0x00000, 0x10000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000,
+                0x00000
+            }
+        },
+        // '7'
+        {'7',
+            {
+                0x00000, 0x10400, 0x00000, 0x00000, 0x08000, 0x00000, 0x00000, 0x01000, 0x00000, 0x00000, 0x00000,
+                0x00100, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00100, 0x00000, 0x00000, 0x00000,
+                0x00000
+            }
+        },
+        // '8'
+        {'8',
+            {
+                0x00000, 0x00400, 0x00000, 0x00000, 0x08008, 0x00000, 0x00000, 0x01000, 0x00000, 0x00000, 0x00000,
+                0x00100, 0x00000, 0x00000, 0x10000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000,
+                0x00000
+            }
+        },
+        // '9'
+        {'9',
+            {
+                0x00000, 0x00400, 0x00000, 0x00000, 0x00008, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000,
+                0x00100, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000,
+                0x00000
+            }
+        },
+        // ' '
+        {' ',
+            {
+                0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000,
+                0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000,
+                0x00000
+            }
+        },
+        // 'C'
+        {'C',
+            {
+                0x00000, 0x00000, 0x00000, 0x00000, 0x08000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000,
+                0x00100, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000,
+                0x00000
+            }
+        },
+        // 'F'
+        {'F',
+            {
+                0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x01000, 0x00000, 0x00000, 0x00000,
+                0x00100, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000,
+                0x00000
+            }
+        },
+        // '.'
+        {'.',
+            {
+                0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000,
+                0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00100, 0x00000, 0x00000, 0x00000,
+                0x00000
+            }
+        },
+        // 'L'
+        {'L',
+            {
+                0x00000, 0x00000, 0x00000, 0x00000, 0x00008, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000,
+                0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00100, 0x00000, 0x00000, 0x00000,
+                0x00000
+            }
+        },
+        // '-'
+        {'-',
+            {
+                0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000,
+                0x00100, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000,
+                0x00000
+            }
+        },
+        // 'O'
+        {'O',
+            {
+                0x00000, 0x00000, 0x00000, 0x00000, 0x08008, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000,
+                0x00000, 0x00000, 0x00000, 0x10000, 0x00000, 0x00000, 0x00000, 0x00100, 0x00000, 0x00000, 0x00000,
+                0x00000
+            }
+        }
+    };
+
+// The sampled large font, which only compares the pixels that tell its characters apart
+static const flare16x_ocr_font flare16x_ocr_large_sampled_font =
+    {
+        FLARE16X_OCR_LARGE_WIDTH,
+        FLARE16X_OCR_LARGE_HEIGHT,
+        0,
+        sizeof(flare16x_ocr_large_sampled_glyphs) / sizeof(flare16x_ocr_glyph),
+        FLARE16X_OCR_LARGE_COLOR,
+        flare16x_ocr_large_sampled_mask,
+        flare16x_ocr_large_sampled_glyphs,
+        NULL
+    };
+
+// The pixels of the large font that are compared, which are all pixels of the glyph
+static const uint32_t flare16x_ocr_large_mask[FLARE16X_OCR_MAX_HEIGHT] =
+    {
+        0x3ffff, 0x3ffff, 0x3ffff, 0x3ffff, 0x3ffff, 0x3ffff, 0x3ffff, 0x3ffff, 0x3ffff, 0x3ffff, 0x3ffff, 0x3ffff,
+        0x3ffff, 0x3ffff, 0x3ffff, 0x3ffff, 0x3ffff, 0x3ffff, 0x3ffff, 0x3ffff, 0x3ffff, 0x3ffff, 0x3ffff
+    };
+
+// The templates of the large font
+static const flare16x_ocr_glyph flare16x_ocr_large_glyphs[] =
+    {
+        // '0'
+        {'0',
+            {
+                0x00000, 0x00780, 0x00fc0, 0x01fe0, 0x01c70, 0x03870, 0x03838, 0x02038, 0x07018, 0x07018, 0x07018,
+                0x07018, 0x07018, 0x07018, 0x17038, 0x03038, 0x03830, 0x03870, 0x01ef0, 0x00fe0, 0x007c0, 0x00000,
+                0x00000
+            }
+        },
+        // '1'
+        {'1',
+            {
+                0x00000, 0x00700, 0x00780, 0x00780, 0x007c0, 0x007e0, 0x00760, 0x01700, 0x00700, 0x00700, 0x00700,
+                0x00600, 0x00700, 0x00700, 0x00700, 0x00700, 0x00700, 0x00700, 0x00600, 0x01fe0, 0x01fe0, 0x00000,
+                0x00000
+            }
+        },
+        // '2'
+        {'2',
+            {
+                0x00000, 0x00780, 0x01fe0, 0x03ff0, 0x0f838, 0x07018, 0x0601c, 0x0601c, 0x07000, 0x07800, 0x03c00,
+                0x01c00, 0x00e00, 0x00700, 0x00380, 0x001c0, 0x001e0, 0x000f0, 0x00178, 0x0fffc, 0x0fffc, 0x00000,
+                0x00000
+            }
+        },
+        // '3'
+        {'3',
+            {
+                0x00000, 0x00780, 0x01fe0, 0x03ff0, 0x03838, 0x07038, 0x07010, 0x07000, 0x07000, 0x03f00, 0x01f80,
+                0x03f00, 0x07800, 0x07000, 0x0e000, 0x0e000, 0x0601c, 0x0703c, 0x07c78, 0x03ff0, 0x00fe0, 0x00000,
+                0x00000
+            }
+        },
+        // '4'
+        {'4',
+            {
+                0x00000, 0x00c00, 0x01c00, 0x01e00, 0x01e00, 0x01f00, 0x01f80, 0x01f80, 0x01dc0, 0x01ce0, 0x01ce0,
+                0x01c70, 0x01c38, 0x01c38, 0x1fffc, 0x0fffc, 0x01c00, 0x01c00, 0x01c00, 0x01c00, 0x01c00, 0x00000,
+                0x00000
+            }
+        },
+        // '5'
+        {'5',
+            {
+                0x00000, 0x07ff8, 0x07ff8, 0x07ff8, 0x00010, 0x00018, 0x00018, 0x0001c, 0x0079c, 0x01ffc, 0x03ffc,
+                0x07838, 0x07018, 0x06000, 0x06000, 0x06000, 0x07018, 0x07038, 0x03c78, 0x01ff0, 0x00fc0, 0x00000,
+                0x00000
+            }
+        },
+        // '6'
+        {'6',
+            {
+                0x00000, 0x01c00, 0x03e00, 0x01f00, 0x087c0, 0x001e0, 0x000e0, 0x00070, 0x007f0, 0x01ff0, 0x03ff8,
+                0x07938, 0x0703c, 0x0601c, 0x1601c, 0x0601c, 0x0701c, 0x07038, 0x03c78, 0x01ff0, 0x00fc0, 0x00000,
+                0x00000
+            }
+        },
+        // '7'
+        {'7',
+            {
+                0x00000, 0x17ffc, 0x0fffc, 0x07ffc, 0x0f000, 0x07000, 0x03800, 0x03800, 0x01800, 0x01c00, 0x00c00,
+                0x00f00, 0x00e00, 0x00700, 0x00700, 0x00300, 0x00380, 0x00380, 0x001c0, 0x001c0, 0x000c0, 0x00000,
+                0x00000
+            }
+        },
+        // '8'
+        {'8',
+            {
+                0x00000, 0x00780, 0x01fe0, 0x03ff0, 0x0b878, 0x07038, 0x07018, 0x07038, 0x03838, 0x03ff0, 0x01fe0,
+                0x03ff8, 0x07838, 0x0701c, 0x1e01c, 0x0e01c, 0x0601c, 0x0703c, 0x07c78, 0x03ff0, 0x00fe0, 0x00000,
+                0x00000
+            }
+        },
+        // '9'
+        {'9',
+            {
+                0x00000, 0x00780, 0x01fe0, 0x03ff0, 0x07838, 0x0701c, 0x0601c, 0x0601c, 0x0701c, 0x0701c, 0x07038,
+                0x03d78, 0x03ff0, 0x03fc0, 0x01c00, 0x01c00, 0x01e00, 0x00f80, 0x006e0, 0x001f0, 0x00070, 0x00000,
+                0x00000
+            }
+        },
+        // ' '
+        {' ',
+            {
+                0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000,
+                0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000,
+                0x00000
+            }
+        },
+        // 'C'
+        {'C',
+            {
+                0x00000, 0x00b00, 0x01fc0, 0x07fe0, 0x0f0f0, 0x0e078, 0x04038, 0x00018, 0x0001c, 0x0001c, 0x0001c,
+                0x0011c, 0x0001c, 0x0001c, 0x0001c, 0x00038, 0x0e038, 0x0f070, 0x078f0, 0x03fe0, 0x01f80, 0x00000,
+                0x00000
+            }
+        },
+        // 'F'
+        {'F',
+            {
+                0x00000, 0x07bf8, 0x07ff8, 0x07ff8, 0x00010, 0x00018, 0x00018, 0x01018, 0x00018, 0x00018, 0x01ff8,
+                0x01ff8, 0x00018, 0x00018, 0x00018, 0x00018, 0x00018, 0x00018, 0x00018, 0x00018, 0x00018, 0x00000,
+                0x00000
+            }
+        },
+        // '.'
+        {'.',
+            {
+                0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000,
+                0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00100, 0x00780, 0x007c0, 0x00780, 0x00380, 0x00000,
+                0x00000
+            }
+        },
+        // 'L'
+        {'L',
+            {
+                0x00000, 0x00018, 0x00018, 0x00018, 0x00018, 0x00018, 0x00018, 0x00018, 0x00018, 0x00018, 0x00018,
+                0x00018, 0x00018, 0x00018, 0x00018, 0x00018, 0x00018, 0x00018, 0x00118, 0x07ff8, 0x07ff8, 0x00000,
+                0x00000
+            }
+        },
+        // '-'
+        {'-',
+            {
+                0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x03ff8,
+                0x07ff8, 0x03ff0, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000, 0x00000,
+                0x00000
+            }
+        },
+        // 'O'
+        {'O',
+            {
+                0x00000, 0x00bc0, 0x01ff0, 0x03ef8, 0x0f03c, 0x0e01c, 0x0e00e, 0x1c00e, 0x1c006, 0x1c007, 0x18007,
+                0x18007, 0x1c007, 0x1c006, 0x1c006, 0x0c00e, 0x0e00e, 0x0701c, 0x07978, 0x03ff0, 0x01fe0, 0x00380,
+                0x00000
+            }
+        }
+    };
+
+// The large font
+const flare16x_ocr_font flare16x_ocr_large_font =
+    {
+        FLARE16X_OCR_LARGE_WIDTH,
+        FLARE16X_OCR_LARGE_HEIGHT,
+        8,
+        sizeof(flare16x_ocr_large_glyphs) / sizeof(flare16x_ocr_glyph),
+        FLARE16X_OCR_LARGE_COLOR,
+        flare16x_ocr_large_mask,
+        flare16x_ocr_large_glyphs,
+        &flare16x_ocr_large_sampled_font
+    };
+
+// The pixels of the small font that tell its characters apart
+static const uint32_t flare16x_ocr_small_sampled_mask[FLARE16X_OCR_MAX_HEIGHT] =
+    {
+        0x000, 0x008, 0x020, 0x000, 0x002, 0x040, 0x000, 0x000, 0x090, 0x000, 0x0a0, 0x000
+    };
+
+// The sampled templates of the small font
+static const flare16x_ocr_glyph flare16x_ocr_small_sampled_glyphs[] =
+    {
+        // '0'
+        {'0',
+            {
+                0x000, 0x008, 0x000, 0x000, 0x002, 0x000, 0x000, 0x000, 0x080, 0x000, 0x000, 0x000
+            }
+        },
+        // '1'
+        {'1',
+            {
+                0x000, 0x000, 0x020, 0x000, 0x000, 0x000, 0x000, 0x000, 0x010, 0x000, 0x020, 0x000
+            }
+        },
+        // '2'
+        {'2',
+            {
+                0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x010, 0x000, 0x0a0, 0x000
+            }
+        },
+        // '3'
+        {'3',
+            {
+                0x000, 0x008, 0x000, 0x000, 0x000, 0x040, 0x000, 0x000, 0x000, 0x000, 0x080, 0x000
+            }
+        },
+        // '4'
+        {'4',
+            {
+                0x000, 0x000, 0x020, 0x000, 0x000, 0x000, 0x000, 0x000, 0x090, 0x000, 0x080, 0x000
+            }
+        },
+        // '5'
+        {'5',
+            {
+                0x000, 0x008, 0x000, 0x000, 0x000, 0x040, 0x000, 0x000, 0x080, 0x000, 0x000, 0x000
+            }
+        },
+        // '6'
+        {'6',
+            {
+                0x000, 0x008, 0x000, 0x000, 0x002, 0x040, 0x000, 0x000, 0x080, 0x000, 0x020, 0x000
+            }
+        },
+        // '7'
+        {'7',
+            {
+                0x000, 0x008, 0x000, 0x000, 0x000, 0x040, 0x000, 0x000, 0x010, 0x000, 0x000, 0x000
+            }
+        },
+        // '8'
+        {'8',
+            {
+                0x000, 0x008, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x080, 0x000, 0x000, 0x000
+            }
+        },
+        // '9'
+        {'9',
+            {
+                0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x0a0, 0x000
+            }
+        },
+        // ' '
+        {' ',
+            {
+                0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000
+            }
+        },
+        // '.'
+        {'.',
+            {
+                0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x020, 0x000
+            }
+        },
+        // ':'
+        {':',
+            {
+                0x000, 0x000, 0x020, 0x000, 0x000, 0x000, 0x000, 0x000, 0x010, 0x000, 0x000, 0x000
+            }
+        },
+        // 'E'
+        {'E',
+            {
+                0x000, 0x008, 0x000, 0x000, 0x000, 0x040, 0x000, 0x000, 0x000, 0x000, 0x0a0, 0x000
+            }
+        }
+    };
+
+// The sampled small font, which only compares the pixels that tell its characters apart
+static const flare16x_ocr_font flare16x_ocr_small_sampled_font =
+    {
+        FLARE16X_OCR_SMALL_WIDTH,
+        FLARE16X_OCR_SMALL_HEIGHT,
+        0,
+        sizeof(flare16x_ocr_small_sampled_glyphs) / sizeof(flare16x_ocr_glyph),
+        FLARE16X_OCR_SMALL_COLOR,
+        flare16x_ocr_small_sampled_mask,
+        flare16x_ocr_small_sampled_glyphs,
+        NULL
+    };
+
+// The pixels of the small font that are compared, which are all pixels of the glyph
+static const uint32_t flare16x_ocr_small_mask[FLARE16X_OCR_MAX_HEIGHT] =
+    {
+        0x3ff, 0x3ff, 0x3ff, 0x3ff, 0x3ff, 0x3ff, 0x3ff, 0x3ff, 0x3ff, 0x3ff, 0x3ff, 0x3ff
+    };
+
+// The templates of the small font
+static const flare16x_ocr_glyph flare16x_ocr_small_glyphs[] =
+    {
+        // '0'
+        {'0',
+            {
+                0x010, 0x07c, 0x044, 0x044, 0x0c6, 0x086, 0x0c6, 0x0c6, 0x0c4, 0x06c, 0x018, 0x000
+            }
+        },
+        // '1'
+        {'1',
+            {
+                0x010, 0x010, 0x03c, 0x010, 0x010, 0x010, 0x010, 0x010, 0x010, 0x010, 0x078, 0x000
+            }
+        },
+        // '2'
+        {'2',
+            {
+                0x038, 0x074, 0x0c6, 0x082, 0x0c0, 0x020, 0x030, 0x010, 0x018, 0x00c, 0x0fe, 0x000
+            }
+        },
+        // '3'
+        {'3',
+            {
+                0x038, 0x07c, 0x0c6, 0x0c0, 0x040, 0x070, 0x0c0, 0x080, 0x002, 0x0c6, 0x0dc, 0x000
+            }
+        },
+        // '4'
+        {'4',
+            {
+                0x000, 0x060, 0x070, 0x070, 0x078, 0x02c, 0x064, 0x0fe, 0x0fe, 0x060, 0x0c0, 0x000
+            }
+        },
+        // '5'
+        {'5',
+            {
+                0x0fc, 0x0fe, 0x006, 0x006, 0x03c, 0x06e, 0x0c6, 0x080, 0x0c0, 0x044, 0x05c, 0x000
+            }
+        },
+        // '6'
+        {'6',
+            {
+                0x040, 0x078, 0x018, 0x00c, 0x03e, 0x06c, 0x0c6, 0x082, 0x0c6, 0x044, 0x07c, 0x000
+            }
+        },
+        // '7'
+        {'7',
+            {
+                0x0fe, 0x0fe, 0x0c0, 0x040, 0x060, 0x060, 0x020, 0x030, 0x010, 0x018, 0x008, 0x000
+            }
+        },
+        // '8'
+        {'8',
+            {
+                0x038, 0x07c, 0x044, 0x0c6, 0x06c, 0x03c, 0x0c6, 0x082, 0x082, 0x0c6, 0x05c, 0x000
+            }
+        },
+        // '9'
+        {'9',
+            {
+                0x038, 0x074, 0x0c6, 0x082, 0x0c0, 0x086, 0x07c, 0x060, 0x020, 0x038, 0x0ac, 0x000
+            }
+        },
+        // ' '
+        {' ',
+            {
+                0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000
+            }
+        },
+        // '.'
+        {'.',
+            {
+                0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x000, 0x038, 0x038, 0x000
+            }
+        },
+        // ':'
+        {':',
+            {
+                0x000, 0x000, 0x030, 0x038, 0x010, 0x000, 0x000, 0x010, 0x038, 0x010, 0x000, 0x000
+            }
+        },
+        // 'E'
+        {'E',
+            {
+                0x0fc, 0x0fe, 0x006, 0x006, 0x004, 0x07e, 0x006, 0x006, 0x006, 0x006, 0x0fe, 0x000
+            }
+        }
+    };
+
+// The small font
+const flare16x_ocr_font flare16x_ocr_small_font =
+    {
+        FLARE16X_OCR_SMALL_WIDTH,
+        FLARE16X_OCR_SMALL_HEIGHT,
+        2,
+        sizeof(flare16x_ocr_small_glyphs) / sizeof(flare16x_ocr_glyph),
+        FLARE16X_OCR_SMALL_COLOR,
+        flare16x_ocr_small_mask,
+        flare16x_ocr_small_glyphs,
+        &flare16x_ocr_small_sampled_font
+    };
+
+// Counts the set bits of a word
+static inline uint16_t flare16x_ocr_popcount(uint32_t word)
 {
-    // Verify that the canvas and output char are not null pointers
-    if (canvas == NULL || result_char == NULL || canvas->pixels == NULL)
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__POPCNT__)
+    return (uint16_t)__builtin_popcount(word);
+#else
+    word = word - ((word >> 1) & 0x55555555u);
+    word = (word & 0x33333333u) + ((word >> 2) & 0x33333333u);
+    return (uint16_t)((((word + (word >> 4)) & 0x0f0f0f0fu) * 0x01010101u) >> 24);
+#endif
+}
+
+// Binarizes the rows of a glyph straight from the canvas
+// Rows outside the mask of the font are never compared, so they are left empty
+static void flare16x_ocr_canvas_rows(flare16x_canvas* canvas, uint16_t offset_x, uint16_t offset_y,
+        const flare16x_ocr_font* font, uint32_t* rows)
+{
+    uint16_t x, y;
+    for (y = 0; y < font->height; y++)
+    {
+        rows[y] = 0;
+        if (font->mask[y] == 0)
+            continue;
+
+        // Walk along the row and set the bit of every pixel in the text color
+        const uint16_t* pixels = &flare16x_canvas_raw(offset_x, offset_y + y, canvas);
+        uint32_t row = 0;
+        for (x = 0; x < font->width; x++)
+            row |= (uint32_t)(pixels[x] == font->color) << x;
+        rows[y] = row;
+    }
+}
+
+// Matches the rows of a glyph against all templates of a font
+// Fails with an unknown error, if no character is close enough, while the match is filled in regardless
+flare16x_error flare16x_ocr_match_glyph(const uint32_t* rows, const flare16x_ocr_font* font,
+        flare16x_ocr_match* match)
+{
+    // Verify that the rows, font and match are not null pointers
+    if (rows == NULL || font == NULL || match == NULL || font->mask == NULL || font->glyphs == NULL)
         return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_OCR);
 
-    // Check, that the width and height are valid
-    if (canvas->width == 0 || canvas->height == 0)
-        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_OCR);
+    // Start without any candidates
+    memset(match, 0, sizeof(flare16x_ocr_match));
+    match->distance = FLARE16X_OCR_NO_DISTANCE;
+    match->runner_up_distance = FLARE16X_OCR_NO_DISTANCE;
 
-    // Also check that the offsets, width and height are correct
-    if (offset_x + FLARE16X_OCR_LARGE_WIDTH > canvas->width || offset_y + FLARE16X_OCR_LARGE_HEIGHT > canvas->height)
-        return flare16x_error_make(FLARE16X_ERROR_IMAGE, FLARE16X_ERROR_SOURCE_OCR);
+    // Mask the glyph once and collect the rows that are compared at all
+    uint32_t masked[FLARE16X_OCR_MAX_HEIGHT];
+    uint8_t compared[FLARE16X_OCR_MAX_HEIGHT];
+    uint8_t glyph, y, count = 0;
+    for (y = 0; y < font->height; y++)
+    {
+        if (font->mask[y] == 0)
+            continue;
+        masked[count] = rows[y] & font->mask[y];
+        compared[count++] = y;
+    }
+
+    // Compare the glyph to every template, keeping the two closest characters
+    for (glyph = 0; glyph < font->count; glyph++)
+    {
+        const uint32_t* template = font->glyphs[glyph].rows;
+        uint16_t distance = 0;
+        for (y = 0; y < count; y++)
+            distance += flare16x_ocr_popcount(masked[y] ^ template[compared[y]]);
+
+        if (distance < match->distance)
+        {
+            match->runner_up = match->best;
+            match->runner_up_distance = match->distance;
+            match->best = font->glyphs[glyph].symbol;
+            match->distance = distance;
+        }
+        else if (distance < match->runner_up_distance)
+        {
+            match->runner_up = font->glyphs[glyph].symbol;
+            match->runner_up_distance = distance;
+        }
+    }
 
-    // Next, calculate the signature
-    uint8_t signature = 0;
-    uint16_t search_color = FLARE16X_OCR_LARGE_COLOR;
-
-    if (flare16x_canvas_raw(offset_x + 10, offset_y + 1, canvas) == search_color)
-        signature |= 1 << 0;
-    if (flare16x_canvas_raw(offset_x + 16, offset_y + 1, canvas) == search_color)
-        signature |= 1 << 1;
-    if (flare16x_canvas_raw(offset_x + 3, offset_y + 4, canvas) == search_color)
-        signature |= 1 << 2;
-    if (flare16x_canvas_raw(offset_x + 15, offset_y + 4, canvas) == search_color)
-        signature |= 1 << 3;
-    if (flare16x_canvas_raw(offset_x + 12, offset_y + 7, canvas) == search_color)
-        signature |= 1 << 4;
-    if (flare16x_canvas_raw(offset_x + 8, offset_y + 11, canvas) == search_color)
-        signature |= 1 << 5;
-    if (flare16x_canvas_raw(offset_x + 16, offset_y + 14, canvas) == search_color)
-        signature |= 1 << 6;
-    if (flare16x_canvas_raw(offset_x + 8, offset_y + 18, canvas) == search_color)
-        signature |= 1 << 7;
-
-    // Finally, match the signature against known values
-    switch (signature)
+    // The confidence is the margin of the closest character over the second closest one
+    match->confidence = (uint16_t)(match->runner_up_distance - match->distance);
+
+    // Only accept the closest character, if it is close enough and unambiguous
+    if (match->distance > font->tolerance || match->confidence == 0)
     {
-        case 0x41:
-            *result_char = '0';
-            break;
-        case 0x11:
-            *result_char = '1';
-            break;
-        case 0x8d:
-            *result_char = '2';
-            break;
-        case 0x35:
-            *result_char = '3';
-            break;
-        case 0x51:
-            *result_char = '4';
-            break;
-        case 0x01:
-            *result_char = '5';
-            break;
-        case 0x69:
-            *result_char = '6';
-            break;
-        case 0xbb:
-            *result_char = '7';
-            break;
-        case 0x7d:
-            *result_char = '8';
-            break;
-        case 0x25:
-            *result_char = '9';
-            break;
-        case 0x00:
-            *result_char = ' ';
-            break;
-        case 0x28:
-            *result_char = 'C';
-            break;
-        case 0x30:
-            *result_char = 'F';
-            break;
-        case 0x80:
-            *result_char = '.';
-            break;
-        case 0x84:
-            *result_char = 'L';
-            break;
-        case 0x20:
-            *result_char = '-';
-            break;
-        case 0xcc:
-            *result_char = 'O';
-            break;
-        default:
-            *result_char = 0;
+        // Fall back to the pixels that tell the characters apart, keeping the match of the font if that fails too
+        flare16x_ocr_match sampled;
+        if (font->fallback == NULL || flare16x_error_reason(flare16x_ocr_match_glyph(rows, font->fallback, &sampled))
+                != FLARE16X_ERROR_NONE)
             return flare16x_error_make(FLARE16X_ERROR_UNKNOWN, FLARE16X_ERROR_SOURCE_OCR);
+        *match = sampled;
+        match->fallback = 1;
+        return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_OCR);
     }
+    match->symbol = match->best;
 
     return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_OCR);
 }
 
-// Attempts to detect a large string (with capacity length + 1) of length characters
-flare16x_error flare16x_ocr_large_string(uint16_t offset_x, uint16_t offset_y, uint16_t pitch, uint16_t length,
-        uint16_t max_unknown, flare16x_canvas* canvas, char* result_string)
+// Attempts to detect a single large font character
+flare16x_error flare16x_ocr_large_char(uint16_t offset_x, uint16_t offset_y, flare16x_canvas* canvas,
+                                        char* result_char)
 {
     // Verify that the canvas and output char are not null pointers
-    if (canvas == NULL || result_string == NULL || canvas->pixels == NULL)
+    if (canvas == NULL || result_char == NULL || canvas->pixels == NULL)
         return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_OCR);
 
     // Check, that the width and height are valid
@@ -126,44 +666,35 @@ flare16x_error flare16x_ocr_large_string(uint16_t offset_x, uint16_t offset_y, u
         return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_OCR);
 
     // Also check that the offsets, width and height are correct
-    if (length == 0 || (FLARE16X_OCR_LARGE_WIDTH + pitch) * length + offset_x > canvas->width + pitch ||
-        offset_y + FLARE16X_OCR_LARGE_HEIGHT > canvas->height)
-        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_OCR);
+    if (offset_x + FLARE16X_OCR_LARGE_WIDTH > canvas->width || offset_y + FLARE16X_OCR_LARGE_HEIGHT > canvas->height)
+        return flare16x_error_make(FLARE16X_ERROR_IMAGE, FLARE16X_ERROR_SOURCE_OCR);
 
-    // Now, clear the output string
-    memset(result_string, 0, length + 1);
+    // Next, binarize the glyph and match it against the templates of the font
+    uint32_t rows[FLARE16X_OCR_MAX_HEIGHT];
+    flare16x_ocr_match match;
+    flare16x_ocr_canvas_rows(canvas, offset_x, offset_y, &flare16x_ocr_large_font, rows);
+    flare16x_error error = flare16x_ocr_match_glyph(rows, &flare16x_ocr_large_font, &match);
 
-    // Next, loop through the characters and end on the first error
-    int src_digit, dst_digit;
-    for (src_digit = 0, dst_digit = 0; src_digit < length; src_digit++)
-    {
-        flare16x_error error;
-        error = flare16x_ocr_large_char((FLARE16X_OCR_LARGE_WIDTH + pitch) * src_digit + offset_x, offset_y,
-                canvas, result_string + dst_digit);
-        switch (flare16x_error_reason(error))
-        {
-            case FLARE16X_ERROR_NONE:
-                // No error, move on to the next digit
-                dst_digit++;
-                break;
-
-            case FLARE16X_ERROR_UNKNOWN:
-                // Unknown digit, don't output it
-                // If the maximum number of unknown digits is reached, throw an error
-                if (max_unknown == 0)
-                    return error;
+    // Finally, return the recognized character, which is 0 for an unknown glyph
+    *result_char = match.symbol;
+    return error;
+}
 
-                // Otherwise, decrement the remaining counter of unknown values and continue
-                max_unknown--;
-                continue;
+// Attempts to detect a large string (with capacity length + 1) of length characters
+flare16x_error flare16x_ocr_large_string(uint16_t offset_x, uint16_t offset_y, uint16_t pitch, uint16_t length,
+        uint16_t max_unknown, flare16x_canvas* canvas, char* result_string)
+{
+    // Describe the string as a single field and recognize it in one pass
+    flare16x_ocr_field field = {offset_x, offset_y, pitch, (uint8_t)length, (uint8_t)max_unknown,
+            &flare16x_ocr_large_font, result_string, 0, 0};
 
-            default:
-                return error;
-        }
-    }
+    // Make sure the length fits into a field, as all other checks are done by the strip recognition
+    if (length > FLARE16X_OCR_MAX_LENGTH)
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_OCR);
+    if (max_unknown > length)
+        field.max_unknown = (uint8_t)length;
 
-    // Fall through to success
-    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_OCR);
+    return flare16x_ocr_strip(canvas, &field, 1);
 }
 
 // Attempts to detect a single small font character
@@ -182,129 +713,197 @@ flare16x_error flare16x_ocr_small_char(uint16_t offset_x, uint16_t offset_y, fla
     if (offset_x + FLARE16X_OCR_SMALL_WIDTH > canvas->width || offset_y + FLARE16X_OCR_SMALL_HEIGHT > canvas->height)
         return flare16x_error_make(FLARE16X_ERROR_IMAGE, FLARE16X_ERROR_SOURCE_OCR);
 
-    // Next, calculate the signature
-    uint8_t signature = 0;
-    uint16_t search_color = FLARE16X_OCR_SMALL_COLOR;
-
-    if (flare16x_canvas_raw(offset_x + 3, offset_y + 1, canvas) == search_color)
-        signature |= 1 << 0;
-    if (flare16x_canvas_raw(offset_x + 5, offset_y + 2, canvas) == search_color)
-        signature |= 1 << 1;
-    if (flare16x_canvas_raw(offset_x + 1, offset_y + 4, canvas) == search_color)
-        signature |= 1 << 2;
-    if (flare16x_canvas_raw(offset_x + 6, offset_y + 5, canvas) == search_color)
-        signature |= 1 << 3;
-    if (flare16x_canvas_raw(offset_x + 4, offset_y + 8, canvas) == search_color)
-        signature |= 1 << 4;
-    if (flare16x_canvas_raw(offset_x + 7, offset_y + 8, canvas) == search_color)
-        signature |= 1 << 5;
-    if (flare16x_canvas_raw(offset_x + 5, offset_y + 10, canvas) == search_color)
-        signature |= 1 << 6;
-    if (flare16x_canvas_raw(offset_x + 7, offset_y + 10, canvas) == search_color)
-        signature |= 1 << 7;
-
-    // Finally, match the signature against known values
-    switch (signature)
-    {
-        case 0x25:
-            *result_char = '0';
-            break;
-        case 0x52:
-            *result_char = '1';
-            break;
-        case 0xd0:
-            *result_char = '2';
-            break;
-        case 0x89:
-            *result_char = '3';
-            break;
-        case 0xb2:
-            *result_char = '4';
-            break;
-        case 0x29:
-            *result_char = '5';
-            break;
-        case 0x6d:
-            *result_char = '6';
-            break;
-        case 0x19:
-            *result_char = '7';
-            break;
-        case 0x21:
-            *result_char = '8';
-            break;
-        case 0xc0:
-            *result_char = '9';
-            break;
-        case 0x00:
-            *result_char = ' ';
-            break;
-        case 0x40:
-            *result_char = '.';
-            break;
-        case 0x12:
-            *result_char = ':';
-            break;
-        case 0xc9:
-            *result_char = 'E';
-            break;
-        default:
-            *result_char = 0;
-            return flare16x_error_make(FLARE16X_ERROR_UNKNOWN, FLARE16X_ERROR_SOURCE_OCR);
-    }
+    // Next, binarize the glyph and match it against the templates of the font
+    uint32_t rows[FLARE16X_OCR_MAX_HEIGHT];
+    flare16x_ocr_match match;
+    flare16x_ocr_canvas_rows(canvas, offset_x, offset_y, &flare16x_ocr_small_font, rows);
+    flare16x_error error = flare16x_ocr_match_glyph(rows, &flare16x_ocr_small_font, &match);
 
-    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_OCR);
+    // Finally, return the recognized character, which is 0 for an unknown glyph
+    *result_char = match.symbol;
+    return error;
 }
 
 // Attempts to detect a small string (with capacity length + 1) of length characters
 flare16x_error flare16x_ocr_small_string(uint16_t offset_x, uint16_t offset_y, uint16_t pitch, uint16_t length,
                                          uint16_t max_unknown, flare16x_canvas* canvas, char* result_string)
 {
-    // Verify that the canvas and output char are not null pointers
-    if (canvas == NULL || result_string == NULL || canvas->pixels == NULL)
+    // Describe the string as a single field and recognize it in one pass
+    flare16x_ocr_field field = {offset_x, offset_y, pitch, (uint8_t)length, (uint8_t)max_unknown,
+            &flare16x_ocr_small_font, result_string, 0, 0};
+
+    // Make sure the length fits into a field, as all other checks are done by the strip recognition
+    if (length > FLARE16X_OCR_MAX_LENGTH)
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_OCR);
+    if (max_unknown > length)
+        field.max_unknown = (uint8_t)length;
+
+    return flare16x_ocr_strip(canvas, &field, 1);
+}
+
+// Recognizes several fields of a text strip in a single row-major pass over the canvas
+// Each row is read once and binarized into the glyphs of all fields that cover it, before all glyphs are matched
+flare16x_error flare16x_ocr_strip(flare16x_canvas* canvas, flare16x_ocr_field* fields, uint8_t count)
+{
+    // Binarize the glyphs first
+    flare16x_ocr_glyphs glyphs;
+    flare16x_error error = flare16x_ocr_strip_binarize(canvas, fields, count, &glyphs);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return error;
+
+    // Then, match them
+    return flare16x_ocr_strip_match(fields, count, &glyphs);
+}
+
+// Binarizes the glyphs of several fields of a text strip in a single row-major pass over the canvas
+// The results of the fields are cleared, but only filled in by matching the glyphs
+flare16x_error flare16x_ocr_strip_binarize(flare16x_canvas* canvas, flare16x_ocr_field* fields, uint8_t count,
+        flare16x_ocr_glyphs* glyphs)
+{
+    // Verify that the canvas, fields and glyphs are not null pointers
+    if (canvas == NULL || fields == NULL || glyphs == NULL || canvas->pixels == NULL)
         return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_OCR);
 
     // Check, that the width and height are valid
     if (canvas->width == 0 || canvas->height == 0)
         return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_OCR);
 
-    // Also check that the offsets, width and height are correct
-    if (length == 0 || (FLARE16X_OCR_SMALL_WIDTH + pitch) * length + offset_x > canvas->width + pitch ||
-        offset_y + FLARE16X_OCR_SMALL_HEIGHT > canvas->height)
+    // Also check the number of fields
+    if (count == 0 || count > FLARE16X_OCR_MAX_FIELDS)
         return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_OCR);
 
-    // Now, clear the output string
-    memset(result_string, 0, length + 1);
+    // Next, verify that every field is complete and fits into the canvas and clear its result
+    uint8_t field;
+    for (field = 0; field < count; field++)
+    {
+        flare16x_ocr_field* current = &fields[field];
+        if (current->font == NULL || current->font->mask == NULL || current->result == NULL)
+            return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_OCR);
+        if (current->length == 0 || current->length > FLARE16X_OCR_MAX_LENGTH ||
+            (current->font->width + current->pitch) * current->length + current->offset_x >
+            canvas->width + current->pitch || current->offset_y + current->font->height > canvas->height)
+            return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_OCR);
+        memset(current->result, 0, current->length + 1);
+    }
 
-    // Next, loop through the characters and end on the first error
-    int src_digit, dst_digit;
-    for (src_digit = 0, dst_digit = 0; src_digit < length; src_digit++)
+    // Walk through the rows in memory order and binarize every glyph row that the font of its field compares
+    memset(glyphs, 0, sizeof(flare16x_ocr_glyphs));
+    glyphs->count = count;
+    uint16_t y, x;
+    uint8_t glyph;
+    for (y = 0; y < canvas->height; y++)
     {
-        flare16x_error error;
-        error = flare16x_ocr_small_char((FLARE16X_OCR_SMALL_WIDTH + pitch) * src_digit + offset_x, offset_y,
-                                        canvas, result_string + dst_digit);
-        switch (flare16x_error_reason(error))
+        const uint16_t* line = &flare16x_canvas_raw(0, y, canvas);
+        for (field = 0; field < count; field++)
         {
-            case FLARE16X_ERROR_NONE:
-                // No error, move on to the next digit
-                dst_digit++;
-                break;
-
-            case FLARE16X_ERROR_UNKNOWN:
-                // Unknown digit, don't output it
-                // If the maximum number of unknown digits is reached, throw an error
-                if (max_unknown == 0)
-                    return error;
+            const flare16x_ocr_field* current = &fields[field];
+            const flare16x_ocr_font* font = current->font;
 
-                // Otherwise, decrement the remaining counter of unknown values and continue
-                max_unknown--;
+            // Skip the field, if this row is not part of its glyphs or never compared
+            if (y < current->offset_y || y >= current->offset_y + font->height ||
+                font->mask[y - current->offset_y] == 0)
                 continue;
 
-            default:
-                return error;
+            // Binarize the row of every glyph from left to right
+            const uint16_t* pixels = line + current->offset_x;
+            for (glyph = 0; glyph < current->length; glyph++, pixels += font->width + current->pitch)
+            {
+                uint32_t row = 0;
+                for (x = 0; x < font->width; x++)
+                    row |= (uint32_t)(pixels[x] == font->color) << x;
+                glyphs->rows[field][glyph][y - current->offset_y] = row;
+            }
+        }
+    }
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_OCR);
+}
+
+// Matches the binarized glyphs of several fields and stores the recognized strings in their results
+// The distance and confidence of every field tell how closely its recognized glyphs matched their templates
+flare16x_error flare16x_ocr_strip_match(flare16x_ocr_field* fields, uint8_t count, flare16x_ocr_glyphs* glyphs)
+{
+    // Verify that the fields and glyphs are not null pointers
+    if (fields == NULL || glyphs == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_OCR);
+
+    // Make sure the glyphs belong to these fields
+    if (count == 0 || count != glyphs->count)
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_OCR);
+
+    // Match the glyphs of every field, skipping up to the allowed number of unknown ones
+    uint8_t field, glyph;
+    for (field = 0; field < count; field++)
+    {
+        flare16x_ocr_field* current = &fields[field];
+        uint8_t position = 0, max_unknown = current->max_unknown;
+        if (current->font == NULL || current->result == NULL)
+            return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_OCR);
+        if (current->length > FLARE16X_OCR_MAX_LENGTH)
+            return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_OCR);
+        current->distance = 0;
+        current->confidence = FLARE16X_OCR_NO_DISTANCE;
+        for (glyph = 0; glyph < current->length; glyph++)
+        {
+            flare16x_ocr_match match;
+            flare16x_error error = flare16x_ocr_match_glyph(glyphs->rows[field][glyph], current->font, &match);
+            switch (flare16x_error_reason(error))
+            {
+                case FLARE16X_ERROR_NONE:
+                    // No error, append the character and keep the worst match of the field
+                    current->result[position++] = match.symbol;
+                    if (match.distance > current->distance)
+                        current->distance = match.distance;
+                    if (match.confidence < current->confidence)
+                        current->confidence = match.confidence;
+                    break;
+
+                case FLARE16X_ERROR_UNKNOWN:
+                    // Unknown glyph, don't output it
+                    // If the maximum number of unknown glyphs is reached, throw an error
+                    if (max_unknown == 0)
+                        return error;
+
+                    // Otherwise, decrement the remaining counter of unknown glyphs and continue
+                    max_unknown--;
+                    continue;
+
+                default:
+                    return error;
+            }
         }
     }
 
     // Fall through to success
     return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_OCR);
 }
+
+// Calculates a 64-bit fingerprint of the compared pixels of all glyphs
+// Glyphs with the same fingerprint are recognized as the same strings, unless the fingerprints collide by chance
+uint64_t flare16x_ocr_fingerprint(const flare16x_ocr_field* fields, uint8_t count,
+        const flare16x_ocr_glyphs* glyphs)
+{
+    // Return the empty fingerprint for null pointers
+    if (fields == NULL || glyphs == NULL || count > FLARE16X_OCR_MAX_FIELDS)
+        return 0;
+
+    // Hash the masked rows of every glyph with FNV-1a on whole words, which runs over a few dozen words only
+    uint64_t hash = 0xcbf29ce484222325ull;
+    uint8_t field, glyph, y;
+    for (field = 0; field < count; field++)
+    {
+        const flare16x_ocr_font* font = fields[field].font;
+        for (glyph = 0; glyph < fields[field].length && glyph < FLARE16X_OCR_MAX_LENGTH; glyph++)
+            for (y = 0; y < font->height; y++)
+                if (font->mask[y] != 0)
+                    hash = (hash ^ (glyphs->rows[field][glyph][y] & font->mask[y])) * 0x100000001b3ull;
+
+        // Separate the fields, so that glyphs cannot move from one field to the next unnoticed
+        hash = (hash ^ (0x100u | field)) * 0x100000001b3ull;
+    }
+
+    // Mix the high bits into the low ones, as the multiplication only carries upwards
+    hash ^= hash >> 29;
+    hash *= 0xbf58476d1ce4e5b9ull;
+    return hash ^ (hash >> 32);
+}
@@ -9,6 +9,8 @@
 #ifndef FLARE16X_OCR_H
 #define FLARE16X_OCR_H
 
+#include <stdint.h>
+
 #include "error.h"
 #include "canvas.h"
 
@@ -20,6 +22,117 @@
 #define FLARE16X_OCR_SMALL_HEIGHT 12
 #define FLARE16X_OCR_SMALL_COLOR flare16x_canvas_rgb888(0xff, 0xff, 0xff)
 
+// The maximum height of a glyph in rows
+#define FLARE16X_OCR_MAX_HEIGHT 23
+// The distance reported for a glyph that was not compared
+#define FLARE16X_OCR_NO_DISTANCE 0xffff
+// The maximum number of fields recognized in one pass over a strip
+#define FLARE16X_OCR_MAX_FIELDS 4
+// The maximum number of glyphs of a field
+#define FLARE16X_OCR_MAX_LENGTH 8
+
+/*
+ * The OCR binarizes the rows of every glyph into single words, which hold one bit per pixel that is set for the
+ * text color, with the leftmost pixel in the least significant bit.
+ * A glyph is recognized by comparing its rows to the template of every character of the font: the distance to a
+ * template is the number of differing pixels within the mask of the font, counted using XOR and popcount.
+ * The character of the closest template wins, as long as its distance is within the tolerance of the font and no
+ * other character is as close. The distance to the closest other character tells how confident the result is.
+ * The built-in fonts compare every pixel of a glyph against templates drawn after the OSD fonts, which agree with
+ * the eight pixels of every glyph that tell the characters of the OSD apart. Any two templates of the large font
+ * differ in at least 17 pixels and those of the small font in at least 6, so these fonts tolerate 8 and 2 differing
+ * pixels, which is less than half of that. A glyph that still differs too much from every template is matched again
+ * against the fallback font, which only compares the eight distinguishing pixels and tolerates no differing pixel,
+ * as two characters may differ in a single one of them. Templates may only set pixels within the mask.
+ */
+
+// The template of a single character
+typedef struct {
+    // The character
+    char symbol;
+    // The pixels of every row that are set for the character, with the leftmost pixel in the least significant bit
+    uint32_t rows[FLARE16X_OCR_MAX_HEIGHT];
+} flare16x_ocr_glyph;
+
+// A font of fixed size glyphs
+typedef struct flare16x_ocr_font {
+    // The width of a glyph in pixels (at most 32)
+    uint8_t width;
+    // The height of a glyph in pixels (at most FLARE16X_OCR_MAX_HEIGHT)
+    uint8_t height;
+    // The maximum distance of a recognized glyph
+    uint8_t tolerance;
+    // The number of templates
+    uint8_t count;
+    // The color of the text
+    uint16_t color;
+    // The pixels of every row that are compared
+    const uint32_t* mask;
+    // The templates of all characters
+    const flare16x_ocr_glyph* glyphs;
+    // The font that a glyph is matched against, if it is not recognized by this font, or NULL
+    const struct flare16x_ocr_font* fallback;
+} flare16x_ocr_font;
+
+// The result of matching a glyph against a font
+typedef struct {
+    // The recognized character or 0, if the glyph is not recognized
+    char symbol;
+    // The closest character, even if the glyph is not recognized
+    char best;
+    // The second closest character
+    char runner_up;
+    // The distance to the closest character
+    uint16_t distance;
+    // The distance to the second closest character
+    uint16_t runner_up_distance;
+    // The distance of the second closest character minus the distance of the closest one
+    uint16_t confidence;
+    // Set, if the glyph was only recognized by the fallback font, to which the distances then refer
+    uint8_t fallback;
+} flare16x_ocr_match;
+
+// A line of equally spaced glyphs of one font that is recognized as a string
+typedef struct {
+    // The x-offset of the first glyph
+    uint16_t offset_x;
+    // The y-offset of the glyphs
+    uint16_t offset_y;
+    // The number of pixels between two glyphs
+    uint16_t pitch;
+    // The number of glyphs (at most FLARE16X_OCR_MAX_LENGTH)
+    uint8_t length;
+    // The number of unknown glyphs that are skipped before failing
+    uint8_t max_unknown;
+    // The font of the glyphs
+    const flare16x_ocr_font* font;
+    // The recognized string with a capacity of length + 1 characters
+    char* result;
+    // The highest distance of all recognized glyphs, filled in by matching the glyphs
+    uint16_t distance;
+    // The lowest confidence of all recognized glyphs, filled in by matching the glyphs
+    uint16_t confidence;
+} flare16x_ocr_field;
+
+// The binarized glyphs of all fields of a strip
+typedef struct {
+    // The number of fields
+    uint8_t count;
+    // The rows of every glyph of every field, of which only the rows compared by the font are filled in
+    uint32_t rows[FLARE16X_OCR_MAX_FIELDS][FLARE16X_OCR_MAX_LENGTH][FLARE16X_OCR_MAX_HEIGHT];
+} flare16x_ocr_glyphs;
+
+// The large font of the temperature
+extern const flare16x_ocr_font flare16x_ocr_large_font;
+
+// The small font of the emissivity
+extern const flare16x_ocr_font flare16x_ocr_small_font;
+
+// Matches the rows of a glyph against all templates of a font
+// Fails with an unknown error, if no character is close enough, while the match is filled in regardless
+flare16x_error flare16x_ocr_match_glyph(const uint32_t* rows, const flare16x_ocr_font* font,
+        flare16x_ocr_match* match);
+
 // Attempts to detect a single large font character
 flare16x_error flare16x_ocr_large_char(uint16_t offset_x, uint16_t offset_y, flare16x_canvas* canvas,
                                        char* result_char);
@@ -36,4 +149,22 @@ flare16x_error flare16x_ocr_small_char(uint16_t offset_x, uint16_t offset_y, fla
 flare16x_error flare16x_ocr_small_string(uint16_t offset_x, uint16_t offset_y, uint16_t pitch, uint16_t length,
                                          uint16_t max_unknown, flare16x_canvas* canvas, char* result_string);
 
+// Recognizes several fields of a text strip in a single row-major pass over the canvas
+// Each row is read once and binarized into the glyphs of all fields that cover it, before all glyphs are matched
+flare16x_error flare16x_ocr_strip(flare16x_canvas* canvas, flare16x_ocr_field* fields, uint8_t count);
+
+// Binarizes the glyphs of several fields of a text strip in a single row-major pass over the canvas
+// The results of the fields are cleared, but only filled in by matching the glyphs
+flare16x_error flare16x_ocr_strip_binarize(flare16x_canvas* canvas, flare16x_ocr_field* fields, uint8_t count,
+        flare16x_ocr_glyphs* glyphs);
+
+// Matches the binarized glyphs of several fields and stores the recognized strings in their results
+// The distance and confidence of every field tell how closely its recognized glyphs matched their templates
+flare16x_error flare16x_ocr_strip_match(flare16x_ocr_field* fields, uint8_t count, flare16x_ocr_glyphs* glyphs);
+
+// Calculates a 64-bit fingerprint of the compared pixels of all glyphs
+// Glyphs with the same fingerprint are recognized as the same strings, unless the fingerprints collide by chance
+uint64_t flare16x_ocr_fingerprint(const flare16x_ocr_field* fields, uint8_t count,
+        const flare16x_ocr_glyphs* glyphs);
+
 #endif //FLARE16X_OCR_H
@@ -10,6 +10,7 @@
 #include <string.h>
 
 #include "error.h"
+#include "profile.h"
 #include "locator.h"
 #include "canvas.h"
 
@@ -79,15 +80,17 @@ flare16x_error flare16x_palettes_find_color(uint16_t color, uint8_t palette_inde
 
     // Check the cache first
     int item;
-    for (item = 0; item < FLARE16X_PALETTES_CACHE_SIZE; item++)
+    for (item = 0; item < cache->length; item++)
         if (cache->entries[item].color == color)
         {
             // Assign the result pointer
             *result_entry = &cache->entries[item];
+            cache->hits++;
             return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_PALETTES);
         }
 
     // Iterate through the palette and try to find the value
+    cache->misses++;
     for (item = 0; item < palette_length; item++)
         if (palette[item].color == color)
         {
@@ -141,10 +144,12 @@ flare16x_error flare16x_palettes_find_value(uint8_t value, uint8_t palette_index
         {
             // Assign the result pointer
             *result_entry = &cache->entries[item];
+            cache->hits++;
             return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_PALETTES);
         }
 
     // Iterate through the palette and try to find the value
+    cache->misses++;
     for (item = 0; item < palette_length; item++)
         if (palette[item].base <= value && palette[item].base + palette[item].width > value)
         {
@@ -175,119 +180,145 @@ flare16x_error flare16x_palettes_find_value(uint8_t value, uint8_t palette_index
     return flare16x_error_make(FLARE16X_ERROR_IMAGE, FLARE16X_ERROR_SOURCE_PALETTES);
 }
 
-// Analyzes the canvas and returns the matching palette enum index
-flare16x_error flare16x_palettes_determine(flare16x_canvas* canvas, uint16_t max_errors, uint8_t* palette_index)
+// Initializes the given tally struct used to determine the palette of an image line by line
+// This will not leak any memory if done repeatedly
+flare16x_error flare16x_palettes_tally_init(uint16_t max_errors, flare16x_palette_tally* tally)
 {
-    // Make sure the canvas and palette index pointers are not null
-    if (canvas == NULL || canvas->pixels == NULL || palette_index == NULL)
+    // Make sure that the tally pointer is not null
+    if (tally == NULL)
         return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_PALETTES);
 
-    // Also verify width and height
-    if (canvas->width == 0 || canvas->height == 0)
-        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_PALETTES);
+    // Zero the structure, which clears the counts and caches
+    memset(tally, 0, sizeof(flare16x_palette_tally));
 
-    // Allocate an array with the size of the number of palettes
-    // This array keeps track of the number of color matches
-    uint32_t palettes_counts[FLARE16X_PALETTES_COUNT];
-    memset(palettes_counts, 0, FLARE16X_PALETTES_COUNT * sizeof(uint32_t));
+    // And keep the number of permitted errors
+    tally->max_errors = max_errors;
 
-    // Also, for speed, cache a number of the latest found palette entries from all palettes
-    flare16x_palette_cache cache[FLARE16X_PALETTES_COUNT];
-    memset(cache, 0, FLARE16X_PALETTES_COUNT * sizeof(flare16x_palette_cache));
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_PALETTES);
+}
 
-    // Iterate through all pixels
-    int x, y;
-    for (y = 0; y < canvas->height; y++)
-        for (x = 0; x < canvas->width; x++)
-        {
-            // Fetch the pixel first
-            uint16_t p = flare16x_canvas_raw(x, y, canvas);
+// Counts the palette matches of a line of RGB565 pixels
+// Fails, once the number of unknown colors exceeds the maximum errors passed to the init function
+flare16x_error flare16x_palettes_tally_line(const uint16_t* pixels, uint16_t width, flare16x_palette_tally* tally)
+{
+    // Make sure the pixel and tally pointers are not null
+    if (pixels == NULL || tally == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_PALETTES);
 
-            // Make sure that the color is not used in the crosshair
-            if (p == FLARE16X_LOCATOR_CROSSHAIR_BORDER || p == FLARE16X_LOCATOR_CROSSHAIR_FILL)
-                continue;
+    // Iterate through all pixels of the line, counting the cache hits and misses for the profile
+    int x;
+    uint32_t hits = 0, misses = 0;
+    int failed = 0;
+    for (x = 0; x < width && !failed; x++)
+    {
+        // Fetch the pixel first
+        uint16_t p = pixels[x];
 
-            // Iterate through the palettes
-            int current_palette, matching_palette = FLARE16X_PALETTES_UNKNOWN;
-            for (current_palette = FLARE16X_PALETTES_MIN; current_palette <= FLARE16X_PALETTES_MAX; current_palette++)
-            {
-                // Try to look it up in the cache first
-                int item;
-                for (item = 0; item < cache[current_palette - FLARE16X_PALETTES_MIN].length; item++)
-                    if (cache[current_palette - FLARE16X_PALETTES_MIN].entries[item].color == p)
+        // Make sure that the color is not used in the crosshair
+        if (p == FLARE16X_LOCATOR_CROSSHAIR_BORDER || p == FLARE16X_LOCATOR_CROSSHAIR_FILL)
+            continue;
+
+        // Iterate through the palettes
+        int current_palette, matching_palette = FLARE16X_PALETTES_UNKNOWN;
+        for (current_palette = FLARE16X_PALETTES_MIN; current_palette <= FLARE16X_PALETTES_MAX; current_palette++)
+        {
+            // Try to look it up in the cache first
+            int item;
+            for (item = 0; item < tally->cache[current_palette - FLARE16X_PALETTES_MIN].length; item++)
+                if (tally->cache[current_palette - FLARE16X_PALETTES_MIN].entries[item].color == p)
+                {
+                    tally->counts[current_palette - FLARE16X_PALETTES_MIN]++;
+                    matching_palette = current_palette;
+                    hits++;
+                    break;
+                }
+
+            // Check, if the item was found
+            if (matching_palette != FLARE16X_PALETTES_UNKNOWN)
+                continue;
+            misses++;
+
+            // Otherwise fetch the palette pointer and assert that the palette must never be null
+            const flare16x_palette_entry* palette = flare16x_palettes_get(current_palette);
+            if (palette == NULL)
+                return flare16x_error_make(FLARE16X_ERROR_ASSERT, FLARE16X_ERROR_SOURCE_PALETTES);
+
+            // Then iterate through the entire palette
+            for (item = 0; item < flare16x_palettes_get_length(current_palette); item++)
+                if (palette[item].color == p)
+                {
+                    // Increment the palette item
+                    tally->counts[current_palette - FLARE16X_PALETTES_MIN]++;
+                    matching_palette = current_palette;
+
+                    // Check, if a new item has to be added
+                    if (tally->cache[current_palette - FLARE16X_PALETTES_MIN].length < FLARE16X_PALETTES_CACHE_SIZE)
                     {
-                        palettes_counts[current_palette - FLARE16X_PALETTES_MIN]++;
-                        matching_palette = current_palette;
+                        // Copy the new palette item, reset its pointer and increment the size
+                        tally->cache[current_palette - FLARE16X_PALETTES_MIN].index = 0;
+                        memcpy(&tally->cache[current_palette - FLARE16X_PALETTES_MIN].entries[
+                                tally->cache[current_palette - FLARE16X_PALETTES_MIN].length++],
+                                        palette + item, sizeof(flare16x_palette_entry));
                         break;
                     }
 
-                // Check, if the item was found
-                if (matching_palette != FLARE16X_PALETTES_UNKNOWN)
-                    continue;
+                    // If the palette is already full, update the item at the pointer
+                    memcpy(&tally->cache[current_palette - FLARE16X_PALETTES_MIN].entries[
+                            tally->cache[current_palette - FLARE16X_PALETTES_MIN].index++], palette + item,
+                                    sizeof(flare16x_palette_entry));
+
+                    // Finally, make sure the pointer is in range
+                    if (tally->cache[current_palette - FLARE16X_PALETTES_MIN].index >=
+                        tally->cache[current_palette - FLARE16X_PALETTES_MIN].length)
+                        tally->cache[current_palette - FLARE16X_PALETTES_MIN].index = 0;
+                    break;
+                }
+        }
 
-                // Otherwise fetch the palette pointer and assert that the palette must never be null
-                const flare16x_palette_entry* palette = flare16x_palettes_get(current_palette);
-                if (palette == NULL)
-                    return flare16x_error_make(FLARE16X_ERROR_ASSERT, FLARE16X_ERROR_SOURCE_PALETTES);
+        // Make sure an item was found
+        if (matching_palette == FLARE16X_PALETTES_UNKNOWN)
+        {
+            // Only count down the maximum errors, if it is not IGNORE_ERRORS
+            if (tally->max_errors == FLARE16X_PALETTES_IGNORE_ERRORS)
+                continue;
 
-                // Then iterate through the entire palette
-                for (item = 0; item < flare16x_palettes_get_length(current_palette); item++)
-                    if (palette[item].color == p)
-                    {
-                        // Increment the palette item
-                        palettes_counts[current_palette - FLARE16X_PALETTES_MIN]++;
-                        matching_palette = current_palette;
-
-                        // Check, if a new item has to be added
-                        if (cache[current_palette - FLARE16X_PALETTES_MIN].length < FLARE16X_PALETTES_CACHE_SIZE)
-                        {
-                            // Copy the new palette item, reset its pointer and increment the size
-                            cache[current_palette - FLARE16X_PALETTES_MIN].index = 0;
-                            memcpy(&cache[current_palette - FLARE16X_PALETTES_MIN].entries[
-                                    cache[current_palette - FLARE16X_PALETTES_MIN].length++],
-                                            palette + item, sizeof(flare16x_palette_entry));
-                            break;
-                        }
-
-                        // If the palette is already full, update the item at the pointer
-                        memcpy(&cache[current_palette - FLARE16X_PALETTES_MIN].entries[
-                                cache[current_palette - FLARE16X_PALETTES_MIN].index++], palette + item,
-                                        sizeof(flare16x_palette_entry));
-
-                        // Finally, make sure the pointer is in range
-                        if (cache[current_palette - FLARE16X_PALETTES_MIN].index >=
-                            cache[current_palette - FLARE16X_PALETTES_MIN].length)
-                            cache[current_palette - FLARE16X_PALETTES_MIN].index = 0;
-                        break;
-                    }
-            }
+            // Decrement the remaining maximum errors
+            tally->max_errors--;
 
-            // Make sure an item was found
-            if (matching_palette == FLARE16X_PALETTES_UNKNOWN)
-            {
-                // Only count down the maximum errors, if it is not IGNORE_ERRORS
-                if (max_errors == FLARE16X_PALETTES_IGNORE_ERRORS)
-                    continue;
+            // If there are no more mishaps possible, fail
+            failed = tally->max_errors < 1;
+        }
+    }
 
-                // Decrement the remaining maximum errors
-                max_errors--;
+    // Add the counts of this line to the profile
+    flare16x_profile_count(FLARE16X_PROFILE_PALETTE_PIXELS, (uint64_t)x);
+    flare16x_profile_count(FLARE16X_PROFILE_PALETTE_HITS, hits);
+    flare16x_profile_count(FLARE16X_PROFILE_PALETTE_MISSES, misses);
 
-                // If there are no more mishaps possible, fail
-                if (max_errors < 1)
-                    return flare16x_error_make(FLARE16X_ERROR_IMAGE, FLARE16X_ERROR_SOURCE_PALETTES);
-            }
-        }
+    // Fail, if there are no more mishaps possible
+    if (failed)
+        return flare16x_error_make(FLARE16X_ERROR_IMAGE, FLARE16X_ERROR_SOURCE_PALETTES);
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_PALETTES);
+}
+
+// Returns the highest ranked palette enum index of all lines counted so far
+flare16x_error flare16x_palettes_tally_result(flare16x_palette_tally* tally, uint8_t* palette_index)
+{
+    // Make sure the tally and palette index pointers are not null
+    if (tally == NULL || palette_index == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_PALETTES);
 
     // Now, determine the highest ranked palette
     int current_palette, highest_palette = FLARE16X_PALETTES_UNKNOWN, equal_palette = FLARE16X_PALETTES_UNKNOWN,
         highest_count = 0;
     for (current_palette = 0; current_palette < FLARE16X_PALETTES_COUNT; current_palette++)
     {
-        if (highest_count < palettes_counts[current_palette])
+        if (highest_count < tally->counts[current_palette])
         {
-            highest_count = palettes_counts[current_palette];
+            highest_count = tally->counts[current_palette];
             highest_palette = current_palette + FLARE16X_PALETTES_MIN;
-        } else if (highest_count == palettes_counts[current_palette])
+        } else if (highest_count == tally->counts[current_palette])
             equal_palette = current_palette + FLARE16X_PALETTES_MIN;
     }
 
@@ -301,3 +332,42 @@ flare16x_error flare16x_palettes_determine(flare16x_canvas* canvas, uint16_t max
     return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_PALETTES);
 }
 
+// Implements flare16x_palettes_determine without profiling
+static flare16x_error flare16x_palettes_determine_untimed(flare16x_canvas* canvas, uint16_t max_errors,
+        uint8_t* palette_index)
+{
+    // Make sure the canvas and palette index pointers are not null
+    if (canvas == NULL || canvas->pixels == NULL || palette_index == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_PALETTES);
+
+    // Also verify width and height
+    if (canvas->width == 0 || canvas->height == 0)
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_PALETTES);
+
+    // Allocate a tally, which keeps track of the number of color matches and caches the latest entries
+    flare16x_palette_tally tally;
+    flare16x_palettes_tally_init(max_errors, &tally);
+
+    // Iterate through all lines
+    int y;
+    for (y = 0; y < canvas->height; y++)
+    {
+        flare16x_error error = flare16x_palettes_tally_line(&flare16x_canvas_raw(0, y, canvas), canvas->width,
+                &tally);
+        if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+            return error;
+    }
+
+    // Now, determine the highest ranked palette
+    return flare16x_palettes_tally_result(&tally, palette_index);
+}
+
+// Analyzes the canvas and returns the matching palette enum index
+flare16x_error flare16x_palettes_determine(flare16x_canvas* canvas, uint16_t max_errors, uint8_t* palette_index)
+{
+    // Time the whole analysis, if profiling is enabled
+    uint64_t start = flare16x_profile_begin();
+    flare16x_error error = flare16x_palettes_determine_untimed(canvas, max_errors, palette_index);
+    flare16x_profile_end(FLARE16X_PROFILE_PALETTES_DETERMINE, start);
+    return error;
+}
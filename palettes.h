@@ -49,8 +49,21 @@ typedef struct {
     flare16x_palette_entry entries[FLARE16X_PALETTES_CACHE_SIZE];
     uint8_t length;
     uint8_t index;
+    // The number of lookups that were answered by the cache and that had to search the palette
+    uint32_t hits;
+    uint32_t misses;
 } flare16x_palette_cache;
 
+// Keeps track of the palette matches while analyzing an image line by line
+typedef struct {
+    // The number of color matches per palette starting at FLARE16X_PALETTES_MIN
+    uint32_t counts[FLARE16X_PALETTES_COUNT];
+    // The caches of the latest found palette entries per palette starting at FLARE16X_PALETTES_MIN
+    flare16x_palette_cache cache[FLARE16X_PALETTES_COUNT];
+    // The remaining number of unknown colors or FLARE16X_PALETTES_IGNORE_ERRORS
+    uint16_t max_errors;
+} flare16x_palette_tally;
+
 // The raw iron palette struct data
 extern const flare16x_palette_entry palette_iron[];
 // The number of struct elements in the iron palette
@@ -88,6 +101,17 @@ flare16x_error flare16x_palettes_find_color(uint16_t color, uint8_t palette_inde
 flare16x_error flare16x_palettes_find_value(uint8_t value, uint8_t palette_index, flare16x_palette_cache* cache,
                                             const flare16x_palette_entry** result_entry);
 
+// Initializes the given tally struct used to determine the palette of an image line by line
+// This will not leak any memory if done repeatedly
+flare16x_error flare16x_palettes_tally_init(uint16_t max_errors, flare16x_palette_tally* tally);
+
+// Counts the palette matches of a line of RGB565 pixels
+// Fails, once the number of unknown colors exceeds the maximum errors passed to the init function
+flare16x_error flare16x_palettes_tally_line(const uint16_t* pixels, uint16_t width, flare16x_palette_tally* tally);
+
+// Returns the highest ranked palette enum index of all lines counted so far
+flare16x_error flare16x_palettes_tally_result(flare16x_palette_tally* tally, uint8_t* palette_index);
+
 // Analyzes the canvas and returns the matching palette enum index
 flare16x_error flare16x_palettes_determine(flare16x_canvas* canvas, uint16_t max_errors, uint8_t* palette_index);
 
@@ -0,0 +1,386 @@
+//
+// flare16x core
+// Developed 2019 by Benedikt Muessig <github@bmuessig.eu>
+// Licensed under GPLv3
+//
+// profile.c: Optional per-stage timing instrumentation of the library
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "error.h"
+
+#include "profile.h"
+
+// Every thread keeps its own accumulators, so that recording never needs a lock
+#if defined(__GNUC__) || defined(__clang__)
+#define FLARE16X_PROFILE_THREAD __thread
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define FLARE16X_PROFILE_THREAD _Thread_local
+#else
+#define FLARE16X_PROFILE_THREAD
+#endif
+
+// The names of all stages
+static const char* const flare16x_profile_names[FLARE16X_PROFILE_STAGE_COUNT] = {
+    // FLARE16X_PROFILE_BITMAP_LOAD
+    "bitmap_load",
+    // FLARE16X_PROFILE_LOCATOR_LOAD
+    "locator_load",
+    // FLARE16X_PROFILE_LOCATOR_CREATE
+    "locator_create",
+    // FLARE16X_PROFILE_LOCATOR_PROCESS
+    "locator_process",
+    // FLARE16X_PROFILE_THERMAL_CREATE
+    "thermal_create",
+    // FLARE16X_PROFILE_THERMAL_OCR
+    "thermal_ocr",
+    // FLARE16X_PROFILE_PALETTES_DETERMINE
+    "palettes_determine",
+    // FLARE16X_PROFILE_THERMAL_DECODE
+    "thermal_decode",
+    // FLARE16X_PROFILE_THERMAL_INTERPOLATE
+    "thermal_interpolate",
+    // FLARE16X_PROFILE_THERMAL_EXPORT
+    "thermal_export",
+    // FLARE16X_PROFILE_THERMAL_CROSSHAIR
+    "thermal_crosshair",
+    // FLARE16X_PROFILE_BITMAP_STORE
+    "bitmap_store"
+};
+
+// The names of all counters
+static const char* const flare16x_profile_counter_names[FLARE16X_PROFILE_COUNTER_COUNT] = {
+    // FLARE16X_PROFILE_PALETTE_HITS
+    "palette_hits",
+    // FLARE16X_PROFILE_PALETTE_MISSES
+    "palette_misses",
+    // FLARE16X_PROFILE_PALETTE_PIXELS
+    "palette_pixels",
+    // FLARE16X_PROFILE_INVALID_PIXELS
+    "invalid_pixels",
+    // FLARE16X_PROFILE_CROSSHAIR_PIXELS
+    "crosshair_pixels",
+    // FLARE16X_PROFILE_NEIGHBOUR_VISITS
+    "neighbour_visits",
+    // FLARE16X_PROFILE_LOCATOR_RESCANS
+    "locator_rescans"
+};
+
+// The initial number of spans of a trace buffer
+#define FLARE16X_PROFILE_TRACE_CAPACITY 1024
+
+// A span of the trace
+typedef struct {
+    // The name of the span
+    const char* name;
+    // The copied file name or null
+    char* file_name;
+    // The start and end time in nanoseconds
+    uint64_t start;
+    uint64_t end;
+    // The device model and palette or negative, if they are not tagged
+    int16_t device_model;
+    int16_t palette;
+} flare16x_profile_span;
+
+// The spans recorded by one thread
+typedef struct flare16x_profile_buffer {
+    // The next buffer in the global list
+    struct flare16x_profile_buffer* next;
+    // The number of the thread in the trace
+    uint32_t thread;
+    // The number of spans recorded
+    size_t count;
+    // The number of spans that fit into the allocated memory
+    size_t capacity;
+    // The number of spans that were dropped, as the memory could not be grown
+    size_t dropped;
+    // The spans
+    flare16x_profile_span* spans;
+} flare16x_profile_buffer;
+
+// The active profiling flags as defined in FLARE16X_PROFILE_* (only to be changed by flare16x_profile_enable)
+volatile uint8_t flare16x_profile_active = 0;
+
+// The accumulators of the calling thread
+static FLARE16X_PROFILE_THREAD flare16x_profile flare16x_profile_thread;
+
+// The trace buffer of the calling thread
+static FLARE16X_PROFILE_THREAD flare16x_profile_buffer* flare16x_profile_thread_buffer;
+
+// The list of the trace buffers of all threads
+static flare16x_profile_buffer* volatile flare16x_profile_buffers;
+
+// The number of threads that recorded spans so far
+static volatile uint32_t flare16x_profile_threads;
+
+// The time the trace started at
+static uint64_t flare16x_profile_origin;
+
+// Links a new trace buffer into the global list without a lock
+static void flare16x_profile_link(flare16x_profile_buffer* buffer)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    buffer->thread = __atomic_add_fetch(&flare16x_profile_threads, 1, __ATOMIC_RELAXED);
+    buffer->next = __atomic_load_n(&flare16x_profile_buffers, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&flare16x_profile_buffers, &buffer->next, buffer, 1, __ATOMIC_RELEASE,
+            __ATOMIC_RELAXED));
+#else
+    // Without atomics, tracing is only safe from a single thread
+    buffer->thread = ++flare16x_profile_threads;
+    buffer->next = flare16x_profile_buffers;
+    flare16x_profile_buffers = buffer;
+#endif
+}
+
+// Writes a string as a JSON string literal
+static void flare16x_profile_write_string(FILE* file, const char* string)
+{
+    fputc('"', file);
+    for (; *string != 0; string++)
+    {
+        unsigned char character = (unsigned char)*string;
+        if (character == '"' || character == '\\')
+            fprintf(file, "\\%c", character);
+        else if (character < 0x20)
+            fprintf(file, "\\u%04x", character);
+        else
+            fputc(character, file);
+    }
+    fputc('"', file);
+}
+
+// Enables profiling for all threads with the flags defined in FLARE16X_PROFILE_* or disables it with zero
+// This should only be changed while no other thread runs any stages
+void flare16x_profile_enable(uint8_t flags)
+{
+    // The trace starts once tracing is first enabled
+    if ((flags & FLARE16X_PROFILE_TRACING) && flare16x_profile_origin == 0)
+        flare16x_profile_origin = flare16x_profile_now();
+    flare16x_profile_active = (uint8_t)(flags & (FLARE16X_PROFILE_TIMING | FLARE16X_PROFILE_TRACING |
+            FLARE16X_PROFILE_COUNTING));
+}
+
+// Returns the current monotonic time in nanoseconds
+uint64_t flare16x_profile_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+// Adds the time passed since start to the accumulator of the stage of the calling thread
+void flare16x_profile_record(uint8_t stage, uint64_t start)
+{
+    // Ignore unknown stages
+    if (stage >= FLARE16X_PROFILE_STAGE_COUNT)
+        return;
+
+    uint64_t end = flare16x_profile_now();
+    flare16x_profile_thread.nanoseconds[stage] += end - start;
+    flare16x_profile_thread.calls[stage]++;
+
+    // Also add the stage to the trace
+    if (flare16x_profile_active & FLARE16X_PROFILE_TRACING)
+        flare16x_profile_trace(flare16x_profile_names[stage], start, end, NULL, -1, -1);
+}
+
+// Adds an amount to a counter of the calling thread
+void flare16x_profile_add(uint8_t counter, uint64_t amount)
+{
+    // Ignore unknown counters
+    if (counter >= FLARE16X_PROFILE_COUNTER_COUNT)
+        return;
+
+    flare16x_profile_thread.counters[counter] += amount;
+}
+
+// Copies the accumulated durations, calls and counters of the calling thread
+flare16x_error flare16x_profile_snapshot(flare16x_profile* profile)
+{
+    // Make sure the profile is not null
+    if (profile == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_PROFILE);
+
+    memcpy(profile, &flare16x_profile_thread, sizeof(flare16x_profile));
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_PROFILE);
+}
+
+// Clears the accumulated durations, calls and counters of the calling thread
+void flare16x_profile_reset(void)
+{
+    memset(&flare16x_profile_thread, 0, sizeof(flare16x_profile));
+}
+
+// Adds the durations, calls and counters of one profile to another, e.g. to combine the snapshots of several threads
+flare16x_error flare16x_profile_merge(flare16x_profile* target, const flare16x_profile* source)
+{
+    // Make sure both profiles are not null
+    if (target == NULL || source == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_PROFILE);
+
+    int stage;
+    for (stage = 0; stage < FLARE16X_PROFILE_STAGE_COUNT; stage++)
+    {
+        target->nanoseconds[stage] += source->nanoseconds[stage];
+        target->calls[stage] += source->calls[stage];
+    }
+    int counter;
+    for (counter = 0; counter < FLARE16X_PROFILE_COUNTER_COUNT; counter++)
+        target->counters[counter] += source->counters[counter];
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_PROFILE);
+}
+
+// Returns the name of a stage
+const char* flare16x_profile_name(uint8_t stage)
+{
+    if (stage >= FLARE16X_PROFILE_STAGE_COUNT)
+        return "unknown";
+    return flare16x_profile_names[stage];
+}
+
+// Returns the name of a counter
+const char* flare16x_profile_counter_name(uint8_t counter)
+{
+    if (counter >= FLARE16X_PROFILE_COUNTER_COUNT)
+        return "unknown";
+    return flare16x_profile_counter_names[counter];
+}
+
+// Appends a span to the trace of the calling thread, if tracing is enabled
+// The name has to outlive the trace, while the file name is copied and may be null
+// The device model and palette are only tagged, if they are not negative
+flare16x_error flare16x_profile_trace(const char* name, uint64_t start, uint64_t end, const char* file_name,
+        int16_t device_model, int16_t palette)
+{
+    // Make sure the name is not null
+    if (name == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_PROFILE);
+
+    // Ignore the span, unless tracing is enabled
+    if (!(flare16x_profile_active & FLARE16X_PROFILE_TRACING))
+        return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_PROFILE);
+
+    // Create the buffer of this thread on its first span
+    flare16x_profile_buffer* buffer = flare16x_profile_thread_buffer;
+    if (buffer == NULL)
+    {
+        buffer = calloc(1, sizeof(flare16x_profile_buffer));
+        if (buffer == NULL)
+            return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_PROFILE);
+        flare16x_profile_link(buffer);
+        flare16x_profile_thread_buffer = buffer;
+    }
+
+    // Grow the spans, if they are full, and drop the span, if that fails
+    if (buffer->count == buffer->capacity)
+    {
+        size_t capacity = buffer->capacity ? buffer->capacity * 2 : FLARE16X_PROFILE_TRACE_CAPACITY;
+        flare16x_profile_span* spans = realloc(buffer->spans, capacity * sizeof(flare16x_profile_span));
+        if (spans == NULL)
+        {
+            buffer->dropped++;
+            return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_PROFILE);
+        }
+        buffer->spans = spans;
+        buffer->capacity = capacity;
+    }
+
+    // Copy the file name, keeping the span without it if that fails
+    flare16x_profile_span* span = &buffer->spans[buffer->count++];
+    span->name = name;
+    span->file_name = NULL;
+    if (file_name != NULL)
+    {
+        span->file_name = malloc(strlen(file_name) + 1);
+        if (span->file_name != NULL)
+            strcpy(span->file_name, file_name);
+    }
+    span->start = start;
+    span->end = end;
+    span->device_model = device_model;
+    span->palette = palette;
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_PROFILE);
+}
+
+// Writes the spans of all threads as trace event JSON and empties the traces
+// The buffers themselves are kept, as every thread keeps using its own buffer for later spans
+// No other thread may record any spans while the trace is written
+flare16x_error flare16x_profile_trace_write(FILE* file)
+{
+    // Make sure the file is not null
+    if (file == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_PROFILE);
+
+    // Write every buffer that holds any spans as one thread of the process, starting with its name
+    flare16x_profile_buffer* buffer;
+    int first = 1;
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    for (buffer = flare16x_profile_buffers; buffer != NULL; buffer = buffer->next)
+    {
+        if (buffer->count == 0 && buffer->dropped == 0)
+            continue;
+        fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+                "\"args\":{\"name\":\"thread %u\"}}", first ? "" : ",", buffer->thread, buffer->thread);
+        first = 0;
+
+        // Each span is a complete event with its start and duration in microseconds
+        size_t index;
+        for (index = 0; index < buffer->count; index++)
+        {
+            flare16x_profile_span* span = &buffer->spans[index];
+            uint64_t start = span->start > flare16x_profile_origin ? span->start - flare16x_profile_origin : 0;
+            uint64_t duration = span->end > span->start ? span->end - span->start : 0;
+            fprintf(file, ",\n{\"name\":");
+            flare16x_profile_write_string(file, span->name);
+            fprintf(file, ",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%llu.%03u,\"dur\":%llu.%03u",
+                    span->file_name != NULL ? "file" : "stage", buffer->thread, (unsigned long long)(start / 1000),
+                    (unsigned)(start % 1000), (unsigned long long)(duration / 1000), (unsigned)(duration % 1000));
+
+            // Add the tags
+            if (span->file_name != NULL || span->device_model >= 0 || span->palette >= 0)
+            {
+                const char* separator = "";
+                fprintf(file, ",\"args\":{");
+                if (span->file_name != NULL)
+                {
+                    fprintf(file, "\"file\":");
+                    flare16x_profile_write_string(file, span->file_name);
+                    separator = ",";
+                }
+                if (span->device_model >= 0)
+                {
+                    fprintf(file, "%s\"device_model\":%d", separator, span->device_model);
+                    separator = ",";
+                }
+                if (span->palette >= 0)
+                    fprintf(file, "%s\"palette\":%d", separator, span->palette);
+                fputc('}', file);
+            }
+            fputc('}', file);
+            free(span->file_name);
+        }
+
+        // Note the number of dropped spans, so that gaps in the trace can be explained
+        if (buffer->dropped > 0)
+            fprintf(file, ",\n{\"name\":\"dropped spans\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%u,"
+                    "\"ts\":0,\"args\":{\"count\":%zu}}", buffer->thread, buffer->dropped);
+
+        // Empty the buffer, but keep it linked, as its thread still refers to it
+        free(buffer->spans);
+        buffer->spans = NULL;
+        buffer->count = 0;
+        buffer->capacity = 0;
+        buffer->dropped = 0;
+    }
+    fprintf(file, "\n]}\n");
+
+    return flare16x_error_make(ferror(file) ? FLARE16X_ERROR_IO : FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_PROFILE);
+}
@@ -0,0 +1,163 @@
+//
+// flare16x core
+// Developed 2019 by Benedikt Muessig <github@bmuessig.eu>
+// Licensed under GPLv3
+//
+// profile.h: Header file for the optional per-stage timing instrumentation of the library
+//
+
+#ifndef FLARE16X_PROFILE_H
+#define FLARE16X_PROFILE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "error.h"
+
+/*
+ * The library records how long its main stages take and how often they run, once profiling has been enabled.
+ * The durations are measured with the monotonic clock and added to accumulators that are private to each thread,
+ * so that profiling never needs a lock. A snapshot copies the accumulators of the calling thread, which lets every
+ * worker thread merge its own snapshot into a total before it ends.
+ * While profiling is disabled, every stage only tests a global flag and never reads the clock.
+ * Stages may contain other stages, e.g. the palette analysis is part of processing a thermal image, but is not
+ * included in its decoding pass. The passes of the thermal processing are only recorded when they complete.
+ *
+ * When tracing is enabled as well, every recorded stage is also appended as a span to an event buffer of its thread.
+ * The buffers are linked into a global list without a lock when a thread records its first span, and are kept after
+ * the thread ends. Once all threads are done, the spans of all buffers are written as trace event JSON, which opens
+ * directly in Perfetto or chrome://tracing. Writing only empties the buffers, so that threads that record spans
+ * afterwards keep using their own buffer. Applications may add spans of their own, e.g. for every processed file,
+ * which can be tagged with the file name, device model and palette.
+ *
+ * Independently of the timing, the library can count how much work its algorithms do, e.g. how many palette lookups
+ * were answered by a palette cache or how many neighbours were visited during the interpolation. Hot loops count in
+ * local variables and only add their totals to the counters of the calling thread once they are done, so that the
+ * counters can be compared before and after processing a single image as well as summed up over a whole batch.
+ */
+
+// Profiling flag enum
+enum {
+    // The durations and calls of the stages are accumulated
+    FLARE16X_PROFILE_TIMING = 0x1u,
+    // Every stage is additionally recorded as a span of the trace
+    FLARE16X_PROFILE_TRACING = 0x2u,
+    // The algorithm counters are accumulated
+    FLARE16X_PROFILE_COUNTING = 0x4u
+};
+
+// Profiling stage enum
+enum {
+    // flare16x_bitmap_load
+    FLARE16X_PROFILE_BITMAP_LOAD,
+    // flare16x_locator_load
+    FLARE16X_PROFILE_LOCATOR_LOAD,
+    // flare16x_locator_create
+    FLARE16X_PROFILE_LOCATOR_CREATE,
+    // flare16x_locator_process
+    FLARE16X_PROFILE_LOCATOR_PROCESS,
+    // flare16x_thermal_create
+    FLARE16X_PROFILE_THERMAL_CREATE,
+    // flare16x_thermal_ocr
+    FLARE16X_PROFILE_THERMAL_OCR,
+    // flare16x_palettes_determine
+    FLARE16X_PROFILE_PALETTES_DETERMINE,
+    // The first pass of flare16x_thermal_process, which decodes the colors of all pixels outside the crosshair
+    FLARE16X_PROFILE_THERMAL_DECODE,
+    // The second pass of flare16x_thermal_process, which interpolates the pixels of the crosshair
+    FLARE16X_PROFILE_THERMAL_INTERPOLATE,
+    // flare16x_thermal_export
+    FLARE16X_PROFILE_THERMAL_EXPORT,
+    // flare16x_thermal_crosshair
+    FLARE16X_PROFILE_THERMAL_CROSSHAIR,
+    // flare16x_bitmap_store
+    FLARE16X_PROFILE_BITMAP_STORE,
+    // The number of profiling stage enum values
+    FLARE16X_PROFILE_STAGE_COUNT
+};
+
+// Profiling counter enum
+enum {
+    // Palette lookups that were answered by a palette cache
+    FLARE16X_PROFILE_PALETTE_HITS,
+    // Palette lookups that had to search the palette
+    FLARE16X_PROFILE_PALETTE_MISSES,
+    // Pixels scanned by the palette analysis
+    FLARE16X_PROFILE_PALETTE_PIXELS,
+    // Pixels of the IR image with a color that is not part of its palette
+    FLARE16X_PROFILE_INVALID_PIXELS,
+    // Pixels of the IR image that are covered by the crosshair
+    FLARE16X_PROFILE_CROSSHAIR_PIXELS,
+    // Neighbouring points visited while interpolating the crosshair and invalid pixels
+    FLARE16X_PROFILE_NEIGHBOUR_VISITS,
+    // Rows that passed the quick count of the locator and were scanned again for the crosshair pattern
+    FLARE16X_PROFILE_LOCATOR_RESCANS,
+    // The number of profiling counter enum values
+    FLARE16X_PROFILE_COUNTER_COUNT
+};
+
+// The accumulated durations and calls of all stages and the algorithm counters
+typedef struct {
+    // The total duration of every stage in nanoseconds
+    uint64_t nanoseconds[FLARE16X_PROFILE_STAGE_COUNT];
+    // The number of completed calls of every stage
+    uint64_t calls[FLARE16X_PROFILE_STAGE_COUNT];
+    // The algorithm counters
+    uint64_t counters[FLARE16X_PROFILE_COUNTER_COUNT];
+} flare16x_profile;
+
+// The active profiling flags as defined in FLARE16X_PROFILE_* (only to be changed by flare16x_profile_enable)
+extern volatile uint8_t flare16x_profile_active;
+
+// Starts timing a stage and returns its start time, or zero if neither timing nor tracing is enabled
+#define flare16x_profile_begin() \
+((flare16x_profile_active & (FLARE16X_PROFILE_TIMING | FLARE16X_PROFILE_TRACING)) ? flare16x_profile_now() : 0)
+
+// Stops timing a stage that was started by flare16x_profile_begin
+#define flare16x_profile_end(stage,start) \
+do { if ((start) != 0) flare16x_profile_record((stage), (start)); } while (0)
+
+// Adds an amount to a counter, if counting is enabled
+#define flare16x_profile_count(counter,amount) \
+do { if (flare16x_profile_active & FLARE16X_PROFILE_COUNTING) flare16x_profile_add((counter), (amount)); } while (0)
+
+// Enables profiling for all threads with the flags defined in FLARE16X_PROFILE_* or disables it with zero
+// This should only be changed while no other thread runs any stages
+void flare16x_profile_enable(uint8_t flags);
+
+// Returns the current monotonic time in nanoseconds
+uint64_t flare16x_profile_now(void);
+
+// Adds the time passed since start to the accumulator of the stage of the calling thread
+void flare16x_profile_record(uint8_t stage, uint64_t start);
+
+// Adds an amount to a counter of the calling thread
+void flare16x_profile_add(uint8_t counter, uint64_t amount);
+
+// Copies the accumulated durations, calls and counters of the calling thread
+flare16x_error flare16x_profile_snapshot(flare16x_profile* profile);
+
+// Clears the accumulated durations, calls and counters of the calling thread
+void flare16x_profile_reset(void);
+
+// Adds the durations, calls and counters of one profile to another, e.g. to combine the snapshots of several threads
+flare16x_error flare16x_profile_merge(flare16x_profile* target, const flare16x_profile* source);
+
+// Returns the name of a stage
+const char* flare16x_profile_name(uint8_t stage);
+
+// Returns the name of a counter
+const char* flare16x_profile_counter_name(uint8_t counter);
+
+// Appends a span to the trace of the calling thread, if tracing is enabled
+// The name has to outlive the trace, while the file name is copied and may be null
+// The device model and palette are only tagged, if they are not negative
+flare16x_error flare16x_profile_trace(const char* name, uint64_t start, uint64_t end, const char* file_name,
+        int16_t device_model, int16_t palette);
+
+// Writes the spans of all threads as trace event JSON and empties the traces
+// The buffers themselves are kept, as every thread keeps using its own buffer for later spans
+// No other thread may record any spans while the trace is written
+flare16x_error flare16x_profile_trace_write(FILE* file);
+
+#endif //FLARE16X_PROFILE_H
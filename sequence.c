@@ -0,0 +1,368 @@
+//
+// flare16x core
+// Developed 2019 by Benedikt Muessig <github@bmuessig.eu>
+// Licensed under GPLv3
+//
+// sequence.c: Functions for the temporal delta compression of thermal image sequences
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "error.h"
+#include "thermal.h"
+#include "codec.h"
+
+#include "sequence.h"
+
+// The alignment of the index in bytes
+#define FLARE16X_SEQUENCE_ALIGNMENT 8
+
+// Starts a new sequence by writing the file header to the file
+// All frames have to have the given dimensions and every interval-th frame becomes a keyframe
+// The file has to stay open until the sequence is finished
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_sequence_create(FILE* file, uint16_t width, uint16_t height, uint16_t interval,
+        flare16x_sequence_writer* writer)
+{
+    // Make sure that there are no null pointers
+    if (file == NULL || writer == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_SEQUENCE);
+
+    // Verify the parameters
+    if (width < 1 || height < 1 || interval < 1)
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_SEQUENCE);
+
+    // Clear the writer
+    memset(writer, 0, sizeof(flare16x_sequence_writer));
+    writer->file = file;
+
+    // Allocate the previous planes, the residuals and the tokens of both planes plus room to try the direct coding
+    // The previous planes start out cleared, as the first keyframe calculates its unused residuals from them
+    size_t count = (size_t)width * height;
+    writer->planes = calloc(count, 2);
+    writer->residuals = malloc(count);
+    writer->tokens = malloc(flare16x_codec_tokens_bound(count) * 3);
+    if (writer->planes == NULL || writer->residuals == NULL || writer->tokens == NULL)
+    {
+        free(writer->planes);
+        free(writer->residuals);
+        free(writer->tokens);
+        memset(writer, 0, sizeof(flare16x_sequence_writer));
+        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_SEQUENCE);
+    }
+
+    // Fill in and write the file header
+    writer->header.magic = FLARE16X_SEQUENCE_MAGIC;
+    writer->header.version = FLARE16X_SEQUENCE_VERSION;
+    writer->header.interval = interval;
+    writer->header.width = width;
+    writer->header.height = height;
+    if (fwrite(&writer->header, sizeof(flare16x_sequence_header), 1, file) != 1)
+    {
+        free(writer->planes);
+        free(writer->residuals);
+        free(writer->tokens);
+        memset(writer, 0, sizeof(flare16x_sequence_writer));
+        return flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_SEQUENCE);
+    }
+    writer->offset = sizeof(flare16x_sequence_header);
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_SEQUENCE);
+}
+
+// Appends a thermal image as the next frame
+flare16x_error flare16x_sequence_append(flare16x_sequence_writer* writer, flare16x_thermal_image* image)
+{
+    // Make sure that there are no null pointers
+    if (writer == NULL || writer->file == NULL || image == NULL || image->points == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_SEQUENCE);
+
+    // All frames have to have the same dimensions
+    if (image->width != writer->header.width || image->height != writer->header.height)
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_SEQUENCE);
+
+    // Grow the index, if required
+    if (writer->count >= writer->capacity)
+    {
+        uint32_t capacity = writer->capacity ? writer->capacity * 2 : 64;
+        uint64_t* offsets = realloc(writer->offsets, capacity * sizeof(uint64_t));
+        if (offsets == NULL)
+            return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_SEQUENCE);
+        writer->offsets = offsets;
+        writer->capacity = capacity;
+    }
+
+    // Fill in the frame header
+    flare16x_sequence_frame_header header;
+    memset(&header, 0, sizeof(header));
+    header.type = writer->count % writer->header.interval == 0 ? FLARE16X_SEQUENCE_FRAME_KEY :
+            FLARE16X_SEQUENCE_FRAME_DELTA;
+    header.mode = image->mode;
+
+    // Code both planes, starting with the residuals to the previous frame
+    size_t count = (size_t)image->width * image->height, point, tokens_size = 0;
+    int plane;
+    for (plane = 0; plane < 2; plane++)
+    {
+        uint8_t* previous = writer->planes + count * plane;
+        for (point = 0; point < count; point++)
+        {
+            uint8_t current = plane == 0 ? image->points[point].value : image->points[point].uncertainty;
+            writer->residuals[point] = (uint8_t)(current - previous[point]);
+            previous[point] = current;
+        }
+
+        // Keyframes code the plane directly, while delta frames only do so if that turns out smaller
+        uint8_t* tokens = writer->tokens + tokens_size;
+        size_t size = header.type == FLARE16X_SEQUENCE_FRAME_KEY ? SIZE_MAX :
+                flare16x_codec_tokens_encode(writer->residuals, count, image->width, tokens);
+        size_t direct = flare16x_codec_tokens_encode(previous, count, image->width,
+                header.type == FLARE16X_SEQUENCE_FRAME_KEY ? tokens : tokens + size);
+        if (direct < size)
+        {
+            if (header.type == FLARE16X_SEQUENCE_FRAME_DELTA)
+            {
+                memmove(tokens, tokens + size, direct);
+                header.flags |= plane == 0 ? FLARE16X_SEQUENCE_FLAG_VALUE_DIRECT :
+                        FLARE16X_SEQUENCE_FLAG_UNCERTAINTY_DIRECT;
+            }
+            size = direct;
+        }
+        if (plane == 0)
+            header.value_size = (uint32_t)size;
+        else
+            header.uncertainty_size = (uint32_t)size;
+        tokens_size += size;
+    }
+
+    // Write the frame header and the tokens
+    if (fwrite(&header, sizeof(header), 1, writer->file) != 1 ||
+        fwrite(writer->tokens, tokens_size, 1, writer->file) != 1)
+        return flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_SEQUENCE);
+
+    // And add the frame to the index
+    writer->offsets[writer->count++] = writer->offset;
+    writer->offset += sizeof(header) + tokens_size;
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_SEQUENCE);
+}
+
+// Completes the sequence by writing the index and trailer and frees all resources used by the writer
+// The file is not closed
+flare16x_error flare16x_sequence_finish(flare16x_sequence_writer* writer)
+{
+    // Make sure that there are no null pointers
+    if (writer == NULL || writer->file == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_SEQUENCE);
+
+    // Align the index, so that it can be used in place
+    static const uint8_t padding[FLARE16X_SEQUENCE_ALIGNMENT] = {0};
+    size_t padding_size = (FLARE16X_SEQUENCE_ALIGNMENT - writer->offset % FLARE16X_SEQUENCE_ALIGNMENT) %
+            FLARE16X_SEQUENCE_ALIGNMENT;
+
+    // Fill in the trailer
+    flare16x_sequence_trailer trailer;
+    memset(&trailer, 0, sizeof(trailer));
+    trailer.index_offset = writer->offset + padding_size;
+    trailer.count = writer->count;
+    trailer.magic = FLARE16X_SEQUENCE_INDEX_MAGIC;
+
+    // Write the padding, the index and the trailer
+    flare16x_error error = flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_SEQUENCE);
+    if ((padding_size > 0 && fwrite(padding, padding_size, 1, writer->file) != 1) ||
+        (writer->count > 0 && fwrite(writer->offsets, writer->count * sizeof(uint64_t), 1, writer->file) != 1) ||
+        fwrite(&trailer, sizeof(trailer), 1, writer->file) != 1 || fflush(writer->file) != 0)
+        error = flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_SEQUENCE);
+
+    // Free the resources in any case
+    free(writer->offsets);
+    free(writer->planes);
+    free(writer->residuals);
+    free(writer->tokens);
+    memset(writer, 0, sizeof(flare16x_sequence_writer));
+
+    return error;
+}
+
+// Opens a sequence that is held in memory without copying it
+// The data has to outlive the sequence
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_sequence_attach(const void* data, size_t size, flare16x_sequence* sequence)
+{
+    // Make sure that there are no null pointers
+    if (data == NULL || sequence == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_SEQUENCE);
+
+    // Clear the sequence
+    memset(sequence, 0, sizeof(flare16x_sequence));
+
+    // Validate the file header
+    const uint8_t* bytes = data;
+    const flare16x_sequence_header* header = data;
+    if (size < sizeof(flare16x_sequence_header) + sizeof(flare16x_sequence_trailer) ||
+        header->magic != FLARE16X_SEQUENCE_MAGIC || header->version != FLARE16X_SEQUENCE_VERSION ||
+        header->interval < 1 || header->width < 1 || header->height < 1)
+        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_SEQUENCE);
+
+    // Validate the trailer and make sure that the aligned index lies within the data
+    const flare16x_sequence_trailer* trailer =
+            (const flare16x_sequence_trailer*)(bytes + size - sizeof(flare16x_sequence_trailer));
+    uint64_t limit = size - sizeof(flare16x_sequence_trailer);
+    if (trailer->magic != FLARE16X_SEQUENCE_INDEX_MAGIC || trailer->index_offset > limit ||
+        trailer->index_offset < sizeof(flare16x_sequence_header) ||
+        trailer->index_offset % FLARE16X_SEQUENCE_ALIGNMENT != 0 ||
+        trailer->count > (limit - trailer->index_offset) / sizeof(uint64_t))
+        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_SEQUENCE);
+
+    // Allocate the planes
+    size_t count = (size_t)header->width * header->height;
+    sequence->planes = malloc(count * 2);
+    sequence->residuals = malloc(count);
+    if (sequence->planes == NULL || sequence->residuals == NULL)
+    {
+        free(sequence->planes);
+        free(sequence->residuals);
+        memset(sequence, 0, sizeof(flare16x_sequence));
+        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_SEQUENCE);
+    }
+
+    sequence->data = bytes;
+    sequence->size = size;
+    sequence->header = header;
+    sequence->trailer = trailer;
+    sequence->offsets = (const uint64_t*)(bytes + trailer->index_offset);
+    sequence->decoded = trailer->count;
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_SEQUENCE);
+}
+
+// Returns the number of frames held in the sequence
+uint32_t flare16x_sequence_count(flare16x_sequence* sequence)
+{
+    if (sequence == NULL || sequence->trailer == NULL)
+        return 0;
+    return sequence->trailer->count;
+}
+
+// Selects the frame that is returned next
+// Seeking is cheap, as the frames since the last keyframe are only decoded once the frame is read
+flare16x_error flare16x_sequence_seek(flare16x_sequence* sequence, uint32_t frame)
+{
+    // Make sure that there are no null pointers
+    if (sequence == NULL || sequence->trailer == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_SEQUENCE);
+
+    // Check the frame index
+    if (frame >= sequence->trailer->count)
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_SEQUENCE);
+
+    sequence->position = frame;
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_SEQUENCE);
+}
+
+// Decodes a single frame into the planes, which have to hold the previous frame for delta frames
+static flare16x_error flare16x_sequence_decode(flare16x_sequence* sequence, uint32_t frame)
+{
+    // Make sure that the frame lies within the data before the index
+    uint64_t offset = sequence->offsets[frame];
+    if (offset < sizeof(flare16x_sequence_header) ||
+        offset > sequence->trailer->index_offset - sizeof(flare16x_sequence_frame_header))
+        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_SEQUENCE);
+    const flare16x_sequence_frame_header* header =
+            (const flare16x_sequence_frame_header*)(sequence->data + offset);
+    const uint8_t* tokens = sequence->data + offset + sizeof(flare16x_sequence_frame_header);
+    if ((uint64_t)header->value_size + header->uncertainty_size >
+        sequence->trailer->index_offset - offset - sizeof(flare16x_sequence_frame_header))
+        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_SEQUENCE);
+
+    // Every interval-th frame has to be a keyframe, while all others have to follow the decoded frame
+    uint8_t type = frame % sequence->header->interval == 0 ? FLARE16X_SEQUENCE_FRAME_KEY :
+            FLARE16X_SEQUENCE_FRAME_DELTA;
+    if (header->type != type || (type == FLARE16X_SEQUENCE_FRAME_DELTA && sequence->decoded != frame - 1))
+        return flare16x_error_make(FLARE16X_ERROR_FORMAT, FLARE16X_ERROR_SOURCE_SEQUENCE);
+
+    // Decode both planes, adding the residuals to the previous planes unless they are coded directly
+    size_t count = (size_t)sequence->header->width * sequence->header->height, point;
+    int plane;
+    for (plane = 0; plane < 2; plane++)
+    {
+        uint8_t* target = sequence->planes + count * plane;
+        uint32_t size = plane == 0 ? header->value_size : header->uncertainty_size;
+        int direct = type == FLARE16X_SEQUENCE_FRAME_KEY || (header->flags & (plane == 0 ?
+                FLARE16X_SEQUENCE_FLAG_VALUE_DIRECT : FLARE16X_SEQUENCE_FLAG_UNCERTAINTY_DIRECT));
+        flare16x_error error = flare16x_codec_tokens_decode(tokens, size, direct ? target : sequence->residuals,
+                count, sequence->header->width);
+        if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+            return flare16x_error_wrap(flare16x_error_make(FLARE16X_ERROR_CALLEE, FLARE16X_ERROR_SOURCE_SEQUENCE),
+                    error);
+        if (!direct)
+            for (point = 0; point < count; point++)
+                target[point] += sequence->residuals[point];
+        tokens += size;
+    }
+
+    sequence->mode = header->mode;
+    sequence->decoded = frame;
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_SEQUENCE);
+}
+
+// Decodes the next frame into a thermal image that has the dimensions of the sequence
+// Reading the frames in order only decodes each frame once, which allows playing back the sequence incrementally
+flare16x_error flare16x_sequence_next(flare16x_sequence* sequence, flare16x_thermal_image* image)
+{
+    // Make sure that there are no null pointers
+    if (sequence == NULL || sequence->trailer == NULL || image == NULL || image->points == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_SEQUENCE);
+
+    // Check the position and the image dimensions
+    uint32_t frame = sequence->position;
+    if (frame >= sequence->trailer->count || image->width != sequence->header->width ||
+        image->height != sequence->header->height)
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_SEQUENCE);
+
+    // Continue from the decoded frame, if it lies between the last keyframe and the frame, or start at the keyframe
+    uint32_t keyframe = frame - frame % sequence->header->interval, current;
+    current = sequence->decoded < sequence->trailer->count && sequence->decoded >= keyframe &&
+            sequence->decoded <= frame ? sequence->decoded + 1 : keyframe;
+
+    // Decode all frames up to the requested one
+    for (; current <= frame; current++)
+    {
+        flare16x_error error = flare16x_sequence_decode(sequence, current);
+        if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        {
+            sequence->decoded = sequence->trailer->count;
+            return error;
+        }
+    }
+
+    // Then, interleave the planes into the thermal points
+    size_t count = (size_t)image->width * image->height, point;
+    for (point = 0; point < count; point++)
+    {
+        image->points[point].value = sequence->planes[point];
+        image->points[point].uncertainty = sequence->planes[count + point];
+    }
+    image->mode = sequence->mode;
+    sequence->position++;
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_SEQUENCE);
+}
+
+// Frees the resources used by a sequence that is being read
+flare16x_error flare16x_sequence_destroy(flare16x_sequence* sequence)
+{
+    // Make sure the sequence is not null
+    if (sequence == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_SEQUENCE);
+
+    // Free the planes and zero the struct
+    free(sequence->planes);
+    free(sequence->residuals);
+    memset(sequence, 0, sizeof(flare16x_sequence));
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_SEQUENCE);
+}
@@ -0,0 +1,173 @@
+//
+// flare16x core
+// Developed 2019 by Benedikt Muessig <github@bmuessig.eu>
+// Licensed under GPLv3
+//
+// sequence.h: Header file for the temporal delta compression of thermal image sequences
+//
+
+#ifndef FLARE16X_SEQUENCE_H
+#define FLARE16X_SEQUENCE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "error.h"
+#include "thermal.h"
+
+/*
+ * A sequence stores the thermal images of a burst or time-lapse in their capture order.
+ * Every frame holds a value and an uncertainty plane, each coded with the tokens of the codec (see codec.h).
+ * Keyframes code the planes themselves, while all other frames code the residuals to the previous frame, which are
+ * the byte-wise differences modulo 256. As nearly identical frames leave residuals that are almost entirely zero,
+ * these frames shrink to a small fraction of a keyframe. Planes that changed too much to benefit from their residuals
+ * are coded directly, which is marked by a flag in the frame header.
+ * Every interval-th frame is a keyframe, so that decoding any frame only requires decoding the frames since the
+ * last keyframe. The index at the end of the file locates every frame.
+ * All fields are stored in the byte order of the host that wrote the file, which is little endian on all supported
+ * platforms; a file written with the other byte order fails the magic check:
+ * 1) The file header identifies the file and holds the keyframe interval
+ * 2) Each frame consists of a frame header followed by the value and uncertainty tokens
+ * 3) The index holds the offset of every frame
+ * 4) The trailer at the very end of the file locates the index
+ */
+
+// The magic number of the file header ("F16S")
+#define FLARE16X_SEQUENCE_MAGIC 0x53363146u
+// The magic number of the trailer ("F16J")
+#define FLARE16X_SEQUENCE_INDEX_MAGIC 0x4a363146u
+// The current version of the sequence format
+#define FLARE16X_SEQUENCE_VERSION 1
+// The default number of frames from one keyframe to the next
+#define FLARE16X_SEQUENCE_INTERVAL 30
+
+// Frame type enum
+enum {
+    // The planes are coded as they are
+    FLARE16X_SEQUENCE_FRAME_KEY,
+    // The residuals to the previous frame are coded
+    FLARE16X_SEQUENCE_FRAME_DELTA
+};
+
+// Frame flag enum
+enum {
+    // The value plane of a delta frame is coded directly
+    FLARE16X_SEQUENCE_FLAG_VALUE_DIRECT = 0x1u,
+    // The uncertainty plane of a delta frame is coded directly
+    FLARE16X_SEQUENCE_FLAG_UNCERTAINTY_DIRECT = 0x2u
+};
+
+// Make sure the sequence structs are laid out exactly like the file
+#pragma pack(push, 1)
+
+// The file header struct
+typedef struct {
+    uint32_t magic; // must be FLARE16X_SEQUENCE_MAGIC
+    uint16_t version; // must be FLARE16X_SEQUENCE_VERSION
+    uint16_t interval; // the number of frames from one keyframe to the next
+    uint16_t width; // the width of all frames
+    uint16_t height; // the height of all frames
+    uint32_t reserved; // must be 0
+} flare16x_sequence_header;
+
+// The frame header struct that precedes the tokens of each frame
+typedef struct {
+    uint8_t type; // the frame type as defined in FLARE16X_SEQUENCE_FRAME_*
+    uint8_t mode; // the quantification mode as defined in FLARE16X_THERMAL_QUANTIFICATION_*
+    uint8_t flags; // the flags as defined in FLARE16X_SEQUENCE_FLAG_*
+    uint8_t reserved; // must be 0
+    uint32_t value_size; // the size of the value tokens
+    uint32_t uncertainty_size; // the size of the uncertainty tokens
+} flare16x_sequence_frame_header;
+
+// The trailer struct
+typedef struct {
+    uint64_t index_offset; // the offset of the index from the start of the file
+    uint32_t count; // the number of frames
+    uint32_t magic; // must be FLARE16X_SEQUENCE_INDEX_MAGIC
+} flare16x_sequence_trailer;
+
+// Restore regular 32 or 64 bit struct boundaries
+#pragma pack(pop)
+
+// Represents a sequence that is being written
+typedef struct {
+    // The target file
+    FILE* file;
+    // The current offset in the file
+    uint64_t offset;
+    // The file header
+    flare16x_sequence_header header;
+    // The offsets of all frames written so far
+    uint64_t* offsets;
+    // The number of frames written so far
+    uint32_t count;
+    // The number of offsets that fit into the allocated index
+    uint32_t capacity;
+    // The value and uncertainty planes of the previous frame
+    uint8_t* planes;
+    // The residual plane
+    uint8_t* residuals;
+    // The token buffer
+    uint8_t* tokens;
+} flare16x_sequence_writer;
+
+// Represents a sequence that is being read
+typedef struct {
+    // The contents of the sequence file
+    const uint8_t* data;
+    // The size of the sequence file
+    size_t size;
+    // The file header
+    const flare16x_sequence_header* header;
+    // The trailer that locates the index
+    const flare16x_sequence_trailer* trailer;
+    // The offsets of all frames
+    const uint64_t* offsets;
+    // The value and uncertainty planes of the decoded frame
+    uint8_t* planes;
+    // The residual plane
+    uint8_t* residuals;
+    // The quantification mode of the decoded frame
+    uint8_t mode;
+    // The index of the frame held in the planes or the frame count, if there is none
+    uint32_t decoded;
+    // The index of the frame returned next
+    uint32_t position;
+} flare16x_sequence;
+
+// Starts a new sequence by writing the file header to the file
+// All frames have to have the given dimensions and every interval-th frame becomes a keyframe
+// The file has to stay open until the sequence is finished
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_sequence_create(FILE* file, uint16_t width, uint16_t height, uint16_t interval,
+        flare16x_sequence_writer* writer);
+
+// Appends a thermal image as the next frame
+flare16x_error flare16x_sequence_append(flare16x_sequence_writer* writer, flare16x_thermal_image* image);
+
+// Completes the sequence by writing the index and trailer and frees all resources used by the writer
+// The file is not closed
+flare16x_error flare16x_sequence_finish(flare16x_sequence_writer* writer);
+
+// Opens a sequence that is held in memory without copying it
+// The data has to outlive the sequence
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_sequence_attach(const void* data, size_t size, flare16x_sequence* sequence);
+
+// Returns the number of frames held in the sequence
+uint32_t flare16x_sequence_count(flare16x_sequence* sequence);
+
+// Selects the frame that is returned next
+// Seeking is cheap, as the frames since the last keyframe are only decoded once the frame is read
+flare16x_error flare16x_sequence_seek(flare16x_sequence* sequence, uint32_t frame);
+
+// Decodes the next frame into a thermal image that has the dimensions of the sequence
+// Reading the frames in order only decodes each frame once, which allows playing back the sequence incrementally
+flare16x_error flare16x_sequence_next(flare16x_sequence* sequence, flare16x_thermal_image* image);
+
+// Frees the resources used by a sequence that is being read
+flare16x_error flare16x_sequence_destroy(flare16x_sequence* sequence);
+
+#endif //FLARE16X_SEQUENCE_H
@@ -0,0 +1,782 @@
+//
+// flare16x core
+// Developed 2019 by Benedikt Muessig <github@bmuessig.eu>
+// Licensed under GPLv3
+//
+// series.c: Functions for combining several processed frames of the same scene
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "error.h"
+#include "thermal.h"
+#include "convert.h"
+
+#include "series.h"
+
+// The vector kernels share the platform check and instruction set detection of the conversion kernels
+#ifdef FLARE16X_CONVERT_X86
+#include <immintrin.h>
+#endif
+
+// Adds the values and their squares to the sums
+static void flare16x_series_accumulate_scalar(const flare16x_thermal_point* points, uint32_t* sums,
+        uint32_t* squares, size_t count)
+{
+    size_t x;
+    for (x = 0; x < count; x++)
+    {
+        uint32_t value = points[x].value;
+        sums[x] += value;
+        squares[x] += value * value;
+    }
+}
+
+#ifdef FLARE16X_CONVERT_X86
+
+// Adds the values and their squares to the sums using SSE2
+// The value is the low byte of every 16-bit point and its square still fits into 16 bits
+__attribute__((target("sse2")))
+static void flare16x_series_accumulate_sse2(const flare16x_thermal_point* points, uint32_t* sums,
+        uint32_t* squares, size_t count)
+{
+    const __m128i low = _mm_set1_epi16(0xff), zero = _mm_setzero_si128();
+    size_t x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        __m128i values = _mm_and_si128(_mm_loadu_si128((const __m128i*)(points + x)), low);
+        __m128i products = _mm_mullo_epi16(values, values);
+        __m128i* sum = (__m128i*)(sums + x);
+        __m128i* square = (__m128i*)(squares + x);
+        _mm_storeu_si128(sum, _mm_add_epi32(_mm_loadu_si128(sum), _mm_unpacklo_epi16(values, zero)));
+        _mm_storeu_si128(sum + 1, _mm_add_epi32(_mm_loadu_si128(sum + 1), _mm_unpackhi_epi16(values, zero)));
+        _mm_storeu_si128(square, _mm_add_epi32(_mm_loadu_si128(square), _mm_unpacklo_epi16(products, zero)));
+        _mm_storeu_si128(square + 1, _mm_add_epi32(_mm_loadu_si128(square + 1),
+                _mm_unpackhi_epi16(products, zero)));
+    }
+    flare16x_series_accumulate_scalar(points + x, sums + x, squares + x, count - x);
+}
+
+// Adds the values and their squares to the sums using AVX2
+__attribute__((target("avx2")))
+static void flare16x_series_accumulate_avx2(const flare16x_thermal_point* points, uint32_t* sums,
+        uint32_t* squares, size_t count)
+{
+    const __m256i low = _mm256_set1_epi16(0xff);
+    size_t x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        __m256i values = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(points + x)), low);
+        __m256i products = _mm256_mullo_epi16(values, values);
+        __m256i* sum = (__m256i*)(sums + x);
+        __m256i* square = (__m256i*)(squares + x);
+        _mm256_storeu_si256(sum, _mm256_add_epi32(_mm256_loadu_si256(sum),
+                _mm256_cvtepu16_epi32(_mm256_castsi256_si128(values))));
+        _mm256_storeu_si256(sum + 1, _mm256_add_epi32(_mm256_loadu_si256(sum + 1),
+                _mm256_cvtepu16_epi32(_mm256_extracti128_si256(values, 1))));
+        _mm256_storeu_si256(square, _mm256_add_epi32(_mm256_loadu_si256(square),
+                _mm256_cvtepu16_epi32(_mm256_castsi256_si128(products))));
+        _mm256_storeu_si256(square + 1, _mm256_add_epi32(_mm256_loadu_si256(square + 1),
+                _mm256_cvtepu16_epi32(_mm256_extracti128_si256(products, 1))));
+    }
+    flare16x_series_accumulate_sse2(points + x, sums + x, squares + x, count - x);
+}
+
+#endif
+
+// Looks up the accumulation kernel of a specific instruction set as defined in FLARE16X_CONVERT_ISA_*
+// Instruction sets without a kernel of their own return the kernel of the best one they include
+// Fails with an unknown error if the instruction set is not supported by the compiler or the running CPU
+flare16x_error flare16x_series_kernel_get(uint8_t isa, flare16x_series_kernel* kernel)
+{
+    // Make sure that the kernel pointer is not null
+    if (kernel == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_SERIES);
+
+    // Validate the instruction set
+    if (isa >= FLARE16X_CONVERT_ISA_COUNT)
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_SERIES);
+
+    // Check, if it can be used
+    if (!flare16x_convert_supported(isa))
+        return flare16x_error_make(FLARE16X_ERROR_UNKNOWN, FLARE16X_ERROR_SOURCE_SERIES);
+
+    switch (isa)
+    {
+#ifdef FLARE16X_CONVERT_X86
+        // AVX2
+        case FLARE16X_CONVERT_ISA_AVX2:
+            *kernel = flare16x_series_accumulate_avx2;
+            break;
+
+        // SSE2, which SSSE3 adds nothing to for the accumulation
+        case FLARE16X_CONVERT_ISA_SSSE3:
+        case FLARE16X_CONVERT_ISA_SSE2:
+            *kernel = flare16x_series_accumulate_sse2;
+            break;
+#endif
+
+        // Plain C
+        default:
+            *kernel = flare16x_series_accumulate_scalar;
+            break;
+    }
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_SERIES);
+}
+
+// Returns the accumulation kernel of the best instruction set supported by the running CPU
+static flare16x_series_kernel flare16x_series_kernel_best(void)
+{
+#ifdef FLARE16X_CONVERT_X86
+    if (flare16x_convert_supported(FLARE16X_CONVERT_ISA_AVX2))
+        return flare16x_series_accumulate_avx2;
+    if (flare16x_convert_supported(FLARE16X_CONVERT_ISA_SSE2))
+        return flare16x_series_accumulate_sse2;
+#endif
+    return flare16x_series_accumulate_scalar;
+}
+
+// Initializes an empty accumulator
+// The first frame added determines the dimensions, device model and crosshair position of all other frames
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_series_accumulator_create(flare16x_series_accumulator* accumulator)
+{
+    // Make sure the accumulator is not null
+    if (accumulator == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_SERIES);
+
+    // The planes are allocated once the first frame is added
+    memset(accumulator, 0, sizeof(flare16x_series_accumulator));
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_SERIES);
+}
+
+// Adds the value plane of a processed frame to the accumulator
+// Frames from another device, with the crosshair at another position or another quantification mode are rejected
+flare16x_error flare16x_series_accumulator_add(flare16x_series_accumulator* accumulator, flare16x_thermal* thermal)
+{
+    // Make sure that there are no null pointers
+    if (accumulator == NULL || thermal == NULL || thermal->thermal_image == NULL ||
+        thermal->thermal_image->points == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_SERIES);
+
+    flare16x_thermal_image* image = thermal->thermal_image;
+    size_t count = (size_t)image->width * image->height;
+
+    // The first frame determines the properties of the series
+    if (accumulator->count == 0)
+    {
+        accumulator->sums = calloc(count, sizeof(uint32_t));
+        accumulator->squares = calloc(count, sizeof(uint32_t));
+        if (accumulator->sums == NULL || accumulator->squares == NULL)
+        {
+            free(accumulator->sums);
+            free(accumulator->squares);
+            memset(accumulator, 0, sizeof(flare16x_series_accumulator));
+            return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_SERIES);
+        }
+
+        accumulator->width = image->width;
+        accumulator->height = image->height;
+        accumulator->mode = image->mode;
+        accumulator->device_model = thermal->device_model;
+        accumulator->spot_x = thermal->spot_x;
+        accumulator->spot_y = thermal->spot_y;
+    }
+
+    // All other frames have to match it
+    else if (image->width != accumulator->width || image->height != accumulator->height ||
+             image->mode != accumulator->mode || thermal->device_model != accumulator->device_model ||
+             thermal->spot_x != accumulator->spot_x || thermal->spot_y != accumulator->spot_y ||
+             accumulator->count >= FLARE16X_SERIES_MAX_FRAMES)
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_SERIES);
+
+    // Add the values to the planes
+    flare16x_series_kernel_best()(image->points, accumulator->sums, accumulator->squares, count);
+    accumulator->count++;
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_SERIES);
+}
+
+// Calculates the mean value of every pixel with FLARE16X_SERIES_MEAN_SHIFT fractional bits and its sample variance
+// Either plane may be null, if it is not needed, and the variance is zero for less than two frames
+flare16x_error flare16x_series_accumulator_result(flare16x_series_accumulator* accumulator, uint16_t* mean,
+        float* variance)
+{
+    // Make sure the accumulator is not null
+    if (accumulator == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_SERIES);
+
+    // There has to be at least one frame
+    if (accumulator->count == 0)
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_SERIES);
+
+    size_t count = (size_t)accumulator->width * accumulator->height, point;
+    uint64_t frames = accumulator->count;
+
+    // Round the mean to the nearest fraction
+    if (mean != NULL)
+        for (point = 0; point < count; point++)
+            mean[point] = (uint16_t)((((uint64_t)accumulator->sums[point] << FLARE16X_SERIES_MEAN_SHIFT) +
+                    frames / 2) / frames);
+
+    // The numerator of the variance is calculated exactly in integers to avoid cancellation
+    if (variance != NULL)
+        for (point = 0; point < count; point++)
+        {
+            uint64_t sum = accumulator->sums[point];
+            variance[point] = frames < 2 ? 0.0f : (float)((double)(frames * accumulator->squares[point] - sum * sum) /
+                    (double)(frames * (frames - 1)));
+        }
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_SERIES);
+}
+
+// Frees the resources used by an accumulator
+flare16x_error flare16x_series_accumulator_destroy(flare16x_series_accumulator* accumulator)
+{
+    // Make sure the accumulator is not null
+    if (accumulator == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_SERIES);
+
+    // Free the planes and zero the struct
+    free(accumulator->sums);
+    free(accumulator->squares);
+    memset(accumulator, 0, sizeof(flare16x_series_accumulator));
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_SERIES);
+}
+
+// The value and validity planes of a frame used by the registration
+typedef struct {
+    int width;
+    int height;
+    // The values of all points
+    uint8_t* values;
+    // One for the points outside the crosshair and zero for all others
+    uint8_t* valid;
+} flare16x_series_plane;
+
+// Separates the values and validities of a frame, keeping only every other line and column at half resolution
+static flare16x_error flare16x_series_plane_create(flare16x_thermal* thermal, int half, flare16x_series_plane* plane)
+{
+    int step = half ? 2 : 1, x, y;
+    plane->width = (thermal->thermal_image->width + step - 1) / step;
+    plane->height = (thermal->thermal_image->height + step - 1) / step;
+    plane->values = malloc((size_t)plane->width * plane->height * 2);
+    if (plane->values == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_SERIES);
+    plane->valid = plane->values + (size_t)plane->width * plane->height;
+
+    for (y = 0; y < plane->height; y++)
+        for (x = 0; x < plane->width; x++)
+        {
+            size_t source = (size_t)y * step * thermal->thermal_image->width + (size_t)x * step;
+            plane->values[y * plane->width + x] = thermal->thermal_image->points[source].value;
+            plane->valid[y * plane->width + x] = thermal->mask.pixels[source] == FLARE16X_LOCATOR_DETECT_IMAGE;
+        }
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_SERIES);
+}
+
+// Compares the valid points of a reference plane with those of a displaced plane
+// The inner loop is free of branches, so that the compiler can vectorize it
+static void flare16x_series_compare(const flare16x_series_plane* reference, const flare16x_series_plane* frame,
+        int shift_x, int shift_y, uint32_t* overlap, uint64_t* difference, int64_t* offset)
+{
+    int width = reference->width, height = reference->height, x, y;
+    int start_x = shift_x < 0 ? -shift_x : 0, end_x = shift_x > 0 ? width - shift_x : width;
+    int start_y = shift_y < 0 ? -shift_y : 0, end_y = shift_y > 0 ? height - shift_y : height;
+
+    *overlap = 0;
+    *difference = 0;
+    *offset = 0;
+    for (y = start_y; y < end_y; y++)
+    {
+        const uint8_t* reference_values = reference->values + (size_t)y * width;
+        const uint8_t* reference_valid = reference->valid + (size_t)y * width;
+        const uint8_t* frame_values = frame->values + (size_t)(y + shift_y) * width;
+        const uint8_t* frame_valid = frame->valid + (size_t)(y + shift_y) * width;
+
+        // The sums of a single line fit into 32 bits
+        uint32_t line_overlap = 0, line_difference = 0;
+        int32_t line_offset = 0;
+        for (x = start_x; x < end_x; x++)
+        {
+            int32_t valid = reference_valid[x] & frame_valid[x + shift_x];
+            int32_t delta = ((int32_t)reference_values[x] - (int32_t)frame_values[x + shift_x]) * valid;
+            line_overlap += (uint32_t)valid;
+            line_difference += (uint32_t)(delta < 0 ? -delta : delta);
+            line_offset += delta;
+        }
+
+        *overlap += line_overlap;
+        *difference += line_difference;
+        *offset += line_offset;
+    }
+}
+
+// Searches the displacement with the smallest mean absolute difference around a center
+// Returns non-zero, if any displacement overlaps by at least the minimum number of points
+static int flare16x_series_search(const flare16x_series_plane* reference, const flare16x_series_plane* frame,
+        int center_x, int center_y, int range, int radius, uint32_t minimum, flare16x_series_shift* shift)
+{
+    uint64_t best = UINT64_MAX, difference;
+    uint32_t overlap;
+    int64_t offset;
+    int x, y;
+
+    for (y = center_y - range; y <= center_y + range; y++)
+        for (x = center_x - range; x <= center_x + range; x++)
+        {
+            // Stay within the search radius
+            if (x < -radius || x > radius || y < -radius || y > radius)
+                continue;
+
+            flare16x_series_compare(reference, frame, x, y, &overlap, &difference, &offset);
+            if (overlap < minimum || overlap == 0)
+                continue;
+
+            // Keep the displacement with the smallest mean absolute difference
+            uint64_t mean = (difference << 8) / overlap;
+            if (mean >= best)
+                continue;
+            best = mean;
+            shift->x = (int16_t)x;
+            shift->y = (int16_t)y;
+            shift->overlap = overlap;
+            shift->difference = (uint32_t)mean;
+            shift->offset = (int16_t)(offset >= 0 ? (offset + overlap / 2) / overlap :
+                    -((-offset + overlap / 2) / overlap));
+        }
+
+    return best != UINT64_MAX;
+}
+
+// Finds the displacement of a frame relative to a reference frame within the given radius
+// Fails with an image error, if the frames do not overlap sufficiently at any displacement
+flare16x_error flare16x_series_register(flare16x_thermal* reference, flare16x_thermal* frame, uint16_t radius,
+        flare16x_series_shift* shift)
+{
+    // Make sure that there are no null pointers
+    if (reference == NULL || frame == NULL || shift == NULL || reference->thermal_image == NULL ||
+        frame->thermal_image == NULL || reference->thermal_image->points == NULL ||
+        frame->thermal_image->points == NULL || reference->mask.pixels == NULL || frame->mask.pixels == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_SERIES);
+
+    // Both frames and their masks have to have the same dimensions
+    uint16_t width = reference->thermal_image->width, height = reference->thermal_image->height;
+    if (frame->thermal_image->width != width || frame->thermal_image->height != height ||
+        reference->mask.width != width || reference->mask.height != height || frame->mask.width != width ||
+        frame->mask.height != height || radius >= width / 2 || radius >= height / 2)
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_SERIES);
+
+    // Prepare the planes at half and full resolution
+    flare16x_series_plane planes[4];
+    flare16x_error error = flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_SERIES);
+    int plane;
+    memset(planes, 0, sizeof(planes));
+    for (plane = 0; plane < 4 && flare16x_error_reason(error) == FLARE16X_ERROR_NONE; plane++)
+        error = flare16x_series_plane_create(plane % 2 ? frame : reference, plane < 2, &planes[plane]);
+
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+    {
+        // At least a quarter of the points have to overlap
+        uint32_t minimum = (uint32_t)((size_t)width * height / 4);
+
+        // Search all even displacements at half resolution first and then refine the best one at full resolution
+        flare16x_series_shift coarse;
+        if (!flare16x_series_search(&planes[0], &planes[1], 0, 0, (radius + 1) / 2, (radius + 1) / 2, minimum / 4,
+                                    &coarse) ||
+            !flare16x_series_search(&planes[2], &planes[3], coarse.x * 2, coarse.y * 2, 2, radius, minimum, shift))
+            error = flare16x_error_make(FLARE16X_ERROR_IMAGE, FLARE16X_ERROR_SOURCE_SERIES);
+    }
+
+    for (plane = 0; plane < 4; plane++)
+        free(planes[plane].values);
+
+    return error;
+}
+
+// Fills the crosshair of a processed frame with the registered values of other frames of the same burst
+// The frames may include the frame itself, while frames of other dimensions or scenes are ignored
+// The number of filled points is stored in filled, unless it is null
+flare16x_error flare16x_series_fill(flare16x_thermal* thermal, flare16x_thermal** frames, size_t count,
+        uint16_t radius, uint32_t* filled)
+{
+    // Make sure that there are no null pointers
+    if (thermal == NULL || (frames == NULL && count > 0) || thermal->thermal_image == NULL ||
+        thermal->thermal_image->points == NULL || thermal->mask.pixels == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_SERIES);
+
+    if (filled != NULL)
+        *filled = 0;
+    if (count == 0)
+        return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_SERIES);
+
+    // Allocate the displacements and the candidates of a single point
+    flare16x_series_shift* shifts = malloc(count * sizeof(flare16x_series_shift));
+    flare16x_thermal** sources = malloc(count * sizeof(flare16x_thermal*));
+    flare16x_thermal_point* candidates = malloc(count * sizeof(flare16x_thermal_point));
+    if (shifts == NULL || sources == NULL || candidates == NULL)
+    {
+        free(shifts);
+        free(sources);
+        free(candidates);
+        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_SERIES);
+    }
+
+    // Register all other frames, skipping those that do not show the same scene
+    size_t frame, used = 0;
+    for (frame = 0; frame < count; frame++)
+    {
+        if (frames[frame] == NULL || frames[frame] == thermal)
+            continue;
+        flare16x_error error = flare16x_series_register(thermal, frames[frame], radius, &shifts[used]);
+        if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE &&
+            shifts[used].difference <= FLARE16X_SERIES_MAX_DIFFERENCE << 8)
+            sources[used++] = frames[frame];
+    }
+
+    // Then, replace every crosshair point with the median of the aligned points outside the other crosshairs
+    flare16x_thermal_image* image = thermal->thermal_image;
+    int x, y;
+    uint32_t points = 0;
+    for (y = 0; y < image->height && used > 0; y++)
+        for (x = 0; x < image->width; x++)
+        {
+            if (thermal->mask.pixels[y * image->width + x] != FLARE16X_LOCATOR_DETECT_CROSSHAIR)
+                continue;
+
+            // Collect the candidates sorted by their value
+            size_t found = 0, candidate;
+            for (frame = 0; frame < used; frame++)
+            {
+                int source_x = x + shifts[frame].x, source_y = y + shifts[frame].y;
+                if (source_x < 0 || source_x >= image->width || source_y < 0 || source_y >= image->height)
+                    continue;
+                size_t offset = (size_t)source_y * image->width + source_x;
+                if (sources[frame]->mask.pixels[offset] != FLARE16X_LOCATOR_DETECT_IMAGE)
+                    continue;
+
+                // Compensate for the different range of the frame
+                flare16x_thermal_point point = sources[frame]->thermal_image->points[offset];
+                int value = point.value + shifts[frame].offset;
+                point.value = (uint8_t)(value < 0 ? 0 : value > 0xff ? 0xff : value);
+
+                for (candidate = found; candidate > 0 && candidates[candidate - 1].value > point.value; candidate--)
+                    candidates[candidate] = candidates[candidate - 1];
+                candidates[candidate] = point;
+                found++;
+            }
+
+            // Keep the interpolated value, if no frame shows the point
+            if (found == 0)
+                continue;
+            flare16x_thermal_image_raw(x, y, image) = candidates[(found - 1) / 2];
+            points++;
+        }
+
+    free(shifts);
+    free(sources);
+    free(candidates);
+
+    if (filled != NULL)
+        *filled = points;
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_SERIES);
+}
+
+// Rounds a value to the nearest integer, away from zero on ties
+static long flare16x_series_round(double value)
+{
+    return value < 0 ? -(long)(0.5 - value) : (long)(value + 0.5);
+}
+
+// Converts a relative value of a frame to degrees celsius times 10 using an absolute mapping
+static int16_t flare16x_series_temperature(const flare16x_series_mapping* mapping, uint8_t value)
+{
+    long temperature = flare16x_series_round((mapping->offset + mapping->gain * value) * 10);
+    return (int16_t)(temperature < INT16_MIN ? INT16_MIN : temperature > INT16_MAX ? INT16_MAX : temperature);
+}
+
+// Fits the line that maps the values of a frame onto those of a reference frame through their overlapping points
+// Returns non-zero, if the frames are registered and their overlapping values correlate sufficiently
+static int flare16x_series_relate(flare16x_thermal* reference, flare16x_thermal* frame, uint16_t radius,
+        double* offset, double* gain)
+{
+    flare16x_series_shift shift;
+    flare16x_error error = flare16x_series_register(reference, frame, radius, &shift);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return 0;
+
+    // Sum up the values of all points outside both crosshairs
+    flare16x_thermal_image* image = reference->thermal_image;
+    double count = 0, sum_frame = 0, sum_reference = 0, squares_frame = 0, squares_reference = 0, products = 0;
+    int x, y;
+    for (y = 0; y < image->height; y++)
+        for (x = 0; x < image->width; x++)
+        {
+            int frame_x = x + shift.x, frame_y = y + shift.y;
+            if (frame_x < 0 || frame_x >= image->width || frame_y < 0 || frame_y >= image->height)
+                continue;
+            size_t reference_offset = (size_t)y * image->width + x;
+            size_t frame_offset = (size_t)frame_y * image->width + frame_x;
+            if (reference->mask.pixels[reference_offset] != FLARE16X_LOCATOR_DETECT_IMAGE ||
+                frame->mask.pixels[frame_offset] != FLARE16X_LOCATOR_DETECT_IMAGE)
+                continue;
+
+            double reference_value = image->points[reference_offset].value;
+            double frame_value = frame->thermal_image->points[frame_offset].value;
+            count++;
+            sum_frame += frame_value;
+            sum_reference += reference_value;
+            squares_frame += frame_value * frame_value;
+            squares_reference += reference_value * reference_value;
+            products += frame_value * reference_value;
+        }
+
+    // Both frames have to show a structured scene that correlates positively
+    double variance_frame = squares_frame * count - sum_frame * sum_frame;
+    double variance_reference = squares_reference * count - sum_reference * sum_reference;
+    double covariance = products * count - sum_frame * sum_reference;
+    if (count < 2 || variance_frame <= 0 || variance_reference <= 0 || covariance <= 0 ||
+        covariance * covariance < FLARE16X_SERIES_MIN_CORRELATION * FLARE16X_SERIES_MIN_CORRELATION *
+                                  variance_frame * variance_reference)
+        return 0;
+
+    *gain = covariance / variance_frame;
+    *offset = (sum_reference - *gain * sum_frame) / count;
+    return 1;
+}
+
+// Calculates the mean value of the aperture spot of a frame
+// Returns non-zero, if the frame has a spot within the image
+static int flare16x_series_spot(flare16x_thermal* thermal, double* mean)
+{
+    flare16x_thermal_image* image = thermal->thermal_image;
+    if (thermal->spot_width == 0 || thermal->spot_height == 0 ||
+        (uint32_t)thermal->spot_x + thermal->spot_width > image->width ||
+        (uint32_t)thermal->spot_y + thermal->spot_height > image->height)
+        return 0;
+
+    uint32_t sum = 0;
+    uint16_t x, y;
+    for (y = thermal->spot_y; y < thermal->spot_y + thermal->spot_height; y++)
+        for (x = thermal->spot_x; x < thermal->spot_x + thermal->spot_width; x++)
+            sum += flare16x_thermal_image_raw(x, y, image).value;
+    *mean = (double)sum / ((uint32_t)thermal->spot_width * thermal->spot_height);
+
+    return 1;
+}
+
+// Relates the values of a sequence of processed frames to a common scale
+// A frame that does not overlap with the previous one is related to the first one instead or left unlinked
+// The mappings have to hold one entry per frame
+flare16x_error flare16x_series_normalize(flare16x_thermal** frames, size_t count, uint16_t radius,
+        flare16x_series_mapping* mappings, flare16x_series_scale* scale)
+{
+    // Make sure that there are no null pointers
+    if (frames == NULL || mappings == NULL || scale == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_SERIES);
+
+    memset(mappings, 0, count * sizeof(flare16x_series_mapping));
+    memset(scale, 0, sizeof(flare16x_series_scale));
+
+    // Find the first usable frame, which defines the common scale
+    size_t frame, first = count, previous;
+    for (frame = 0; frame < count && first == count; frame++)
+        if (frames[frame] != NULL && frames[frame]->thermal_image != NULL &&
+            frames[frame]->thermal_image->points != NULL && frames[frame]->mask.pixels != NULL)
+            first = frame;
+    if (first == count)
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_SERIES);
+    mappings[first].gain = 1;
+    mappings[first].linked = 1;
+
+    // Relate every other frame to the previous linked frame or the first one
+    double offset, gain;
+    for (frame = first + 1, previous = first; frame < count; frame++)
+    {
+        if (frames[frame] == NULL || frames[frame]->thermal_image == NULL ||
+            frames[frame]->thermal_image->points == NULL || frames[frame]->mask.pixels == NULL)
+            continue;
+
+        size_t reference = previous;
+        if (!flare16x_series_relate(frames[reference], frames[frame], radius, &offset, &gain))
+        {
+            reference = first;
+            if (previous == first || !flare16x_series_relate(frames[reference], frames[frame], radius, &offset, &gain))
+                continue;
+        }
+
+        // Chain the mapping onto the common scale
+        mappings[frame].offset = mappings[reference].offset + mappings[reference].gain * offset;
+        mappings[frame].gain = mappings[reference].gain * gain;
+        mappings[frame].linked = 1;
+        previous = frame;
+    }
+
+    // Determine the range of all linked frames on the relative scale
+    int initialized = 0;
+    for (frame = first; frame < count; frame++)
+    {
+        if (!mappings[frame].linked)
+            continue;
+
+        flare16x_thermal_image* image = frames[frame]->thermal_image;
+        size_t point, size = (size_t)image->width * image->height;
+        uint8_t minimum = 0xff, maximum = 0;
+        for (point = 0; point < size; point++)
+        {
+            if (image->points[point].value < minimum)
+                minimum = image->points[point].value;
+            if (image->points[point].value > maximum)
+                maximum = image->points[point].value;
+        }
+
+        double low = mappings[frame].offset + mappings[frame].gain * minimum;
+        double high = mappings[frame].offset + mappings[frame].gain * maximum;
+        if (!initialized || low < scale->minimum)
+            scale->minimum = low;
+        if (!initialized || high > scale->maximum)
+            scale->maximum = high;
+        initialized = 1;
+    }
+
+    // Fit a line through the common spot values and the spot temperatures
+    double points = 0, sum_value = 0, sum_temperature = 0, squares_value = 0, squares_temperature = 0, products = 0;
+    double spot;
+    int16_t coldest = INT16_MAX, hottest = INT16_MIN;
+    for (frame = first; frame < count; frame++)
+    {
+        if (!mappings[frame].linked || !flare16x_series_spot(frames[frame], &spot))
+            continue;
+
+        double value = mappings[frame].offset + mappings[frame].gain * spot;
+        double temperature = frames[frame]->temperature_spot / 10.0;
+        if (frames[frame]->temperature_spot < coldest)
+            coldest = frames[frame]->temperature_spot;
+        if (frames[frame]->temperature_spot > hottest)
+            hottest = frames[frame]->temperature_spot;
+        points++;
+        sum_value += value;
+        sum_temperature += temperature;
+        squares_value += value * value;
+        squares_temperature += temperature * temperature;
+        products += value * temperature;
+    }
+
+    // The spot values have to spread by at least one count and the temperatures by a few OSD steps,
+    // and both have to correlate just as strongly as the values of two related frames
+    double variance_value = squares_value * points - sum_value * sum_value;
+    double variance_temperature = squares_temperature * points - sum_temperature * sum_temperature;
+    double covariance = products * points - sum_value * sum_temperature;
+    if (points < 2 || variance_value < points * points || hottest - coldest < FLARE16X_SERIES_MIN_SPREAD ||
+        variance_temperature <= 0 || covariance <= 0 ||
+        covariance * covariance < FLARE16X_SERIES_MIN_CORRELATION * FLARE16X_SERIES_MIN_CORRELATION *
+                                  variance_value * variance_temperature)
+        return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_SERIES);
+
+    // Keep the relative scale, if the anchored range would collapse into less than one OSD step
+    gain = covariance / variance_value;
+    offset = (sum_temperature - gain * sum_value) / points;
+    if (gain * (scale->maximum - scale->minimum) < 0.1)
+        return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_SERIES);
+
+    // Anchor the mappings and the range to degrees celsius
+    for (frame = first; frame < count; frame++)
+    {
+        mappings[frame].offset = offset + gain * mappings[frame].offset;
+        mappings[frame].gain *= gain;
+    }
+    scale->minimum = offset + gain * scale->minimum;
+    scale->maximum = offset + gain * scale->maximum;
+    scale->absolute = 1;
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_SERIES);
+}
+
+// Requantizes the values of all linked frames from the range of the common scale
+// For an absolute scale, the calculated temperatures of the frames are filled in as well
+flare16x_error flare16x_series_remap(flare16x_thermal** frames, size_t count,
+        const flare16x_series_mapping* mappings, const flare16x_series_scale* scale)
+{
+    // Make sure that there are no null pointers
+    if (frames == NULL || mappings == NULL || scale == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_SERIES);
+
+    // A flat scale maps every value to zero
+    double factor = scale->maximum > scale->minimum ? 255.0 / (scale->maximum - scale->minimum) : 0;
+    size_t frame;
+    for (frame = 0; frame < count; frame++)
+    {
+        if (!mappings[frame].linked || frames[frame] == NULL || frames[frame]->thermal_image == NULL ||
+            frames[frame]->thermal_image->points == NULL)
+            continue;
+
+        // Calculate the new value of every relative value and the new uncertainty of every relative count
+        double step = mappings[frame].gain * factor;
+        uint8_t values[256];
+        int value;
+        for (value = 0; value < 256; value++)
+        {
+            long mapped = flare16x_series_round((mappings[frame].offset + mappings[frame].gain * value -
+                                                 scale->minimum) * factor);
+            values[value] = (uint8_t)(mapped < 0 ? 0 : mapped > 0xff ? 0xff : mapped);
+        }
+
+        // Fill in the spot temperatures in degrees celsius times 10 before the values change
+        flare16x_thermal* thermal = frames[frame];
+        flare16x_thermal_image* image = thermal->thermal_image;
+        uint8_t minimum = 0xff, maximum = 0;
+        uint16_t x, y;
+        if (scale->absolute && thermal->spot_width > 0 && thermal->spot_height > 0 &&
+            (uint32_t)thermal->spot_x + thermal->spot_width <= image->width &&
+            (uint32_t)thermal->spot_y + thermal->spot_height <= image->height)
+        {
+            for (y = thermal->spot_y; y < thermal->spot_y + thermal->spot_height; y++)
+                for (x = thermal->spot_x; x < thermal->spot_x + thermal->spot_width; x++)
+                {
+                    uint8_t current = flare16x_thermal_image_raw(x, y, image).value;
+                    if (current < minimum)
+                        minimum = current;
+                    if (current > maximum)
+                        maximum = current;
+                }
+            thermal->temperature_spot_min = flare16x_series_temperature(&mappings[frame], minimum);
+            thermal->temperature_spot_max = flare16x_series_temperature(&mappings[frame], maximum);
+        }
+
+        // Then, remap the points, keeping track of the range of the frame
+        size_t point, size = (size_t)image->width * image->height;
+        minimum = 0xff;
+        maximum = 0;
+        for (point = 0; point < size; point++)
+        {
+            flare16x_thermal_point* current = &image->points[point];
+            if (current->value < minimum)
+                minimum = current->value;
+            if (current->value > maximum)
+                maximum = current->value;
+
+            // Round the uncertainty up, so that it still covers all values
+            double uncertainty = current->uncertainty * step;
+            long counts = (long)uncertainty;
+            counts += counts < uncertainty;
+            current->value = values[current->value];
+            current->uncertainty = (uint8_t)(counts > 0xff ? 0xff : counts);
+        }
+
+        // And the temperatures of the entire frame
+        if (scale->absolute)
+        {
+            thermal->temperature_min = flare16x_series_temperature(&mappings[frame], minimum);
+            thermal->temperature_max = flare16x_series_temperature(&mappings[frame], maximum);
+        }
+    }
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_SERIES);
+}
@@ -0,0 +1,162 @@
+//
+// flare16x core
+// Developed 2019 by Benedikt Muessig <github@bmuessig.eu>
+// Licensed under GPLv3
+//
+// series.h: Header file for combining several processed frames of the same scene
+//
+
+#ifndef FLARE16X_SERIES_H
+#define FLARE16X_SERIES_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "error.h"
+#include "thermal.h"
+
+// The maximum number of frames an accumulator can hold without overflowing its planes
+#define FLARE16X_SERIES_MAX_FRAMES 65535
+// The number of fractional bits of the mean value plane
+#define FLARE16X_SERIES_MEAN_SHIFT 8
+// The default maximum displacement between two frames searched by the registration in pixels
+#define FLARE16X_SERIES_RADIUS 8
+// The maximum mean absolute difference in counts of a registered frame that still shows the same scene
+#define FLARE16X_SERIES_MAX_DIFFERENCE 8
+// The minimum correlation of the overlapping values of two frames that are related to each other
+#define FLARE16X_SERIES_MIN_CORRELATION 0.8
+// The minimum spread of the spot temperatures in degrees celsius times 10 that anchors a sequence to degrees celsius
+#define FLARE16X_SERIES_MIN_SPREAD 10
+
+/*
+ * The palettes quantize the relative values into steps that are often wider than a single count.
+ * When a static scene is captured repeatedly, the sensor noise makes the quantized values flicker between the
+ * neighbouring steps, so that their mean recovers the value with a precision finer than one step.
+ * The accumulator sums the values and their squares of every pixel in wide integer planes, from which the mean and
+ * the variance of every pixel are calculated once all frames have been added.
+ */
+
+// Accumulates the value planes of several frames
+typedef struct {
+    // The width of the accumulated planes in pixels
+    uint16_t width;
+    // The height of the accumulated planes in pixels
+    uint16_t height;
+    // The quantification mode of all frames as defined in FLARE16X_THERMAL_QUANTIFICATION_*
+    uint8_t mode;
+    // The device model of all frames as defined in FLARE16X_LOCATOR_MODEL_*
+    uint8_t device_model;
+    // The x-coordinate of the aperture spot of all frames
+    uint16_t spot_x;
+    // The y-coordinate of the aperture spot of all frames
+    uint16_t spot_y;
+    // The number of frames added so far
+    uint32_t count;
+    // The sum of the values of every pixel
+    uint32_t* sums;
+    // The sum of the squared values of every pixel
+    uint32_t* squares;
+} flare16x_series_accumulator;
+
+// Initializes an empty accumulator
+// The first frame added determines the dimensions, device model and crosshair position of all other frames
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_series_accumulator_create(flare16x_series_accumulator* accumulator);
+
+// Adds the value plane of a processed frame to the accumulator
+// Frames from another device, with the crosshair at another position or another quantification mode are rejected
+flare16x_error flare16x_series_accumulator_add(flare16x_series_accumulator* accumulator, flare16x_thermal* thermal);
+
+// Calculates the mean value of every pixel with FLARE16X_SERIES_MEAN_SHIFT fractional bits and its sample variance
+// Either plane may be null, if it is not needed, and the variance is zero for less than two frames
+flare16x_error flare16x_series_accumulator_result(flare16x_series_accumulator* accumulator, uint16_t* mean,
+        float* variance);
+
+// Frees the resources used by an accumulator
+flare16x_error flare16x_series_accumulator_destroy(flare16x_series_accumulator* accumulator);
+
+// Adds the values of a line of thermal points and their squares to the sums of an accumulator
+typedef void (*flare16x_series_kernel)(const flare16x_thermal_point* points, uint32_t* sums, uint32_t* squares,
+        size_t count);
+
+// Looks up the accumulation kernel of a specific instruction set as defined in FLARE16X_CONVERT_ISA_*
+// Instruction sets without a kernel of their own return the kernel of the best one they include
+// Fails with an unknown error if the instruction set is not supported by the compiler or the running CPU
+flare16x_error flare16x_series_kernel_get(uint8_t isa, flare16x_series_kernel* kernel);
+
+/*
+ * A handheld camera moves slightly between the frames of a burst, so the scene hidden by the crosshair of one frame
+ * is usually visible in the others. The registration finds the translation between two frames that minimizes the
+ * mean absolute difference of the pixels outside the crosshair of both, first on every other pixel for all
+ * displacements and then on every pixel around the best one. The crosshair pixels of a frame are then filled with
+ * the median of the aligned values of the other frames, while the interpolated value is kept where none has data.
+ * Frames that differ too much even at their best displacement show another scene and are not used.
+ */
+
+// The result of registering a frame against a reference frame
+typedef struct {
+    // The horizontal displacement, so that the reference point (x, y) shows the frame point (x + x, y + y)
+    int16_t x;
+    // The vertical displacement
+    int16_t y;
+    // The mean difference of the reference values minus the frame values
+    int16_t offset;
+    // The number of points outside the crosshair in both frames
+    uint32_t overlap;
+    // The mean absolute difference of these points times 256
+    uint32_t difference;
+} flare16x_series_shift;
+
+// Finds the displacement of a frame relative to a reference frame within the given radius
+// Fails with an image error, if the frames do not overlap sufficiently at any displacement
+flare16x_error flare16x_series_register(flare16x_thermal* reference, flare16x_thermal* frame, uint16_t radius,
+        flare16x_series_shift* shift);
+
+// Fills the crosshair of a processed frame with the registered values of other frames of the same burst
+// The frames may include the frame itself, while frames of other dimensions or scenes are ignored
+// The number of filled points is stored in filled, unless it is null
+flare16x_error flare16x_series_fill(flare16x_thermal* thermal, flare16x_thermal** frames, size_t count,
+        uint16_t radius, uint32_t* filled);
+
+/*
+ * Each frame scales its palette to the range of its own scene, so the same relative value means another temperature
+ * in every frame. The normalizer relates the values of every frame linearly to those of the previous frame by
+ * fitting a line through the values of their overlapping points once both are registered. This puts all frames onto
+ * the relative scale of the first one. The spot temperatures read from the OSD then anchor this common scale to
+ * degrees celsius, provided that the spot values and temperatures of the frames spread far enough and correlate
+ * as strongly as two related frames. Otherwise, and if the anchored range would be flat, the relative scale is kept.
+ * Finally, all frames can be remapped from one fixed range of the common scale, which keeps them comparable.
+ */
+
+// The linear mapping of the values of a frame onto the common scale
+typedef struct {
+    // The common value of the relative value zero
+    double offset;
+    // The common value difference of one relative count
+    double gain;
+    // Non-zero, if the frame could be related to the other frames
+    uint8_t linked;
+} flare16x_series_mapping;
+
+// The common scale of a normalized sequence
+typedef struct {
+    // Non-zero, if the common scale is in degrees celsius, or zero for the relative scale of the first frame
+    uint8_t absolute;
+    // The lowest common value of all linked frames
+    double minimum;
+    // The highest common value of all linked frames
+    double maximum;
+} flare16x_series_scale;
+
+// Relates the values of a sequence of processed frames to a common scale
+// A frame that does not overlap with the previous one is related to the first one instead or left unlinked
+// The mappings have to hold one entry per frame
+flare16x_error flare16x_series_normalize(flare16x_thermal** frames, size_t count, uint16_t radius,
+        flare16x_series_mapping* mappings, flare16x_series_scale* scale);
+
+// Requantizes the values of all linked frames from the range of the common scale
+// For an absolute scale, the calculated temperatures of the frames are filled in as well
+flare16x_error flare16x_series_remap(flare16x_thermal** frames, size_t count,
+        const flare16x_series_mapping* mappings, const flare16x_series_scale* scale);
+
+#endif //FLARE16X_SERIES_H
@@ -0,0 +1,485 @@
+//
+// flare16x core
+// Developed 2019 by Benedikt Muessig <github@bmuessig.eu>
+// Licensed under GPLv3
+//
+// stream.c: Fused streaming recolor operator working on a few lines at a time
+//
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "error.h"
+#include "bitmap.h"
+#include "canvas.h"
+#include "locator.h"
+#include "palettes.h"
+#include "thermal.h"
+
+#include "stream.h"
+
+// The largest supported stride of a source line (32 bits per pixel)
+#define FLARE16X_STREAM_SOURCE_STRIDE (FLARE16X_LOCATOR_EXPECTED_WIDTH * 4)
+// The stride of an output line (16 bits per pixel aligned to 32 bits)
+#define FLARE16X_STREAM_OUTPUT_STRIDE ((((FLARE16X_LOCATOR_IR_WIDTH * 16) + 31) & ~31) >> 3)
+
+// Creates a new streaming recolor context and allocates the line buffers
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_stream_create(uint8_t palette_index, uint8_t interpolation_mode, uint8_t quantification_mode,
+        uint8_t crosshair_mode, uint16_t crosshair_border, uint16_t crosshair_fill, flare16x_stream* stream)
+{
+    // Make sure the stream is not null
+    if (stream == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_STREAM);
+
+    // Validate the palette, interpolation and quantification modes
+    const flare16x_palette_entry* palette = flare16x_palettes_get(palette_index);
+    int palette_length = flare16x_palettes_get_length(palette_index);
+    if (palette == NULL || palette_length < 1 || interpolation_mode >= FLARE16X_THERMAL_INTERPOLATION_COUNT ||
+        quantification_mode >= FLARE16X_THERMAL_QUANTIFICATION_COUNT)
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_STREAM);
+
+    // Clear the context and copy the settings
+    memset(stream, 0, sizeof(flare16x_stream));
+    stream->palette_index = palette_index;
+    stream->interpolation_mode = interpolation_mode;
+    stream->quantification_mode = quantification_mode;
+    stream->crosshair_mode = crosshair_mode;
+    stream->crosshair_border = crosshair_border;
+    stream->crosshair_fill = crosshair_fill;
+
+    // Build the value lookup table, where the first palette entry covering a value wins just like in the export
+    int value, item;
+    for (value = 0; value < 256; value++)
+        for (item = 0; item < palette_length; item++)
+            if (palette[item].width > 0 && palette[item].base <= value &&
+                palette[item].base + palette[item].width > value)
+            {
+                stream->value_colors[value] = palette[item].color;
+                stream->value_valid[value] = 1;
+                break;
+            }
+
+    // Allocate the line buffers
+    stream->line = malloc(FLARE16X_STREAM_SOURCE_STRIDE);
+    stream->pixels = malloc(FLARE16X_LOCATOR_IR_WIDTH * sizeof(uint16_t));
+    stream->values = malloc(FLARE16X_STREAM_LINES * FLARE16X_LOCATOR_IR_WIDTH);
+    stream->mask = malloc(FLARE16X_STREAM_LINES * FLARE16X_LOCATOR_IR_WIDTH);
+    stream->output = malloc(FLARE16X_STREAM_OUTPUT_STRIDE);
+    if (stream->line == NULL || stream->pixels == NULL || stream->values == NULL || stream->mask == NULL ||
+        stream->output == NULL)
+    {
+        flare16x_stream_destroy(stream);
+        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_STREAM);
+    }
+
+    // Clear the output line, so that the padding is always zero
+    memset(stream->output, 0, FLARE16X_STREAM_OUTPUT_STRIDE);
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_STREAM);
+}
+
+// Returns the color lookup table of a source palette and creates it, if it does not exist yet
+static flare16x_error flare16x_stream_entries(flare16x_stream* stream, uint8_t palette_index, uint8_t** entries)
+{
+    // Validate the palette
+    const flare16x_palette_entry* palette = flare16x_palettes_get(palette_index);
+    int palette_length = flare16x_palettes_get_length(palette_index);
+    if (palette == NULL || palette_length < 1 || palette_length >= FLARE16X_STREAM_NO_ENTRY)
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_STREAM);
+
+    // Check, if the table has already been created
+    *entries = stream->color_entries[palette_index - FLARE16X_PALETTES_MIN];
+    if (*entries != NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_STREAM);
+
+    // Otherwise allocate a table covering all RGB565 colors and mark them as unknown
+    *entries = malloc(1 << 16);
+    if (*entries == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_STREAM);
+    memset(*entries, FLARE16X_STREAM_NO_ENTRY, 1 << 16);
+
+    // Fill in the entries backwards, so that the first entry of a color wins just like in the palette search
+    int item;
+    for (item = palette_length - 1; item >= 0; item--)
+        (*entries)[palette[item].color] = item;
+
+    // Keep the table for the next images
+    stream->color_entries[palette_index - FLARE16X_PALETTES_MIN] = *entries;
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_STREAM);
+}
+
+// Reads a line of the IR region from the source file and converts it to RGB565
+static flare16x_error flare16x_stream_read(flare16x_stream* stream, flare16x_bitmap* bitmap, FILE* source,
+        uint16_t y)
+{
+    // Calculate the line within the file, as bottom up bitmaps store the last line first
+    long line = FLARE16X_LOCATOR_IR_OFFSET_Y + y;
+    if (bitmap->dib->height > 0)
+        line = bitmap->dib->height - 1 - line;
+
+    // Seek to the line and read it
+    if (fseek(source, (long)bitmap->header->payload_offset + line * bitmap->stride, SEEK_SET) != 0 ||
+        fread(stream->line, bitmap->stride, 1, source) != 1)
+        return flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_STREAM);
+
+    // And convert the IR region
+    flare16x_error error = flare16x_bitmap_scanline(bitmap, stream->line, FLARE16X_LOCATOR_IR_OFFSET_X,
+            FLARE16X_LOCATOR_IR_WIDTH, stream->pixels);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return flare16x_error_wrap(flare16x_error_make(FLARE16X_ERROR_CALLEE, FLARE16X_ERROR_SOURCE_STREAM), error);
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_STREAM);
+}
+
+// Adds the values of all image pixels within the radius around a pixel of the ring buffer to the sum and count
+static void flare16x_stream_gather(flare16x_stream* stream, int x, int y, int radius, int weight,
+        uint32_t* sum, uint32_t* count)
+{
+    int offset_x, offset_y;
+    for (offset_y = -radius; offset_y <= radius; offset_y++)
+    {
+        // Skip lines outside of the image
+        if (y + offset_y < 0 || y + offset_y >= FLARE16X_LOCATOR_IR_HEIGHT)
+            continue;
+
+        for (offset_x = -radius; offset_x <= radius; offset_x++)
+            if (x + offset_x >= 0 && x + offset_x < FLARE16X_LOCATOR_IR_WIDTH &&
+                flare16x_stream_ring(x + offset_x, y + offset_y, stream->mask) == FLARE16X_LOCATOR_DETECT_IMAGE)
+            {
+                *sum += flare16x_stream_ring(x + offset_x, y + offset_y, stream->values) * weight;
+                *count += weight;
+            }
+    }
+}
+
+// Recolors a screenshot from the seekable source file and writes the IR image as RGB565 bitmap to the target file
+// On success, the detected device model, palette, aperture spot and value statistics are stored in the context
+flare16x_error flare16x_stream_recolor(flare16x_stream* stream, FILE* source, FILE* target)
+{
+    // Make sure that there are no null pointers
+    if (stream == NULL || source == NULL || target == NULL || stream->line == NULL || stream->pixels == NULL ||
+        stream->values == NULL || stream->mask == NULL || stream->output == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_STREAM);
+
+    // Load the headers of the source bitmap
+    flare16x_bitmap bitmap;
+    flare16x_error error = flare16x_bitmap_load_header(source, &bitmap);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return flare16x_error_wrap(flare16x_error_make(FLARE16X_ERROR_CALLEE, FLARE16X_ERROR_SOURCE_STREAM), error);
+
+    // Check, if the size of the bitmap matches and the line fits into the buffer
+    if (bitmap.dib->width != FLARE16X_LOCATOR_EXPECTED_WIDTH ||
+        abs(bitmap.dib->height) != FLARE16X_LOCATOR_EXPECTED_HEIGHT ||
+        bitmap.stride > FLARE16X_STREAM_SOURCE_STRIDE)
+    {
+        flare16x_bitmap_destroy(&bitmap);
+        return flare16x_error_make(FLARE16X_ERROR_IMAGE, FLARE16X_ERROR_SOURCE_STREAM);
+    }
+
+    // The locator only requires the dimensions of the IR canvas to detect the crosshair pixels
+    flare16x_canvas frame = {FLARE16X_LOCATOR_IR_WIDTH, FLARE16X_LOCATOR_IR_HEIGHT, NULL};
+    flare16x_locator locator;
+    memset(&locator, 0, sizeof(flare16x_locator));
+
+    // Allocate a tally for the palette analysis
+    flare16x_palette_tally tally;
+    flare16x_palettes_tally_init(FLARE16X_PALETTES_IGNORE_ERRORS, &tally);
+
+    // First pass: Search the crosshair and determine the palette line by line
+    int x, y, found = 0;
+    for (y = 0; y < FLARE16X_LOCATOR_IR_HEIGHT; y++)
+    {
+        error = flare16x_stream_read(stream, &bitmap, source, y);
+        if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        {
+            flare16x_bitmap_destroy(&bitmap);
+            return error;
+        }
+
+        // Stop searching for the crosshair once it has been found
+        if (!found && flare16x_error_reason(flare16x_locator_scan(stream->pixels, FLARE16X_LOCATOR_IR_WIDTH, y,
+                &locator)) == FLARE16X_ERROR_NONE)
+            found = 1;
+
+        flare16x_palettes_tally_line(stream->pixels, FLARE16X_LOCATOR_IR_WIDTH, &tally);
+    }
+
+    // An image without crosshair is treated as IR data only
+    if (!found)
+        locator.device_model = FLARE16X_LOCATOR_MODEL_UNKNOWN;
+    locator.ir_canvas = &frame;
+
+    // Store the results of the locator
+    stream->device_model = locator.device_model;
+    stream->spot_x = locator.aperture_x;
+    stream->spot_y = locator.aperture_y;
+    stream->spot_width = locator.aperture_width;
+    stream->spot_height = locator.aperture_height;
+
+    // Determine the palette and fetch its lookup table
+    uint8_t palette_index;
+    uint8_t* entries;
+    error = flare16x_palettes_tally_result(&tally, &palette_index);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+    {
+        flare16x_bitmap_destroy(&bitmap);
+        return flare16x_error_wrap(flare16x_error_make(FLARE16X_ERROR_CALLEE, FLARE16X_ERROR_SOURCE_STREAM), error);
+    }
+    stream->palette = palette_index;
+    error = flare16x_stream_entries(stream, palette_index, &entries);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+    {
+        flare16x_bitmap_destroy(&bitmap);
+        return error;
+    }
+    const flare16x_palette_entry* palette = flare16x_palettes_get(palette_index);
+
+    // Second pass: Gather the statistics of the image pixels, if the interpolation mode requires them
+    uint32_t value_med_sum = 0, value_med_count = 0;
+    uint8_t value_min = 0xff, value_max = 0, value_med = 0;
+    if (stream->interpolation_mode == FLARE16X_THERMAL_INTERPOLATION_MIN ||
+        stream->interpolation_mode == FLARE16X_THERMAL_INTERPOLATION_MED ||
+        stream->interpolation_mode == FLARE16X_THERMAL_INTERPOLATION_MAX)
+    {
+        for (y = 0; y < FLARE16X_LOCATOR_IR_HEIGHT; y++)
+        {
+            error = flare16x_stream_read(stream, &bitmap, source, y);
+            if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+            {
+                flare16x_bitmap_destroy(&bitmap);
+                return error;
+            }
+
+            for (x = 0; x < FLARE16X_LOCATOR_IR_WIDTH; x++)
+            {
+                // Only known colors outside of the crosshair count
+                uint8_t entry = entries[stream->pixels[x]];
+                if (entry == FLARE16X_STREAM_NO_ENTRY ||
+                    flare16x_locator_detect(&locator, x, y) != FLARE16X_LOCATOR_DETECT_IMAGE)
+                    continue;
+
+                value_med_sum += palette[entry].base;
+                value_med_count++;
+                if (value_max < palette[entry].base)
+                    value_max = palette[entry].base;
+                if (value_min > palette[entry].base)
+                    value_min = palette[entry].base;
+            }
+        }
+
+        // The statistics require at least one image pixel
+        if (value_med_count < 1)
+        {
+            flare16x_bitmap_destroy(&bitmap);
+            return flare16x_error_make(FLARE16X_ERROR_IMAGE, FLARE16X_ERROR_SOURCE_STREAM);
+        }
+        value_med = value_med_sum / value_med_count;
+    }
+
+    // Write the headers of the output bitmap
+    flare16x_bitmap output;
+    error = flare16x_bitmap_describe16(FLARE16X_LOCATOR_IR_WIDTH, FLARE16X_LOCATOR_IR_HEIGHT, &output);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+    {
+        error = flare16x_bitmap_store_header(&output, target);
+        flare16x_bitmap_destroy(&output);
+    }
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+    {
+        flare16x_bitmap_destroy(&bitmap);
+        return flare16x_error_wrap(flare16x_error_make(FLARE16X_ERROR_CALLEE, FLARE16X_ERROR_SOURCE_STREAM), error);
+    }
+
+    // Final pass: Convert the lines into the ring buffer and emit each line once its neighborhood is complete
+    uint32_t output_sum = 0;
+    uint8_t output_min = 0xff, output_max = 0;
+    int line;
+    for (line = 0; line < FLARE16X_LOCATOR_IR_HEIGHT + FLARE16X_STREAM_RADIUS; line++)
+    {
+        // Convert the next line, while there is one
+        if (line < FLARE16X_LOCATOR_IR_HEIGHT)
+        {
+            error = flare16x_stream_read(stream, &bitmap, source, line);
+            if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+            {
+                flare16x_bitmap_destroy(&bitmap);
+                return error;
+            }
+
+            for (x = 0; x < FLARE16X_LOCATOR_IR_WIDTH; x++)
+            {
+                uint8_t mask = flare16x_locator_detect(&locator, x, line), value = 0;
+                if (mask == FLARE16X_LOCATOR_DETECT_IMAGE)
+                {
+                    // Translate the color and mark unknown colors as invalid
+                    uint8_t entry = entries[stream->pixels[x]];
+                    if (entry == FLARE16X_STREAM_NO_ENTRY)
+                        mask = FLARE16X_LOCATOR_DETECT_INVALID;
+                    else
+                    {
+                        // Quantify the palette entry
+                        const flare16x_palette_entry* palette_entry = &palette[entry];
+                        if (palette_entry->width < 1 || (palette_entry->width != 1 &&
+                            stream->quantification_mode == FLARE16X_THERMAL_QUANTIFICATION_EXACT))
+                        {
+                            flare16x_bitmap_destroy(&bitmap);
+                            return flare16x_error_make(FLARE16X_ERROR_IMAGE, FLARE16X_ERROR_SOURCE_STREAM);
+                        }
+                        switch (stream->quantification_mode)
+                        {
+                            case FLARE16X_THERMAL_QUANTIFICATION_CEILING:
+                                value = (palette_entry->width - 1) + palette_entry->base;
+                                break;
+                            case FLARE16X_THERMAL_QUANTIFICATION_MEDIAN_LOW:
+                                value = ((palette_entry->width - 1) / 2) + palette_entry->base;
+                                break;
+                            case FLARE16X_THERMAL_QUANTIFICATION_MEDIAN_HIGH:
+                                value = (palette_entry->width / 2) + palette_entry->base;
+                                break;
+                            default:
+                                value = palette_entry->base;
+                                break;
+                        }
+                    }
+                } else if (mask != FLARE16X_LOCATOR_DETECT_CROSSHAIR)
+                {
+                    // Something went wrong detecting the crosshair
+                    flare16x_bitmap_destroy(&bitmap);
+                    return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_STREAM);
+                }
+
+                flare16x_stream_ring(x, line, stream->values) = value;
+                flare16x_stream_ring(x, line, stream->mask) = mask;
+            }
+        }
+
+        // Check, if there is a complete line to emit
+        y = line - FLARE16X_STREAM_RADIUS;
+        if (y < 0)
+            continue;
+
+        for (x = 0; x < FLARE16X_LOCATOR_IR_WIDTH; x++)
+        {
+            uint8_t mask = flare16x_stream_ring(x, y, stream->mask);
+            if (mask == FLARE16X_LOCATOR_DETECT_IMAGE)
+                continue;
+
+            // Replace the pixel in the same way as the thermal processing does
+            uint32_t sum = 0, count = 0;
+            switch (stream->interpolation_mode)
+            {
+                case FLARE16X_THERMAL_INTERPOLATION_ZERO:
+                    flare16x_stream_ring(x, y, stream->values) = 0;
+                    break;
+                case FLARE16X_THERMAL_INTERPOLATION_MIN:
+                    flare16x_stream_ring(x, y, stream->values) = value_min;
+                    break;
+                case FLARE16X_THERMAL_INTERPOLATION_MAX:
+                    flare16x_stream_ring(x, y, stream->values) = value_max;
+                    break;
+                case FLARE16X_THERMAL_INTERPOLATION_MED:
+                    flare16x_stream_ring(x, y, stream->values) = value_med;
+                    break;
+                default:
+                    // The large square adds the weight square, which adds the small square
+                    if (stream->interpolation_mode == FLARE16X_THERMAL_INTERPOLATION_SQUARE_LARGE)
+                        flare16x_stream_gather(stream, x, y, 6, 1, &sum, &count);
+                    if (stream->interpolation_mode != FLARE16X_THERMAL_INTERPOLATION_SQUARE_SMALL)
+                        flare16x_stream_gather(stream, x, y, 1,
+                                stream->interpolation_mode == FLARE16X_THERMAL_INTERPOLATION_SQUARE_WEIGHT ? 4 : 1,
+                                &sum, &count);
+                    flare16x_stream_gather(stream, x, y, 2, 1, &sum, &count);
+
+                    // Verify, that at least one point was found
+                    if (count < 1)
+                    {
+                        flare16x_bitmap_destroy(&bitmap);
+                        return flare16x_error_make(FLARE16X_ERROR_IMAGE, FLARE16X_ERROR_SOURCE_STREAM);
+                    }
+                    flare16x_stream_ring(x, y, stream->values) = sum / count;
+                    break;
+            }
+
+            // Invalid pixels become part of the image once they have been interpolated
+            if (mask == FLARE16X_LOCATOR_DETECT_INVALID)
+                flare16x_stream_ring(x, y, stream->mask) = FLARE16X_LOCATOR_DETECT_IMAGE;
+        }
+
+        // Translate the line into the target palette and redraw the crosshair, if desired
+        for (x = 0; x < FLARE16X_LOCATOR_IR_WIDTH; x++)
+        {
+            uint8_t value = flare16x_stream_ring(x, y, stream->values);
+            if (!stream->value_valid[value])
+            {
+                flare16x_bitmap_destroy(&bitmap);
+                return flare16x_error_make(FLARE16X_ERROR_IMAGE, FLARE16X_ERROR_SOURCE_STREAM);
+            }
+            stream->output[x] = stream->value_colors[value];
+
+            // Keep track of the output statistics
+            output_sum += value;
+            if (value < output_min)
+                output_min = value;
+            if (value > output_max)
+                output_max = value;
+
+            if (!stream->crosshair_mode ||
+                flare16x_stream_ring(x, y, stream->mask) != FLARE16X_LOCATOR_DETECT_CROSSHAIR)
+                continue;
+
+            // Crosshair pixels at the start or end of a horizontal or vertical run are border pixels
+            // Runs touching the right or bottom edge keep their fill, just like in flare16x_thermal_crosshair
+            if (x == 0 || flare16x_stream_ring(x - 1, y, stream->mask) != FLARE16X_LOCATOR_DETECT_CROSSHAIR ||
+                (x + 1 < FLARE16X_LOCATOR_IR_WIDTH &&
+                 flare16x_stream_ring(x + 1, y, stream->mask) != FLARE16X_LOCATOR_DETECT_CROSSHAIR) ||
+                y == 0 || flare16x_stream_ring(x, y - 1, stream->mask) != FLARE16X_LOCATOR_DETECT_CROSSHAIR ||
+                (y + 1 < FLARE16X_LOCATOR_IR_HEIGHT &&
+                 flare16x_stream_ring(x, y + 1, stream->mask) != FLARE16X_LOCATOR_DETECT_CROSSHAIR))
+                stream->output[x] = stream->crosshair_border;
+            else
+                stream->output[x] = stream->crosshair_fill;
+        }
+
+        // And write the line straight to the target file
+        if (fwrite(stream->output, FLARE16X_STREAM_OUTPUT_STRIDE, 1, target) != 1)
+        {
+            flare16x_bitmap_destroy(&bitmap);
+            return flare16x_error_make(FLARE16X_ERROR_IO, FLARE16X_ERROR_SOURCE_STREAM);
+        }
+    }
+
+    // Store the output statistics
+    stream->value_min = output_min;
+    stream->value_max = output_max;
+    stream->value_mean = output_sum / (FLARE16X_LOCATOR_IR_WIDTH * FLARE16X_LOCATOR_IR_HEIGHT);
+
+    flare16x_bitmap_destroy(&bitmap);
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_STREAM);
+}
+
+// Frees all resources used by a streaming recolor context
+flare16x_error flare16x_stream_destroy(flare16x_stream* stream)
+{
+    // Make sure the stream is not null
+    if (stream == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_STREAM);
+
+    // Free the lookup tables
+    int palette;
+    for (palette = 0; palette < FLARE16X_PALETTES_COUNT; palette++)
+        free(stream->color_entries[palette]);
+
+    // Free the line buffers
+    free(stream->line);
+    free(stream->pixels);
+    free(stream->values);
+    free(stream->mask);
+    free(stream->output);
+
+    // Finally, zero the struct
+    memset(stream, 0, sizeof(flare16x_stream));
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_STREAM);
+}
@@ -0,0 +1,109 @@
+//
+// flare16x core
+// Developed 2019 by Benedikt Muessig <github@bmuessig.eu>
+// Licensed under GPLv3
+//
+// stream.h: Header file for the fused streaming recolor operator
+//
+
+#ifndef FLARE16X_STREAM_H
+#define FLARE16X_STREAM_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "error.h"
+#include "canvas.h"
+#include "locator.h"
+#include "palettes.h"
+
+/*
+ * The streaming recolor operator produces the same bitmap as the thermal pipeline consisting of
+ * flare16x_bitmap_load, flare16x_locator_create, flare16x_locator_process, flare16x_thermal_create,
+ * flare16x_thermal_process, flare16x_thermal_export, the optional flare16x_thermal_crosshair and
+ * flare16x_bitmap_store, but it never materializes any of the intermediate images.
+ * Instead, the source file is read line by line in (at most) three passes:
+ * 1) The first pass searches for the crosshair and counts the palette matches of each line
+ * 2) The second pass is only required for the MIN, MED and MAX interpolation modes and gathers the statistics
+ * 3) The final pass converts each line via lookup tables into a small ring buffer of thermal values
+ *    As soon as all lines within the interpolation radius are available, the oldest line is interpolated,
+ *    translated into the target palette, has the crosshair redrawn and is written straight to the target file
+ * Therefore, the source file has to be seekable, while the target file is written strictly sequentially.
+ */
+
+// The largest distance in lines that any interpolation mode reads from the interpolated pixel
+#define FLARE16X_STREAM_RADIUS 6
+// The number of lines kept in the ring buffer
+#define FLARE16X_STREAM_LINES (FLARE16X_STREAM_RADIUS * 2 + 1)
+// The marker used in the color lookup table for colors that are not part of the palette
+#define FLARE16X_STREAM_NO_ENTRY 0xff
+
+// Represents a streaming recolor context that can be re-used for any number of images
+typedef struct {
+    // The palette used to render the output image as defined in FLARE16X_PALETTES_*
+    uint8_t palette_index;
+    // The interpolation mode used to erase the crosshair as defined in FLARE16X_THERMAL_INTERPOLATION_*
+    uint8_t interpolation_mode;
+    // The quantification mode used to convert colors to values as defined in FLARE16X_THERMAL_QUANTIFICATION_*
+    uint8_t quantification_mode;
+    // If non-zero, the crosshair is redrawn in the output image using the two colors below
+    uint8_t crosshair_mode;
+    // The RGB565 color of the redrawn crosshair's border
+    uint16_t crosshair_border;
+    // The RGB565 color of the redrawn crosshair's fill
+    uint16_t crosshair_fill;
+
+    // The device model of the latest image as defined in FLARE16X_LOCATOR_MODEL_*
+    uint8_t device_model;
+    // The palette detected in the latest image as defined in FLARE16X_PALETTES_*
+    uint8_t palette;
+    // The x-coordinate of the aperture spot's upper left origin relative to the IR image
+    uint16_t spot_x;
+    // The y-coordinate of the aperture spot's upper left origin relative to the IR image
+    uint16_t spot_y;
+    // The width of the crosshair's aperture spot in pixels
+    uint16_t spot_width;
+    // The height of the crosshair's aperture spot in pixels
+    uint16_t spot_height;
+    // The smallest relative thermal value of the latest output image
+    uint8_t value_min;
+    // The largest relative thermal value of the latest output image
+    uint8_t value_max;
+    // The average relative thermal value of the latest output image
+    uint16_t value_mean;
+
+    // The lookup tables from RGB565 colors to palette entry indices, created on demand per source palette
+    uint8_t* color_entries[FLARE16X_PALETTES_COUNT];
+    // The lookup table from relative thermal values to the RGB565 colors of the target palette
+    uint16_t value_colors[256];
+    // Flags, whether a relative thermal value is covered by the target palette
+    uint8_t value_valid[256];
+
+    // The raw source line in the format of the source file
+    uint8_t* line;
+    // The RGB565 pixels of the IR region of the current source line
+    uint16_t* pixels;
+    // The ring buffer of relative thermal values
+    uint8_t* values;
+    // The ring buffer of mask values as defined in FLARE16X_LOCATOR_DETECT_*
+    uint8_t* mask;
+    // The raw output line in the RGB565 bitmap format
+    uint16_t* output;
+} flare16x_stream;
+
+// Access to a value or mask pixel of a line held in the ring buffer
+#define flare16x_stream_ring(x,y,buffer) (buffer)[((y) % FLARE16X_STREAM_LINES) * FLARE16X_LOCATOR_IR_WIDTH + (x)]
+
+// Creates a new streaming recolor context and allocates the line buffers
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_stream_create(uint8_t palette_index, uint8_t interpolation_mode, uint8_t quantification_mode,
+        uint8_t crosshair_mode, uint16_t crosshair_border, uint16_t crosshair_fill, flare16x_stream* stream);
+
+// Recolors a screenshot from the seekable source file and writes the IR image as RGB565 bitmap to the target file
+// On success, the detected device model, palette, aperture spot and value statistics are stored in the context
+flare16x_error flare16x_stream_recolor(flare16x_stream* stream, FILE* source, FILE* target);
+
+// Frees all resources used by a streaming recolor context
+flare16x_error flare16x_stream_destroy(flare16x_stream* stream);
+
+#endif //FLARE16X_STREAM_H
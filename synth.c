@@ -0,0 +1,331 @@
+//
+// flare16x core
+// Developed 2019 by Benedikt Muessig <github@bmuessig.eu>
+// Licensed under GPLv3
+//
+// synth.c: Functions for generating synthetic screenshots of the TG165 and TG167
+//
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "error.h"
+#include "bitmap.h"
+#include "canvas.h"
+#include "locator.h"
+#include "palettes.h"
+#include "ocr.h"
+
+#include "synth.h"
+
+// The lowest relative value rendered into a scene
+#define FLARE16X_SYNTH_VALUE_MIN 1
+// The highest relative value rendered into a scene
+#define FLARE16X_SYNTH_VALUE_MAX 250
+// The number of disks of the spot scene
+#define FLARE16X_SYNTH_SPOTS 4
+
+// The filled rectangles of a crosshair (x, y, width, height relative to its origin)
+typedef struct {
+    uint8_t x;
+    uint8_t y;
+    uint8_t width;
+    uint8_t height;
+} flare16x_synth_rectangle;
+
+// The rectangles of the TG165 crosshair, which are the ones detected by flare16x_locator_detect
+static const flare16x_synth_rectangle flare16x_synth_tg165[] = {
+    {6, 6, 11, 3}, {0, 10, 6, 3}, {17, 10, 6, 3}, {10, 17, 3, 6},
+    {6, 9, 3, 8}, {14, 9, 3, 8}, {10, 0, 3, 6}, {9, 14, 5, 3}
+};
+
+// The rectangles of the TG167 crosshair, which are the ones detected by flare16x_locator_detect
+static const flare16x_synth_rectangle flare16x_synth_tg167[] = {
+    {13, 12, 23, 3}, {13, 32, 23, 3}, {0, 22, 13, 3}, {36, 22, 13, 3},
+    {23, 35, 3, 12}, {13, 15, 3, 17}, {33, 15, 3, 17}, {23, 0, 3, 12}
+};
+
+// Advances the xorshift state of the generator and returns the next pseudo-random number
+static uint32_t flare16x_synth_random(uint32_t* state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+// Approximates the sine of a phase, of which 1024 steps make up a full period, scaled to -256 to 256
+static int32_t flare16x_synth_wave(uint32_t phase)
+{
+    int32_t half = (int32_t)(phase & 511);
+    int32_t value = (half * (512 - half)) >> 8;
+    return (phase & 512) ? -value : value;
+}
+
+// Calculates the relative value of a point of the scene before the noise is added
+static int32_t flare16x_synth_scene(const flare16x_synth_options* options, const int32_t* spots, int x, int y)
+{
+    switch (options->scene)
+    {
+        case FLARE16X_SYNTH_SCENE_WAVES:
+            // A wave of about 144 pixels horizontally times one of about 195 pixels vertically
+            return 127 + 100 * flare16x_synth_wave((uint32_t)(x * 1024 / 144) + options->seed * 97) *
+                    flare16x_synth_wave((uint32_t)(y * 1024 / 195) + 256) / (256 * 256);
+
+        case FLARE16X_SYNTH_SCENE_GRADIENT:
+            // A ramp from the upper left to the lower right corner
+            return FLARE16X_SYNTH_VALUE_MIN + ((x * (FLARE16X_SYNTH_VALUE_MAX - FLARE16X_SYNTH_VALUE_MIN) /
+                    (FLARE16X_LOCATOR_IR_WIDTH - 1)) + (y * (FLARE16X_SYNTH_VALUE_MAX - FLARE16X_SYNTH_VALUE_MIN) /
+                    (FLARE16X_LOCATOR_IR_HEIGHT - 1))) / 2;
+
+        case FLARE16X_SYNTH_SCENE_SPOTS:
+        {
+            // The last disk that covers the point wins, while the dim ramp shows everywhere else
+            int32_t value = 60 + (x + y) * 40 / (FLARE16X_LOCATOR_IR_WIDTH + FLARE16X_LOCATOR_IR_HEIGHT);
+            int spot;
+            for (spot = 0; spot < FLARE16X_SYNTH_SPOTS; spot++)
+            {
+                const int32_t* disk = &spots[spot * 4];
+                if ((x - disk[0]) * (x - disk[0]) + (y - disk[1]) * (y - disk[1]) < disk[2] * disk[2])
+                    value = disk[3];
+            }
+            return value;
+        }
+
+        default:
+            // The flat scene
+            return 127;
+    }
+}
+
+// Draws the glyphs of a string with the templates of a font onto the canvas
+static void flare16x_synth_text(const char* text, uint8_t length, uint16_t offset_x, uint16_t offset_y,
+        uint16_t pitch, const flare16x_ocr_font* font, flare16x_canvas* canvas)
+{
+    uint8_t index;
+    for (index = 0; index < length && text[index] != 0; index++)
+    {
+        // Look up the template of the character and leave the glyph blank, if there is none
+        const flare16x_ocr_glyph* glyph = NULL;
+        uint8_t item;
+        for (item = 0; item < font->count && glyph == NULL; item++)
+            if (font->glyphs[item].symbol == text[index])
+                glyph = &font->glyphs[item];
+        if (glyph == NULL)
+            continue;
+
+        // Then set the pixels of the template
+        uint16_t glyph_x = offset_x + index * (font->width + pitch);
+        int x, y;
+        for (y = 0; y < font->height; y++)
+            for (x = 0; x < font->width; x++)
+                if (glyph->rows[y] & (1u << x))
+                    flare16x_canvas_raw(glyph_x + x, offset_y + y, canvas) = font->color;
+    }
+}
+
+// Fills in the options of a wave scene with a little noise and the crosshair in the center of the IR image
+flare16x_error flare16x_synth_defaults(uint8_t device_model, uint8_t palette, flare16x_synth_options* options)
+{
+    // Make sure the options are not null
+    if (options == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_SYNTH);
+
+    // Only the crosshairs of the TG165 and TG167 are known
+    uint16_t width, height;
+    if (device_model == FLARE16X_LOCATOR_MODEL_TG165)
+    {
+        width = FLARE16X_LOCATOR_CROSSHAIR_BORDER_WIDTH + FLARE16X_LOCATOR_TG165_CENTER_WIDTH +
+                FLARE16X_LOCATOR_TG165_FILL_WIDTH * 2;
+        height = FLARE16X_LOCATOR_TG165_CROSSHAIR_HEIGHT;
+    }
+    else if (device_model == FLARE16X_LOCATOR_MODEL_TG167)
+    {
+        width = FLARE16X_LOCATOR_CROSSHAIR_BORDER_WIDTH + FLARE16X_LOCATOR_TG167_CENTER_WIDTH +
+                FLARE16X_LOCATOR_TG167_FILL_WIDTH * 2;
+        height = FLARE16X_LOCATOR_TG167_CROSSHAIR_HEIGHT;
+    }
+    else
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_SYNTH);
+
+    // Fill in the options
+    memset(options, 0, sizeof(flare16x_synth_options));
+    options->device_model = device_model;
+    options->palette = palette;
+    options->scene = FLARE16X_SYNTH_SCENE_WAVES;
+    options->noise = 3;
+    options->crosshair_x = (FLARE16X_LOCATOR_IR_WIDTH - width) / 2;
+    options->crosshair_y = (FLARE16X_LOCATOR_IR_HEIGHT - height) / 2;
+    options->seed = 1;
+    options->temperature = FLARE16X_SYNTH_TEMPERATURE;
+    options->emissivity = FLARE16X_SYNTH_EMISSIVITY;
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_SYNTH);
+}
+
+// Renders a synthetic screenshot into a new top-down RGB565 bitmap
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_synth_render(const flare16x_synth_options* options, flare16x_bitmap* screenshot)
+{
+    // Make sure that there are no null pointers
+    if (options == NULL || screenshot == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_SYNTH);
+
+    // Fetch the crosshair of the model
+    const flare16x_synth_rectangle* rectangles;
+    size_t rectangle_count;
+    uint16_t crosshair_width, crosshair_height;
+    if (options->device_model == FLARE16X_LOCATOR_MODEL_TG165)
+    {
+        rectangles = flare16x_synth_tg165;
+        rectangle_count = sizeof(flare16x_synth_tg165) / sizeof(flare16x_synth_rectangle);
+        crosshair_width = FLARE16X_LOCATOR_CROSSHAIR_BORDER_WIDTH + FLARE16X_LOCATOR_TG165_CENTER_WIDTH +
+                FLARE16X_LOCATOR_TG165_FILL_WIDTH * 2;
+        crosshair_height = FLARE16X_LOCATOR_TG165_CROSSHAIR_HEIGHT;
+    }
+    else if (options->device_model == FLARE16X_LOCATOR_MODEL_TG167)
+    {
+        rectangles = flare16x_synth_tg167;
+        rectangle_count = sizeof(flare16x_synth_tg167) / sizeof(flare16x_synth_rectangle);
+        crosshair_width = FLARE16X_LOCATOR_CROSSHAIR_BORDER_WIDTH + FLARE16X_LOCATOR_TG167_CENTER_WIDTH +
+                FLARE16X_LOCATOR_TG167_FILL_WIDTH * 2;
+        crosshair_height = FLARE16X_LOCATOR_TG167_CROSSHAIR_HEIGHT;
+    }
+    else
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_SYNTH);
+
+    // Verify the scene, the palette and that the crosshair lies within the IR image
+    const flare16x_palette_entry* palette = flare16x_palettes_get(options->palette);
+    int palette_length = flare16x_palettes_get_length(options->palette);
+    if (options->scene >= FLARE16X_SYNTH_SCENE_COUNT || palette == NULL || palette_length < 1 ||
+        options->crosshair_x + crosshair_width > FLARE16X_LOCATOR_IR_WIDTH ||
+        options->crosshair_y + crosshair_height > FLARE16X_LOCATOR_IR_HEIGHT)
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_SYNTH);
+
+    // Look up the color of every relative value, using the closest lower entry for values the palette skips
+    uint16_t colors[256];
+    int value, item;
+    for (value = 0; value < 256; value++)
+    {
+        int closest = 0;
+        for (item = 0; item < palette_length; item++)
+        {
+            if (palette[item].base <= value && palette[item].base + palette[item].width > value)
+            {
+                closest = item;
+                break;
+            }
+            if (palette[item].base <= value && palette[item].base > palette[closest].base)
+                closest = item;
+        }
+        colors[value] = palette[closest].color;
+    }
+
+    // Place the disks of the spot scene, alternating between hot and cold ones
+    uint32_t state = options->seed ? options->seed : 1;
+    int32_t spots[FLARE16X_SYNTH_SPOTS * 4];
+    int spot;
+    for (spot = 0; spot < FLARE16X_SYNTH_SPOTS; spot++)
+    {
+        spots[spot * 4] = (int32_t)(flare16x_synth_random(&state) % FLARE16X_LOCATOR_IR_WIDTH);
+        spots[spot * 4 + 1] = (int32_t)(flare16x_synth_random(&state) % FLARE16X_LOCATOR_IR_HEIGHT);
+        spots[spot * 4 + 2] = (int32_t)(6 + flare16x_synth_random(&state) % 24);
+        spots[spot * 4 + 3] = (int32_t)(spot & 1 ? 5 + flare16x_synth_random(&state) % 36 :
+                200 + flare16x_synth_random(&state) % 51);
+    }
+
+    // Create a black canvas of the size of a screenshot
+    flare16x_canvas canvas;
+    flare16x_error error = flare16x_canvas_create(FLARE16X_LOCATOR_EXPECTED_WIDTH, FLARE16X_LOCATOR_EXPECTED_HEIGHT,
+            &canvas);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return flare16x_error_wrap(flare16x_error_make(FLARE16X_ERROR_CALLEE, FLARE16X_ERROR_SOURCE_SYNTH), error);
+    memset(canvas.pixels, 0, (size_t)canvas.width * canvas.height * sizeof(uint16_t));
+
+    // Render the noisy scene into the IR window
+    int x, y;
+    for (y = 0; y < FLARE16X_LOCATOR_IR_HEIGHT; y++)
+        for (x = 0; x < FLARE16X_LOCATOR_IR_WIDTH; x++)
+        {
+            value = (int)flare16x_synth_scene(options, spots, x, y);
+            if (options->noise > 0)
+                value += (int)(flare16x_synth_random(&state) % (2u * options->noise + 1)) - options->noise;
+            if (value < FLARE16X_SYNTH_VALUE_MIN)
+                value = FLARE16X_SYNTH_VALUE_MIN;
+            if (value > FLARE16X_SYNTH_VALUE_MAX)
+                value = FLARE16X_SYNTH_VALUE_MAX;
+            flare16x_canvas_raw(FLARE16X_LOCATOR_IR_OFFSET_X + x, FLARE16X_LOCATOR_IR_OFFSET_Y + y, &canvas) =
+                    colors[value];
+        }
+
+    // Mark the pixels of the crosshair
+    uint8_t mask[64 * 64];
+    size_t rectangle;
+    memset(mask, 0, sizeof(mask));
+    for (rectangle = 0; rectangle < rectangle_count; rectangle++)
+        for (y = rectangles[rectangle].y; y < rectangles[rectangle].y + rectangles[rectangle].height; y++)
+            for (x = rectangles[rectangle].x; x < rectangles[rectangle].x + rectangles[rectangle].width; x++)
+                mask[y * 64 + x] = 1;
+
+    // Fill every horizontal run of the crosshair with white and close both ends with a black border pixel
+    uint16_t origin_x = FLARE16X_LOCATOR_IR_OFFSET_X + options->crosshair_x,
+        origin_y = FLARE16X_LOCATOR_IR_OFFSET_Y + options->crosshair_y;
+    int run;
+    for (y = 0; y < crosshair_height; y++)
+        for (x = 0, run = 0; x <= crosshair_width; x++)
+        {
+            if (x < crosshair_width && mask[y * 64 + x])
+            {
+                flare16x_canvas_raw(origin_x + x, origin_y + y, &canvas) = run++ == 0 ?
+                        FLARE16X_LOCATOR_CROSSHAIR_BORDER : FLARE16X_LOCATOR_CROSSHAIR_FILL;
+                continue;
+            }
+            if (run > 1)
+                flare16x_canvas_raw(origin_x + x - 1, origin_y + y, &canvas) = FLARE16X_LOCATOR_CROSSHAIR_BORDER;
+            run = 0;
+        }
+
+    // Then also close both ends of every vertical run
+    for (x = 0; x < crosshair_width; x++)
+        for (y = 0, run = 0; y <= crosshair_height; y++)
+        {
+            if (y < crosshair_height && mask[y * 64 + x])
+            {
+                if (run++ == 0)
+                    flare16x_canvas_raw(origin_x + x, origin_y + y, &canvas) = FLARE16X_LOCATOR_CROSSHAIR_BORDER;
+                continue;
+            }
+            if (run > 1)
+                flare16x_canvas_raw(origin_x + x, origin_y + y - 1, &canvas) = FLARE16X_LOCATOR_CROSSHAIR_BORDER;
+            run = 0;
+        }
+
+    // Draw the OSD text
+    if (options->temperature != NULL)
+        flare16x_synth_text(options->temperature, FLARE16X_LOCATOR_TEMPERATURE_DIGITS,
+                FLARE16X_LOCATOR_TEXT_OFFSET_X + FLARE16X_LOCATOR_TEMPERATURE_OFFSET_X,
+                FLARE16X_LOCATOR_TEXT_OFFSET_Y + FLARE16X_LOCATOR_TEMPERATURE_OFFSET_Y,
+                FLARE16X_LOCATOR_TEMPERATURE_PITCH, &flare16x_ocr_large_font, &canvas);
+    if (options->emissivity != NULL)
+        flare16x_synth_text(options->emissivity, FLARE16X_LOCATOR_EMISSIVITY_DIGITS,
+                FLARE16X_LOCATOR_TEXT_OFFSET_X + FLARE16X_LOCATOR_EMISSIVITY_OFFSET_X,
+                FLARE16X_LOCATOR_TEXT_OFFSET_Y + FLARE16X_LOCATOR_EMISSIVITY_OFFSET_Y,
+                FLARE16X_LOCATOR_EMISSIVITY_PITCH, &flare16x_ocr_small_font, &canvas);
+
+    // Finally, copy the canvas into a new bitmap
+    error = flare16x_bitmap_create16(FLARE16X_LOCATOR_EXPECTED_WIDTH, FLARE16X_LOCATOR_EXPECTED_HEIGHT, screenshot);
+    if (flare16x_error_reason(error) == FLARE16X_ERROR_NONE)
+    {
+        error = flare16x_bitmap_merge(&canvas, 0, 0, screenshot);
+        if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+            flare16x_bitmap_destroy(screenshot);
+    }
+    flare16x_canvas_destroy(&canvas);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return flare16x_error_wrap(flare16x_error_make(FLARE16X_ERROR_CALLEE, FLARE16X_ERROR_SOURCE_SYNTH), error);
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_SYNTH);
+}
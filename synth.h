@@ -0,0 +1,75 @@
+//
+// flare16x core
+// Developed 2019 by Benedikt Muessig <github@bmuessig.eu>
+// Licensed under GPLv3
+//
+// synth.h: Header file for generating synthetic screenshots of the TG165 and TG167
+//
+
+#ifndef FLARE16X_SYNTH_H
+#define FLARE16X_SYNTH_H
+
+#include <stdint.h>
+
+#include "error.h"
+#include "bitmap.h"
+
+/*
+ * The generator renders screenshots that look like the ones stored by the devices, so that the whole library can be
+ * exercised and benchmarked without any real screenshots at hand.
+ * A scene of relative values is rendered into the IR window, with uniform noise added to every pixel, and colored
+ * through the palette tables. The crosshair of the device model is drawn at the requested position with the same
+ * geometry that the locator detects, with a black border around a white fill. Finally, the OSD temperature and
+ * emissivity are drawn from the templates of the OCR fonts, so that the OCR reads them back exactly.
+ * All randomness comes from the seed, so the same options always render the same screenshot.
+ */
+
+// The OSD temperature of the default options
+#define FLARE16X_SYNTH_TEMPERATURE " 25.3C"
+// The OSD emissivity of the default options
+#define FLARE16X_SYNTH_EMISSIVITY "E:0.95"
+
+// Scene enum
+enum {
+    // Two crossed waves, which resemble a smoothly varying real scene
+    FLARE16X_SYNTH_SCENE_WAVES,
+    // A diagonal ramp over the full range of relative values
+    FLARE16X_SYNTH_SCENE_GRADIENT,
+    // A few hot and cold disks in front of a dim ramp
+    FLARE16X_SYNTH_SCENE_SPOTS,
+    // A single relative value, which is the best case for every palette cache
+    FLARE16X_SYNTH_SCENE_FLAT,
+    // The number of scene enum values
+    FLARE16X_SYNTH_SCENE_COUNT
+};
+
+// The options of a synthetic screenshot
+typedef struct {
+    // The device model as defined in FLARE16X_LOCATOR_MODEL_*, which has to be a TG165 or TG167
+    uint8_t device_model;
+    // The palette as defined in FLARE16X_PALETTES_*
+    uint8_t palette;
+    // The scene as defined in FLARE16X_SYNTH_SCENE_*
+    uint8_t scene;
+    // The maximum deviation of the uniform noise added to every relative value
+    uint8_t noise;
+    // The x-coordinate of the crosshair's upper left origin relative to the IR canvas
+    uint16_t crosshair_x;
+    // The y-coordinate of the crosshair's upper left origin relative to the IR canvas
+    uint16_t crosshair_y;
+    // The seed of the scene and noise
+    uint32_t seed;
+    // The OSD temperature of FLARE16X_LOCATOR_TEMPERATURE_DIGITS characters, e.g. " 25.3C", or null for none
+    const char* temperature;
+    // The OSD emissivity of FLARE16X_LOCATOR_EMISSIVITY_DIGITS characters, e.g. "E:0.95", or null for none
+    const char* emissivity;
+} flare16x_synth_options;
+
+// Fills in the options of a wave scene with a little noise and the crosshair in the center of the IR image
+flare16x_error flare16x_synth_defaults(uint8_t device_model, uint8_t palette, flare16x_synth_options* options);
+
+// Renders a synthetic screenshot into a new top-down RGB565 bitmap
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_synth_render(const flare16x_synth_options* options, flare16x_bitmap* screenshot);
+
+#endif //FLARE16X_SYNTH_H
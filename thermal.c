@@ -6,9 +6,13 @@
 // thermal.c: Functions for working with infrared image data
 //
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "error.h"
+#include "profile.h"
+#include "bitmap.h"
 #include "canvas.h"
 #include "locator.h"
 #include "ocr.h"
@@ -16,10 +20,8 @@
 
 #include "thermal.h"
 
-// Initializes the thermal context using a locator struct and calculates the crosshair mask
-// Will destroy the locator struct supplied by moving its pointers to the thermal context
-// Will overwrite any existing state and WILL leak memory if a previous state is re-used
-flare16x_error flare16x_thermal_create(flare16x_locator* locator, flare16x_thermal* thermal)
+// Implements flare16x_thermal_create without profiling
+static flare16x_error flare16x_thermal_create_untimed(flare16x_locator* locator, flare16x_thermal* thermal)
 {
     // Make sure the locator and thermal structs are not null
     if (locator == NULL || thermal == NULL || locator->ir_canvas == NULL || locator->text_canvas == NULL ||
@@ -83,9 +85,20 @@ flare16x_error flare16x_thermal_create(flare16x_locator* locator, flare16x_therm
     return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_THERMAL);
 }
 
-// Runs OCR on the image and attempts to parse the OSD text
-// If this function returns no error, it is safe to destroy the text image
-flare16x_error flare16x_thermal_ocr(flare16x_thermal* thermal)
+// Initializes the thermal context using a locator struct and calculates the crosshair mask
+// Will destroy the locator struct supplied by moving its pointers to the thermal context
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_thermal_create(flare16x_locator* locator, flare16x_thermal* thermal)
+{
+    // Time the whole creation, if profiling is enabled
+    uint64_t start = flare16x_profile_begin();
+    flare16x_error error = flare16x_thermal_create_untimed(locator, thermal);
+    flare16x_profile_end(FLARE16X_PROFILE_THERMAL_CREATE, start);
+    return error;
+}
+
+// Implements flare16x_thermal_ocr without profiling
+static flare16x_error flare16x_thermal_ocr_untimed(flare16x_thermal* thermal, flare16x_thermal_ocr_cache* cache)
 {
     // Make sure the thermal struct is not null
     if (thermal == NULL || thermal->text_image == NULL || thermal->text_image->pixels == NULL)
@@ -104,52 +117,161 @@ flare16x_error flare16x_thermal_ocr(flare16x_thermal* thermal)
     memset(temperature_string, 0, FLARE16X_LOCATOR_TEMPERATURE_DIGITS + 1);
     memset(emissivity_string, 0, FLARE16X_LOCATOR_EMISSIVITY_DIGITS + 1);
 
-    // Run the OCR on the temperature first
+    // Describe the temperature and emissivity fields of the text strip
+    flare16x_ocr_field fields[2] =
+        {
+            {FLARE16X_LOCATOR_TEMPERATURE_OFFSET_X, FLARE16X_LOCATOR_TEMPERATURE_OFFSET_Y,
+                    FLARE16X_LOCATOR_TEMPERATURE_PITCH, FLARE16X_LOCATOR_TEMPERATURE_DIGITS, 0,
+                    &flare16x_ocr_large_font, temperature_string, 0, 0},
+            {FLARE16X_LOCATOR_EMISSIVITY_OFFSET_X, FLARE16X_LOCATOR_EMISSIVITY_OFFSET_Y,
+                    FLARE16X_LOCATOR_EMISSIVITY_PITCH, FLARE16X_LOCATOR_EMISSIVITY_DIGITS, 0,
+                    &flare16x_ocr_small_font, emissivity_string, 0, 0}
+        };
+
+    // Binarize the glyphs of both fields in a single pass over the text image
+    flare16x_ocr_glyphs glyphs;
     flare16x_error error;
-    error = flare16x_ocr_large_string(FLARE16X_LOCATOR_TEMPERATURE_OFFSET_X, FLARE16X_LOCATOR_TEMPERATURE_OFFSET_Y,
-            FLARE16X_LOCATOR_TEMPERATURE_PITCH, FLARE16X_LOCATOR_TEMPERATURE_DIGITS, 0,
-            thermal->text_image, temperature_string);
+    error = flare16x_ocr_strip_binarize(thermal->text_image, fields, 2, &glyphs);
     if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
         return flare16x_error_wrap(flare16x_error_make(FLARE16X_ERROR_CALLEE, FLARE16X_ERROR_SOURCE_THERMAL),
                 error);
 
-    // Followed by an OCR on the emissivity
-    error = flare16x_ocr_small_string(FLARE16X_LOCATOR_EMISSIVITY_OFFSET_X, FLARE16X_LOCATOR_EMISSIVITY_OFFSET_Y,
-            FLARE16X_LOCATOR_EMISSIVITY_PITCH, FLARE16X_LOCATOR_EMISSIVITY_DIGITS, 0,
-            thermal->text_image, emissivity_string);
+    // If the glyphs are the same as in the previous frame, reuse its values
+    uint64_t fingerprint = 0;
+    if (cache != NULL)
+    {
+        fingerprint = flare16x_ocr_fingerprint(fields, 2, &glyphs);
+        cache->lookups++;
+        if (cache->valid && cache->fingerprint == fingerprint)
+        {
+            cache->hits++;
+            thermal->temperature_spot = cache->temperature_spot;
+            thermal->emissivity = cache->emissivity;
+            thermal->temperature_flags = cache->temperature_flags;
+            return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_THERMAL);
+        }
+
+        // The cache is only refilled once the new text has been read successfully
+        cache->valid = 0;
+    }
+
+    // Otherwise, recognize the glyphs
+    error = flare16x_ocr_strip_match(fields, 2, &glyphs);
     if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
         return flare16x_error_wrap(flare16x_error_make(FLARE16X_ERROR_CALLEE, FLARE16X_ERROR_SOURCE_THERMAL),
-               error);
+                error);
+
+    // Next, parse the temperature, which may also turn out to be out of range
+    flare16x_error temperature_error;
+    temperature_error = flare16x_thermal_parse_temperature(temperature_string, FLARE16X_LOCATOR_TEMPERATURE_DIGITS,
+            &thermal->temperature_spot, &thermal->temperature_flags);
+    if (flare16x_error_reason(temperature_error) != FLARE16X_ERROR_NONE &&
+        flare16x_error_reason(temperature_error) != FLARE16X_ERROR_RANGE)
+        return temperature_error;
+
+    // Followed by the emissivity, which is read even if the temperature is out of range
+    error = flare16x_thermal_parse_emissivity(emissivity_string, FLARE16X_LOCATOR_EMISSIVITY_DIGITS,
+            &thermal->emissivity);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return error;
+    if (flare16x_error_reason(temperature_error) != FLARE16X_ERROR_NONE)
+        return temperature_error;
+
+    // Remember the values for the next frame
+    if (cache != NULL)
+    {
+        cache->valid = 1;
+        cache->fingerprint = fingerprint;
+        cache->temperature_spot = thermal->temperature_spot;
+        cache->emissivity = thermal->emissivity;
+        cache->temperature_flags = thermal->temperature_flags;
+    }
+
+    // That's it, return success
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_THERMAL);
+}
+
+// Runs OCR on the image and attempts to parse the OSD text
+// The optional cache skips the recognition and parsing, if the text is the same as in the previous frame
+// If this function returns no error, it is safe to destroy the text image
+flare16x_error flare16x_thermal_ocr(flare16x_thermal* thermal, flare16x_thermal_ocr_cache* cache)
+{
+    // Time the whole OCR, if profiling is enabled
+    uint64_t start = flare16x_profile_begin();
+    flare16x_error error = flare16x_thermal_ocr_untimed(thermal, cache);
+    flare16x_profile_end(FLARE16X_PROFILE_THERMAL_OCR, start);
+    return error;
+}
 
-    // Next, read the temperature
-    char temperature_unit = 0;
-    int temperature, temperature_integer = 0, temperature_fractional = 0;
-    if (sscanf(temperature_string, "%d.%1u%c", &temperature_integer, &temperature_fractional,
-            &temperature_unit) != 3)
+// Parses the glyphs of the OSD temperature into degrees celsius times 10 without any intermediate string
+// Parsing stops at the first null glyph or after length glyphs and sets the flags defined in FLARE16X_THERMAL_OSD_*
+// An overrange reading or one that does not fit into 16 bits fails with a range error, but still sets its flags
+flare16x_error flare16x_thermal_parse_temperature(const char* glyphs, uint8_t length, int16_t* temperature,
+        uint8_t* flags)
+{
+    // Make sure the glyphs and outputs are not null
+    if (glyphs == NULL || temperature == NULL || flags == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_THERMAL);
+
+    // Stop at the first null glyph
+    uint8_t end = 0, position = 0;
+    while (end < length && glyphs[end] != 0)
+        end++;
+
+    // Skip the leading blanks
+    *flags = 0;
+    while (position < end && glyphs[position] == ' ')
+        position++;
+
+    // Check for the minus sign
+    if (position < end && glyphs[position] == '-')
+    {
+        *flags |= FLARE16X_THERMAL_OSD_NEGATIVE;
+        position++;
+    }
+
+    // An overrange reading shows "OL" instead of the digits, optionally followed by the unit
+    if (end - position >= 2 && glyphs[position] == 'O' && glyphs[position + 1] == 'L')
+    {
+        position += 2;
+        if (position < end && glyphs[position] == 'F')
+            *flags |= FLARE16X_THERMAL_OSD_FAHRENHEIT;
+        *flags |= FLARE16X_THERMAL_OSD_OVERRANGE;
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_THERMAL);
+    }
+
+    // Read the integer digits in tenths of a degree, limiting them to the digits that fit into the display
+    int32_t tenths = 0;
+    uint8_t digits = 0;
+    while (position < end && glyphs[position] >= '0' && glyphs[position] <= '9' && digits < 4)
+    {
+        tenths = tenths * 10 + (glyphs[position++] - '0');
+        digits++;
+    }
+
+    // The integer digits are followed by the decimal point and exactly one fractional digit
+    if (digits == 0 || end - position < 3 || glyphs[position] != '.' || glyphs[position + 1] < '0' ||
+        glyphs[position + 1] > '9')
         return flare16x_error_make(FLARE16X_ERROR_IMAGE, FLARE16X_ERROR_SOURCE_THERMAL);
+    tenths = tenths * 10 + (glyphs[position + 1] - '0');
+    position += 2;
 
-    // Check, if the temperature is negative and negate the fractional
-    if (temperature_integer < 0)
-        temperature_fractional = -temperature_fractional;
+    // Apply the sign, which also covers readings between zero and minus one degree
+    if (*flags & FLARE16X_THERMAL_OSD_NEGATIVE)
+        tenths = -tenths;
 
-    // Check, assemble and optionally convert the temperature
-    switch (temperature_unit)
+    // Check and optionally convert the unit
+    switch (glyphs[position++])
     {
         // Degrees celsius
         case 'C':
-            // Conversion is simple here
-            thermal->temperature_spot = temperature_integer * 10 + temperature_fractional;
             break;
 
-        // Degrees fahrenheit (convert it to celsius)
+        // Degrees fahrenheit (convert it to celsius, rounding to the nearest tenth)
         case 'F':
-            // The buffering of the temperature is desired, as the maximum temperature that can be stored in 16 bits
-            // is 687,36F which results in about 363,89C, which is at the edge of the device's resolution
-            temperature = ((temperature_integer - 32) * 10 + temperature_fractional) * 5;
-            // Round up, if the remainder is larger than 4
-            if (temperature % 9 >= 5)
-                temperature += 8;
-            thermal->temperature_spot = temperature / 9;
+            *flags |= FLARE16X_THERMAL_OSD_FAHRENHEIT;
+            tenths = (tenths - 320) * 5;
+            tenths = tenths >= 0 ? (tenths + 4) / 9 : -((-tenths + 4) / 9);
             break;
 
         // Unknown unit
@@ -157,24 +279,122 @@ flare16x_error flare16x_thermal_ocr(flare16x_thermal* thermal)
             return flare16x_error_make(FLARE16X_ERROR_IMAGE, FLARE16X_ERROR_SOURCE_THERMAL);
     }
 
-    // Next, prepare reading the emissivity
-    char emissivity_prefix[3];
+    // Only blanks may follow the unit
+    while (position < end && glyphs[position] == ' ')
+        position++;
+    if (position != end)
+        return flare16x_error_make(FLARE16X_ERROR_IMAGE, FLARE16X_ERROR_SOURCE_THERMAL);
+
+    // A reading that does not fit into the temperature is treated like an overrange reading
+    if (tenths < INT16_MIN || tenths > INT16_MAX)
+    {
+        *flags |= FLARE16X_THERMAL_OSD_OVERRANGE;
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_THERMAL);
+    }
+
+    *temperature = (int16_t)tenths;
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_THERMAL);
+}
+
+// Parses the glyphs of the OSD emissivity into the emissivity times 100 without any intermediate string
+// Parsing stops at the first null glyph or after length glyphs
+flare16x_error flare16x_thermal_parse_emissivity(const char* glyphs, uint8_t length, uint8_t* emissivity)
+{
+    // Make sure the glyphs and output are not null
+    if (glyphs == NULL || emissivity == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_THERMAL);
 
-    // Clear the prefix
-    memset(emissivity_prefix, 0, 3);
+    // Stop at the first null glyph
+    uint8_t end = 0, position = 0;
+    while (end < length && glyphs[end] != 0)
+        end++;
 
-    // Read the values
-    if (sscanf(emissivity_string, "%2s0.%2hhu", emissivity_prefix, &thermal->emissivity) != 2)
+    // Skip the leading blanks
+    while (position < end && glyphs[position] == ' ')
+        position++;
+
+    // Verify the "E:0." prefix
+    if (end - position < 5 || glyphs[position] != 'E' || glyphs[position + 1] != ':' ||
+        glyphs[position + 2] != '0' || glyphs[position + 3] != '.')
         return flare16x_error_make(FLARE16X_ERROR_IMAGE, FLARE16X_ERROR_SOURCE_THERMAL);
+    position += 4;
+
+    // Read up to two fractional digits in hundredths
+    uint8_t value = 0, digits = 0;
+    while (position < end && glyphs[position] >= '0' && glyphs[position] <= '9' && digits < 2)
+    {
+        value = (uint8_t)(value * 10 + (glyphs[position++] - '0'));
+        digits++;
+    }
+    if (digits == 1)
+        value *= 10;
 
-    // Verify the prefix and value
-    if (strcmp(emissivity_prefix, "E:") != 0 || thermal->emissivity == 0 || thermal->emissivity > 99)
+    // Only blanks may follow the digits
+    while (position < end && glyphs[position] == ' ')
+        position++;
+
+    // Verify the value
+    if (digits == 0 || position != end || value == 0)
         return flare16x_error_make(FLARE16X_ERROR_IMAGE, FLARE16X_ERROR_SOURCE_THERMAL);
 
-    // That's it, return success
+    *emissivity = value;
     return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_THERMAL);
 }
 
+// Reads only the OSD text lines of a screenshot file and runs the OCR on them without decoding the IR image
+// Only the temperature, emissivity and text image of the thermal context are filled in
+// The optional cache is passed on to the OCR
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_thermal_probe(FILE* screenshot_file, flare16x_thermal* thermal,
+        flare16x_thermal_ocr_cache* cache)
+{
+    // Make sure the file and thermal struct are not null
+    if (screenshot_file == NULL || thermal == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_THERMAL);
+
+    // Zero the thermal context first
+    memset(thermal, 0, sizeof(flare16x_thermal));
+
+    // Load and validate the bitmap headers only
+    flare16x_bitmap bitmap;
+    flare16x_error error = flare16x_bitmap_load_header(screenshot_file, &bitmap);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return flare16x_error_wrap(flare16x_error_make(FLARE16X_ERROR_CALLEE, FLARE16X_ERROR_SOURCE_THERMAL),
+                error);
+
+    // Check, if the size of the bitmap matches
+    if (bitmap.dib->width != FLARE16X_LOCATOR_EXPECTED_WIDTH ||
+        abs(bitmap.dib->height) != FLARE16X_LOCATOR_EXPECTED_HEIGHT)
+    {
+        flare16x_bitmap_destroy(&bitmap);
+        return flare16x_error_make(FLARE16X_ERROR_IMAGE, FLARE16X_ERROR_SOURCE_THERMAL);
+    }
+
+    // Allocate the text image and read only the text lines into it
+    thermal->text_image = malloc(sizeof(flare16x_canvas));
+    if (thermal->text_image == NULL)
+    {
+        flare16x_bitmap_destroy(&bitmap);
+        return flare16x_error_make(FLARE16X_ERROR_MALLOC, FLARE16X_ERROR_SOURCE_THERMAL);
+    }
+    error = flare16x_bitmap_read_region(&bitmap, screenshot_file, FLARE16X_LOCATOR_TEXT_OFFSET_X,
+            FLARE16X_LOCATOR_TEXT_OFFSET_Y, FLARE16X_LOCATOR_TEXT_WIDTH, FLARE16X_LOCATOR_TEXT_HEIGHT,
+            thermal->text_image);
+
+    // The headers are not needed anymore
+    flare16x_bitmap_destroy(&bitmap);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+    {
+        free(thermal->text_image);
+        thermal->text_image = NULL;
+        return flare16x_error_wrap(flare16x_error_make(FLARE16X_ERROR_CALLEE, FLARE16X_ERROR_SOURCE_THERMAL),
+                error);
+    }
+
+    // Finally, run the OCR on the text image
+    return flare16x_thermal_ocr(thermal, cache);
+}
+
 // Runs the palette analysis and converts the visible light image into relative IR data
 // This step may take a while, as it calculates every pixel at least twice
 // If this function returns no error, it is safe to destroy the thermal image
@@ -206,6 +426,9 @@ flare16x_error flare16x_thermal_process(flare16x_thermal* thermal, uint8_t inter
         return flare16x_error_wrap(flare16x_error_make(FLARE16X_ERROR_CALLEE, FLARE16X_ERROR_SOURCE_THERMAL),
                                    error);
 
+    // Keep track of the detected palette
+    thermal->palette = palette_index;
+
     // Allocate memory for the new relative infrared image struct
     thermal->thermal_image = malloc(sizeof(flare16x_thermal_image));
     if (thermal->thermal_image == NULL)
@@ -231,6 +454,10 @@ flare16x_error flare16x_thermal_process(flare16x_thermal* thermal, uint8_t inter
     // This counter counts any skipped points
     uint32_t skipped_points = 0;
 
+    // These counters count the invalid and crosshair points and the neighbours visited for the profile
+    uint32_t invalid_points = 0, crosshair_points = 0;
+    uint64_t neighbour_visits = 0;
+
     // For the min, max and med, keep the respective markers
     uint32_t value_med_sum = 0, value_med_count = 0;
     uint8_t value_min = 0xff, value_max = 0;
@@ -243,6 +470,7 @@ flare16x_error flare16x_thermal_process(flare16x_thermal* thermal, uint8_t inter
     flare16x_palettes_cache_init(&palette_cache);
 
     // Perform the first iteration over the input pixel data and process all non-crosshair pixels and verify the mask
+    uint64_t pass_start = flare16x_profile_begin();
     int x, y;
     for (y = 0; y < thermal->visible_image->height; y++)
         for (x = 0; x < thermal->visible_image->width; x++)
@@ -275,6 +503,7 @@ flare16x_error flare16x_thermal_process(flare16x_thermal* thermal, uint8_t inter
 
                         // Finally, count this pixel as skipped
                         skipped_points++;
+                        invalid_points++;
 
                         // And move on to the next pixel
                         break;
@@ -374,6 +603,7 @@ flare16x_error flare16x_thermal_process(flare16x_thermal* thermal, uint8_t inter
                     // Check, if this is the first line with crosshair data and store the current one, if true
                     if (start_y < 0)
                         start_y = y;
+                    crosshair_points++;
 
                     // Check, if the zero interpolation mode is used
                     if (interpolation_mode == FLARE16X_THERMAL_INTERPOLATION_ZERO)
@@ -397,6 +627,14 @@ flare16x_error flare16x_thermal_process(flare16x_thermal* thermal, uint8_t inter
             }
         }
 
+    flare16x_profile_end(FLARE16X_PROFILE_THERMAL_DECODE, pass_start);
+
+    // Add the counts of the first pass to the profile
+    flare16x_profile_count(FLARE16X_PROFILE_PALETTE_HITS, palette_cache.hits);
+    flare16x_profile_count(FLARE16X_PROFILE_PALETTE_MISSES, palette_cache.misses);
+    flare16x_profile_count(FLARE16X_PROFILE_INVALID_PIXELS, invalid_points);
+    flare16x_profile_count(FLARE16X_PROFILE_CROSSHAIR_PIXELS, crosshair_points);
+
     // Assert: Min <= Max
     if (value_min > value_max)
     {
@@ -425,6 +663,7 @@ flare16x_error flare16x_thermal_process(flare16x_thermal* thermal, uint8_t inter
     uint8_t value_med = value_med_sum / value_med_count;
 
     // As it is necessary, perform a partial second pass
+    pass_start = flare16x_profile_begin();
     for (y = start_y; y < thermal->visible_image->height; y++)
         for (x = 0; x < thermal->visible_image->width; x++)
         {
@@ -448,19 +687,28 @@ flare16x_error flare16x_thermal_process(flare16x_thermal* thermal, uint8_t inter
                     break;
 
                 case FLARE16X_LOCATOR_DETECT_INVALID:
-                    // For invalid pixels, clear them from the mask immediately
-                    mask = FLARE16X_LOCATOR_DETECT_IMAGE;
-                    thermal->mask.pixels[y * thermal->mask.width + x] = mask;
-
-                    // Then, fall through to the regular crosshair routine
+                    // Invalid pixels are cleared from the mask once they have been interpolated
+                    // Clearing them earlier would make the interpolation read their own, uninitialized value
+                    // Fall through to the regular crosshair routine
 
                 case FLARE16X_LOCATOR_DETECT_CROSSHAIR:
+                    // In the zero mode, crosshair pixels have already been set and were not counted in the first pass
+                    if (mask == FLARE16X_LOCATOR_DETECT_CROSSHAIR &&
+                        interpolation_mode == FLARE16X_THERMAL_INTERPOLATION_ZERO)
+                        break;
+
                     // Decrement the skipped pixel counter
                     skipped_points--;
 
                     // Crosshair pixels have to be replaced with interpolated or fixed data
                     switch (interpolation_mode)
                     {
+                        case FLARE16X_THERMAL_INTERPOLATION_ZERO:
+                            // Only invalid pixels are left for the zero mode, which are replaced just the same
+                            flare16x_thermal_image_raw(x, y, thermal->thermal_image).value = 0;
+                            flare16x_thermal_image_raw(x, y, thermal->thermal_image).uncertainty = 1;
+                            break;
+
                         case FLARE16X_THERMAL_INTERPOLATION_MIN:
                             // Simply replace the unknown points with the minimum value observed in the image
                             flare16x_thermal_image_raw(x, y, thermal->thermal_image).value = value_min;
@@ -481,6 +729,7 @@ flare16x_error flare16x_thermal_process(flare16x_thermal* thermal, uint8_t inter
 
                         case FLARE16X_THERMAL_INTERPOLATION_SQUARE_LARGE:
                             // This mode calculates the average value of the surrounding square with size 6
+                            neighbour_visits += 13 * 13;
                             // Check, if each point is within bounds and fetch its value
                             for (offset_y = -6; offset_y <= 6; offset_y++)
                                 for (offset_x = -6; offset_x <= 6; offset_x++)
@@ -496,6 +745,7 @@ flare16x_error flare16x_thermal_process(flare16x_thermal* thermal, uint8_t inter
 
                         case FLARE16X_THERMAL_INTERPOLATION_SQUARE_WEIGHT:
                             // This mode calculates the average value of the surrounding square with size 1 and 2
+                            neighbour_visits += 3 * 3;
                             // Check, if each point is within bounds and fetch its value
                             for (offset_y = -1; offset_y <= 1; offset_y++)
                                 for (offset_x = -1; offset_x <= 1; offset_x++)
@@ -508,6 +758,7 @@ flare16x_error flare16x_thermal_process(flare16x_thermal* thermal, uint8_t inter
 
                         case FLARE16X_THERMAL_INTERPOLATION_SQUARE_SMALL:
                             // This mode calculates the average value of the surrounding square with size 2
+                            neighbour_visits += 5 * 5;
                             // Check, if each point is within bounds and fetch its value
                             for (offset_y = -2; offset_y <= 2; offset_y++)
                                 for (offset_x = -2; offset_x <= 2; offset_x++)
@@ -545,6 +796,10 @@ flare16x_error flare16x_thermal_process(flare16x_thermal* thermal, uint8_t inter
                             return flare16x_error_make(FLARE16X_ERROR_ASSERT, FLARE16X_ERROR_SOURCE_THERMAL);
                     }
 
+                    // Now that the pixel has a value, invalid pixels become regular image pixels
+                    if (mask == FLARE16X_LOCATOR_DETECT_INVALID)
+                        thermal->mask.pixels[y * thermal->mask.width + x] = FLARE16X_LOCATOR_DETECT_IMAGE;
+
                     // And continue
                     break;
 
@@ -566,13 +821,16 @@ flare16x_error flare16x_thermal_process(flare16x_thermal* thermal, uint8_t inter
         return flare16x_error_make(FLARE16X_ERROR_ASSERT, FLARE16X_ERROR_SOURCE_THERMAL);
     }
 
+    flare16x_profile_end(FLARE16X_PROFILE_THERMAL_INTERPOLATE, pass_start);
+    flare16x_profile_count(FLARE16X_PROFILE_NEIGHBOUR_VISITS, neighbour_visits);
+
     // Success!
     return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_THERMAL);
 }
 
-// Converts the relative thermal image into a visible image using the supplied palette
-// Will overwrite any existing state and WILL leak memory if a previous state is re-used
-flare16x_error flare16x_thermal_export(flare16x_thermal* thermal, uint8_t palette_index, flare16x_canvas* canvas)
+// Implements flare16x_thermal_export without profiling
+static flare16x_error flare16x_thermal_export_untimed(flare16x_thermal* thermal, uint8_t palette_index,
+        flare16x_canvas* canvas)
 {
     // Make sure the thermal struct and canvas are not null
     if (thermal == NULL || thermal->thermal_image == NULL || thermal->thermal_image->points == NULL || canvas == NULL)
@@ -626,12 +884,27 @@ flare16x_error flare16x_thermal_export(flare16x_thermal* thermal, uint8_t palett
             flare16x_canvas_raw(x, y, canvas) = palette_entry->color;
         }
 
+    // Add the cache hits and misses to the profile
+    flare16x_profile_count(FLARE16X_PROFILE_PALETTE_HITS, palette_cache.hits);
+    flare16x_profile_count(FLARE16X_PROFILE_PALETTE_MISSES, palette_cache.misses);
+
     // Success :-)
     return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_THERMAL);
 }
 
-// Adds a custom colored crosshair onto an exported thermal image using the mask
-flare16x_error flare16x_thermal_crosshair(uint16_t crosshair_border, uint16_t crosshair_fill,
+// Converts the relative thermal image into a visible image using the supplied palette
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_thermal_export(flare16x_thermal* thermal, uint8_t palette_index, flare16x_canvas* canvas)
+{
+    // Time the whole export, if profiling is enabled
+    uint64_t start = flare16x_profile_begin();
+    flare16x_error error = flare16x_thermal_export_untimed(thermal, palette_index, canvas);
+    flare16x_profile_end(FLARE16X_PROFILE_THERMAL_EXPORT, start);
+    return error;
+}
+
+// Implements flare16x_thermal_crosshair without profiling
+static flare16x_error flare16x_thermal_crosshair_untimed(uint16_t crosshair_border, uint16_t crosshair_fill,
         flare16x_thermal* thermal, flare16x_canvas* canvas)
 {
     // Make sure the thermal struct and canvas are not null
@@ -784,6 +1057,41 @@ flare16x_error flare16x_thermal_crosshair(uint16_t crosshair_border, uint16_t cr
     return flare16x_error_make(FLARE16X_THERMAL_MASK_NONE, FLARE16X_ERROR_SOURCE_THERMAL);
 }
 
+// Adds a custom colored crosshair onto an exported thermal image using the mask
+flare16x_error flare16x_thermal_crosshair(uint16_t crosshair_border, uint16_t crosshair_fill,
+        flare16x_thermal* thermal, flare16x_canvas* canvas)
+{
+    // Time the whole drawing, if profiling is enabled
+    uint64_t start = flare16x_profile_begin();
+    flare16x_error error = flare16x_thermal_crosshair_untimed(crosshair_border, crosshair_fill, thermal, canvas);
+    flare16x_profile_end(FLARE16X_PROFILE_THERMAL_CROSSHAIR, start);
+    return error;
+}
+
+// Copies the pixels of a canvas that hold the selected value in the mask to an offset on another canvas
+// The mask has to match the dimensions of the source canvas, such as the visible image and its crosshair mask
+flare16x_error flare16x_thermal_merge_masked(flare16x_thermal_mask* mask, uint8_t selected,
+        flare16x_canvas* source_canvas, int16_t target_offset_x, int16_t target_offset_y,
+        flare16x_canvas* target_canvas)
+{
+    // Make sure the mask and canvas are not null
+    if (mask == NULL || mask->pixels == NULL || source_canvas == NULL)
+        return flare16x_error_make(FLARE16X_ERROR_NULL, FLARE16X_ERROR_SOURCE_THERMAL);
+
+    // Check, if the dimensions of the mask and the source canvas match
+    if (mask->width != source_canvas->width || mask->height != source_canvas->height)
+        return flare16x_error_make(FLARE16X_ERROR_RANGE, FLARE16X_ERROR_SOURCE_THERMAL);
+
+    // Then, copy the selected pixels
+    flare16x_error error = flare16x_canvas_merge_masked(source_canvas, mask->pixels, selected, 0, 0,
+            target_offset_x, target_offset_y, source_canvas->width, source_canvas->height, target_canvas);
+    if (flare16x_error_reason(error) != FLARE16X_ERROR_NONE)
+        return flare16x_error_wrap(flare16x_error_make(FLARE16X_ERROR_CALLEE, FLARE16X_ERROR_SOURCE_THERMAL),
+                error);
+
+    return flare16x_error_make(FLARE16X_ERROR_NONE, FLARE16X_ERROR_SOURCE_THERMAL);
+}
+
 // Frees all resources used by a thermal struct including the canvas data
 flare16x_error flare16x_thermal_destroy(flare16x_thermal* thermal)
 {
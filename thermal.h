@@ -10,6 +10,7 @@
 #define FLARE16X_THERMAL_H
 
 #include <stdint.h>
+#include <stdio.h>
 
 #include "locator.h"
 #include "canvas.h"
@@ -92,8 +93,12 @@ typedef struct {
     int16_t temperature_max;
     // The emissivity times 100 identified via OCR (0.95 => 95)
     uint8_t emissivity;
+    // The flags of the spot temperature as defined in FLARE16X_THERMAL_OSD_*
+    uint8_t temperature_flags;
     // The device model as defined in FLARE16X_LOCATOR_MODEL_*
     uint8_t device_model;
+    // The palette detected while processing as defined in FLARE16X_PALETTES_*
+    uint8_t palette;
     // The y-coordinate of the aperture spot's upper left origin relative to the IR canvas
     uint16_t spot_x;
     // The y-coordinate of the aperture spot's upper left origin relative to the IR canvas
@@ -104,6 +109,34 @@ typedef struct {
     uint16_t spot_height;
 } flare16x_thermal;
 
+// Enum describing the flags of the spot temperature shown by the OSD
+enum {
+    // The temperature is shown in degrees fahrenheit
+    FLARE16X_THERMAL_OSD_FAHRENHEIT = 0x1u,
+    // The temperature is shown with a minus sign
+    FLARE16X_THERMAL_OSD_NEGATIVE = 0x2u,
+    // The temperature is outside of the measurement range, which the OSD shows as "OL"
+    FLARE16X_THERMAL_OSD_OVERRANGE = 0x4u
+};
+
+// Remembers the OSD text of the previous frame, so that frames showing the same text skip its recognition
+typedef struct {
+    // Non-zero, if the cache holds the result of a previous frame
+    uint8_t valid;
+    // The fingerprint of the glyphs of the previous frame
+    uint64_t fingerprint;
+    // The spot temperature read from the previous frame
+    int16_t temperature_spot;
+    // The emissivity read from the previous frame
+    uint8_t emissivity;
+    // The flags of the spot temperature read from the previous frame
+    uint8_t temperature_flags;
+    // The number of frames looked up in the cache
+    uint32_t lookups;
+    // The number of frames whose text was found in the cache
+    uint32_t hits;
+} flare16x_thermal_ocr_cache;
+
 // Enum describing the crosshair removal mode
 enum {
     // The crosshair's pixels are replaced with the zero IR intensity value
@@ -147,8 +180,26 @@ FLARE16X_LOCATOR_DETECT_IMAGE )
 flare16x_error flare16x_thermal_create(flare16x_locator* locator, flare16x_thermal* thermal);
 
 // Runs OCR on the image and attempts to parse the OSD text
+// The optional cache skips the recognition and parsing, if the text is the same as in the previous frame
 // If this function returns no error, it is safe to destroy the text image
-flare16x_error flare16x_thermal_ocr(flare16x_thermal* thermal);
+flare16x_error flare16x_thermal_ocr(flare16x_thermal* thermal, flare16x_thermal_ocr_cache* cache);
+
+// Parses the glyphs of the OSD temperature into degrees celsius times 10 without any intermediate string
+// Parsing stops at the first null glyph or after length glyphs and sets the flags defined in FLARE16X_THERMAL_OSD_*
+// An overrange reading or one that does not fit into 16 bits fails with a range error, but still sets its flags
+flare16x_error flare16x_thermal_parse_temperature(const char* glyphs, uint8_t length, int16_t* temperature,
+        uint8_t* flags);
+
+// Parses the glyphs of the OSD emissivity into the emissivity times 100 without any intermediate string
+// Parsing stops at the first null glyph or after length glyphs
+flare16x_error flare16x_thermal_parse_emissivity(const char* glyphs, uint8_t length, uint8_t* emissivity);
+
+// Reads only the OSD text lines of a screenshot file and runs the OCR on them without decoding the IR image
+// Only the temperature, emissivity and text image of the thermal context are filled in
+// The optional cache is passed on to the OCR
+// Will overwrite any existing state and WILL leak memory if a previous state is re-used
+flare16x_error flare16x_thermal_probe(FILE* screenshot_file, flare16x_thermal* thermal,
+        flare16x_thermal_ocr_cache* cache);
 
 // Runs the palette analysis and converts the visible light image into relative IR data
 // This step may take a while, as it calculates every pixel at least twice
@@ -164,6 +215,12 @@ flare16x_error flare16x_thermal_export(flare16x_thermal* thermal, uint8_t palett
 flare16x_error flare16x_thermal_crosshair(uint16_t crosshair_border, uint16_t crosshair_fill,
                                           flare16x_thermal* thermal, flare16x_canvas* canvas);
 
+// Copies the pixels of a canvas that hold the selected value in the mask to an offset on another canvas
+// The mask has to match the dimensions of the source canvas, such as the visible image and its crosshair mask
+flare16x_error flare16x_thermal_merge_masked(flare16x_thermal_mask* mask, uint8_t selected,
+        flare16x_canvas* source_canvas, int16_t target_offset_x, int16_t target_offset_y,
+        flare16x_canvas* target_canvas);
+
 // Frees all resources used by a thermal struct including the canvas data
 flare16x_error flare16x_thermal_destroy(flare16x_thermal* thermal);
 